@@ -0,0 +1,65 @@
+#pragma once
+
+#include "v8.h"
+#include "piston_native_class.h"
+#include "piston_native_module.h"
+#include <runtime/performance_monitor.h>
+#include <set>
+#include <string>
+
+using namespace v8;
+using namespace piston;
+using namespace mosaic::runtime;
+
+namespace mosaic::diagnostics {
+	class Performance : public NativeClass<Performance> {
+		public:
+			/* V8 members */
+			static Local<Function> Make(Local<Context> context);
+			static Local<Object> EntryToObject(Local<Context> context, const PerformanceMonitor::Entry& entry);
+			static void ConstructorCallback(const FunctionCallbackInfo<Value> &args);
+			static void NowCallback(const FunctionCallbackInfo<Value> &args);
+			static void GetEntriesCallback(const FunctionCallbackInfo<Value> &args);
+			static void GetEventLoopLagCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void GetLongTaskThresholdCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void SetLongTaskThresholdCallback(Local<String> property, Local<Value> value, const PropertyCallbackInfo<void>& info);
+
+		private:
+			Performance() {};
+			~Performance() {};
+	};
+
+	class PerformanceObserver : public NativeClass<PerformanceObserver> {
+		public:
+			/* Native members */
+			void Observe(std::set<std::string> entry_types);
+			void Disconnect();
+
+			/* V8 members */
+			static Local<Function> Make(Local<Context> context);
+			static void ConstructorCallback(const FunctionCallbackInfo<Value> &args);
+			static void ObserveCallback(const FunctionCallbackInfo<Value> &args);
+			static void DisconnectCallback(const FunctionCallbackInfo<Value> &args);
+			static void ListGetEntriesCallback(const FunctionCallbackInfo<Value> &args);
+
+		protected:
+			PerformanceObserver(Isolate* isolate, Local<Function> callback);
+			~PerformanceObserver();
+			void Notify(const std::vector<PerformanceMonitor::Entry>& entries);
+
+			/* Native fields */
+			std::set<std::string> entry_types_;
+			int listener_id_;
+
+			/* V8 fields */
+			Persistent<Function> callback_;
+	};
+
+	class PerformanceModule : public NativeModule<PerformanceModule> {
+		public:
+			static Local<Module> Make(Isolate* isolate);
+
+		protected:
+			using NativeModule<PerformanceModule>::NativeModule;
+	};
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "v8.h"
+#include "piston_native_class.h"
+#include "piston_native_module.h"
+#include <sys/stat.h>
+#include <functional>
+#include <memory>
+#include <string>
+
+using namespace v8;
+using namespace piston;
+
+namespace mosaic::io {
+	class File : public NativeClass<File> {
+		public:
+			/* Native members */
+			using ReadDone = std::function<void(int error, char* data, size_t length)>;
+			using WriteDone = std::function<void(int error, size_t written)>;
+			using StatDone = std::function<void(int error, const struct statx& stat)>;
+			using OpenDone = std::function<void(int error, int fd)>;
+			using TransferDone = std::function<void(int error, size_t count)>;
+
+			static bool IsUsingIoRing();
+			static void Read(std::string path, ReadDone done);
+			static void Write(std::string path, std::shared_ptr<BackingStore> store, const char* data, size_t length, WriteDone done);
+			static void Stat(std::string path, StatDone done);
+			static void Open(std::string path, int flags, OpenDone done);
+			/* Transfer at the given offset, or at the current position when it is -1. */
+			static void ReadSome(int fd, char* buffer, size_t size, off_t offset, TransferDone done);
+			static void WriteSome(int fd, const char* data, size_t length, off_t offset, TransferDone done);
+			static void Close(int fd);
+
+			/* V8 members */
+			static Local<Function> Make(Local<Context> context);
+			static void ConstructorCallback(const FunctionCallbackInfo<Value> &args);
+			static void ReadCallback(const FunctionCallbackInfo<Value> &args);
+			static void ReadTextCallback(const FunctionCallbackInfo<Value> &args);
+			static void WriteCallback(const FunctionCallbackInfo<Value> &args);
+			static void StatCallback(const FunctionCallbackInfo<Value> &args);
+			static void ReadDirCallback(const FunctionCallbackInfo<Value> &args);
+			static void OpenReadCallback(const FunctionCallbackInfo<Value> &args);
+			static void OpenWriteCallback(const FunctionCallbackInfo<Value> &args);
+
+		private:
+			File() {};
+			~File() {};
+	};
+
+	class FileModule : public NativeModule<FileModule> {
+		public:
+			static Local<Module> Make(Isolate* isolate);
+
+		protected:
+			using NativeModule<FileModule>::NativeModule;
+	};
+}
\ No newline at end of file
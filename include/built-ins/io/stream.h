@@ -0,0 +1,154 @@
+#pragma once
+
+#include "v8.h"
+#include "piston_native_class.h"
+#include "piston_native_module.h"
+#include <runtime/buffer_pool.h>
+#include <runtime/pending_promise.h>
+#include <deque>
+#include <memory>
+#include <string>
+
+using namespace v8;
+using namespace piston;
+
+namespace mosaic::io {
+	/**
+	 * Readable byte stream over a file or pipe.
+	 *
+	 * Native reads fill pooled chunks until the queued bytes reach the high
+	 * water mark, then pause until JS consumes chunks with read(). Streams
+	 * dropped by JS are collected, except while a read is in flight.
+	 */
+	class ReadableStream : public NativeClass<ReadableStream> {
+		public:
+			/* Native members */
+			void Read(std::shared_ptr<runtime::PendingPromise> pending);
+			void Cancel();
+			inline size_t GetHighWaterMark() { return high_water_mark_; }
+			inline long GetDesiredSize() { return (long)high_water_mark_ - (long)queued_bytes_; }
+
+			/* V8 members */
+			static Local<Function> Make(Local<Context> context);
+			static Local<Object> FromPath(Local<Context> context, std::string path, size_t chunk_size, size_t high_water_mark);
+			static void ConstructorCallback(const FunctionCallbackInfo<Value> &args);
+			static void ReadCallback(const FunctionCallbackInfo<Value> &args);
+			static void CancelCallback(const FunctionCallbackInfo<Value> &args);
+			static void GetReaderCallback(const FunctionCallbackInfo<Value> &args);
+			static void ReleaseLockCallback(const FunctionCallbackInfo<Value> &args);
+			static void AsyncIteratorCallback(const FunctionCallbackInfo<Value> &args);
+			static void IteratorNextCallback(const FunctionCallbackInfo<Value> &args);
+			static void IteratorReturnCallback(const FunctionCallbackInfo<Value> &args);
+			static void GetDesiredSizeCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void GetHighWaterMarkCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+
+		protected:
+			struct Chunk {
+				char* data;
+				size_t length;
+			};
+
+			ReadableStream(std::string path, size_t chunk_size, size_t high_water_mark);
+			~ReadableStream();
+			void Pump();
+			void UpdateWeak();
+			void OnRead(int error, char* buffer, size_t count);
+			void Settle();
+			void ResolveChunk(std::shared_ptr<runtime::PendingPromise> pending, Chunk chunk);
+			void ResolveDone(std::shared_ptr<runtime::PendingPromise> pending);
+
+			std::string path_;
+			int fd_;
+			off_t position_;
+			bool opening_;
+			bool reading_;
+			bool ended_;
+			int error_;
+			runtime::BufferPool* pool_;
+			size_t high_water_mark_;
+			size_t queued_bytes_;
+			std::deque<Chunk> chunks_;
+			std::deque<std::shared_ptr<runtime::PendingPromise>> pending_reads_;
+
+			/* Constructor locking */
+			static inline void UnlockConstructor() { lock_constructor_ = false; }
+			static inline void LockConstructor() { lock_constructor_ = true; }
+			static inline bool IsConstructorLocked() { return lock_constructor_; }
+			static bool lock_constructor_;
+	};
+
+	/**
+	 * Writable byte stream over a file or pipe.
+	 *
+	 * Chunks are written in order without copying. desiredSize and ready
+	 * expose backpressure once the queued bytes exceed the high water mark.
+	 * Like readable streams, they are only kept alive by writes in flight.
+	 */
+	class WritableStream : public NativeClass<WritableStream> {
+		public:
+			/* Native members */
+			void Write(std::shared_ptr<BackingStore> store, const char* data, size_t length, std::shared_ptr<runtime::PendingPromise> pending);
+			void Close(std::shared_ptr<runtime::PendingPromise> pending);
+			void Abort();
+			void WhenReady(std::shared_ptr<runtime::PendingPromise> pending);
+			inline size_t GetHighWaterMark() { return high_water_mark_; }
+			inline long GetDesiredSize() { return (long)high_water_mark_ - (long)queued_bytes_; }
+
+			/* V8 members */
+			static Local<Function> Make(Local<Context> context);
+			static Local<Object> FromPath(Local<Context> context, std::string path, size_t high_water_mark);
+			static void ConstructorCallback(const FunctionCallbackInfo<Value> &args);
+			static void WriteCallback(const FunctionCallbackInfo<Value> &args);
+			static void CloseCallback(const FunctionCallbackInfo<Value> &args);
+			static void AbortCallback(const FunctionCallbackInfo<Value> &args);
+			static void GetWriterCallback(const FunctionCallbackInfo<Value> &args);
+			static void ReleaseLockCallback(const FunctionCallbackInfo<Value> &args);
+			static void GetReadyCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void GetDesiredSizeCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void GetHighWaterMarkCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+
+		protected:
+			struct Chunk {
+				std::shared_ptr<BackingStore> store;
+				const char* data;
+				size_t length;
+				size_t offset;
+				std::shared_ptr<runtime::PendingPromise> pending;
+			};
+
+			WritableStream(std::string path, size_t high_water_mark);
+			~WritableStream();
+			void Flush();
+			void UpdateWeak();
+			void OnWrite(int error, size_t count);
+			void Fail(int error);
+			void NotifyReady();
+
+			std::string path_;
+			int fd_;
+			off_t position_;
+			bool opening_;
+			bool writing_;
+			bool closing_;
+			int error_;
+			size_t high_water_mark_;
+			size_t queued_bytes_;
+			std::deque<Chunk> chunks_;
+			std::deque<std::shared_ptr<runtime::PendingPromise>> ready_waiters_;
+			std::shared_ptr<runtime::PendingPromise> close_promise_;
+
+			/* Constructor locking */
+			static inline void UnlockConstructor() { lock_constructor_ = false; }
+			static inline void LockConstructor() { lock_constructor_ = true; }
+			static inline bool IsConstructorLocked() { return lock_constructor_; }
+			static bool lock_constructor_;
+	};
+
+	class StreamModule : public NativeModule<StreamModule> {
+		public:
+			static Local<Module> Make(Isolate* isolate);
+
+		protected:
+			using NativeModule<StreamModule>::NativeModule;
+	};
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace mosaic::presentation {
+	/**
+	 * Dynamic bounding volume tree over rectangles keyed by integer ids.
+	 *
+	 * Leaves hold each shape's bounds grown by a margin, so shapes that move
+	 * a little are updated without touching the tree. Inserting picks the
+	 * cheapest sibling by surface area and rotations keep the tree balanced,
+	 * which keeps point and range queries logarithmic in the shape count.
+	 */
+	class AabbTree {
+		public:
+			struct Rect {
+				float min_x;
+				float min_y;
+				float max_x;
+				float max_y;
+			};
+
+			AabbTree();
+
+			/* Add a shape, or move it when the id is already used. Later shapes are above earlier ones. */
+			void Set(int32_t id, const Rect& bounds);
+			bool Remove(int32_t id);
+			void Clear();
+
+			inline size_t GetCount() { return leaves_.size(); };
+			inline bool Has(int32_t id) { return leaves_.count(id) > 0; };
+			bool GetBounds(int32_t id, Rect* bounds);
+
+			/* Bytes held by nodes and the id lookup, for external memory accounting. */
+			size_t GetMemorySize();
+
+			/**
+			 * Topmost shape containing a point, edges included.
+			 * @returns False when there is none.
+			 */
+			bool HitTest(float x, float y, int32_t* id);
+
+			/* Call back with every shape intersecting an area, in no particular order. */
+			void Query(const Rect& area, std::function<void(int32_t id)> callback);
+
+			/* Levels below the root, for tests of the balancing. */
+			inline int GetHeight() { return root_ == null_node ? 0 : nodes_[root_].height; };
+
+		private:
+			static const int null_node = -1;
+
+			struct Node {
+				Rect box;
+				int parent;
+				int child1;
+				int child2;
+
+				// 0 for leaves, -1 for nodes in the free list
+				int height;
+
+				// Leaves only: the shape's own bounds, id and stacking order
+				Rect bounds;
+				int32_t id;
+				uint64_t order;
+			};
+
+			int AllocateNode();
+			void FreeNode(int node);
+			void InsertLeaf(int leaf);
+			void RemoveLeaf(int leaf);
+			int Balance(int node);
+			void Refit(int node);
+
+			std::vector<Node> nodes_;
+			int root_;
+			int free_list_;
+			uint64_t next_order_;
+			std::unordered_map<int32_t, int> leaves_;
+
+			/* Traversal stack kept between queries */
+			std::vector<int> stack_;
+	};
+}
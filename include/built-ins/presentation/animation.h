@@ -0,0 +1,110 @@
+#pragma once
+
+#include "v8.h"
+#include "piston_native_class.h"
+#include "piston_native_module.h"
+#include <gtk-3.0/gtk/gtk.h>
+#include <functional>
+
+using namespace v8;
+using namespace piston;
+
+namespace mosaic::presentation {
+	/**
+	 * Timing curve shaped like CSS's cubic-bezier(), from (0, 0) to (1, 1).
+	 */
+	struct Easing {
+		double x1;
+		double y1;
+		double x2;
+		double y2;
+
+		/* Eased progress for a linear progress between 0 and 1. */
+		double Evaluate(double t) const;
+
+		/* Named CSS curves: linear, ease, ease-in, ease-out and ease-in-out. */
+		static bool FromName(const char* name, Easing* easing);
+	};
+
+	/**
+	 * Tween of one numeric property of a native object.
+	 *
+	 * The value is computed and set from the target's frame clock, so an
+	 * animation costs no JS while it runs: the only call back is onFinish.
+	 * Animated layers should be attached to their drawing area, which then
+	 * moves and fades them without running its onDraw again.
+	 *
+	 * Targets are layers (x, y, opacity) and windows (width, height).
+	 * Running animations keep themselves and their target alive, idle ones
+	 * are collected once JS drops them.
+	 */
+	class Animation : public NativeClass<Animation> {
+		public:
+			/* Native members */
+			inline bool IsRunning() { return running_; };
+			void Start();
+			void Cancel();
+			void Finish();
+
+			/* Advance to a frame time in microseconds, false once finished. */
+			bool Tick(gint64 frame_time);
+
+			/* V8 members */
+			static Local<Function> Make(Local<Context> context);
+			static void ConstructorCallback(const FunctionCallbackInfo<Value> &args);
+			static void StartCallback(const FunctionCallbackInfo<Value> &args);
+			static void CancelCallback(const FunctionCallbackInfo<Value> &args);
+			static void FinishCallback(const FunctionCallbackInfo<Value> &args);
+			static void GetRunningCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void GetOnFinishCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void SetOnFinishCallback(Local<String> property, Local<Value> value, const PropertyCallbackInfo<void>& info);
+
+		protected:
+			Animation();
+			~Animation();
+			void SetClockWidget(GtkWidget* widget);
+			bool BindProperty(Local<Context> context, Local<Object> target, const char* property);
+			double Sample(double progress);
+			void Complete();
+			void RemoveTick();
+			static gboolean ReleaseCallback(gpointer user_data);
+
+			/* Native fields */
+			std::function<double()> getter_;
+			std::function<void(double)> setter_;
+
+			/* Widget whose frame clock drives the animation, referenced, or NULL when headless */
+			GtkWidget* clock_widget_;
+			guint tick_id_;
+			bool running_;
+
+			/* Idle source making a finished animation weak again, once its finish event went out */
+			guint release_source_id_;
+			gint64 start_time_;
+
+			/* Timing, durations in milliseconds */
+			bool has_from_;
+			double from_;
+			double start_value_;
+			double to_;
+			double duration_;
+			double delay_;
+			double iterations_;
+			bool alternate_;
+			Easing easing_;
+
+			/* V8 fields */
+			Persistent<Function> finish_callback_;
+
+			/* Keeps the animated object alive, the getter and setter point into it */
+			Persistent<Object> target_;
+	};
+
+	class AnimationModule : public NativeModule<AnimationModule> {
+		public:
+			static Local<Module> Make(Isolate* isolate);
+
+		protected:
+			using NativeModule<AnimationModule>::NativeModule;
+	};
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "v8.h"
+#include "piston_native_class.h"
+#include "piston_native_module.h"
+#include <gtk-3.0/gtk/gtk.h>
+#include <vector>
+
+using namespace v8;
+using namespace piston;
+
+namespace mosaic::presentation {
+	/**
+	 * Many small images packed into a few large surfaces.
+	 *
+	 * Sprites are placed with a skyline bottom-left packer, a new page being
+	 * opened only when none of the current ones has room. Drawing thousands of
+	 * them is one native loop over an instance array, every blit sampling one
+	 * of a handful of page patterns instead of a surface of its own.
+	 */
+	class Atlas : public NativeClass<Atlas> {
+		public:
+			/* Floats per instance given to Draw(): sprite, x, y, scale, rotation, alpha */
+			static const int instance_stride = 6;
+
+			struct Sprite {
+				int page;
+				int x;
+				int y;
+				int width;
+				int height;
+			};
+
+			/* Native members */
+			inline size_t GetSpriteCount() { return sprites_.size(); };
+			inline size_t GetPageCount() { return pages_.size(); };
+
+			/**
+			 * Copy a surface into the atlas.
+			 * @returns The new sprite's index, or -1 when it's larger than a page.
+			 */
+			int Add(cairo_surface_t* surface);
+			void Clear();
+
+			/**
+			 * Draw sprite instances, each centered on its position and rotated and scaled around it.
+			 * Instances naming unknown sprites, or placed with non-finite numbers, are skipped.
+			 */
+			void Draw(cairo_t* cairo_context, const float* instances, size_t count);
+
+			/* V8 members */
+			static Local<Function> Make(Local<Context> context);
+			static bool IsAtlas(Local<Context> context, Local<Value> value);
+			static void ConstructorCallback(const FunctionCallbackInfo<Value> &args);
+			static void AddCallback(const FunctionCallbackInfo<Value> &args);
+			static void ClearCallback(const FunctionCallbackInfo<Value> &args);
+			static void GetSpriteCallback(const FunctionCallbackInfo<Value> &args);
+			static void GetCountCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void GetPageCountCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+
+		protected:
+			/* Span of the skyline, the packed area's top edge from x to x + width */
+			struct SkylineNode {
+				int x;
+				int y;
+				int width;
+			};
+
+			struct Page {
+				cairo_surface_t* surface;
+				cairo_pattern_t* pattern;
+				std::vector<SkylineNode> skyline;
+			};
+
+			Atlas(int page_width, int page_height);
+			~Atlas();
+			bool Pack(Page& page, int width, int height, int* x, int* y);
+			int FitSkyline(Page& page, size_t index, int width, int height);
+
+			/* Native fields */
+			int page_width_;
+			int page_height_;
+			std::vector<Page> pages_;
+			std::vector<Sprite> sprites_;
+	};
+
+	class AtlasModule : public NativeModule<AtlasModule> {
+		public:
+			static Local<Module> Make(Isolate* isolate);
+
+		protected:
+			using NativeModule<AtlasModule>::NativeModule;
+	};
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <gtk-3.0/gtk/gtk.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace mosaic::presentation {
+	/**
+	 * Bulk primitives read straight from typed arrays.
+	 *
+	 * Colors are packed as 0xRRGGBBAA, either one per primitive or a single
+	 * one for all of them. Primitives sharing a color are drawn as one path
+	 * with a single source change, so primitives of different colors are not
+	 * guaranteed to overlap in array order. Ordered batches only merge runs
+	 * of one opaque color, and overlap exactly like separate draws.
+	 */
+	class DrawBatch {
+		public:
+			/* coords holds x, y, width, height for each rectangle. */
+			static void FillRects(cairo_t* cr, const float* coords, size_t count, const uint32_t* colors, size_t color_count, bool ordered);
+
+			/* coords holds x1, y1, x2, y2 for each line. */
+			static void StrokeLines(cairo_t* cr, const float* coords, size_t count, const uint32_t* colors, size_t color_count, double line_width, bool ordered);
+
+			/* coords holds center x, center y, radius for each circle. */
+			static void FillCircles(cairo_t* cr, const float* coords, size_t count, const uint32_t* colors, size_t color_count, bool ordered);
+
+			/* Same as above, appended to a draw command list instead of drawn. */
+			static void EncodeFillRects(std::vector<float>* commands, const float* coords, size_t count, const uint32_t* colors, size_t color_count, bool ordered);
+			static void EncodeStrokeLines(std::vector<float>* commands, const float* coords, size_t count, const uint32_t* colors, size_t color_count, double line_width, bool ordered);
+			static void EncodeFillCircles(std::vector<float>* commands, const float* coords, size_t count, const uint32_t* colors, size_t color_count, bool ordered);
+	};
+}
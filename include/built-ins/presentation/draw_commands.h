@@ -0,0 +1,55 @@
+#pragma once
+
+#include <gtk-3.0/gtk/gtk.h>
+#include <stddef.h>
+
+namespace mosaic::presentation {
+	/**
+	 * Opcodes of the drawing command buffer. A command is its opcode followed
+	 * by a fixed number of float arguments. Colors use 0-255 channels and a
+	 * 0-1 alpha, like DrawingContext.setColor().
+	 */
+	enum DrawCommand {
+		DRAW_COMMAND_RECT = 1,				// x, y, width, height
+		DRAW_COMMAND_SET_COLOR = 2,			// r, g, b, a
+		DRAW_COMMAND_FILL = 3,
+		DRAW_COMMAND_FILL_RECT = 4,			// x, y, width, height
+		DRAW_COMMAND_STROKE = 5,
+		DRAW_COMMAND_SET_LINE_WIDTH = 6,	// width
+		DRAW_COMMAND_MOVE_TO = 7,			// x, y
+		DRAW_COMMAND_LINE_TO = 8,			// x, y
+		DRAW_COMMAND_CLOSE_PATH = 9,
+		DRAW_COMMAND_SAVE = 10,
+		DRAW_COMMAND_RESTORE = 11,
+		DRAW_COMMAND_TRANSLATE = 12,		// x, y
+		DRAW_COMMAND_SCALE = 13,			// x, y
+		DRAW_COMMAND_CLEAR = 14,			// r, g, b, a
+		DRAW_COMMAND_CIRCLE = 15,			// x, y, radius
+		DRAW_COMMAND_CURVE_TO = 16,			// x1, y1, x2, y2, x, y
+		DRAW_COMMAND_COUNT
+	};
+
+	class DrawCommands {
+		public:
+			/* Number of arguments following the opcode, or -1 for unknown opcodes. */
+			static int GetArgumentCount(int command);
+
+			/* Opcode stored in a buffer float, or 0 when it isn't a valid one. */
+			static int Decode(float value);
+
+			/* Name of the opcode as exposed to JS, e.g. "FILL_RECT". */
+			static const char* GetName(int command);
+
+			/**
+			 * Replay an encoded buffer into a cairo context.
+			 * @returns -1 on success, or the offset of the first malformed command.
+			 */
+			static long Replay(cairo_t* cr, const float* data, size_t length);
+
+			/**
+			 * Check an encoded buffer without drawing it.
+			 * @returns -1 when well formed, or the offset of the first malformed command.
+			 */
+			static long Validate(const float* data, size_t length);
+	};
+}
@@ -3,18 +3,52 @@
 #include "v8.h"
 #include "piston_native_class.h"
 #include "piston_native_module.h"
+#include <runtime/frame_stats.h>
 #include <gtk-3.0/gtk/gtk.h>
+#include <vector>
 
 using namespace v8;
 using namespace piston;
+using namespace mosaic::runtime;
 
 namespace mosaic::presentation {
+	class Layer;
+
 	class DrawingArea : public NativeClass<DrawingArea> {
 		public:
 			/* Native members */
 			int GetWidth();
 			int GetHeight();
+			void Invalidate();
+			void InvalidateRect(int x, int y, int width, int height);
+
+			/* Paint again without discarding what onDraw drew, for attached layers. */
+			void Repaint();
+			void AttachLayer(Layer* layer);
+			void DetachLayer(Layer* layer);
+			inline bool IsRetained() { return retained_; };
+			void SetRetained(bool value);
+			/**
+			 * Tiled areas record onDraw as draw commands, rasterized on the task pool.
+			 * Rectangles, colors, Path2D fills and strokes, submit() and the batched
+			 * primitives are recorded. Text, images, sprites, layers and pixel access
+			 * need the area's own cairo context and throw a TypeError instead.
+			 */
+			inline bool IsTiled() { return tiled_; };
+			void SetTiled(bool value);
+			inline bool IsPersistent() { return persistent_; };
+			void SetPersistent(bool value);
+
+			/* Start the persistent back buffer over from transparent pixels. */
+			void ClearBuffer();
 			inline GtkWidget* GetGtkWidget() { return widget_; };
+
+			/* Headless drawing areas have no widget, their window paints them, see Headless */
+			inline bool IsHeadless() { return widget_ == NULL; };
+			void RenderHeadless(cairo_t* cairo_context, int width, int height);
+			inline FrameStats* GetFrameStats() { return frame_stats_; };
+			static void InvalidateDescendants(GtkWidget* widget);
+			static void InvalidateDescendantsRect(GtkWidget* root, int x, int y, int width, int height);
 			
 			/* V8 members */
 			static Local<Function> Make(Local<Context> context);
@@ -23,13 +57,75 @@ namespace mosaic::presentation {
 			static void GetHeightCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
 			static void GetOnDrawCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
 			static void SetOnDrawCallback(Local<String> property, Local<Value> value, const PropertyCallbackInfo<void>& info);
+			static void GetRetainedCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void SetRetainedCallback(Local<String> property, Local<Value> value, const PropertyCallbackInfo<void>& info);
+			static void GetTiledCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void SetTiledCallback(Local<String> property, Local<Value> value, const PropertyCallbackInfo<void>& info);
+			static void GetPersistentCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void SetPersistentCallback(Local<String> property, Local<Value> value, const PropertyCallbackInfo<void>& info);
+			static void ClearBufferCallback(const FunctionCallbackInfo<Value> &args);
+			static void GetFrameStatsCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void InvalidateCallback(const FunctionCallbackInfo<Value> &args);
+			static void InvalidateRectCallback(const FunctionCallbackInfo<Value> &args);
+			static void CreateLayerCallback(const FunctionCallbackInfo<Value> &args);
+			static void AttachLayerCallback(const FunctionCallbackInfo<Value> &args);
+			static void DetachLayerCallback(const FunctionCallbackInfo<Value> &args);
 
 		protected:
 			DrawingArea();
 			~DrawingArea() {};
 			inline void SetGtkWidget(GtkWidget* widget) { widget_ = widget; };
+			struct Tile {
+				cairo_rectangle_int_t area;
+				cairo_surface_t* surface;
+				bool dirty;
+			};
+
+			void Draw(cairo_t* cairo_context);
+			void DrawContent(cairo_t* cairo_context);
+			void CompositeLayers(cairo_t* cairo_context);
+			void DrawTiled(cairo_t* cairo_context, const cairo_rectangle_int_t& clip);
+			void DrawPersistent(cairo_t* cairo_context);
+			void RunDrawCallback(cairo_t* cairo_context, const cairo_rectangle_int_t& clip, std::vector<float>* commands = NULL, bool preserved = false);
+			void DiscardDisplayList();
+			void DiscardTiles();
+			void AddDamage(int x, int y, int width, int height);
 			GtkWidget* widget_;
 			Persistent<Function> draw_callback_;
+			Persistent<Object> drawing_context_;
+
+			/* Retained rendering, opted into with the retained property */
+			bool retained_;
+			bool dirty_;
+			cairo_surface_t* display_list_;
+			int display_list_width_;
+			int display_list_height_;
+			int display_list_patches_;
+
+			/* Areas requested with invalidateRect() since the last draw */
+			cairo_region_t* damage_;
+
+			/* Layers composited above everything onDraw painted, in attach order */
+			std::vector<Layer*> attached_layers_;
+
+			/* Tiled rendering, the frame is recorded as draw commands and rasterized on the task pool */
+			bool tiled_;
+			std::vector<float> frame_;
+			std::vector<Tile> tiles_;
+			int tiles_width_;
+			int tiles_height_;
+
+			/* Persistent rendering, onDraw only adds to pixels kept from the previous draws */
+			bool persistent_;
+			cairo_surface_t* back_buffer_;
+
+			/* Timings of the last frames, and how many drawing areas were created to name them */
+			FrameStats* frame_stats_;
+			static int count_;
+
+			/* Size given by the window of a headless drawing area */
+			int headless_width_;
+			int headless_height_;
 	};
 
 	class DrawingAreaModule : public NativeModule<DrawingAreaModule> {
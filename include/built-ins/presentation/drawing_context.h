@@ -1,37 +1,84 @@
 #pragma once
 
 #include "v8.h"
+#include "v8-fast-api-calls.h"
 #include "piston_native_class.h"
 #include "piston_native_module.h"
 #include <gtk-3.0/gtk/gtk.h>
+#include <string>
+#include <vector>
 
 using namespace v8;
 using namespace piston;
 
 namespace mosaic::presentation {
+	class Path2D;
+
 	class DrawingContext : public NativeClass<DrawingContext> {
 		public:
 			/* Native members */
 			inline cairo_t* GetCairoContext() { return cairo_context_; };
+			inline bool IsRecording() { return commands_ != NULL; };
+			inline bool IsBound() { return cairo_context_ != NULL || commands_ != NULL; };
+
+			/* Point the context at this frame's target. Wrappers are reused across frames and unbound between them. */
+			inline void Bind(cairo_t* cairo_context) { cairo_context_ = cairo_context; commands_ = NULL; };
+			inline void Bind(std::vector<float>* commands) { cairo_context_ = NULL; commands_ = commands; };
+			inline void Unbind() { cairo_context_ = NULL; commands_ = NULL; };
+
 			void Rect(int x, int y, int width, int height);
 			void SetColor(double r, double g, double b);
 			void SetColor(double r, double g, double b, double a);
 			void Fill();
+			long Submit(const float* commands, size_t length);
+			void FillRects(const float* coords, size_t count, const uint32_t* colors, size_t color_count, bool ordered);
+			void StrokeLines(const float* coords, size_t count, const uint32_t* colors, size_t color_count, double line_width, bool ordered);
+			void FillCircles(const float* coords, size_t count, const uint32_t* colors, size_t color_count, bool ordered);
+			void FillPath(Path2D* path);
+			void StrokePath(Path2D* path, double line_width);
+			void FillText(const std::string& text, double x, double y, int max_width);
 			
 			/* V8 members */
 			static Local<Function> Make(Local<Context> context);
-			static Local<Object> FromCairoContext(Local<Context> context, cairo_t* cairo_context);
+			static Local<Object> New(Local<Context> context);
 			static void ConstructorCallback(const FunctionCallbackInfo<Value> &args);
 			static void RectCallback(const FunctionCallbackInfo<Value> &args);
 			static void SetColorCallback(const FunctionCallbackInfo<Value> &args);
 			static void FillCallback(const FunctionCallbackInfo<Value> &args);
+			static void SubmitCallback(const FunctionCallbackInfo<Value> &args);
+			static void DrawLayerCallback(const FunctionCallbackInfo<Value> &args);
+			static void FillRectsCallback(const FunctionCallbackInfo<Value> &args);
+			static void StrokeLinesCallback(const FunctionCallbackInfo<Value> &args);
+			static void FillCirclesCallback(const FunctionCallbackInfo<Value> &args);
+			static void CreateImageDataCallback(const FunctionCallbackInfo<Value> &args);
+			static void GetImageDataCallback(const FunctionCallbackInfo<Value> &args);
+			static void PutImageDataCallback(const FunctionCallbackInfo<Value> &args);
+			static void DrawImageCallback(const FunctionCallbackInfo<Value> &args);
+			static void GetFontCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void SetFontCallback(Local<String> property, Local<Value> value, const PropertyCallbackInfo<void>& info);
+			static void DrawSpritesCallback(const FunctionCallbackInfo<Value> &args);
+			static void FillPathCallback(const FunctionCallbackInfo<Value> &args);
+			static void StrokePathCallback(const FunctionCallbackInfo<Value> &args);
+			static void FillTextCallback(const FunctionCallbackInfo<Value> &args);
+			static void MeasureTextCallback(const FunctionCallbackInfo<Value> &args);
+
+			/* Fast API calls, used by optimized code. Fall back to the slow callbacks on errors. */
+			static void FastRect(ApiObject receiver, int32_t x, int32_t y, int32_t width, int32_t height, FastApiCallbackOptions& options);
+			static void FastSetColor(ApiObject receiver, double r, double g, double b, double a, FastApiCallbackOptions& options);
+			static void FastFill(ApiObject receiver, FastApiCallbackOptions& options);
 
 		protected:
-			DrawingContext(cairo_t* cairo_context);
+			DrawingContext();
 			~DrawingContext() {};
-			inline void SetCairoContext(cairo_t* cairo_context) { cairo_context_ = cairo_context; };
+			static DrawingContext* FromApiObject(ApiObject receiver);
 			cairo_t* cairo_context_;
 
+			/* Pango font description used by text methods, e.g. "Sans Bold 12" */
+			std::string font_;
+
+			/* Encodes calls as draw commands instead of drawing them, when set */
+			std::vector<float>* commands_;
+
 			/* Constructor locking */
 			static inline void UnlockConstructor() { lock_constructor_ = false; }
 			static inline void LockConstructor() { lock_constructor_ = true; }
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "v8.h"
+#include "piston_native_class.h"
+#include "piston_native_module.h"
+
+using namespace v8;
+using namespace piston;
+
+namespace mosaic::presentation {
+	class Events : public NativeClass<Events> {
+		public:
+			/* V8 members */
+			static Local<Function> Make(Local<Context> context);
+			static void ConstructorCallback(const FunctionCallbackInfo<Value> &args);
+			static void BatchedCallback(const FunctionCallbackInfo<Value> &args);
+
+		private:
+			Events() {};
+			~Events() {};
+	};
+
+	class EventsModule : public NativeModule<EventsModule> {
+		public:
+			static Local<Module> Make(Isolate* isolate);
+
+		protected:
+			using NativeModule<EventsModule>::NativeModule;
+	};
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "v8.h"
+#include "piston_native_class.h"
+#include "piston_native_module.h"
+#include <gtk-3.0/gtk/gtk.h>
+#include <glib.h>
+#include <functional>
+#include <vector>
+
+using namespace v8;
+using namespace piston;
+
+namespace mosaic::presentation {
+	class Window;
+
+	/**
+	 * Rendering without a display, enabled by setting MOSAIC_HEADLESS.
+	 *
+	 * GTK is never initialized: the script runs on a plain GLib main loop,
+	 * which quits once the main module finishes evaluating. Windows and their
+	 * drawing areas paint into image surfaces, and only when Headless.step()
+	 * asks for a frame, so a script decides exactly which frames exist and
+	 * what they contain. window.capture() and ImageData.savePng() get them out.
+	 */
+	class Headless : public NativeClass<Headless> {
+		public:
+			/* Frames are numbered as if shown at this rate, for Headless.frameTime */
+			static const int frame_rate = 60;
+
+			/* Native members */
+			static bool IsEnabled();
+			static void AddWindow(Window* window);
+			static void RemoveWindow(Window* window);
+
+			/* Have the next step paint every shown window. */
+			static inline void QueueFrame() { frame_queued_ = true; };
+
+			/* Advance some frames, painting the shown windows when a frame was queued. */
+			static void Step(int count);
+			static inline gint64 GetFrame() { return frame_; };
+
+			/**
+			 * Stand-in for gtk_widget_add_tick_callback(), called with the frame time
+			 * in microseconds before each stepped frame until it returns false.
+			 * @returns Id for RemoveTickCallback().
+			 */
+			static guint AddTickCallback(std::function<bool(gint64)> callback);
+			static void RemoveTickCallback(guint id);
+
+			/**
+			 * Run a main loop until Quit(), calling start from it first.
+			 * @returns The status given to Quit().
+			 */
+			static int Run(std::function<void()> start);
+			static void Quit(int status);
+
+			/* V8 members */
+			static Local<Function> Make(Local<Context> context);
+			static void ConstructorCallback(const FunctionCallbackInfo<Value> &args);
+			static void StepCallback(const FunctionCallbackInfo<Value> &args);
+			static void GetEnabledCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void GetFrameCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void GetFrameTimeCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+
+		private:
+			Headless() {};
+			~Headless() {};
+
+			static std::vector<Window*> windows_;
+			static std::vector<std::pair<guint, std::function<bool(gint64)>>> tick_callbacks_;
+			static guint next_tick_callback_id_;
+			static bool frame_queued_;
+			static gint64 frame_;
+			static GMainLoop* loop_;
+			static int exit_status_;
+	};
+
+	class HeadlessModule : public NativeModule<HeadlessModule> {
+		public:
+			static Local<Module> Make(Isolate* isolate);
+
+		protected:
+			using NativeModule<HeadlessModule>::NativeModule;
+	};
+}
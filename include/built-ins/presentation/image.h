@@ -0,0 +1,79 @@
+#pragma once
+
+#include "v8.h"
+#include "piston_native_class.h"
+#include "piston_native_module.h"
+#include <runtime/pending_promise.h>
+#include <gtk-3.0/gtk/gtk.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace v8;
+using namespace piston;
+using namespace mosaic::runtime;
+
+namespace mosaic::presentation {
+	/**
+	 * Decoded image, ready to be drawn with a single blit.
+	 *
+	 * Image.load() decodes on the task pool and converts the pixels once to a
+	 * premultiplied cairo surface, which is shared through the ImageCache.
+	 * Each Image holds a reference to the surface until it is collected.
+	 */
+	class Image : public NativeClass<Image> {
+		public:
+			/* Native members */
+			inline cairo_surface_t* GetSurface() { return surface_; };
+			inline int GetWidth() { return cairo_image_surface_get_width(surface_); };
+			inline int GetHeight() { return cairo_image_surface_get_height(surface_); };
+			void Draw(cairo_t* cairo_context, double x, double y);
+			void Draw(cairo_t* cairo_context, double x, double y, double width, double height);
+
+			/**
+			 * Decode an image file on a worker thread.
+			 * @returns A new reference to the surface, or NULL with error set.
+			 */
+			static cairo_surface_t* Decode(const std::string& path, std::string* error);
+
+			/* V8 members */
+			static Local<Function> Make(Local<Context> context);
+			static Local<Object> FromSurface(Local<Context> context, cairo_surface_t* surface, const std::string& src);
+			static bool IsImage(Local<Context> context, Local<Value> value);
+			static void ConstructorCallback(const FunctionCallbackInfo<Value> &args);
+			static void LoadCallback(const FunctionCallbackInfo<Value> &args);
+			static void ClearCacheCallback(const FunctionCallbackInfo<Value> &args);
+			static void GetCacheBudgetCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void SetCacheBudgetCallback(Local<String> property, Local<Value> value, const PropertyCallbackInfo<void>& info);
+			static void GetCacheSizeCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void GetWidthCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void GetHeightCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void GetSrcCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+
+		protected:
+			Image(cairo_surface_t* surface, const std::string& src);
+			~Image();
+
+			/* Native fields */
+			cairo_surface_t* surface_;
+			std::string src_;
+
+			/* Loads in flight, so concurrent requests for one file decode it once */
+			static std::unordered_map<std::string, std::vector<std::shared_ptr<PendingPromise>>> loading_;
+
+			/* Constructor locking */
+			static inline void UnlockConstructor() { lock_constructor_ = false; }
+			static inline void LockConstructor() { lock_constructor_ = true; }
+			static inline bool IsConstructorLocked() { return lock_constructor_; }
+			static bool lock_constructor_;
+	};
+
+	class ImageModule : public NativeModule<ImageModule> {
+		public:
+			static Local<Module> Make(Isolate* isolate);
+
+		protected:
+			using NativeModule<ImageModule>::NativeModule;
+	};
+}
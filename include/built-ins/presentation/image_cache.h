@@ -0,0 +1,55 @@
+#pragma once
+
+#include <gtk-3.0/gtk/gtk.h>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+namespace mosaic::presentation {
+	/**
+	 * Least recently used cache of decoded image surfaces, bounded by the
+	 * bytes of their pixels. Images may still hold surfaces the cache let
+	 * go of, so the surfaces themselves report their pixels to V8 as
+	 * external memory, not the cache. Main thread only.
+	 */
+	class ImageCache {
+		public:
+			static ImageCache* GetInstance();
+			static void Shutdown();
+
+			/**
+			 * Look a surface up and mark it as the most recently used.
+			 * @returns A new reference the caller must release, or NULL.
+			 */
+			cairo_surface_t* Get(const std::string& key);
+
+			/* Store a surface, taking a new reference, then evict down to the budget. */
+			void Put(const std::string& key, cairo_surface_t* surface);
+
+			void Clear();
+			void SetBudget(size_t bytes);
+			inline size_t GetBudget() { return budget_; };
+			inline size_t GetSize() { return size_; };
+			inline size_t GetCount() { return entries_.size(); };
+
+		protected:
+			struct Entry {
+				std::string key;
+				cairo_surface_t* surface;
+				size_t size;
+			};
+
+			ImageCache(size_t budget);
+			~ImageCache();
+			void Evict(size_t budget);
+			void Remove(std::list<Entry>::iterator entry);
+
+			/* Most recently used first */
+			std::list<Entry> entries_;
+			std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+			size_t budget_;
+			size_t size_;
+
+			static ImageCache* instance_;
+	};
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "v8.h"
+#include "piston_native_class.h"
+#include "piston_native_module.h"
+#include <gtk-3.0/gtk/gtk.h>
+
+using namespace v8;
+using namespace piston;
+
+namespace mosaic::presentation {
+	/**
+	 * Pixels of a cairo ARGB32 image surface.
+	 *
+	 * 'data' is a Uint8ClampedArray over the surface's own memory, so reads and
+	 * writes from JS need no copy. The layout is cairo's rather than the web's:
+	 * premultiplied alpha, B, G, R, A byte order on little-endian machines, and
+	 * rows 'stride' bytes apart.
+	 */
+	class ImageData : public NativeClass<ImageData> {
+		public:
+			/* Native members */
+			inline cairo_surface_t* GetSurface() { return surface_; };
+			inline int GetWidth() { return width_; };
+			inline int GetHeight() { return height_; };
+			inline int GetStride() { return cairo_image_surface_get_stride(surface_); };
+			inline uint8_t* GetPixels() { return cairo_image_surface_get_data(surface_); };
+
+			/* Tell cairo the pixels were written outside of it, before drawing the surface. */
+			inline void MarkDirty() { cairo_surface_mark_dirty(surface_); };
+
+			/* V8 members */
+			static Local<Function> Make(Local<Context> context);
+			static Local<Object> FromSurface(Local<Context> context, cairo_surface_t* surface);
+			static bool IsImageData(Local<Context> context, Local<Value> value);
+			static void ConstructorCallback(const FunctionCallbackInfo<Value> &args);
+			static void GetWidthCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void GetHeightCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void GetStrideCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void GetDataCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void FillCallback(const FunctionCallbackInfo<Value> &args);
+			static void BlendCallback(const FunctionCallbackInfo<Value> &args);
+			static void PremultiplyCallback(const FunctionCallbackInfo<Value> &args);
+			static void UnpremultiplyCallback(const FunctionCallbackInfo<Value> &args);
+			static void BlurCallback(const FunctionCallbackInfo<Value> &args);
+			static void SavePngCallback(const FunctionCallbackInfo<Value> &args);
+			static void GetSimdCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+
+		protected:
+			ImageData(Isolate* isolate, cairo_surface_t* surface);
+			~ImageData();
+
+			/* Native fields */
+			cairo_surface_t* surface_;
+			int width_;
+			int height_;
+
+			/* V8 fields */
+			Persistent<Uint8ClampedArray> data_;
+
+			/* Surface for the instance being created by FromSurface(), instead of a new one */
+			static cairo_surface_t* adopted_surface_;
+	};
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "v8.h"
+#include "piston_native_class.h"
+#include "piston_native_module.h"
+#include <gtk-3.0/gtk/gtk.h>
+
+using namespace v8;
+using namespace piston;
+
+namespace mosaic::presentation {
+	class DrawingArea;
+
+	/**
+	 * Offscreen image surface owned by a drawing area.
+	 *
+	 * The layer's onDraw runs only when the layer was invalidated, every
+	 * other frame composites the cached pixels with a single paint.
+	 */
+	class Layer : public NativeClass<Layer> {
+		public:
+			/* Native members */
+			inline int GetWidth() { return width_; };
+			inline int GetHeight() { return height_; };
+			inline double GetX() { return x_; };
+			inline double GetY() { return y_; };
+			inline double GetOpacity() { return opacity_; };
+			inline bool IsDirty() { return dirty_; };
+			inline DrawingArea* GetOwner() { return owner_; };
+			inline bool IsAttached() { return attached_; };
+			void SetAttached(bool value);
+			void Invalidate();
+			void SetPosition(double x, double y);
+			void SetOpacity(double opacity);
+			void Render();
+			void Composite(cairo_t* cairo_context, double x, double y, double opacity);
+
+			/* V8 members */
+			static Local<Function> Make(Local<Context> context);
+			static Local<Object> FromDrawingArea(Local<Context> context, DrawingArea* owner, int width, int height);
+			static void ConstructorCallback(const FunctionCallbackInfo<Value> &args);
+			static void InvalidateCallback(const FunctionCallbackInfo<Value> &args);
+			static void GetWidthCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void GetHeightCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void GetXCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void SetXCallback(Local<String> property, Local<Value> value, const PropertyCallbackInfo<void>& info);
+			static void GetYCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void SetYCallback(Local<String> property, Local<Value> value, const PropertyCallbackInfo<void>& info);
+			static void GetOpacityCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void SetOpacityCallback(Local<String> property, Local<Value> value, const PropertyCallbackInfo<void>& info);
+			static void GetOnDrawCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void SetOnDrawCallback(Local<String> property, Local<Value> value, const PropertyCallbackInfo<void>& info);
+
+		protected:
+			Layer(DrawingArea* owner, int width, int height);
+			~Layer();
+
+			/* Native fields */
+			DrawingArea* owner_;
+			cairo_surface_t* surface_;
+			int width_;
+			int height_;
+			double x_;
+			double y_;
+			double opacity_;
+			bool dirty_;
+
+			/* Composited by the owner itself, see DrawingArea.attachLayer() */
+			bool attached_;
+
+			/* V8 fields */
+			Persistent<Function> draw_callback_;
+			Persistent<Object> drawing_context_;
+
+			/* Constructor locking */
+			static inline void UnlockConstructor() { lock_constructor_ = false; }
+			static inline void LockConstructor() { lock_constructor_ = true; }
+			static inline bool IsConstructorLocked() { return lock_constructor_; }
+			static bool lock_constructor_;
+	};
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "v8.h"
+#include "piston_native_class.h"
+#include "piston_native_module.h"
+#include <gtk-3.0/gtk/gtk.h>
+#include <vector>
+
+using namespace v8;
+using namespace piston;
+
+namespace mosaic::presentation {
+	/**
+	 * Reusable path, built once and drawn any number of times.
+	 *
+	 * Segments are stored natively as cairo path data, in doubles, arcs and
+	 * quadratic curves being converted to cubic ones up front. Drawing
+	 * appends them as is, and tiled drawing areas get them as MOVE_TO,
+	 * LINE_TO, CURVE_TO and CLOSE_PATH draw commands instead.
+	 */
+	class Path2D : public NativeClass<Path2D> {
+		public:
+			/* Native members */
+			void MoveTo(double x, double y);
+			void LineTo(double x, double y);
+			void CurveTo(double x1, double y1, double x2, double y2, double x, double y);
+			void QuadraticCurveTo(double cx, double cy, double x, double y);
+			void Arc(double x, double y, double radius, double start, double end, bool counterclockwise);
+			void Rect(double x, double y, double width, double height);
+			void ClosePath();
+
+			/* Path over the stored segments, owned by this instance and valid until the next change. */
+			cairo_path_t* GetCairoPath();
+
+			/* Append the segments as draw commands, for drawing areas that record instead of drawing. */
+			void EncodeCommands(std::vector<float>* commands);
+
+			/* V8 members */
+			static Local<Function> Make(Local<Context> context);
+			static bool IsPath2D(Local<Context> context, Local<Value> value);
+			static void ConstructorCallback(const FunctionCallbackInfo<Value> &args);
+			static void MoveToCallback(const FunctionCallbackInfo<Value> &args);
+			static void LineToCallback(const FunctionCallbackInfo<Value> &args);
+			static void BezierCurveToCallback(const FunctionCallbackInfo<Value> &args);
+			static void QuadraticCurveToCallback(const FunctionCallbackInfo<Value> &args);
+			static void ArcCallback(const FunctionCallbackInfo<Value> &args);
+			static void RectCallback(const FunctionCallbackInfo<Value> &args);
+			static void ClosePathCallback(const FunctionCallbackInfo<Value> &args);
+
+		protected:
+			Path2D();
+			~Path2D() {};
+
+			/* Native fields */
+			std::vector<cairo_path_data_t> data_;
+			cairo_path_t path_;
+			bool has_current_point_;
+			double current_x_;
+			double current_y_;
+			double start_x_;
+			double start_y_;
+	};
+}
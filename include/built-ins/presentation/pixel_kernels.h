@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace mosaic::presentation {
+	/**
+	 * Pixel loops over cairo ARGB32 buffers: premultiplied alpha, one native
+	 * endian uint32_t per pixel, rows 'stride' bytes apart.
+	 *
+	 * Each kernel picks an AVX2, SSE2 or scalar implementation once, from what
+	 * the CPU supports. MOSAIC_SIMD=scalar|sse2|avx2 caps the choice.
+	 */
+	class PixelKernels {
+		public:
+			enum SimdLevel {
+				SIMD_SCALAR = 0,
+				SIMD_SSE2 = 1,
+				SIMD_AVX2 = 2
+			};
+
+			static SimdLevel GetSimdLevel();
+			static const char* GetSimdLevelName();
+
+			/* Set every pixel to a premultiplied color. */
+			static void Fill(uint8_t* pixels, int width, int height, int stride, uint32_t color);
+
+			/* Composite src over dst, both premultiplied, with src scaled by opacity (0-255). */
+			static void Blend(uint8_t* dst, int dst_stride, const uint8_t* src, int src_stride, int width, int height, uint8_t opacity);
+
+			/* Convert straight alpha to premultiplied alpha, and back. */
+			static void Premultiply(uint8_t* pixels, int width, int height, int stride);
+			static void Unpremultiply(uint8_t* pixels, int width, int height, int stride);
+
+			/* Box blur with a (2 * radius + 1) square kernel, edges extended. */
+			static void BoxBlur(uint8_t* pixels, int width, int height, int stride, int radius);
+	};
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "v8.h"
+#include "piston_native_class.h"
+#include "piston_native_module.h"
+
+using namespace v8;
+using namespace piston;
+
+namespace mosaic::presentation {
+	/**
+	 * Scheduler.postTask(callback, { priority, delay }) queues JS work in
+	 * frame sized slices, see FrameScheduler. The returned promise settles
+	 * with the callback's result.
+	 */
+	class Scheduler : public NativeClass<Scheduler> {
+		public:
+			/* V8 members */
+			static Local<Function> Make(Local<Context> context);
+			static void ConstructorCallback(const FunctionCallbackInfo<Value> &args);
+			static void PostTaskCallback(const FunctionCallbackInfo<Value> &args);
+			static void ShouldYieldCallback(const FunctionCallbackInfo<Value> &args);
+
+		private:
+			Scheduler() {};
+			~Scheduler() {};
+	};
+
+	class SchedulerModule : public NativeModule<SchedulerModule> {
+		public:
+			static Local<Module> Make(Isolate* isolate);
+
+		protected:
+			using NativeModule<SchedulerModule>::NativeModule;
+	};
+}
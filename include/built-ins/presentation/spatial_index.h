@@ -0,0 +1,54 @@
+#pragma once
+
+#include "v8.h"
+#include "piston_native_class.h"
+#include "piston_native_module.h"
+#include <built-ins/presentation/aabb_tree.h>
+
+using namespace v8;
+using namespace piston;
+
+namespace mosaic::presentation {
+	/**
+	 * Shapes registered by id and bounds, for hit-testing what a drawing
+	 * area painted without looping over every shape in JS.
+	 *
+	 * Ids are 32-bit integers. Shapes set later are above earlier ones, and
+	 * moving a shape with set() keeps its place in that order. Bounds must be
+	 * finite, set() and setMany() throw a RangeError otherwise.
+	 */
+	class SpatialIndex : public NativeClass<SpatialIndex> {
+		public:
+			/* V8 members */
+			static Local<Function> Make(Local<Context> context);
+			static void ConstructorCallback(const FunctionCallbackInfo<Value> &args);
+			static void SetCallback(const FunctionCallbackInfo<Value> &args);
+			static void SetManyCallback(const FunctionCallbackInfo<Value> &args);
+			static void DeleteCallback(const FunctionCallbackInfo<Value> &args);
+			static void HasCallback(const FunctionCallbackInfo<Value> &args);
+			static void ClearCallback(const FunctionCallbackInfo<Value> &args);
+			static void GetBoundsCallback(const FunctionCallbackInfo<Value> &args);
+			static void HitTestCallback(const FunctionCallbackInfo<Value> &args);
+			static void QueryCallback(const FunctionCallbackInfo<Value> &args);
+			static void GetSizeCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+
+		protected:
+			SpatialIndex();
+			~SpatialIndex();
+
+			/* Tell the GC how much memory the tree holds now. */
+			void ReportMemory(Isolate* isolate);
+
+			/* Native fields */
+			AabbTree tree_;
+			size_t reported_memory_;
+	};
+
+	class SpatialIndexModule : public NativeModule<SpatialIndexModule> {
+		public:
+			static Local<Module> Make(Isolate* isolate);
+
+		protected:
+			using NativeModule<SpatialIndexModule>::NativeModule;
+	};
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <gtk-3.0/gtk/gtk.h>
+#include <pango/pangocairo.h>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+namespace mosaic::presentation {
+	/**
+	 * Shaped Pango layouts, keyed by text, font and wrapping width.
+	 *
+	 * Shaping runs once, when a layout is first measured or drawn, and the
+	 * layout keeps its glyph runs afterwards. Redrawing an unchanged label is
+	 * then a lookup plus a glyph blit. Least recently used layouts and font
+	 * descriptions are dropped past fixed counts. Main thread only.
+	 */
+	class TextLayoutCache {
+		public:
+			static TextLayoutCache* GetInstance();
+			static void Shutdown();
+
+			/**
+			 * Get the layout for some text, shaping it on a miss.
+			 * @param max_width Wrapping width in pixels, or a negative number to never wrap.
+			 * @returns A layout owned by the cache, valid until the next call.
+			 */
+			PangoLayout* Get(const std::string& text, const std::string& font, int max_width);
+
+			void Clear();
+			inline size_t GetCount() { return entries_.size(); };
+
+		protected:
+			struct Entry {
+				std::string key;
+				PangoLayout* layout;
+			};
+
+			struct FontEntry {
+				std::string font;
+				PangoFontDescription* description;
+			};
+
+			TextLayoutCache(size_t capacity);
+			~TextLayoutCache();
+			PangoFontDescription* GetFontDescription(const std::string& font);
+
+			/* Shared by every layout, so they all shape with the same font options */
+			PangoContext* context_;
+
+			/* Most recently used first */
+			std::list<Entry> entries_;
+			std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+			size_t capacity_;
+
+			/* Parsed font descriptions, most recently used first, as computed font sizes can make many */
+			std::list<FontEntry> fonts_;
+			std::unordered_map<std::string, std::list<FontEntry>::iterator> font_index_;
+
+			static TextLayoutCache* instance_;
+	};
+}
@@ -3,19 +3,26 @@
 #include "v8.h"
 #include "piston_native_class.h"
 #include "piston_native_module.h"
+#include <runtime/frame_stats.h>
 #include <gtk-3.0/gtk/gtk.h>
+#include <string>
 
 using namespace v8;
 using namespace piston;
+using namespace mosaic::runtime;
 
 namespace mosaic::presentation {
+	class DrawingArea;
+
 	class Window : public NativeClass<Window> {
 		public:
 			/* Native members */
 			void Show();
 			void Close();
 			void AddChild(GtkWidget* widget);
+			void AddChild(DrawingArea* drawing_area);
 			void Invalidate();
+			void InvalidateRect(int x, int y, int width, int height);
 			int GetWidth();
 			void SetWidth(int value);
 			int GetHeight();
@@ -29,6 +36,14 @@ namespace mosaic::presentation {
 			const char* GetTitle();
 			void SetTitle(const char* value);
 			inline GtkWidget* GetGtkWidget() { return widget_; };
+			inline FrameStats* GetFrameStats() { return frame_stats_; };
+
+			/* Headless windows have no widget, see Headless */
+			inline bool IsHeadless() { return widget_ == NULL; };
+			void Render();
+
+			/* Copy of the window's pixels, as a new image surface. */
+			cairo_surface_t* Capture();
 			
 			/* V8 members */
 			static Local<Function> Make(Local<Context> context);
@@ -37,6 +52,7 @@ namespace mosaic::presentation {
 			static void CloseCallback(const FunctionCallbackInfo<Value> &args);
 			static void AddChildCallback(const FunctionCallbackInfo<Value> &args);
 			static void InvalidateCallback(const FunctionCallbackInfo<Value> &args);
+			static void InvalidateRectCallback(const FunctionCallbackInfo<Value> &args);
 			static void GetWidthCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
 			static void SetWidthCallback(Local<String> property, Local<Value> value, const PropertyCallbackInfo<void>& info);
 			static void GetHeightCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
@@ -51,6 +67,8 @@ namespace mosaic::presentation {
 			static void SetTitleCallback(Local<String> property, Local<Value> value, const PropertyCallbackInfo<void>& info);
 			static void GetOnResizeCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
 			static void SetOnResizeCallback(Local<String> property, Local<Value> value, const PropertyCallbackInfo<void>& info);
+			static void CaptureCallback(const FunctionCallbackInfo<Value> &args);
+			static void GetFrameStatsCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
 
 		protected:
 			Window(char* title, int width, int height);
@@ -60,6 +78,22 @@ namespace mosaic::presentation {
 			Persistent<Function> resize_callback_;
 			int _last_width;
 			int _last_height;
+
+			/* Frame clock cycles only count as frames when the window was drawn during them */
+			FrameStats* frame_stats_;
+			bool painted_;
+
+			/* State of headless windows, which GTK would otherwise keep */
+			void Resize(int width, int height);
+			std::string title_;
+			int width_;
+			int height_;
+			int min_width_;
+			int min_height_;
+			bool resizable_;
+			bool shown_;
+			DrawingArea* child_;
+			cairo_surface_t* surface_;
 	};
 
 	class WindowModule : public NativeModule<WindowModule> {
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "v8.h"
+#include "piston_native_class.h"
+#include "piston_native_module.h"
+#include <built-ins/simulation/entity_kernels.h>
+
+using namespace v8;
+using namespace piston;
+
+namespace mosaic::simulation {
+	/**
+	 * A fixed number of moving rectangles, stored as structure of arrays.
+	 *
+	 * Every field is a typed array over native memory, so JS can set up and
+	 * read entities without copies while step() moves all of them natively.
+	 * 'rects' holds the packed rectangles step() leaves behind, and with
+	 * 'colors' goes straight to DrawingContext.fillRects():
+	 *
+	 *     entities.step(1, 0, 0, area.width, area.height);
+	 *     context.fillRects(entities.rects, entities.colors);
+	 */
+	class Entities : public NativeClass<Entities> {
+		public:
+			enum Field {
+				FIELD_X = 0,
+				FIELD_Y,
+				FIELD_VX,
+				FIELD_VY,
+				FIELD_WIDTH,
+				FIELD_HEIGHT,
+				FIELD_COLORS,
+				FIELD_RECTS,
+				FIELD_COUNT
+			};
+
+			/* V8 members */
+			static Local<Function> Make(Local<Context> context);
+			static void ConstructorCallback(const FunctionCallbackInfo<Value> &args);
+			static void StepCallback(const FunctionCallbackInfo<Value> &args);
+			static void PackCallback(const FunctionCallbackInfo<Value> &args);
+			static void GetCountCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+			static void GetFieldCallback(Local<String> property, const PropertyCallbackInfo<Value>& info);
+
+		protected:
+			Entities(Isolate* isolate, size_t count, void* memory);
+			~Entities();
+
+			/* Native fields */
+			size_t count_;
+			EntityKernels::Fields fields_;
+
+			/* V8 fields */
+			Persistent<Object> views_[FIELD_COUNT];
+	};
+
+	class EntitiesModule : public NativeModule<EntitiesModule> {
+		public:
+			static Local<Module> Make(Isolate* isolate);
+
+		protected:
+			using NativeModule<EntitiesModule>::NativeModule;
+	};
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stddef.h>
+
+namespace mosaic::simulation {
+	/**
+	 * Update loops over entities stored as structure of arrays, one float
+	 * array per field, so each vector instruction moves 4 or 8 entities.
+	 *
+	 * Like PixelKernels, an AVX2, SSE2 or scalar implementation is picked
+	 * once and MOSAIC_SIMD=scalar|sse2|avx2 caps the choice. Every level
+	 * does the same float operations in the same order, so results match.
+	 */
+	class EntityKernels {
+		public:
+			struct Fields {
+				float* x;
+				float* y;
+				float* vx;
+				float* vy;
+				const float* width;
+				const float* height;
+
+				/* x, y, width and height per entity, the layout DrawingContext.fillRects() takes */
+				float* rects;
+			};
+
+			/* Rectangle entities are kept in, or NULL for none. */
+			struct Bounds {
+				float x;
+				float y;
+				float width;
+				float height;
+			};
+
+			/**
+			 * Move entities by their velocity times dt, then pack their rectangles.
+			 * Entities leaving the bounds are mirrored back in, with the velocity
+			 * on that axis turned to point inside.
+			 */
+			static void Step(const Fields& fields, size_t count, float dt, const Bounds* bounds);
+
+			/* Only pack the rectangles, after fields were changed some other way. */
+			static void Pack(const Fields& fields, size_t count);
+	};
+}
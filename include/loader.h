@@ -18,10 +18,11 @@ const char* get_current_dir();
 const char* path_to_file_uri(const char* path);
 string resolve_module_specifier(string referrer, string specifier);
 void report_exception(Isolate* isolate, TryCatch* try_catch);
+void report_exception(Isolate* isolate, Local<Value> exception);
 void initialize_import_meta_object_callback(Local<Context> context, Local<Module> module, Local<Object> meta);
 Local<Context> create_global_context(Isolate* isolate);
 void run_module(Isolate* isolate, Local<Context> context, string path);
-void run_application(const char* path);
+int run_application();
 ModuleRepository* setup_module_repository(Local<Context> context);
 void setup_builtin_modules(ModuleRepository* repository);
 unique_ptr<Platform> initialize_v8(const char* exec_path);
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <v8.h>
+#include <mutex>
+#include <vector>
+
+using namespace v8;
+
+namespace mosaic::runtime {
+	/**
+	 * Thread-safe pool of fixed-size buffers.
+	 *
+	 * Buffers handed to JS through NewBackingStore() come back to the pool when
+	 * the last ArrayBuffer using them is collected, so steady streaming reuses
+	 * the same few allocations instead of churning the allocator.
+	 */
+	class BufferPool {
+		public:
+			/* Get the process-wide pool for the given buffer size. */
+			static BufferPool* Get(size_t buffer_size);
+
+			/* A free buffer, or NULL when a new one can't be allocated. */
+			char* Acquire();
+			void Release(char* buffer);
+
+			/* Wrap a pooled buffer so V8 returns it here when done. */
+			std::shared_ptr<BackingStore> NewBackingStore(char* buffer, size_t length);
+
+			inline size_t GetBufferSize() { return buffer_size_; }
+
+		protected:
+			BufferPool(size_t buffer_size, size_t max_idle);
+
+			static void BackingStoreDeleter(void* data, size_t length, void* deleter_data);
+
+			size_t buffer_size_;
+			size_t max_idle_;
+			std::vector<char*> idle_;
+			std::mutex mutex_;
+
+			static std::vector<BufferPool*> pools_;
+			static std::mutex pools_mutex_;
+	};
+}
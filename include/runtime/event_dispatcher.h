@@ -0,0 +1,58 @@
+#pragma once
+
+#include <v8.h>
+#include <glib.h>
+#include <vector>
+
+using namespace v8;
+
+namespace mosaic::runtime {
+	/**
+	 * Single entry point for native events going to JS.
+	 *
+	 * Posted events are queued during a main loop iteration and delivered
+	 * together from one idle callback, under one HandleScope and followed by
+	 * one microtask checkpoint. Handlers marked with SetBatched() are called
+	 * once per flush with every queued event instead of once per event.
+	 */
+	class EventDispatcher {
+		public:
+			static EventDispatcher* GetInstance();
+			static void Shutdown();
+
+			/**
+			 * Queue a call to the handler stored in a native object. The handler is
+			 * read when the queue is flushed, so it must outlive the event.
+			 */
+			void Post(const char* name, Persistent<Function>* handler, std::vector<double> args);
+
+			/**
+			 * Call a handler right away. For events whose arguments are only valid
+			 * while the signal is being emitted, such as draws.
+			 */
+			void Dispatch(const char* name, Local<Function> handler, int argc, Local<Value> argv[]);
+
+			/* Deliver every queued event now. */
+			void Flush();
+
+			static void SetBatched(Isolate* isolate, Local<Function> handler);
+			static bool IsBatched(Isolate* isolate, Local<Function> handler);
+
+		protected:
+			struct Event {
+				const char* name;
+				Persistent<Function>* handler;
+				std::vector<double> args;
+			};
+
+			EventDispatcher();
+			~EventDispatcher();
+
+			static gboolean FlushCallback(gpointer user_data);
+
+			std::vector<Event> queue_;
+			guint flush_source_id_;
+
+			static EventDispatcher* instance_;
+	};
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <gtk-3.0/gtk/gtk.h>
+#include <glib.h>
+#include <deque>
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace mosaic::runtime {
+	/**
+	 * Main thread task queues sliced to fit between frames.
+	 *
+	 * Windows report their frame clock's phases, from which the scheduler
+	 * predicts when the next paint starts. Each slice runs queued tasks in
+	 * priority order until that deadline, minus the time painting usually
+	 * takes, then gives the main loop back so the frame isn't delayed.
+	 * Timing is kept per clock and the earliest deadline of all windows
+	 * wins, so a slow or idle window doesn't misplace another one's:
+	 *
+	 * - user-blocking tasks run as soon as possible, even past the deadline.
+	 * - user-visible tasks only run before the deadline.
+	 * - background tasks also wait while any window's frames miss their
+	 *   refresh interval, and resume after one that didn't or once its
+	 *   painting stopped.
+	 *
+	 * Without any frame clock, such as in headless mode, slices last one
+	 * 60Hz frame.
+	 */
+	class FrameScheduler {
+		public:
+			enum Priority {
+				PRIORITY_USER_BLOCKING = 0,
+				PRIORITY_USER_VISIBLE = 1,
+				PRIORITY_BACKGROUND = 2,
+				PRIORITY_COUNT
+			};
+
+			static FrameScheduler* GetInstance();
+			static void Shutdown();
+
+			/* Priority named like in the Prioritized Task Scheduling API. */
+			static bool ParsePriority(const char* name, Priority* priority);
+
+			/* Queue a task, or queue it after a delay in milliseconds. */
+			void Post(Priority priority, std::function<void()> task, guint delay = 0);
+
+			/* Frame clock phases of a window, see Window. */
+			void BeginFrame(GdkFrameClock* clock);
+			void EndFrame(GdkFrameClock* clock);
+
+			/* Monotonic time in microseconds when the current slice should end. */
+			gint64 GetDeadline();
+
+			/* Whether the task running now went past its slice, always false outside of one. */
+			inline bool ShouldYield() { return this->in_slice_ && g_get_monotonic_time() >= this->GetDeadline(); };
+
+		protected:
+			FrameScheduler();
+			~FrameScheduler();
+
+			void Schedule();
+			void RunSlice();
+			bool CanRunBackground(gint64 now);
+			gint64 GetNextPaint(gint64 now);
+			gint64 GetRefreshInterval();
+			static gboolean RunSliceCallback(gpointer user_data);
+			static void ClockFinalizedCallback(gpointer user_data, GObject* clock);
+
+			struct DelayedTask {
+				FrameScheduler* scheduler;
+				Priority priority;
+				std::function<void()> task;
+				guint source_id;
+			};
+
+			/* Frame timing of one clock, all in microseconds of the monotonic clock */
+			struct ClockTiming {
+				gint64 frame_time;
+				gint64 refresh_interval;
+				gint64 paint_start;
+				gint64 paint_duration;
+				gint64 last_paint_end;
+				bool over_budget;
+			};
+
+			std::deque<std::function<void()>> queues_[PRIORITY_COUNT];
+			std::vector<DelayedTask*> delayed_;
+			guint source_id_;
+			bool source_is_timeout_;
+			gint64 slice_start_;
+			bool in_slice_;
+
+			/* Clocks of windows that began a frame, dropped when the clock is finalized */
+			static const gint64 default_refresh_interval = G_USEC_PER_SEC / 60;
+			std::map<GdkFrameClock*, ClockTiming> clocks_;
+
+			static FrameScheduler* instance_;
+	};
+}
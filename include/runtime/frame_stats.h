@@ -0,0 +1,117 @@
+#pragma once
+
+#include <v8.h>
+#include <gtk-3.0/gtk/gtk.h>
+#include <glib.h>
+#include <list>
+#include <string>
+#include <vector>
+
+using namespace v8;
+
+namespace mosaic::runtime {
+	/**
+	 * Rolling timings of the frames a window or drawing area painted.
+	 *
+	 * Each frame is split into time spent in JS draw callbacks and the rest,
+	 * which is mostly cairo rasterizing, and tagged with how long it took
+	 * since the first invalidate it answered. That latency runs to when the
+	 * frame reached the screen, once the frame clock reports it, and to the
+	 * end of the paint otherwise. Frames nest: a window's frame also counts
+	 * the JS time of the drawing areas and layers painted inside of it.
+	 *
+	 * When MOSAIC_FRAME_STATS is set, every instance that painted is summed
+	 * up on stderr every that many seconds (5 when it isn't a number).
+	 */
+	class FrameStats {
+		public:
+			enum Metric {
+				METRIC_SCRIPT = 0,
+				METRIC_RASTER = 1,
+				METRIC_LATENCY = 2,
+				METRIC_COUNT
+			};
+
+			FrameStats(const std::string& name);
+			~FrameStats();
+
+			/* Remember when the owner was first invalidated since its last frame. */
+			void MarkInvalidated();
+
+			void BeginFrame();
+
+			/**
+			 * Close the frame opened by BeginFrame().
+			 * @param clock Frame clock that scheduled the frame, used to count dropped frames. May be NULL.
+			 */
+			void EndFrame(GdkFrameClock* clock);
+
+			/* Forget the frame opened by BeginFrame(), when nothing was painted after all. */
+			void CancelFrame();
+
+			/* Attribute JS time to every frame in progress. */
+			static void AddScriptTime(gint64 microseconds);
+
+			/**
+			 * Time a JS callback, for every frame in progress. Callbacks run from
+			 * inside another one, like a layer drawn from onDraw, are counted once.
+			 * @returns The start to give to EndScript().
+			 */
+			static gint64 BeginScript();
+			static void EndScript(gint64 start);
+
+			/* Value under which a share of the recent frames fall, in milliseconds. */
+			double GetPercentile(Metric metric, double percentile);
+
+			inline size_t GetFrameCount() { return frames_; };
+			inline size_t GetDroppedCount() { return dropped_; };
+			inline const std::string& GetName() { return name_; };
+
+			/* { frames, dropped, script, raster, latency }, each metric as { p50, p95, p99, max }. */
+			Local<Object> ToObject(Local<Context> context);
+
+			static void Shutdown();
+
+		protected:
+			struct Sample {
+				double values[METRIC_COUNT];
+			};
+
+			/* Painted frame the frame clock hasn't reported a presentation time for yet */
+			struct PendingPresentation {
+				GdkFrameClock* clock;
+				gint64 frame_counter;
+				gint64 invalidated_at;
+				size_t sample;
+			};
+
+			/* Move latencies of frames the clock has since presented to their presentation time. */
+			void ResolvePresentations(GdkFrameClock* clock);
+
+			std::string name_;
+			std::vector<Sample> samples_;
+			std::list<PendingPresentation> pending_;
+			size_t next_sample_;
+			size_t frames_;
+			size_t dropped_;
+			size_t logged_frames_;
+			size_t logged_dropped_;
+
+			gint64 frame_start_;
+			gint64 frame_script_;
+			gint64 invalidated_at_;
+
+			static gboolean LogCallback(gpointer user_data);
+
+			/* Every instance, for the periodic log */
+			static std::vector<FrameStats*> instances_;
+
+			/* Frames between BeginFrame() and EndFrame(), innermost last */
+			static std::vector<FrameStats*> active_;
+
+			/* JS callbacks being timed, innermost last */
+			static int script_depth_;
+
+			static guint log_source_id_;
+	};
+}
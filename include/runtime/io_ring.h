@@ -0,0 +1,93 @@
+#pragma once
+
+#include <v8.h>
+#include <glib.h>
+#include <linux/io_uring.h>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+using namespace v8;
+
+namespace mosaic::runtime {
+	/**
+	 * Minimal io_uring wrapper driven by the GTK main loop.
+	 *
+	 * Submissions are made from the main thread and completions are reaped
+	 * through an eventfd registered with the ring, so callbacks always run on
+	 * the main thread and may use V8 directly.
+	 */
+	class IoRing {
+		public:
+			/* Fills a zeroed submission entry. */
+			using Prepare = std::function<void(io_uring_sqe* sqe)>;
+
+			/* Receives the completion result (negative errno on failure). */
+			using Completion = std::function<void(int result)>;
+
+			/**
+			 * Get the shared ring, or nullptr if the kernel lacks io_uring or
+			 * any of the required operations.
+			 */
+			static IoRing* GetInstance();
+			static void Shutdown();
+
+			void Submit(Prepare prepare, Completion completion);
+
+			/* Whether the kernel reported an IORING_FEAT_* flag at setup. */
+			inline bool HasFeature(unsigned int feature) { return (features_ & feature) != 0; }
+
+		protected:
+			struct Request {
+				Prepare prepare;
+				Completion completion;
+			};
+
+			IoRing();
+			~IoRing();
+
+			bool Setup(unsigned int entries, std::initializer_list<int> required_ops);
+			bool Enqueue(Request* request);
+
+			/* Submit everything enqueued, failing what the kernel refuses. */
+			void Flush();
+			void Reap();
+
+			static gboolean CompletionSourceCallback(gint fd, GIOCondition condition, gpointer user_data);
+
+			int ring_fd_;
+			int event_fd_;
+			guint event_source_id_;
+
+			void* sq_ring_;
+			size_t sq_ring_size_;
+			void* cq_ring_;
+			size_t cq_ring_size_;
+			io_uring_sqe* sqes_;
+			size_t sqes_size_;
+
+			unsigned int* sq_head_;
+			unsigned int* sq_tail_;
+			unsigned int* sq_mask_;
+			unsigned int* sq_entries_;
+			unsigned int* sq_array_;
+			unsigned int* cq_head_;
+			unsigned int* cq_tail_;
+			unsigned int* cq_mask_;
+			io_uring_cqe* cqes_;
+			unsigned int cq_entries_;
+			unsigned int in_flight_;
+			unsigned int features_;
+
+			/* Requests waiting for a free submission slot */
+			std::deque<Request*> backlog_;
+
+			/* Requests taken back after a failed submit, with their error */
+			std::vector<std::pair<Request*, int>> failed_;
+
+			static IoRing* instance_;
+			static bool probed_;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <v8.h>
+#include <string>
+
+using namespace v8;
+
+namespace mosaic::runtime {
+	/**
+	 * A promise that is settled later from native code, on the main thread.
+	 * Keeps its resolver and creation context alive until then.
+	 */
+	class PendingPromise {
+		public:
+			PendingPromise(Local<Context> context) {
+				isolate_ = context->GetIsolate();
+				context_.Reset(isolate_, context);
+				resolver_.Reset(isolate_, Promise::Resolver::New(context).ToLocalChecked());
+			}
+
+			inline Isolate* GetIsolate() { return isolate_; }
+			inline Local<Context> GetContext() { return context_.Get(isolate_); }
+			inline Local<Promise> GetPromise() { return resolver_.Get(isolate_)->GetPromise(); }
+
+			void Resolve(Local<Value> value) {
+				resolver_.Get(isolate_)->Resolve(GetContext(), value).Check();
+			}
+
+			void Reject(Local<Value> reason) {
+				resolver_.Get(isolate_)->Reject(GetContext(), reason).Check();
+			}
+
+			void Reject(const std::string& message) {
+				Reject(Exception::Error(String::NewFromUtf8(isolate_, message.c_str()).ToLocalChecked()));
+			}
+
+		private:
+			Isolate* isolate_;
+			Global<Context> context_;
+			Global<Promise::Resolver> resolver_;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <v8.h>
+#include <glib.h>
+#include <stdio.h>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace v8;
+
+namespace mosaic::runtime {
+	/**
+	 * Times native-to-JS dispatches and samples main loop lag.
+	 *
+	 * Dispatches slower than the long task threshold, and lag samples above it,
+	 * become entries that are buffered and handed to listeners from an idle
+	 * callback. When MOSAIC_TRACE points to a file, every dispatch is also
+	 * written there in the Chrome trace event format.
+	 */
+	class PerformanceMonitor {
+		public:
+			struct Entry {
+				/* "longtask" or "lag". */
+				std::string type;
+
+				/* What was dispatched, e.g. "click" or "draw". */
+				std::string name;
+
+				/* "url:line:column" of the JS callback, empty when unknown. */
+				std::string source;
+
+				/* Milliseconds since the monitor started. */
+				double start_time;
+				double duration;
+			};
+
+			using Listener = std::function<void(const std::vector<Entry>& entries)>;
+
+			/**
+			 * Measures a dispatch for as long as it is alive. Only the outermost
+			 * scope can produce a long task, nested ones only show up in traces.
+			 */
+			class Scope {
+				public:
+					Scope(const char* name, Local<Function> callback = Local<Function>());
+					~Scope();
+
+				private:
+					const char* name_;
+					Local<Function> callback_;
+					gint64 start_;
+			};
+
+			static PerformanceMonitor* GetInstance();
+			static void Shutdown();
+
+			/* Milliseconds since the monitor started. */
+			double Now();
+
+			inline double GetLongTaskThreshold() { return long_task_threshold_; }
+			inline void SetLongTaskThreshold(double value) { long_task_threshold_ = value; }
+
+			/* Start the lag sampling timer, it is off until someone asks for lag. */
+			void EnableLagSampling();
+
+			inline double GetCurrentLag() { return current_lag_; }
+			inline double GetMaxLag() { return max_lag_; }
+			inline double GetMeanLag() { return lag_samples_ > 0 ? lag_sum_ / lag_samples_ : 0; }
+
+			inline const std::deque<Entry>& GetEntries() { return entries_; }
+
+			int AddListener(Listener listener);
+			void RemoveListener(int id);
+
+		protected:
+			PerformanceMonitor();
+			~PerformanceMonitor();
+
+			void RecordDispatch(const char* name, Local<Function> callback, gint64 start, gint64 end);
+			void Record(Entry entry);
+			void Deliver();
+			void WriteTraceEvent(const char* name, const std::string& source, gint64 start, gint64 end);
+
+			static std::string DescribeSource(Local<Function> callback);
+			static gboolean LagSampleCallback(gpointer user_data);
+			static gboolean DeliverCallback(gpointer user_data);
+
+			gint64 origin_;
+			int depth_;
+			double long_task_threshold_;
+
+			std::deque<Entry> entries_;
+			std::vector<Entry> undelivered_;
+			std::map<int, Listener> listeners_;
+			int next_listener_id_;
+			guint deliver_source_id_;
+
+			guint lag_source_id_;
+			gint64 last_lag_tick_;
+			double current_lag_;
+			double max_lag_;
+			double lag_sum_;
+			size_t lag_samples_;
+
+			FILE* trace_file_;
+			bool trace_has_events_;
+
+			static PerformanceMonitor* instance_;
+	};
+}
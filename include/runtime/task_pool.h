@@ -0,0 +1,97 @@
+#pragma once
+
+#include <v8.h>
+#include <glib.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace v8;
+
+namespace mosaic::runtime {
+	/**
+	 * Shared native thread pool for asynchronous built-ins.
+	 *
+	 * Work runs on worker threads, each owning a deque that other workers steal
+	 * from when idle. Completions are handed back to the GTK main loop through a
+	 * single eventfd-backed GSource, which runs them in batches under one
+	 * HandleScope followed by one microtask checkpoint.
+	 */
+	class TaskPool {
+		public:
+			/* Runs on a worker thread. Must not touch V8. */
+			using Work = std::function<void()>;
+
+			/* Runs on the main thread once the work is done. */
+			using Completion = std::function<void(Local<Context> context, Local<Promise::Resolver> resolver)>;
+
+			static TaskPool* GetInstance();
+			static void Shutdown();
+
+			/**
+			 * Run work on the pool and return a promise settled by the completion.
+			 * If the work throws, the promise is rejected and the completion skipped.
+			 */
+			Local<Promise> Submit(Local<Context> context, Work work, Completion completion);
+
+			/**
+			 * Run work on the pool, then optionally run a callback on the main
+			 * thread. Can be called from workers to fan out nested work.
+			 */
+			void Post(Work work, std::function<void()> main_thread_callback = nullptr);
+
+			/**
+			 * Call body once for every index in [0, count) across the pool and
+			 * return when all calls finished. The calling thread takes part, so it
+			 * is safe from workers too. The body must not throw or touch V8.
+			 */
+			void ParallelFor(size_t count, std::function<void(size_t index)> body);
+
+			inline size_t GetThreadCount() { return workers_.size(); }
+
+		protected:
+			struct Job {
+				Work work;
+				std::function<void()> complete;
+				std::string error;
+			};
+
+			struct Worker {
+				std::deque<Job*> queue;
+				std::mutex queue_mutex;
+				std::thread handle;
+			};
+
+			TaskPool(size_t thread_count);
+			~TaskPool();
+
+			void Push(Job* job);
+			Job* Pop(size_t worker_index);
+			Job* Steal(size_t thief_index);
+			void RunWorker(size_t worker_index);
+			void Complete(Job* job);
+			void Wake();
+			void DrainCompletions();
+
+			static gboolean CompletionSourceCallback(gint fd, GIOCondition condition, gpointer user_data);
+
+			std::vector<Worker*> workers_;
+			std::atomic<size_t> next_worker_;
+			std::atomic<size_t> pending_;
+			std::atomic<bool> stopping_;
+			std::mutex sleep_mutex_;
+			std::condition_variable sleep_condition_;
+
+			std::vector<Job*> completed_;
+			std::mutex completed_mutex_;
+			int event_fd_;
+			guint event_source_id_;
+
+			static TaskPool* instance_;
+	};
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cassert>
+#include <vector>
 #include <v8.h>
 using namespace v8;
 
@@ -49,6 +50,17 @@ namespace piston {
 				return handle_scope.Escape(local_handle);
 			}
 
+			// Unlike InstanceOf, which only walks prototypes, this can't be fooled by plain objects
+			static bool HasInstance(Isolate* isolate, Local<Value> value) {
+				for (auto& class_tpl : templates_) {
+					if (Local<FunctionTemplate>::New(isolate, class_tpl)->HasInstance(value)) {
+						return true;
+					}
+				}
+
+				return false;
+			}
+
 			virtual ~NativeClass() {
 				Persistent<Object>& persistent = this->GetPersistentHandle();
 
@@ -70,14 +82,41 @@ namespace piston {
 				persistent.Reset(Isolate::GetCurrent(), handle);
 			}
 
+			// Let V8 collect the handle once JS drops it, deleting this object along with it
+			void MakeWeak() {
+				persistent_.SetWeak(this, WeakCallback, WeakCallbackType::kParameter);
+			}
+
+			// Keep the handle alive again, for as long as native code holds on to this object
+			void ClearWeak() {
+				persistent_.ClearWeak();
+			}
+
 			static Local<Function> Make(Local<Context> context) {
 				return T::Make(context);
 			}
 
+			// Remember the template Make() built the constructor from, for HasInstance()
+			static void AddTemplate(Isolate* isolate, Local<FunctionTemplate> class_tpl) {
+				templates_.emplace_back(isolate, class_tpl);
+			}
+
 		private:
+			static void WeakCallback(const WeakCallbackInfo<NativeClass>& info) {
+				// Only the handle may be touched here, destructors can call into V8 in the second pass
+				info.GetParameter()->persistent_.Reset();
+				info.SetSecondPassCallback(DeleteCallback);
+			}
+
+			static void DeleteCallback(const WeakCallbackInfo<NativeClass>& info) {
+				delete info.GetParameter();
+			}
+
 			Persistent<Object> persistent_;
 			static std::unordered_map<int, Persistent<Function, CopyablePersistentTraits<Function>>> constructors_;
+			static std::vector<Persistent<FunctionTemplate, CopyablePersistentTraits<FunctionTemplate>>> templates_;
 	};
 
 	template<class T> std::unordered_map<int, Persistent<Function, CopyablePersistentTraits<Function>>> NativeClass<T>::constructors_;
+	template<class T> std::vector<Persistent<FunctionTemplate, CopyablePersistentTraits<FunctionTemplate>>> NativeClass<T>::templates_;
 }
\ No newline at end of file
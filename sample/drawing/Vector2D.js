@@ -1,6 +0,0 @@
-export class Vector2D {
-    constructor(x, y) {
-        this.x = x;
-        this.y = y;
-    }
-}
\ No newline at end of file
@@ -1,20 +1,37 @@
-import { Window, DrawingArea } from "../mosaic/presentation";
-import { Block } from "./Block.js";
+import { Window, DrawingArea, Animation } from "../mosaic/presentation";
+import { Entities } from "../mosaic/simulation";
 import { Color } from "./Color.js";
 import { sleep } from "../lib/utils.js";
 
 let window, drawingArea;
-let blocks = [
-	new Block(0, 0, 20, 20, new Color(255, 255, 0)),
-	new Block(30, 100, 20, 20, new Color(0, 255, 0)),
-	new Block(60, 20, 20, 20, new Color(0, 75, 255), 2, 1),
-	new Block(100, 60, 20, 20, new Color(255, 75, 0), 1, 2),
-	new Block(0, 40, 20, 20, new Color(255, 0, 75), 2, 2),
-	new Block(60, 20, 20, 20, new Color(0, 255, 75), 3, 1),
-	new Block(100, 60, 20, 20, new Color(0, 255, 255), 3, 2),
-	new Block(0, 40, 20, 20, new Color(255, 100, 100), 2, 3)
+
+// x, y, x speed, y speed and color of each block, all 20x20
+const blocks = [
+	[0, 0, 1, 1, new Color(255, 255, 0)],
+	[30, 100, 1, 1, new Color(0, 255, 0)],
+	[60, 20, 2, 1, new Color(0, 75, 255)],
+	[100, 60, 1, 2, new Color(255, 75, 0)],
+	[0, 40, 2, 2, new Color(255, 0, 75)],
+	[60, 20, 3, 1, new Color(0, 255, 75)],
+	[100, 60, 3, 2, new Color(0, 255, 255)],
+	[0, 40, 2, 3, new Color(255, 100, 100)]
 ];
 
+// Moved and bounced natively, then handed to fillRects() as they are
+const entities = new Entities(blocks.length);
+
+blocks.forEach(([x, y, xSpeed, ySpeed, color], i) => {
+	entities.x[i] = x;
+	entities.y[i] = y;
+	entities.vx[i] = xSpeed;
+	entities.vy[i] = ySpeed;
+	entities.width[i] = 20;
+	entities.height[i] = 20;
+	entities.colors[i] = ((color.r << 24) | (color.g << 16) | (color.b << 8) | 0xff) >>> 0;
+});
+
+entities.pack();
+
 async function main() {
 	window = showWindow();
 	drawingArea = createDrawingArea();
@@ -37,33 +54,38 @@ function showWindow() {
 function createDrawingArea() {
 	const area = new DrawingArea();
 	area.onDraw = draw;
+	createBadge(area);
 	return area;
 }
 
+function createBadge(area) {
+	const badge = area.createLayer(120, 24);
+	badge.x = 8;
+	badge.y = 8;
+
+	badge.onDraw = context => {
+		context.font = "Sans 10";
+		context.setColor(40, 40, 40);
+		context.fillText("native animation", 4, 16);
+	};
+
+	// Composited and faded by the drawing area itself, no JS runs per frame
+	area.attachLayer(badge);
+	new Animation(badge, "opacity", { from: 1, to: 0.2, duration: 800, easing: "ease-in-out", iterations: Infinity, alternate: true }).start();
+}
+
 function update() {
-	for (let block of blocks) {
-		block.update();
-
-		if (block.right >= drawingArea.width) {
-			block.speed.x = -Math.abs(block.speed.x);
-		} else if (block.left <= 0) {
-			block.speed.x = Math.abs(block.speed.x);
-		}
-		
-		if (block.bottom >= drawingArea.height) {
-			block.speed.y = -Math.abs(block.speed.y);
-		} else if (block.top <= 0) {
-			block.speed.y = Math.abs(block.speed.y);
-		}
-	}
+	entities.step(1, 0, 0, drawingArea.width, drawingArea.height);
 }
 
 function draw(context) {
-	for (let block of blocks) {
-		context.setColor(block.color.r, block.color.g, block.color.b);
-		context.rect(block.position.x, block.position.y, block.width, block.height);
-		context.fill();
-	}
+	// Fill every block natively with a single call
+	context.fillRects(entities.rects, entities.colors);
+
+	// Same text every frame, so it's shaped once and redrawn from the cache
+	context.font = "Sans Bold 12";
+	context.setColor(40, 40, 40);
+	context.fillText(`${entities.count} blocks`, 8, drawingArea.height - 8);
 }
 
 await main();
\ No newline at end of file
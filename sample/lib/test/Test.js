@@ -1,4 +1,5 @@
 import { TestFailedError } from "./TestFailedError.js";
+import { TestSkippedError } from "./TestSkippedError.js";
 import { TestResult, TestResultType } from "./TestResult.js";
 
 /**
@@ -74,6 +75,12 @@ export class Test {
                         TestResultType.fail,
                         e.message
                     );
+                } else if (e instanceof TestSkippedError) {
+                    result = new TestResult(
+                        this,
+                        TestResultType.skip,
+                        e.message
+                    );
                 } else {
                     throw e;
                 }
@@ -8,7 +8,8 @@ import { Debug } from "../../mosaic/diagnostics";
 export const TestResultType = {
     pass: "pass",
     fail: "fail",
-    error: "error"
+    error: "error",
+    skip: "skip"
 };
 
 // Freeze the enum
@@ -67,7 +68,7 @@ export class TestResult {
      * Print test result in readable format.
      */
     print() {
-        if (this.type === TestResultType.pass) {
+        if (this.type === TestResultType.pass || this.type === TestResultType.skip) {
             Debug.log(this.toString());
         } else {
             Debug.error(this.toString());
@@ -75,7 +76,7 @@ export class TestResult {
     }
 
     toString() {
-        const symbol = this.type === TestResultType.pass ? "✓" : "✗";
+        const symbol = this.type === TestResultType.pass ? "✓" : this.type === TestResultType.skip ? "-" : "✗";
         const label = this.type[0].toUpperCase() + this.type.substr(1);
 
         if (this.cause) {
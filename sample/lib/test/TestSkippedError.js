@@ -0,0 +1,2 @@
+export class TestSkippedError extends Error {}
+export default TestSkippedError;
\ No newline at end of file
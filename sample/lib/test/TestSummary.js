@@ -18,6 +18,9 @@ export class TestSummary {
     /** @type {number} */
     #errors = 0;
 
+    /** @type {number} */
+    #skipped = 0;
+
     /**
      * Test results in this summary.
      * @returns {IterableIterator<TestResult>}
@@ -58,6 +61,14 @@ export class TestSummary {
         return this.#errors;
     }
 
+    /**
+     * Number of tests that were skipped.
+     * @type {number} 
+     */
+    get skipped() {
+        return this.#skipped;
+    }
+
     /**
      * Add a result to the summary.
      * @param {TestResult} result Result to add.
@@ -76,6 +87,10 @@ export class TestSummary {
                 case TestResultType.error:
                     this.#errors++;
                     break;
+
+                case TestResultType.skip:
+                    this.#skipped++;
+                    break;
             }
 
             this.#total++;
@@ -102,6 +117,10 @@ export class TestSummary {
                 sections.push(`${this.errors === this.total ? "all" : this.errors} with errors`);
             }
 
+            if (this.skipped > 0) {
+                sections.push(`${this.skipped === this.total ? "all" : this.skipped} skipped`);
+            }
+
             /** @type {string} */
             let count;
             
@@ -113,7 +132,7 @@ export class TestSummary {
             
             Debug.log();
 
-            if (this.total === this.passed) {
+            if (this.total === this.passed + this.skipped) {
                 Debug.log(`${this.total} tests executed:`, count);
             } else {
                 Debug.error(`${this.total} tests executed:`, count);
@@ -1,5 +1,6 @@
 import Debug from "@mosaic/diagnostics/Debug";
 import { TestFailedError } from "./TestFailedError.js";
+import { TestSkippedError } from "./TestSkippedError.js";
 
 export function assert(value) {
     if (!value) {
@@ -17,6 +18,14 @@ export function assertEquals(value1, value2) {
     return true;
 }
 
+/**
+ * Stop the running test and report it as skipped instead of passed.
+ * @param {string} reason Why the test can't run here.
+ */
+export function skip(reason) {
+    throw new TestSkippedError(reason);
+}
+
 export async function test(name, func, ...args) {
     try {
         await func(...args);
@@ -24,6 +33,8 @@ export async function test(name, func, ...args) {
     } catch(e) {
         if (e instanceof TestFailedError) {
             Debug.log(`✗ [Fail] ${name}: ${e.message}`);
+        } else if (e instanceof TestSkippedError) {
+            Debug.log(`- [Skip] ${name}: ${e.message}`);
         } else {
             Debug.log(`✗ [Error] ${name}: ${e.message || "Unknown error"}`);
         }
@@ -1 +1,2 @@
-export { default as Debug } from "@mosaic/diagnostics/Debug";
\ No newline at end of file
+export { default as Debug } from "@mosaic/diagnostics/Debug";
+export { default as Performance, PerformanceObserver } from "@mosaic/diagnostics/Performance";
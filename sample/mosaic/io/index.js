@@ -0,0 +1,2 @@
+export { default as File } from "@mosaic/io/File";
+export { ReadableStream, WritableStream } from "@mosaic/io/Stream";
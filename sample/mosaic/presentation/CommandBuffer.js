@@ -0,0 +1,133 @@
+import { DrawingContext } from "@mosaic/presentation/DrawingArea";
+
+const { Commands } = DrawingContext;
+
+/**
+ * Encodes drawing commands into a Float32Array that can be replayed natively
+ * with a single DrawingContext.submit() call.
+ */
+export class CommandBuffer {
+    /**
+     * Create a new command buffer.
+     * @param {number} capacity Initial capacity, in floats.
+     */
+    constructor(capacity = 4096) {
+        this.#data = new Float32Array(capacity);
+    }
+
+    /** @type {Float32Array} */
+    #data;
+
+    /** @type {number} */
+    #length = 0;
+
+    /**
+     * Encoded commands. Only the first 'length' floats are meaningful.
+     * @type {Float32Array}
+     */
+    get data() { return this.#data; }
+
+    /**
+     * Number of floats used.
+     * @type {number}
+     */
+    get length() { return this.#length; }
+
+    /**
+     * Forget every encoded command, keeping the allocation.
+     */
+    reset() {
+        this.#length = 0;
+    }
+
+    /**
+     * Replay the encoded commands into a drawing context.
+     * @param {DrawingContext} context Context received in onDraw.
+     */
+    submit(context) {
+        context.submit(this.#data, this.#length);
+    }
+
+    rect(x, y, width, height) { this.#push5(Commands.RECT, x, y, width, height); }
+    setColor(r, g, b, a = 1) { this.#push5(Commands.SET_COLOR, r, g, b, a); }
+    fill() { this.#push1(Commands.FILL); }
+    fillRect(x, y, width, height) { this.#push5(Commands.FILL_RECT, x, y, width, height); }
+    stroke() { this.#push1(Commands.STROKE); }
+    setLineWidth(width) { this.#push2(Commands.SET_LINE_WIDTH, width); }
+    moveTo(x, y) { this.#push3(Commands.MOVE_TO, x, y); }
+    lineTo(x, y) { this.#push3(Commands.LINE_TO, x, y); }
+    closePath() { this.#push1(Commands.CLOSE_PATH); }
+    save() { this.#push1(Commands.SAVE); }
+    restore() { this.#push1(Commands.RESTORE); }
+    translate(x, y) { this.#push3(Commands.TRANSLATE, x, y); }
+    scale(x, y) { this.#push3(Commands.SCALE, x, y); }
+    clear(r, g, b, a = 1) { this.#push5(Commands.CLEAR, r, g, b, a); }
+    circle(x, y, radius) { this.#push4(Commands.CIRCLE, x, y, radius); }
+    curveTo(x1, y1, x2, y2, x, y) { this.#push7(Commands.CURVE_TO, x1, y1, x2, y2, x, y); }
+
+    #reserve(count) {
+        if (this.#length + count > this.#data.length) {
+            const data = new Float32Array(Math.max(this.#data.length * 2, this.#length + count));
+            data.set(this.#data.subarray(0, this.#length));
+            this.#data = data;
+        }
+    }
+
+    #push1(command) {
+        this.#reserve(1);
+        this.#data[this.#length++] = command;
+    }
+
+    #push2(command, a) {
+        this.#reserve(2);
+        this.#data[this.#length++] = command;
+        this.#data[this.#length++] = a;
+    }
+
+    #push3(command, a, b) {
+        this.#reserve(3);
+        this.#data[this.#length++] = command;
+        this.#data[this.#length++] = a;
+        this.#data[this.#length++] = b;
+    }
+
+    #push4(command, a, b, c) {
+        this.#reserve(4);
+        this.#data[this.#length++] = command;
+        this.#data[this.#length++] = a;
+        this.#data[this.#length++] = b;
+        this.#data[this.#length++] = c;
+    }
+
+    #push5(command, a, b, c, d) {
+        this.#reserve(5);
+        const data = this.#data;
+        let i = this.#length;
+
+        data[i++] = command;
+        data[i++] = a;
+        data[i++] = b;
+        data[i++] = c;
+        data[i++] = d;
+
+        this.#length = i;
+    }
+
+    #push7(command, a, b, c, d, e, f) {
+        this.#reserve(7);
+        const data = this.#data;
+        let i = this.#length;
+
+        data[i++] = command;
+        data[i++] = a;
+        data[i++] = b;
+        data[i++] = c;
+        data[i++] = d;
+        data[i++] = e;
+        data[i++] = f;
+
+        this.#length = i;
+    }
+}
+
+export default CommandBuffer;
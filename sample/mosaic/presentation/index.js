@@ -1,3 +1,11 @@
 export { default as Window } from "@mosaic/presentation/Window";
 export { default as Button } from "@mosaic/presentation/Button";
-export { default as DrawingArea, DrawingContext } from "@mosaic/presentation/DrawingArea";
\ No newline at end of file
+export { default as DrawingArea, DrawingContext, Layer, ImageData, Path2D } from "@mosaic/presentation/DrawingArea";
+export { default as Events, batched } from "@mosaic/presentation/Events";
+export { default as Image } from "@mosaic/presentation/Image";
+export { default as Atlas } from "@mosaic/presentation/Atlas";
+export { default as Headless } from "@mosaic/presentation/Headless";
+export { default as Animation } from "@mosaic/presentation/Animation";
+export { default as Scheduler } from "@mosaic/presentation/Scheduler";
+export { default as SpatialIndex } from "@mosaic/presentation/SpatialIndex";
+export { default as CommandBuffer } from "./CommandBuffer.js";
@@ -0,0 +1 @@
+export { default as Entities } from "@mosaic/simulation/Entities";
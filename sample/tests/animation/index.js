@@ -0,0 +1,72 @@
+import { Animation, DrawingArea, Headless } from "../../mosaic/presentation";
+import { assert, assertEquals, until } from "../../lib/test";
+import Test from "../../lib/test/Test.js";
+import TestSet from "../../lib/test/TestSet.js";
+
+function throws(func, type) {
+    try {
+        func();
+    } catch (error) {
+        return error instanceof type;
+    }
+
+    return false;
+}
+
+await new TestSet({
+    tests: [
+        new Test({
+            name: "should reject properties it can't animate",
+            test: () => {
+                const layer = new DrawingArea().createLayer(16, 16);
+
+                assert(throws(() => new Animation(layer, "width", { to: 10 }), TypeError));
+                assert(throws(() => new Animation({}, "x", { to: 10 }), TypeError));
+                assert(throws(() => new Animation(layer, "x", {}), TypeError));
+                assert(throws(() => new Animation(layer, "x", { to: 10, easing: "bouncy" }), TypeError));
+                assert(throws(() => new Animation(layer, "x", { to: 10, duration: -1 }), RangeError));
+            }
+        }),
+
+        new Test({
+            name: "should jump to the end when finished",
+            test: async () => {
+                const layer = new DrawingArea().createLayer(16, 16);
+                const animation = new Animation(layer, "opacity", { from: 1, to: 0, duration: 1000 });
+
+                animation.start();
+                assert(animation.running);
+
+                await until(done => {
+                    animation.onFinish = done;
+                    animation.finish();
+                }, 1000);
+
+                assert(!animation.running);
+                assertEquals(layer.opacity, 0);
+            }
+        }),
+
+        new Test({
+            name: "should follow the frame clock",
+            test: () => {
+                // Frames only advance on demand without a display
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                const layer = new DrawingArea().createLayer(16, 16);
+                const animation = new Animation(layer, "x", { from: 0, to: 100, duration: 1000, easing: "linear" });
+
+                animation.start();
+                Headless.step(1);
+                Headless.step(30);
+                assertEquals(Math.round(layer.x), 50);
+
+                Headless.step(30);
+                assertEquals(layer.x, 100);
+                assert(!animation.running);
+            }
+        })
+    ]
+}).run(true);
\ No newline at end of file
@@ -0,0 +1,114 @@
+import { Atlas, ImageData, Window, DrawingArea, Headless } from "../../mosaic/presentation";
+import { assert, assertEquals } from "../../lib/test";
+import Test from "../../lib/test/Test.js";
+import TestSet from "../../lib/test/TestSet.js";
+
+function overlaps(a, b) {
+    return a.page === b.page && a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+await new TestSet({
+    tests: [
+        new Test({
+            name: "should pack sprites without overlapping",
+            test: () => {
+                const atlas = new Atlas(64, 64);
+                const sprites = [];
+
+                for (let i = 0; i < 20; i++) {
+                    sprites.push(atlas.getSprite(atlas.add(new ImageData(5 + i % 7, 4 + i % 5))));
+                }
+
+                assertEquals(atlas.count, 20);
+                assertEquals(atlas.pageCount, 1);
+
+                for (let i = 0; i < sprites.length; i++) {
+                    for (let j = i + 1; j < sprites.length; j++) {
+                        assert(!overlaps(sprites[i], sprites[j]));
+                    }
+                }
+            }
+        }),
+
+        new Test({
+            name: "should open a new page when full",
+            test: () => {
+                const atlas = new Atlas(16, 16);
+
+                atlas.add(new ImageData(16, 16));
+                atlas.add(new ImageData(16, 16));
+
+                assertEquals(atlas.pageCount, 2);
+                assertEquals(atlas.getSprite(1).page, 1);
+            }
+        }),
+
+        new Test({
+            name: "should reject images larger than a page",
+            test: () => {
+                const atlas = new Atlas(16, 16);
+                let thrown = false;
+
+                try {
+                    atlas.add(new ImageData(17, 1));
+                } catch (error) {
+                    thrown = error instanceof RangeError;
+                }
+
+                assert(thrown);
+            }
+        }),
+
+        new Test({
+            name: "should forget everything when cleared",
+            test: () => {
+                const atlas = new Atlas(16, 16);
+
+                atlas.add(new ImageData(4, 4));
+                atlas.clear();
+
+                assertEquals(atlas.count, 0);
+                assertEquals(atlas.pageCount, 0);
+                assertEquals(atlas.getSprite(0), undefined);
+            }
+        }),
+
+        new Test({
+            name: "should skip instances with invalid numbers and keep drawing",
+            test: () => {
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                const atlas = new Atlas(16, 16);
+                const sprite = new ImageData(4, 4);
+                sprite.fill(255, 0, 0);
+                atlas.add(sprite);
+
+                // sprite, x, y, scale, rotation, alpha
+                const instances = new Float32Array([
+                    NaN, 10, 10, 1, 0, 1,
+                    1e30, 10, 10, 1, 0, 1,
+                    -Infinity, 10, 10, 1, 0, 1,
+                    0, NaN, 10, 1, 0, 1,
+                    0, 10, 10, Infinity, 0, 1,
+                    0, 10, 10, 1, 0, 1
+                ]);
+
+                const window = new Window("Atlas", 40, 40);
+                const area = new DrawingArea();
+
+                area.onDraw = (context) => context.drawSprites(atlas, instances);
+                window.addChild(area);
+                window.show();
+
+                const image = window.capture();
+                window.close();
+
+                // Only the last instance draws, and the context survived the others
+                assertEquals(image.data[10 * image.stride + 10 * 4 + 2], 255);
+                assertEquals(image.data[20 * image.stride + 20 * 4 + 2], 0);
+            }
+        })
+    ]
+}).run(true);
\ No newline at end of file
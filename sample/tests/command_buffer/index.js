@@ -0,0 +1,121 @@
+import { Window, DrawingArea, DrawingContext, Headless, CommandBuffer } from "../../mosaic/presentation";
+import { assert, assertEquals } from "../../lib/test";
+import Test from "../../lib/test/Test.js";
+import TestSet from "../../lib/test/TestSet.js";
+
+const { Commands } = DrawingContext;
+
+function capture(draw) {
+    const window = new Window("Command buffer", 200, 150);
+    const area = new DrawingArea();
+
+    area.onDraw = draw;
+    window.addChild(area);
+    window.show();
+
+    const pixels = window.capture().data;
+    window.close();
+
+    return pixels;
+}
+
+// Only calls DrawingContext also has, so replays can be compared with direct draws
+function draw(target) {
+    target.setColor(200, 40, 40);
+    target.rect(10, 10, 80, 60);
+    target.fill();
+    target.setColor(40, 40, 200, 0.5);
+    target.rect(50, 40, 120, 90);
+    target.rect(0, 100, 30, 30);
+    target.fill();
+}
+
+// Submits a buffer from onDraw and returns what it threw, if anything
+function submitError(commands, length) {
+    let error = null;
+
+    capture(context => {
+        try {
+            context.submit(commands, length);
+        } catch (e) {
+            error = e;
+        }
+    });
+
+    return error;
+}
+
+await new TestSet({
+    tests: [
+        new Test({
+            name: "should grow while encoding",
+            test: () => {
+                const buffer = new CommandBuffer(4);
+
+                buffer.clear(255, 255, 255);
+                buffer.circle(100, 75, 40);
+                buffer.setLineWidth(3);
+                buffer.moveTo(0, 0);
+                buffer.curveTo(50, 150, 150, 0, 200, 150);
+                buffer.stroke();
+
+                assertEquals(buffer.data[0], Commands.CLEAR);
+                assertEquals(buffer.data[5], Commands.CIRCLE);
+                assertEquals(buffer.length, 5 + 4 + 2 + 3 + 7 + 1);
+                assert(buffer.data.length >= buffer.length);
+
+                buffer.reset();
+                assertEquals(buffer.length, 0);
+            }
+        }),
+
+        new Test({
+            name: "should replay like direct drawing calls",
+            test: () => {
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                const buffer = new CommandBuffer();
+                draw(buffer);
+
+                const replayed = capture(context => buffer.submit(context));
+                const direct = capture(context => draw(context));
+
+                assertEquals(replayed.length, direct.length);
+                assert(replayed.every((value, i) => value === direct[i]));
+            }
+        }),
+
+        new Test({
+            name: "should accept plain array buffers",
+            test: () => {
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                const commands = new Float32Array([Commands.SET_COLOR, 0, 0, 0, 1, Commands.FILL_RECT, 0, 0, 10, 10]);
+                assertEquals(submitError(commands.buffer), null);
+            }
+        }),
+
+        new Test({
+            name: "should reject malformed commands",
+            test: () => {
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                assert(submitError(new Float32Array([NaN])) instanceof RangeError);
+                assert(submitError(new Float32Array([Infinity])) instanceof RangeError);
+                assert(submitError(new Float32Array([1e10])) instanceof RangeError);
+                assert(submitError(new Float32Array([Commands.FILL, 1.5])) instanceof RangeError);
+                assert(submitError(new Float32Array([Commands.RECT, 0, 0])) instanceof RangeError);
+                assert(submitError([Commands.FILL]) instanceof TypeError);
+
+                // Only the used part of the buffer is read
+                assertEquals(submitError(new Float32Array([Commands.FILL, NaN]), 1), null);
+            }
+        })
+    ]
+}).run(true);
\ No newline at end of file
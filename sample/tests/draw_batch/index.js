@@ -0,0 +1,96 @@
+import { Window, DrawingArea, Headless } from "../../mosaic/presentation";
+import { assert, assertEquals } from "../../lib/test";
+import Test from "../../lib/test/Test.js";
+import TestSet from "../../lib/test/TestSet.js";
+
+function capture(draw, tiled = false) {
+    const window = new Window("Draw batch", 200, 150);
+    const area = new DrawingArea();
+
+    area.tiled = tiled;
+    area.onDraw = draw;
+    window.addChild(area);
+    window.show();
+
+    const image = window.capture();
+    window.close();
+
+    return image;
+}
+
+// Red, then blue over it, then red again over the blue
+const coords = new Float32Array([0, 0, 60, 60, 40, 40, 60, 60, 80, 80, 60, 60]);
+const colors = new Uint32Array([0xff0000ff, 0x0000ffff, 0xff0000ff]);
+
+// Translucent rectangles of one color, blending where they overlap
+const translucentCoords = new Float32Array([10, 10, 100, 80, 60, 40, 100, 80]);
+const translucentColors = new Uint32Array([0x00800080]);
+
+function separately(context, coords, colors) {
+    for (let i = 0; i < coords.length / 4; i++) {
+        const color = colors[colors.length === 1 ? 0 : i];
+
+        context.setColor(color >>> 24, (color >>> 16) & 0xff, (color >>> 8) & 0xff, (color & 0xff) / 255);
+        context.rect(coords[i * 4], coords[i * 4 + 1], coords[i * 4 + 2], coords[i * 4 + 3]);
+        context.fill();
+    }
+}
+
+function red(image, x, y) {
+    return image.data[y * image.stride + x * 4 + 2];
+}
+
+function same(a, b) {
+    return a.data.length === b.data.length && a.data.every((value, i) => value === b.data[i]);
+}
+
+await new TestSet({
+    tests: [
+        new Test({
+            name: "should group colors unless asked to keep order",
+            test: () => {
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                const grouped = capture(context => context.fillRects(coords, colors));
+                const ordered = capture(context => context.fillRects(coords, colors, { ordered: true }));
+
+                assertEquals(red(grouped, 90, 90), 0);
+                assertEquals(red(ordered, 90, 90), 255);
+            }
+        }),
+
+        new Test({
+            name: "should overlap like separate draws when ordered",
+            test: () => {
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                const expected = capture(context => separately(context, coords, colors));
+                const translucent = capture(context => separately(context, translucentCoords, translucentColors));
+
+                assert(same(expected, capture(context => context.fillRects(coords, colors, { ordered: true }))));
+                assert(same(expected, capture(context => context.fillRects(coords, colors, { ordered: true }), true)));
+                assert(same(translucent, capture(context => context.fillRects(translucentCoords, translucentColors, { ordered: true }))));
+            }
+        }),
+
+        new Test({
+            name: "should keep line and circle order when asked to",
+            test: () => {
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                const lines = new Float32Array([0, 90, 200, 90, 90, 0, 90, 150, 0, 91, 200, 91]);
+                const circles = new Float32Array([60, 60, 40, 90, 90, 40, 120, 120, 40]);
+
+                assertEquals(red(capture(context => context.strokeLines(lines, colors, 6, { ordered: true })), 90, 90), 255);
+                assertEquals(red(capture(context => context.fillCircles(circles, colors, { ordered: true })), 110, 110), 255);
+                assertEquals(red(capture(context => context.fillCircles(circles, colors)), 110, 110), 0);
+            }
+        })
+    ]
+}).run(true);
\ No newline at end of file
@@ -0,0 +1,76 @@
+import { Window, Headless, batched } from "../../mosaic/presentation";
+import { assert, assertEquals, until } from "../../lib/test";
+import Test from "../../lib/test/Test.js";
+import TestSet from "../../lib/test/TestSet.js";
+
+function throws(func, type) {
+    try {
+        func();
+    } catch (error) {
+        return error instanceof type;
+    }
+
+    return false;
+}
+
+// Headless windows resize synchronously, so each width change queues its own event
+async function resizeTwice(handler) {
+    const window = new Window("Events", 300, 200);
+
+    window.onResize = handler;
+    window.width = 320;
+    window.width = 340;
+
+    await until(done => setTimeout(done, 50));
+    window.close();
+}
+
+await new TestSet({
+    tests: [
+        new Test({
+            name: "should only mark functions as batched",
+            test: () => {
+                const handler = () => {};
+
+                assertEquals(batched(handler), handler);
+                assert(throws(() => batched({}), TypeError));
+                assert(throws(() => batched(), TypeError));
+            }
+        }),
+
+        new Test({
+            name: "should call plain handlers once per event",
+            test: async () => {
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                const calls = [];
+                await resizeTwice((width, height) => calls.push([width, height]));
+
+                assertEquals(calls.length, 2);
+                assertEquals(calls[0][0], 320);
+                assertEquals(calls[1][0], 340);
+                assertEquals(calls[1][1], 200);
+            }
+        }),
+
+        new Test({
+            name: "should call batched handlers once with every event",
+            test: async () => {
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                const calls = [];
+                await resizeTwice(batched(events => calls.push(events)));
+
+                assertEquals(calls.length, 1);
+                assertEquals(calls[0].length, 2);
+                assertEquals(calls[0][0][0], 320);
+                assertEquals(calls[0][1][0], 340);
+                assertEquals(calls[0][1][1], 200);
+            }
+        })
+    ]
+}).run(true);
\ No newline at end of file
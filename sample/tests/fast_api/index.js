@@ -0,0 +1,127 @@
+import { Window, DrawingArea, Headless } from "../../mosaic/presentation";
+import { assert, assertEquals } from "../../lib/test";
+import Test from "../../lib/test/Test.js";
+import TestSet from "../../lib/test/TestSet.js";
+
+// Enough calls for V8 to optimize the callers and switch to the fast callbacks
+const iterations = 20000;
+
+function capture(draw, tiled = false) {
+    const window = new Window("Fast API", 200, 150);
+    const area = new DrawingArea();
+    let saved = null;
+
+    area.tiled = tiled;
+    area.onDraw = context => {
+        saved = context;
+        draw(context);
+    };
+
+    window.addChild(area);
+    window.show();
+
+    const pixels = window.capture().data;
+    window.close();
+
+    return { pixels, context: saved };
+}
+
+function square(context, i) {
+    context.setColor(200, 40 + (i % 2), 40, 1);
+    context.rect(10 + (i % 3), 10, 80, 60);
+    context.fill();
+}
+
+function same(a, b) {
+    return a.length === b.length && a.every((value, i) => value === b[i]);
+}
+
+await new TestSet({
+    tests: [
+        new Test({
+            name: "should draw the same through hot calls",
+            test: () => {
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                const once = capture(context => {
+                    for (let i = iterations - 3; i < iterations; i++) {
+                        square(context, i);
+                    }
+                });
+
+                const hot = capture(context => {
+                    for (let i = 0; i < iterations; i++) {
+                        square(context, i);
+                    }
+                });
+
+                const recorded = capture(context => {
+                    for (let i = 0; i < iterations; i++) {
+                        square(context, i);
+                    }
+                }, true);
+
+                assert(same(once.pixels, hot.pixels));
+                assert(same(once.pixels, recorded.pixels));
+            }
+        }),
+
+        new Test({
+            name: "should still throw from hot calls outside of onDraw",
+            test: () => {
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                const { context } = capture(context => {
+                    for (let i = 0; i < iterations; i++) {
+                        square(context, i);
+                    }
+                });
+
+                let errors = 0;
+
+                for (let i = 0; i < iterations; i++) {
+                    try {
+                        square(context, i);
+                    } catch (error) {
+                        errors += error instanceof TypeError ? 1 : 0;
+                    }
+                }
+
+                assertEquals(errors, iterations);
+            }
+        }),
+
+        new Test({
+            name: "should reject missing arguments without drawing",
+            test: () => {
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                let errors = 0;
+
+                const blank = capture(() => {});
+                const missing = capture(context => {
+                    context.setColor(0, 0, 0);
+
+                    for (const call of [() => context.rect(0, 0, 50), () => context.setColor(255, 0)]) {
+                        try {
+                            call();
+                        } catch (error) {
+                            errors += error instanceof TypeError ? 1 : 0;
+                        }
+                    }
+
+                    context.fill();
+                });
+
+                assertEquals(errors, 2);
+                assert(same(blank.pixels, missing.pixels));
+            }
+        })
+    ]
+}).run(true);
\ No newline at end of file
@@ -0,0 +1,105 @@
+import { File } from "../../mosaic/io";
+import { assert, assertEquals } from "../../lib/test";
+import Test from "../../lib/test/Test.js";
+import TestSet from "../../lib/test/TestSet.js";
+
+const path = "/tmp/mosaic-file-io-test.txt";
+const text = "Hello from Mosaic! :3";
+
+await new TestSet({
+    tests: [
+        new Test({
+            name: "should write text and report written bytes",
+            test: async () => assertEquals(await File.write(path, text), text.length)
+        }),
+
+        new Test({
+            name: "should read text back",
+            test: async () => assertEquals(await File.readText(path), text)
+        }),
+
+        new Test({
+            name: "should read into an ArrayBuffer",
+            test: async () => {
+                const buffer = await File.read(path);
+                assert(buffer instanceof ArrayBuffer);
+                assertEquals(buffer.byteLength, text.length);
+                assertEquals(new Uint8Array(buffer)[0], "H".charCodeAt(0));
+            }
+        }),
+
+        new Test({
+            name: "should write typed arrays",
+            test: async () => {
+                await File.write(path, new Uint8Array([1, 2, 3]));
+                assertEquals((await File.read(path)).byteLength, 3);
+            }
+        }),
+
+        new Test({
+            name: "should stat files",
+            test: async () => {
+                const stat = await File.stat(path);
+                assert(stat.isFile);
+                assert(!stat.isDirectory);
+                assertEquals(stat.size, 3);
+            }
+        }),
+
+        new Test({
+            name: "should list directories",
+            test: async () => assert((await File.readdir("/tmp")).includes("mosaic-file-io-test.txt"))
+        }),
+
+        new Test({
+            name: "should stream writes and reads in chunks",
+            test: async () => {
+                const writer = File.openWrite(path);
+
+                for (let i = 0; i < 4; i++) {
+                    await writer.ready;
+                    await writer.write(new Uint8Array(1000).fill(i));
+                }
+
+                await writer.close();
+
+                let total = 0;
+                let chunks = 0;
+
+                for await (const chunk of File.openRead(path, { chunkSize: 1024 })) {
+                    assert(chunk instanceof Uint8Array);
+                    total += chunk.byteLength;
+                    chunks++;
+                }
+
+                assertEquals(total, 4000);
+                assertEquals(chunks, 4);
+            }
+        }),
+
+        new Test({
+            name: "should reject missing files",
+            test: async () => {
+                let rejected = false;
+
+                try {
+                    await File.read("/tmp/mosaic-missing-file");
+                } catch (e) {
+                    rejected = true;
+                }
+
+                assert(rejected);
+            }
+        }),
+
+        new Test({
+            name: "should stat symbolic links themselves",
+            test: async () => {
+                // Always a link to the process' own directory
+                const stat = await File.stat("/proc/self");
+                assert(stat.isSymbolicLink);
+                assert(!stat.isDirectory);
+            }
+        })
+    ]
+}).run(true);
\ No newline at end of file
@@ -0,0 +1,83 @@
+import { Window, DrawingArea, Headless } from "../../mosaic/presentation";
+import { assert, assertEquals } from "../../lib/test";
+import Test from "../../lib/test/Test.js";
+import TestSet from "../../lib/test/TestSet.js";
+
+// Keeps JS running for at least that many milliseconds
+function busy(milliseconds) {
+    const end = Date.now() + milliseconds;
+    while (Date.now() < end);
+}
+
+// Renders one frame of an area set up by setup, and returns its stats
+function frameStats(setup) {
+    const window = new Window("Frame stats", 100, 100);
+    const area = new DrawingArea();
+
+    setup(area);
+    window.addChild(area);
+    window.show();
+    window.capture();
+
+    const stats = { area: area.frameStats, window: window.frameStats };
+    window.close();
+
+    return stats;
+}
+
+await new TestSet({
+    tests: [
+        new Test({
+            name: "should count onDraw as script time",
+            test: () => {
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                const stats = frameStats((area) => {
+                    area.onDraw = () => busy(20);
+                });
+
+                assertEquals(stats.area.frames, 1);
+                assert(stats.area.script.max >= 20);
+                assert(stats.window.script.max >= 20);
+            }
+        }),
+
+        new Test({
+            name: "should count attached layers as script time",
+            test: () => {
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                const stats = frameStats((area) => {
+                    const layer = area.createLayer(20, 20);
+                    layer.onDraw = () => busy(20);
+                    area.attachLayer(layer);
+                });
+
+                assert(stats.area.script.max >= 20);
+                assert(stats.window.script.max >= 20);
+            }
+        }),
+
+        new Test({
+            name: "should count layers drawn from onDraw once",
+            test: () => {
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                const stats = frameStats((area) => {
+                    const layer = area.createLayer(20, 20);
+                    layer.onDraw = () => busy(30);
+                    area.onDraw = (context) => context.drawLayer(layer, 0, 0);
+                });
+
+                assert(stats.area.script.max >= 30);
+                assert(stats.area.script.max < 60);
+            }
+        })
+    ]
+}).run(true);
\ No newline at end of file
@@ -0,0 +1,130 @@
+import { Window, DrawingArea, Image, Headless } from "../../mosaic/presentation";
+import { assert, assertEquals } from "../../lib/test";
+import Test from "../../lib/test/Test.js";
+import TestSet from "../../lib/test/TestSet.js";
+
+const path = "/tmp/mosaic-headless-test.png";
+
+// A shown window with one area filling it red, counting its draws
+function setup() {
+    const window = new Window("Headless", 40, 30);
+    const area = new DrawingArea();
+    const state = { draws: 0 };
+
+    area.onDraw = (context, clip) => {
+        state.draws++;
+        context.setColor(255, 0, 0);
+        context.rect(0, 0, clip.width, clip.height);
+        context.fill();
+    };
+
+    window.addChild(area);
+    window.show();
+
+    return { window, area, state };
+}
+
+await new TestSet({
+    tests: [
+        new Test({
+            name: "should advance frames and their time on step",
+            test: () => {
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                const frame = Headless.frame;
+                Headless.step(3);
+
+                assertEquals(Headless.frame, frame + 3);
+                assertEquals(Headless.frameTime, (frame + 3) * 1000 / 60);
+            }
+        }),
+
+        new Test({
+            name: "should only paint frames something was queued for",
+            test: () => {
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                const { window, area, state } = setup();
+
+                Headless.step(1);
+                assertEquals(state.draws, 1);
+
+                Headless.step(5);
+                assertEquals(state.draws, 1);
+
+                area.invalidate();
+                Headless.step(1);
+                assertEquals(state.draws, 2);
+
+                window.close();
+            }
+        }),
+
+        new Test({
+            name: "should capture what the window painted",
+            test: () => {
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                const { window } = setup();
+                const image = window.capture();
+                window.close();
+
+                assertEquals(image.width, 40);
+                assertEquals(image.height, 30);
+
+                // BGRA bytes, premultiplied
+                const offset = 29 * image.stride + 39 * 4;
+                assertEquals(image.data[offset], 0);
+                assertEquals(image.data[offset + 1], 0);
+                assertEquals(image.data[offset + 2], 255);
+                assertEquals(image.data[offset + 3], 255);
+            }
+        }),
+
+        new Test({
+            name: "should save captures as PNG files",
+            test: async () => {
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                const { window } = setup();
+                window.capture().savePng(path);
+                window.close();
+
+                Image.clearCache();
+                const image = await Image.load(path);
+
+                assertEquals(image.width, 40);
+                assertEquals(image.height, 30);
+            }
+        }),
+
+        new Test({
+            name: "should only take drawing areas as children",
+            test: () => {
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                const window = new Window("Headless", 10, 10);
+                let error = null;
+
+                try {
+                    window.addChild({});
+                } catch (e) {
+                    error = e;
+                }
+
+                window.close();
+                assert(error instanceof TypeError);
+            }
+        })
+    ]
+}).run(true);
\ No newline at end of file
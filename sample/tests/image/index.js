@@ -0,0 +1,84 @@
+import { Image } from "../../mosaic/presentation";
+import { File } from "../../mosaic/io";
+import { assert, assertEquals } from "../../lib/test";
+import Test from "../../lib/test/Test.js";
+import TestSet from "../../lib/test/TestSet.js";
+
+const path = "/tmp/mosaic-image-test.png";
+
+// A single opaque red pixel
+const png = new Uint8Array([
+    137, 80, 78, 71, 13, 10, 26, 10, 0, 0, 0, 13, 73, 72, 68, 82, 0, 0, 0, 1, 0, 0, 0, 1, 8, 6, 0, 0, 0, 31,
+    21, 196, 137, 0, 0, 0, 13, 73, 68, 65, 84, 120, 218, 99, 252, 207, 192, 240, 31, 0, 5, 5, 2, 0, 95, 200,
+    241, 210, 0, 0, 0, 0, 73, 69, 78, 68, 174, 66, 96, 130
+]);
+
+await File.write(path, png);
+
+await new TestSet({
+    tests: [
+        new Test({
+            name: "should decode images off the main thread",
+            test: async () => {
+                const image = await Image.load(path);
+                assertEquals(image.width, 1);
+                assertEquals(image.height, 1);
+                assertEquals(image.src, path);
+            }
+        }),
+
+        new Test({
+            name: "should decode concurrent loads once",
+            test: async () => {
+                Image.clearCache();
+                const [first, second] = await Promise.all([Image.load(path), Image.load(path)]);
+                assert(first === second);
+            }
+        }),
+
+        new Test({
+            name: "should account cached pixels against the budget",
+            test: async () => {
+                await Image.load(path);
+                assert(Image.cacheSize > 0);
+
+                const budget = Image.cacheBudget;
+                Image.cacheBudget = 0;
+                assertEquals(Image.cacheSize, 0);
+                Image.cacheBudget = budget;
+            }
+        }),
+
+        new Test({
+            name: "should keep images usable after the cache lets them go",
+            test: async () => {
+                const image = await Image.load(path);
+                const budget = Image.cacheBudget;
+
+                Image.cacheBudget = 0;
+                assertEquals(image.width, 1);
+                Image.cacheBudget = budget;
+
+                // Loading again decodes a new surface, the old image keeps its own
+                const reloaded = await Image.load(path);
+                assert(reloaded !== image);
+                assertEquals(reloaded.height, 1);
+            }
+        }),
+
+        new Test({
+            name: "should reject files that can't be decoded",
+            test: async () => {
+                let error = null;
+
+                try {
+                    await Image.load("/tmp/mosaic-missing-image.png");
+                } catch (e) {
+                    error = e;
+                }
+
+                assert(error instanceof Error);
+            }
+        })
+    ]
+}).run(true);
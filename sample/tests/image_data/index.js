@@ -0,0 +1,131 @@
+import { ImageData } from "../../mosaic/presentation";
+import { assert, assertEquals } from "../../lib/test";
+import Test from "../../lib/test/Test.js";
+import TestSet from "../../lib/test/TestSet.js";
+
+// Calls fn and returns what it threw, if anything
+function thrown(fn) {
+    try {
+        fn();
+    } catch (e) {
+        return e;
+    }
+
+    return null;
+}
+
+// Pixels are native-endian ARGB32, so reading them as words avoids byte order assumptions
+function pixelAt(image, x, y) {
+    return new Uint32Array(image.data.buffer, y * image.stride + x * 4, 1)[0];
+}
+
+await new TestSet({
+    tests: [
+        new Test({
+            name: "should expose the surface pixels without copying",
+            test: () => {
+                const image = new ImageData(3, 2);
+                assert(image.data instanceof Uint8ClampedArray);
+                assert(image.data === image.data);
+                assertEquals(image.data.length, image.stride * 2);
+            }
+        }),
+
+        new Test({
+            name: "should fill with premultiplied colors",
+            test: () => {
+                const image = new ImageData(9, 3);
+                image.fill(255, 0, 0, 0.5);
+                assertEquals(pixelAt(image, 8, 2), 0x80800000);
+            }
+        }),
+
+        new Test({
+            name: "should see writes made from JS",
+            test: () => {
+                const image = new ImageData(2, 2);
+                new Uint32Array(image.data.buffer)[0] = 0xff00ff00;
+                assertEquals(pixelAt(image, 0, 0), 0xff00ff00);
+            }
+        }),
+
+        new Test({
+            name: "should blend images over each other",
+            test: () => {
+                const target = new ImageData(10, 1);
+                const source = new ImageData(10, 1);
+
+                target.fill(0, 0, 255);
+                source.fill(255, 0, 0, 0.5);
+                target.blend(source);
+
+                assertEquals(pixelAt(target, 9, 0), 0xff80007f);
+            }
+        }),
+
+        new Test({
+            name: "should round trip premultiplication",
+            test: () => {
+                const image = new ImageData(5, 1);
+                new Uint32Array(image.data.buffer).fill(0x80ff8000);
+
+                image.premultiply();
+                assertEquals(pixelAt(image, 4, 0), 0x80804000);
+
+                image.unpremultiply();
+                assertEquals(pixelAt(image, 4, 0), 0x80ff8000);
+            }
+        }),
+
+        new Test({
+            name: "should keep flat areas flat when blurring",
+            test: () => {
+                const image = new ImageData(16, 16);
+                image.fill(10, 20, 30);
+                image.blur(3);
+                assertEquals(pixelAt(image, 7, 7), 0xff0a141e);
+            }
+        }),
+
+        new Test({
+            name: "should unpremultiply every pixel of wide rows alike",
+            test: () => {
+                const image = new ImageData(21, 1);
+                new Uint32Array(image.data.buffer).fill(0x40402010);
+
+                image.unpremultiply();
+
+                for (let x = 0; x < 21; x++) {
+                    assertEquals(pixelAt(image, x, 0), 0x40ff8040);
+                }
+            }
+        }),
+
+        new Test({
+            name: "should blur with radii larger than the image",
+            test: () => {
+                const image = new ImageData(4, 4);
+                image.fill(10, 20, 30);
+                image.blur(0x7fffffff);
+                assertEquals(pixelAt(image, 2, 2), 0xff0a141e);
+            }
+        }),
+
+        new Test({
+            name: "should reject sizes cairo can't allocate",
+            test: () => {
+                assert(thrown(() => new ImageData(1 << 30, 1 << 30)) instanceof RangeError);
+            }
+        }),
+
+        new Test({
+            name: "should not take objects faking the prototype for images",
+            test: () => {
+                const image = new ImageData(2, 2);
+                const fake = Object.create(ImageData.prototype);
+
+                assert(thrown(() => image.blend(fake)) instanceof TypeError);
+            }
+        })
+    ]
+}).run(true);
\ No newline at end of file
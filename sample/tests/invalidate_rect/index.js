@@ -0,0 +1,128 @@
+import { Window, DrawingArea, Headless } from "../../mosaic/presentation";
+import { assertEquals, skip } from "../../lib/test";
+import Test from "../../lib/test/Test.js";
+import TestSet from "../../lib/test/TestSet.js";
+
+// Green channel of a captured pixel, captures use cairo's B, G, R, A order
+function green(image, x, y) {
+    return image.data[y * image.stride + x * 4 + 1];
+}
+
+// A retained area only calls onDraw again for damage that reaches it
+function setup() {
+    const window = new Window("Invalidate rect", 200, 150);
+    const area = new DrawingArea();
+    const state = { calls: 0, clip: null };
+
+    area.retained = true;
+    area.onDraw = (context, clip) => {
+        state.calls++;
+        state.clip = clip;
+    };
+
+    window.addChild(area);
+    window.show();
+    window.capture();
+
+    return { window, area, state };
+}
+
+await new TestSet({
+    tests: [
+        new Test({
+            name: "should skip areas the rectangle misses",
+            test: () => {
+                if (!Headless.enabled) {
+                    skip("needs headless mode");
+                }
+
+                const { window, state } = setup();
+
+                window.invalidateRect(300, 300, 20, 20);
+                window.invalidateRect(-40, 0, 20, 20);
+                Headless.step(1);
+                assertEquals(state.calls, 1);
+
+                window.close();
+            }
+        }),
+
+        new Test({
+            name: "should only damage the part over the area",
+            test: () => {
+                if (!Headless.enabled) {
+                    skip("needs headless mode");
+                }
+
+                const { window, state } = setup();
+
+                window.invalidateRect(180, 140, 50, 50);
+                Headless.step(1);
+
+                assertEquals(state.calls, 2);
+                assertEquals(state.clip.x, 180);
+                assertEquals(state.clip.y, 140);
+                assertEquals(state.clip.width, 20);
+                assertEquals(state.clip.height, 10);
+
+                window.close();
+            }
+        }),
+
+        new Test({
+            name: "should not keep old pixels under the damage",
+            test: () => {
+                if (!Headless.enabled) {
+                    skip("needs headless mode");
+                }
+
+                const { window, area, state } = setup();
+                let x = 0;
+
+                // A red square over the white window background, moved within the damaged area
+                area.onDraw = (context, clip) => {
+                    state.calls++;
+                    state.clip = clip;
+                    context.setColor(255, 0, 0);
+                    context.rect(x, 0, 10, 10);
+                    context.fill();
+                };
+
+                area.invalidate();
+                Headless.step(1);
+
+                x = 5;
+                area.invalidateRect(0, 0, 20, 10);
+                Headless.step(1);
+
+                const image = window.capture();
+                assertEquals(green(image, 2, 5), 255);
+                assertEquals(green(image, 7, 5), 0);
+
+                window.close();
+            }
+        }),
+
+        new Test({
+            name: "should keep repainting only the damage",
+            test: () => {
+                if (!Headless.enabled) {
+                    skip("needs headless mode");
+                }
+
+                const { window, state } = setup();
+
+                for (let i = 0; i < 3; i++) {
+                    window.invalidateRect(10, 10, 20, 10);
+                    Headless.step(1);
+
+                    assertEquals(state.clip.width, 20);
+                    assertEquals(state.clip.height, 10);
+                }
+
+                assertEquals(state.calls, 4);
+                window.close();
+            }
+        })
+    ]
+}).run(true);
\ No newline at end of file
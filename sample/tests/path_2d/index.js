@@ -0,0 +1,115 @@
+import { Window, DrawingArea, DrawingContext, Path2D, Headless } from "../../mosaic/presentation";
+import { assert, assertEquals } from "../../lib/test";
+import Test from "../../lib/test/Test.js";
+import TestSet from "../../lib/test/TestSet.js";
+
+// Draws one headless frame and returns the captured pixels
+function capture(draw) {
+    const window = new Window("Path2D", 100, 100);
+    const area = new DrawingArea();
+
+    area.onDraw = draw;
+    window.addChild(area);
+    window.show();
+
+    const image = window.capture();
+    window.close();
+
+    return image;
+}
+
+// Red channel of a pixel, captures being BGRA
+function redAt(image, x, y) {
+    return image.data[y * image.stride + x * 4 + 2];
+}
+
+await new TestSet({
+    tests: [
+        new Test({
+            name: "should leave the path being built through the context alone",
+            test: () => {
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                const image = capture((context) => {
+                    const path = new Path2D();
+                    path.rect(60, 60, 20, 20);
+
+                    context.setColor(255, 0, 0);
+                    context.rect(10, 10, 20, 20);
+                    context.fillPath(path);
+                    context.strokePath(path, 2);
+                    context.fill();
+                });
+
+                assertEquals(redAt(image, 20, 20), 255);
+                assertEquals(redAt(image, 70, 70), 255);
+            }
+        }),
+
+        new Test({
+            name: "should keep coordinates beyond float precision",
+            test: () => {
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                // 2^24 + 1 has no float representation, it would round down to 2^24
+                const image = capture((context) => {
+                    const path = new Path2D();
+                    path.rect(16777217, 0, 10, 10);
+
+                    context.submit(new Float32Array([DrawingContext.Commands.TRANSLATE, -16777216, 0]));
+                    context.setColor(255, 0, 0);
+                    context.fillPath(path);
+                });
+
+                assertEquals(redAt(image, 0, 5), 0);
+                assertEquals(redAt(image, 1, 5), 255);
+            }
+        }),
+
+        new Test({
+            name: "should reject arcs with non-finite arguments",
+            test: () => {
+                const path = new Path2D();
+
+                for (const args of [[0, 0, 10, 0, Infinity], [0, 0, 10, NaN, 1], [Infinity, 0, 10, 0, 1], [0, 0, Infinity, 0, 1]]) {
+                    let error = null;
+
+                    try {
+                        path.arc(...args);
+                    } catch (e) {
+                        error = e;
+                    }
+
+                    assert(error instanceof RangeError);
+                }
+            }
+        }),
+
+        new Test({
+            name: "should copy segments into new paths",
+            test: () => {
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                const image = capture((context) => {
+                    const source = new Path2D();
+                    source.rect(0, 0, 10, 10);
+
+                    const copy = new Path2D(source);
+                    copy.rect(50, 50, 10, 10);
+
+                    context.setColor(255, 0, 0);
+                    context.fillPath(copy);
+                });
+
+                assertEquals(redAt(image, 5, 5), 255);
+                assertEquals(redAt(image, 55, 55), 255);
+            }
+        })
+    ]
+}).run(true);
\ No newline at end of file
@@ -0,0 +1,88 @@
+import { Performance, PerformanceObserver } from "../../mosaic/diagnostics";
+import { assert, assertEquals, until } from "../../lib/test";
+import Test from "../../lib/test/Test.js";
+import TestSet from "../../lib/test/TestSet.js";
+
+function block(milliseconds) {
+    const start = Performance.now();
+    while (Performance.now() - start < milliseconds);
+}
+
+await new TestSet({
+    tests: [
+        new Test({
+            name: "should report a monotonic clock",
+            test: () => {
+                const first = Performance.now();
+                block(2);
+                assert(Performance.now() > first);
+            }
+        }),
+
+        new Test({
+            name: "should report long timer callbacks with their source",
+            test: async () => {
+                let entries = [];
+
+                const observer = new PerformanceObserver(list => {
+                    entries = list.getEntries();
+                });
+
+                observer.observe({ entryTypes: ["longtask"] });
+
+                await until(done => {
+                    setTimeout(() => {
+                        block(Performance.longTaskThreshold + 10);
+                        done();
+                    }, 0);
+                });
+
+                // Entries are delivered from an idle callback after the task
+                await until(done => setTimeout(done, 50));
+
+                observer.disconnect();
+
+                assertEquals(entries.length, 1);
+                assertEquals(entries[0].entryType, "longtask");
+                assertEquals(entries[0].name, "timeout");
+                assert(entries[0].source.includes("performance/index.js"));
+            }
+        }),
+
+        new Test({
+            name: "should not notify observers after disconnect()",
+            test: async () => {
+                let calls = 0;
+
+                const observer = new PerformanceObserver(() => {
+                    calls++;
+                });
+
+                observer.observe({ entryTypes: ["longtask"] });
+
+                await until(done => {
+                    setTimeout(() => {
+                        block(Performance.longTaskThreshold + 10);
+
+                        // Timers go before the idle delivery, the entry is queued but not delivered yet
+                        setTimeout(() => {
+                            observer.disconnect();
+                            done();
+                        }, 0);
+                    }, 0);
+                });
+
+                await until(done => setTimeout(done, 50));
+                assertEquals(calls, 0);
+            }
+        }),
+
+        new Test({
+            name: "should expose event loop lag",
+            test: () => {
+                const lag = Performance.eventLoopLag;
+                assert(lag.max >= lag.current);
+            }
+        })
+    ]
+}).run(true);
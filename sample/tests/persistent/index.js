@@ -0,0 +1,117 @@
+import { Window, DrawingArea, Headless } from "../../mosaic/presentation";
+import { assert, assertEquals, skip } from "../../lib/test";
+import Test from "../../lib/test/Test.js";
+import TestSet from "../../lib/test/TestSet.js";
+
+// Red channel of a captured pixel, captures use cairo's B, G, R, A order
+function red(image, x, y) {
+    return image.data[y * image.stride + x * 4 + 2];
+}
+
+// A persistent area filling its clip with a red level that can change between frames
+function setup() {
+    const window = new Window("Persistent", 100, 80);
+    const area = new DrawingArea();
+    const state = { level: 100, clips: [] };
+
+    area.persistent = true;
+    area.onDraw = (context, clip) => {
+        state.clips.push(clip);
+        context.setColor(state.level, 0, 0);
+        context.rect(clip.x, clip.y, clip.width, clip.height);
+        context.fill();
+    };
+
+    window.addChild(area);
+    window.show();
+    Headless.step(1);
+
+    return { window, area, state };
+}
+
+await new TestSet({
+    tests: [
+        new Test({
+            name: "should only keep a buffer when asked to",
+            test: () => {
+                assertEquals(new DrawingArea().persistent, false);
+            }
+        }),
+
+        new Test({
+            name: "should keep pixels outside of the invalidated rectangle",
+            test: () => {
+                if (!Headless.enabled) {
+                    skip("needs headless mode");
+                }
+
+                const { window, area, state } = setup();
+
+                assertEquals(state.clips.length, 1);
+                assertEquals(state.clips[0].preserved, false);
+
+                state.level = 200;
+                area.invalidateRect(0, 0, 10, 10);
+                Headless.step(1);
+
+                const clip = state.clips[1];
+                assertEquals(clip.preserved, true);
+                assertEquals(clip.width, 10);
+                assertEquals(clip.height, 10);
+
+                const image = window.capture();
+                assertEquals(red(image, 5, 5), 200);
+                assertEquals(red(image, 50, 50), 100);
+
+                window.close();
+            }
+        }),
+
+        new Test({
+            name: "should start over from transparent pixels after clearBuffer()",
+            test: () => {
+                if (!Headless.enabled) {
+                    skip("needs headless mode");
+                }
+
+                const { window, area, state } = setup();
+
+                area.clearBuffer();
+                Headless.step(1);
+
+                const clip = state.clips[1];
+                assertEquals(clip.preserved, false);
+                assertEquals(clip.width, 100);
+                assertEquals(clip.height, 80);
+
+                window.close();
+            }
+        }),
+
+        new Test({
+            name: "should not report pixels a resize added as preserved",
+            test: () => {
+                if (!Headless.enabled) {
+                    skip("needs headless mode");
+                }
+
+                const { window, state } = setup();
+
+                window.width = 150;
+                Headless.step(1);
+
+                const grown = state.clips[state.clips.length - 1];
+                assertEquals(grown.preserved, false);
+                assert(grown.x + grown.width >= 150);
+
+                window.width = 60;
+                Headless.step(1);
+
+                const shrunk = state.clips[state.clips.length - 1];
+                assertEquals(shrunk.preserved, true);
+
+                window.close();
+            }
+        })
+    ]
+}).run(true);
\ No newline at end of file
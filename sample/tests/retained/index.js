@@ -0,0 +1,141 @@
+import { Window, DrawingArea, Headless } from "../../mosaic/presentation";
+import { assert, assertEquals, skip } from "../../lib/test";
+import Test from "../../lib/test/Test.js";
+import TestSet from "../../lib/test/TestSet.js";
+
+// Red channel of a captured pixel, captures use cairo's B, G, R, A order
+function red(image, x, y) {
+    return image.data[y * image.stride + x * 4 + 2];
+}
+
+// An area painting itself with a red level that can change between frames
+function setup(retained) {
+    const window = new Window("Retained", 200, 150);
+    const area = new DrawingArea();
+    const state = { level: 100, calls: 0, clip: null };
+
+    area.retained = retained;
+    area.onDraw = (context, clip) => {
+        state.calls++;
+        state.clip = clip;
+        context.setColor(state.level, 0, 0);
+        context.rect(0, 0, 200, 150);
+        context.fill();
+    };
+
+    window.addChild(area);
+    window.show();
+
+    return { window, area, state };
+}
+
+await new TestSet({
+    tests: [
+        new Test({
+            name: "should only retain when asked to",
+            test: () => {
+                assertEquals(new DrawingArea().retained, false);
+            }
+        }),
+
+        new Test({
+            name: "should call onDraw for every frame when not retained",
+            test: () => {
+                if (!Headless.enabled) {
+                    skip("needs headless mode");
+                }
+
+                const { window, state } = setup(false);
+
+                window.capture();
+                Headless.step(1);
+                assertEquals(state.calls, 2);
+
+                window.close();
+            }
+        }),
+
+        new Test({
+            name: "should replay the display list until invalidated",
+            test: () => {
+                if (!Headless.enabled) {
+                    skip("needs headless mode");
+                }
+
+                const { window, area, state } = setup(true);
+
+                window.capture();
+                Headless.step(1);
+                assertEquals(state.calls, 1);
+
+                state.level = 200;
+                area.invalidate();
+                Headless.step(1);
+                assertEquals(state.calls, 2);
+                assertEquals(red(window.capture(), 100, 100), 200);
+
+                window.close();
+            }
+        }),
+
+        new Test({
+            name: "should record again when onDraw invalidates",
+            test: () => {
+                if (!Headless.enabled) {
+                    skip("needs headless mode");
+                }
+
+                const { window, area, state } = setup(true);
+                const draw = area.onDraw;
+
+                // Only the first recording asks for another one
+                area.onDraw = (context, clip) => {
+                    draw(context, clip);
+
+                    if (state.calls === 1) {
+                        state.level = 200;
+                        area.invalidate();
+                    }
+                };
+
+                Headless.step(1);
+                assertEquals(state.calls, 1);
+
+                Headless.step(1);
+                assertEquals(state.calls, 2);
+                assertEquals(red(window.capture(), 100, 100), 200);
+
+                Headless.step(1);
+                assertEquals(state.calls, 2);
+
+                window.close();
+            }
+        }),
+
+        new Test({
+            name: "should only repaint the damaged area",
+            test: () => {
+                if (!Headless.enabled) {
+                    skip("needs headless mode");
+                }
+
+                const { window, area, state } = setup(true);
+
+                window.capture();
+                state.level = 200;
+                area.invalidateRect(0, 0, 20, 10);
+                Headless.step(1);
+
+                assertEquals(state.calls, 2);
+                assertEquals(state.clip.width, 20);
+                assertEquals(state.clip.height, 10);
+
+                const image = window.capture();
+                assertEquals(red(image, 5, 5), 200);
+                assertEquals(red(image, 100, 100), 100);
+
+                window.close();
+            }
+        })
+    ]
+}).run(true);
\ No newline at end of file
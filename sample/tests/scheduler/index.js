@@ -0,0 +1,78 @@
+import { Scheduler } from "../../mosaic/presentation";
+import { assert, assertEquals } from "../../lib/test";
+import Test from "../../lib/test/Test.js";
+import TestSet from "../../lib/test/TestSet.js";
+
+await new TestSet({
+    tests: [
+        new Test({
+            name: "should run tasks by priority",
+            test: async () => {
+                const order = [];
+
+                await Promise.all([
+                    Scheduler.postTask(() => order.push("background"), { priority: "background" }),
+                    Scheduler.postTask(() => order.push("user-visible")),
+                    Scheduler.postTask(() => order.push("user-blocking"), { priority: "user-blocking" })
+                ]);
+
+                assertEquals(order.join(), "user-blocking,user-visible,background");
+            }
+        }),
+
+        new Test({
+            name: "should settle with the task's result",
+            test: async () => {
+                assertEquals(await Scheduler.postTask(() => 42), 42);
+
+                let reason;
+
+                try {
+                    await Scheduler.postTask(() => { throw new Error("failed"); });
+                } catch (error) {
+                    reason = error.message;
+                }
+
+                assertEquals(reason, "failed");
+            }
+        }),
+
+        new Test({
+            name: "should reject unknown priorities",
+            test: () => {
+                let thrown = false;
+
+                try {
+                    Scheduler.postTask(() => {}, { priority: "urgent" });
+                } catch (error) {
+                    thrown = error instanceof TypeError;
+                }
+
+                assert(thrown);
+            }
+        }),
+
+        new Test({
+            name: "should reject non-finite delays",
+            test: () => {
+                let thrown = false;
+
+                try {
+                    Scheduler.postTask(() => {}, { delay: Infinity });
+                } catch (error) {
+                    thrown = error instanceof RangeError;
+                }
+
+                assert(thrown);
+            }
+        }),
+
+        new Test({
+            name: "should only ask tasks to yield",
+            test: async () => {
+                assertEquals(Scheduler.shouldYield(), false);
+                assertEquals(await Scheduler.postTask(() => typeof Scheduler.shouldYield()), "boolean");
+            }
+        })
+    ]
+}).run(true);
\ No newline at end of file
@@ -0,0 +1,93 @@
+import { Entities } from "../../mosaic/simulation";
+import { assert, assertEquals } from "../../lib/test";
+import Test from "../../lib/test/Test.js";
+import TestSet from "../../lib/test/TestSet.js";
+
+await new TestSet({
+    tests: [
+        new Test({
+            name: "should move entities by their velocity",
+            test: () => {
+                const entities = new Entities(3);
+
+                entities.vx.set([1, -2, 0.5]);
+                entities.vy.set([0, 3, -1]);
+                entities.width.fill(10);
+                entities.height.fill(10);
+                entities.step(2);
+
+                assertEquals(Array.from(entities.x).join(), "2,-4,1");
+                assertEquals(Array.from(entities.y).join(), "0,6,-2");
+                assertEquals(Array.from(entities.rects.subarray(4, 8)).join(), "-4,6,10,10");
+            }
+        }),
+
+        new Test({
+            name: "should bounce entities off the bounds",
+            test: () => {
+                const entities = new Entities(2);
+
+                entities.x.set([95, 3]);
+                entities.vx.set([4, -5]);
+                entities.width.fill(10);
+                entities.height.fill(10);
+                entities.step(1, 0, 0, 100, 100);
+
+                // Mirrored back inside, velocities pointing in again
+                assertEquals(Array.from(entities.x).join(), "81,2");
+                assertEquals(Array.from(entities.vx).join(), "-4,5");
+            }
+        }),
+
+        new Test({
+            name: "should agree with a JS loop",
+            test: () => {
+                // Not a multiple of any vector width, so scalar tails run too
+                const count = 1027;
+                const entities = new Entities(count);
+                const x = new Float32Array(count);
+                const vx = new Float32Array(count);
+
+                for (let i = 0; i < count; i++) {
+                    x[i] = entities.x[i] = (i * 37) % 500;
+                    vx[i] = entities.vx[i] = (i % 23) - 11;
+                    entities.width[i] = 5 + i % 20;
+                }
+
+                for (let frame = 0; frame < 100; frame++) {
+                    entities.step(1, 0, 0, 500, 500);
+
+                    for (let i = 0; i < count; i++) {
+                        const last = 500 - entities.width[i];
+                        x[i] = Math.fround(x[i] + vx[i]);
+
+                        if (x[i] < 0) {
+                            x[i] = -x[i];
+                            vx[i] = Math.abs(vx[i]);
+                        }
+
+                        if (x[i] > last) {
+                            x[i] = Math.fround(last - Math.fround(x[i] - last));
+                            vx[i] = -Math.abs(vx[i]);
+                        }
+                    }
+                }
+
+                assertEquals(Array.from(entities.x).join(), Array.from(x).join());
+                assertEquals(Array.from(entities.vx).join(), Array.from(vx).join());
+            }
+        }),
+
+        new Test({
+            name: "should keep views over the same memory",
+            test: () => {
+                const entities = new Entities(4);
+
+                assert(entities.x === entities.x);
+                assertEquals(entities.count, 4);
+                assertEquals(entities.rects.length, 16);
+                assertEquals(entities.colors.constructor, Uint32Array);
+            }
+        })
+    ]
+}).run(true);
\ No newline at end of file
@@ -0,0 +1,97 @@
+import { SpatialIndex } from "../../mosaic/presentation";
+import { assert, assertEquals } from "../../lib/test";
+import Test from "../../lib/test/Test.js";
+import TestSet from "../../lib/test/TestSet.js";
+
+await new TestSet({
+    tests: [
+        new Test({
+            name: "should hit the topmost shape",
+            test: () => {
+                const index = new SpatialIndex();
+
+                index.set(1, 0, 0, 100, 100);
+                index.set(2, 50, 50, 100, 100);
+
+                assertEquals(index.hitTest(75, 75), 2);
+                assertEquals(index.hitTest(25, 25), 1);
+                assertEquals(index.hitTest(200, 200), undefined);
+            }
+        }),
+
+        new Test({
+            name: "should follow moved and deleted shapes",
+            test: () => {
+                const index = new SpatialIndex();
+
+                index.set(1, 0, 0, 10, 10);
+                index.set(1, 500, 500, 10, 10);
+                assertEquals(index.hitTest(5, 5), undefined);
+                assertEquals(index.hitTest(505, 505), 1);
+
+                assert(index.delete(1));
+                assert(!index.has(1));
+                assertEquals(index.size, 0);
+            }
+        }),
+
+        new Test({
+            name: "should agree with a linear scan",
+            test: () => {
+                const index = new SpatialIndex();
+                const count = 5000;
+                const ids = new Int32Array(count);
+                const bounds = new Float32Array(count * 4);
+
+                for (let i = 0; i < count; i++) {
+                    ids[i] = i;
+                    bounds.set([(i * 37) % 1000, (i * 91) % 1000, 5 + i % 20, 5 + i % 13], i * 4);
+                }
+
+                index.setMany(ids, bounds);
+
+                const found = Array.from(index.query(200, 200, 100, 100)).sort((a, b) => a - b);
+                const expected = [];
+
+                for (let i = 0; i < count; i++) {
+                    const [x, y, width, height] = bounds.subarray(i * 4, i * 4 + 4);
+
+                    if (x <= 300 && 200 <= x + width && y <= 300 && 200 <= y + height) {
+                        expected.push(i);
+                    }
+                }
+
+                assertEquals(found.join(), expected.join());
+            }
+        }),
+
+        new Test({
+            name: "should keep non-finite bounds out of the tree",
+            test: () => {
+                const index = new SpatialIndex();
+                let error = null;
+
+                try {
+                    index.set(1, NaN, 0, 10, 10);
+                } catch (e) {
+                    error = e;
+                }
+
+                assert(error instanceof RangeError);
+                assertEquals(index.has(1), false);
+
+                error = null;
+
+                try {
+                    index.setMany(new Int32Array([2, 3]), new Float32Array([0, 0, 10, 10, 0, Infinity, 10, 10]));
+                } catch (e) {
+                    error = e;
+                }
+
+                assert(error instanceof RangeError);
+                assertEquals(index.has(2), false);
+                assertEquals(index.has(3), false);
+            }
+        })
+    ]
+}).run(true);
\ No newline at end of file
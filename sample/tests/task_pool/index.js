@@ -0,0 +1,73 @@
+import { File } from "../../mosaic/io";
+import { Window, DrawingArea, Headless } from "../../mosaic/presentation";
+import { assert, assertEquals } from "../../lib/test";
+import Test from "../../lib/test/Test.js";
+import TestSet from "../../lib/test/TestSet.js";
+
+function capture(tiled) {
+    const window = new Window("Task pool", 600, 400);
+    const area = new DrawingArea();
+
+    area.tiled = tiled;
+    area.onDraw = context => {
+        // Crosses every tile border, so each tile has something of its own to rasterize
+        for (let i = 0; i < 40; i++) {
+            context.setColor((i * 37) % 255, (i * 91) % 255, (i * 53) % 255);
+            context.rect(i * 15, i * 10, 80, 60);
+            context.fill();
+        }
+    };
+
+    window.addChild(area);
+    window.show();
+
+    const pixels = window.capture().data;
+    window.close();
+
+    return pixels;
+}
+
+await new TestSet({
+    tests: [
+        new Test({
+            name: "should settle a burst of tasks",
+            test: async () => {
+                // Completions arrive in batches, every promise must still get its own result
+                const listings = await Promise.all(Array.from({ length: 64 }, () => File.readdir("/")));
+                const expected = listings[0].join();
+
+                assert(listings[0].length > 0);
+                assert(listings.every(listing => listing.join() === expected));
+            }
+        }),
+
+        new Test({
+            name: "should reject failed tasks",
+            test: async () => {
+                const results = await Promise.allSettled([
+                    File.readdir("/"),
+                    File.readdir("/mosaic-task-pool-missing"),
+                    File.readdir("/")
+                ]);
+
+                assertEquals(results.map(result => result.status).join(), "fulfilled,rejected,fulfilled");
+            }
+        }),
+
+        new Test({
+            name: "should rasterize tiles in parallel like a direct draw",
+            test: () => {
+                // Painting on demand needs the headless backend
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                const direct = capture(false);
+                const tiled = capture(true);
+
+                assertEquals(direct.length, tiled.length);
+                assert(direct.every((value, i) => value === tiled[i]));
+            }
+        })
+    ]
+}).run(true);
\ No newline at end of file
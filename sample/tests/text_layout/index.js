@@ -0,0 +1,77 @@
+import { Window, DrawingArea, Headless } from "../../mosaic/presentation";
+import { assert, assertEquals } from "../../lib/test";
+import Test from "../../lib/test/Test.js";
+import TestSet from "../../lib/test/TestSet.js";
+
+// Runs draw inside a single headless frame and returns what it returned
+function drawOnce(draw) {
+    const window = new Window("Text layout", 200, 100);
+    const area = new DrawingArea();
+    let result = null;
+
+    area.onDraw = (context) => {
+        result = draw(context);
+    };
+
+    window.addChild(area);
+    window.show();
+    window.capture();
+    window.close();
+
+    return result;
+}
+
+await new TestSet({
+    tests: [
+        new Test({
+            name: "should measure the same after many fonts came and went",
+            test: () => {
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                const [before, after] = drawOnce((context) => {
+                    context.font = "Sans 12";
+                    const before = context.measureText("Mosaic").width;
+
+                    // Computed sizes, far more fonts than the cache keeps
+                    for (let size = 1; size <= 300; size++) {
+                        context.font = `Sans ${size / 4}`;
+                        context.measureText("Mosaic");
+                    }
+
+                    context.font = "Sans 12";
+                    return [before, context.measureText("Mosaic").width];
+                });
+
+                assert(before > 0);
+                assertEquals(after, before);
+            }
+        }),
+
+        new Test({
+            name: "should still draw with fonts dropped from the cache",
+            test: () => {
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                const width = drawOnce((context) => {
+                    context.font = "Sans 40";
+                    context.fillText("W", 0, 0);
+
+                    for (let size = 1; size <= 300; size++) {
+                        context.font = `Serif ${size}`;
+                        context.measureText("W");
+                    }
+
+                    context.font = "Sans 40";
+                    context.fillText("W", 0, 0);
+                    return context.measureText("W").width;
+                });
+
+                assert(width > 0);
+            }
+        })
+    ]
+}).run(true);
\ No newline at end of file
@@ -0,0 +1,101 @@
+import { Window, DrawingArea, Path2D, Headless } from "../../mosaic/presentation";
+import { assert, assertEquals, skip } from "../../lib/test";
+import Test from "../../lib/test/Test.js";
+import TestSet from "../../lib/test/TestSet.js";
+
+// Larger than a 256 pixel tile both ways, so shapes cross tile borders
+function capture(tiled, draw) {
+    const window = new Window("Tiled", 600, 400);
+    const area = new DrawingArea();
+
+    area.tiled = tiled;
+    area.onDraw = draw;
+    window.addChild(area);
+    window.show();
+
+    const pixels = window.capture().data;
+    window.close();
+
+    return pixels;
+}
+
+function scene(context) {
+    const path = new Path2D();
+    path.moveTo(20, 380);
+    path.bezierCurveTo(200, 0, 400, 400, 580, 20);
+    path.arc(300, 200, 120, 0, Math.PI * 1.5);
+    path.closePath();
+
+    context.setColor(30, 120, 200);
+    context.fillPath(path);
+    context.setColor(200, 30, 30, 0.8);
+    context.strokePath(path, 6);
+
+    const coords = new Float32Array(4 * 50);
+
+    for (let i = 0; i < 50; i++) {
+        coords.set([i * 12, 240 + (i % 5) * 20, 30, 30], i * 4);
+    }
+
+    context.fillRects(coords, new Uint32Array([0x40c040ff]));
+}
+
+// Calls a method from onDraw of a tiled area and returns what it threw, if anything
+function tiledError(call) {
+    let error = null;
+
+    capture(true, context => {
+        try {
+            call(context);
+        } catch (e) {
+            error = e;
+        }
+    });
+
+    return error;
+}
+
+await new TestSet({
+    tests: [
+        new Test({
+            name: "should only tile when asked to",
+            test: () => {
+                const area = new DrawingArea();
+                assertEquals(area.tiled, false);
+
+                area.tiled = true;
+                assertEquals(area.tiled, true);
+            }
+        }),
+
+        new Test({
+            name: "should record paths and batches like a direct draw",
+            test: () => {
+                if (!Headless.enabled) {
+                    skip("needs headless mode");
+                }
+
+                const direct = capture(false, scene);
+                const tiled = capture(true, scene);
+
+                assertEquals(direct.length, tiled.length);
+                assert(direct.every((value, i) => value === tiled[i]));
+            }
+        }),
+
+        new Test({
+            name: "should reject what it can't record",
+            test: () => {
+                if (!Headless.enabled) {
+                    skip("needs headless mode");
+                }
+
+                const layer = new DrawingArea().createLayer(16, 16);
+
+                assert(tiledError(context => context.fillText("text", 10, 10)) instanceof TypeError);
+                assert(tiledError(context => context.getImageData(0, 0, 10, 10)) instanceof TypeError);
+                assert(tiledError(context => context.drawLayer(layer, 0, 0)) instanceof TypeError);
+            }
+        })
+    ]
+}).run(true);
\ No newline at end of file
@@ -0,0 +1,83 @@
+import { Window, DrawingArea, Path2D, Headless } from "../../mosaic/presentation";
+import { assert } from "../../lib/test";
+import Test from "../../lib/test/Test.js";
+import TestSet from "../../lib/test/TestSet.js";
+
+// Renders one frame with draw as onDraw and returns the context it was given
+function keepContext(draw) {
+    const window = new Window("Unbound context", 50, 50);
+    const area = new DrawingArea();
+    let kept = null;
+
+    area.onDraw = (context, clip) => {
+        kept = context;
+        draw(context, clip);
+    };
+
+    window.addChild(area);
+    window.show();
+    window.capture();
+    window.close();
+
+    return kept;
+}
+
+// Calls fn and returns what it threw, if anything
+function thrown(fn) {
+    try {
+        fn();
+    } catch (e) {
+        return e;
+    }
+
+    return null;
+}
+
+// Every kind of argument, valid or not, must hit the same binding check first
+function assertUnbound(context) {
+    const calls = [
+        () => context.fillPath(new Path2D()),
+        () => context.fillPath({}),
+        () => context.strokePath(new Path2D(), 2),
+        () => context.strokePath(),
+        () => context.rect(0, 0, 10, 10),
+        () => context.fill()
+    ];
+
+    for (const call of calls) {
+        const error = thrown(call);
+        assert(error instanceof TypeError);
+        assert(error.message.includes("draw callback"));
+    }
+}
+
+await new TestSet({
+    tests: [
+        new Test({
+            name: "should refuse contexts kept past onDraw",
+            test: () => {
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                assertUnbound(keepContext(() => {}));
+            }
+        }),
+
+        new Test({
+            name: "should refuse contexts from an onDraw that threw",
+            test: () => {
+                if (!Headless.enabled) {
+                    return;
+                }
+
+                const context = keepContext(() => {
+                    throw new Error("Thrown on purpose from onDraw");
+                });
+
+                assert(context !== null);
+                assertUnbound(context);
+            }
+        })
+    ]
+}).run(true);
\ No newline at end of file
@@ -0,0 +1,313 @@
+#include <functional>
+#include <v8.h>
+#include <piston_native_class.h>
+#include <piston_native_module.h>
+#include <built-ins/diagnostics/performance.h>
+
+using namespace v8;
+using namespace std;
+using namespace mosaic::runtime;
+
+namespace mosaic::diagnostics {
+	Local<Function> Performance::Make(Local<Context> context) {
+		Isolate * isolate = context->GetIsolate();
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<FunctionTemplate> class_tpl = FunctionTemplate::New(isolate, ConstructorCallback);
+		class_tpl->SetClassName(String::NewFromUtf8(isolate, "Performance").ToLocalChecked());
+
+		Local<FunctionTemplate> now_tpl = FunctionTemplate::New(isolate, NowCallback);
+		Local<FunctionTemplate> get_entries_tpl = FunctionTemplate::New(isolate, GetEntriesCallback);
+
+		class_tpl->Set(String::NewFromUtf8(isolate, "now").ToLocalChecked(), now_tpl);
+		class_tpl->Set(String::NewFromUtf8(isolate, "getEntries").ToLocalChecked(), get_entries_tpl);
+		class_tpl->SetNativeDataProperty(String::NewFromUtf8(isolate, "eventLoopLag").ToLocalChecked(), GetEventLoopLagCallback);
+		class_tpl->SetNativeDataProperty(String::NewFromUtf8(isolate, "longTaskThreshold").ToLocalChecked(), GetLongTaskThresholdCallback, SetLongTaskThresholdCallback);
+
+		return handle_scope.Escape(class_tpl->GetFunction(context).ToLocalChecked());
+	}
+
+	Local<Object> Performance::EntryToObject(Local<Context> context, const PerformanceMonitor::Entry& entry) {
+		Isolate* isolate = context->GetIsolate();
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<Object> result = Object::New(isolate);
+		result->Set(context, String::NewFromUtf8(isolate, "entryType").ToLocalChecked(), String::NewFromUtf8(isolate, entry.type.c_str()).ToLocalChecked());
+		result->Set(context, String::NewFromUtf8(isolate, "name").ToLocalChecked(), String::NewFromUtf8(isolate, entry.name.c_str()).ToLocalChecked());
+		result->Set(context, String::NewFromUtf8(isolate, "startTime").ToLocalChecked(), Number::New(isolate, entry.start_time));
+		result->Set(context, String::NewFromUtf8(isolate, "duration").ToLocalChecked(), Number::New(isolate, entry.duration));
+		result->Set(context, String::NewFromUtf8(isolate, "source").ToLocalChecked(), String::NewFromUtf8(isolate, entry.source.c_str()).ToLocalChecked());
+
+		return handle_scope.Escape(result);
+	}
+
+	void Performance::ConstructorCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		isolate->ThrowException(Exception::TypeError(
+			String::NewFromUtf8(isolate, "Unable to instantiate static class.").ToLocalChecked()
+		));
+	}
+
+	void Performance::NowCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		args.GetReturnValue().Set(Number::New(isolate, PerformanceMonitor::GetInstance()->Now()));
+	}
+
+	void Performance::GetEntriesCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+
+		// Optionally filter by entry type, like getEntriesByType()
+		string type;
+
+		if (args.Length() > 0 && args[0]->IsString()) {
+			String::Utf8Value type_str(isolate, args[0]);
+			type = *type_str;
+		}
+
+		Local<Array> result = Array::New(isolate);
+		uint32_t index = 0;
+
+		for (const PerformanceMonitor::Entry& entry : PerformanceMonitor::GetInstance()->GetEntries()) {
+			if (type.empty() || entry.type == type) {
+				result->Set(context, index++, EntryToObject(context, entry));
+			}
+		}
+
+		args.GetReturnValue().Set(result);
+	}
+
+	void Performance::GetEventLoopLagCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Isolate* isolate = info.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+
+		PerformanceMonitor* monitor = PerformanceMonitor::GetInstance();
+		monitor->EnableLagSampling();
+
+		Local<Object> result = Object::New(isolate);
+		result->Set(context, String::NewFromUtf8(isolate, "current").ToLocalChecked(), Number::New(isolate, monitor->GetCurrentLag()));
+		result->Set(context, String::NewFromUtf8(isolate, "max").ToLocalChecked(), Number::New(isolate, monitor->GetMaxLag()));
+		result->Set(context, String::NewFromUtf8(isolate, "mean").ToLocalChecked(), Number::New(isolate, monitor->GetMeanLag()));
+
+		info.GetReturnValue().Set(result);
+	}
+
+	void Performance::GetLongTaskThresholdCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Isolate* isolate = info.GetIsolate();
+		info.GetReturnValue().Set(Number::New(isolate, PerformanceMonitor::GetInstance()->GetLongTaskThreshold()));
+	}
+
+	void Performance::SetLongTaskThresholdCallback(Local<String> property, Local<Value> value, const PropertyCallbackInfo<void>& info) {
+		Isolate* isolate = info.GetIsolate();
+
+		// Zero reports every task, NaN would report none
+		if (!value->IsNumber() || !(value.As<Number>()->Value() >= 0)) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to set property: longTaskThreshold must be a non-negative number.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		PerformanceMonitor::GetInstance()->SetLongTaskThreshold(value.As<Number>()->Value());
+	}
+
+	PerformanceObserver::PerformanceObserver(Isolate* isolate, Local<Function> callback) {
+		this->callback_.Reset(isolate, callback);
+		this->listener_id_ = 0;
+	}
+
+	PerformanceObserver::~PerformanceObserver() {
+		// Only disconnected observers are collected, but never leave a listener behind
+		if (this->listener_id_ != 0) {
+			PerformanceMonitor::GetInstance()->RemoveListener(this->listener_id_);
+		}
+
+		this->callback_.Reset();
+	}
+
+	void PerformanceObserver::Observe(set<string> entry_types) {
+		this->entry_types_ = entry_types;
+
+		if (entry_types.count("lag") > 0) {
+			PerformanceMonitor::GetInstance()->EnableLagSampling();
+		}
+
+		if (this->listener_id_ == 0) {
+			this->listener_id_ = PerformanceMonitor::GetInstance()->AddListener([this](const vector<PerformanceMonitor::Entry>& entries) {
+				this->Notify(entries);
+			});
+
+			// The monitor calls back into this object, observing keeps it alive like in browsers
+			this->ClearWeak();
+		}
+	}
+
+	void PerformanceObserver::Disconnect() {
+		if (this->listener_id_ != 0) {
+			PerformanceMonitor::GetInstance()->RemoveListener(this->listener_id_);
+			this->listener_id_ = 0;
+			this->MakeWeak();
+		}
+	}
+
+	void PerformanceObserver::Notify(const vector<PerformanceMonitor::Entry>& entries) {
+		Isolate* isolate = Isolate::GetCurrent();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+
+		Local<Array> observed = Array::New(isolate);
+		uint32_t index = 0;
+
+		for (const PerformanceMonitor::Entry& entry : entries) {
+			if (this->entry_types_.count(entry.type) > 0) {
+				observed->Set(context, index++, Performance::EntryToObject(context, entry));
+			}
+		}
+
+		if (index == 0) {
+			return;
+		}
+
+		// Mirrors PerformanceObserverEntryList, entries are only reachable through getEntries()
+		Local<Object> list = Object::New(isolate);
+		list->Set(context, String::NewFromUtf8(isolate, "getEntries").ToLocalChecked(), Function::New(context, ListGetEntriesCallback, observed).ToLocalChecked());
+
+		Local<Value> args[2];
+		args[0] = list;
+		args[1] = this->GetLocalHandle(isolate);
+
+		Local<Function> callback = Local<Function>::New(isolate, this->callback_);
+		callback->Call(context, context->Global(), 2, args);
+	}
+
+	Local<Function> PerformanceObserver::Make(Local<Context> context) {
+		Isolate * isolate = context->GetIsolate();
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<FunctionTemplate> class_tpl = FunctionTemplate::New(isolate, ConstructorCallback);
+		class_tpl->SetClassName(String::NewFromUtf8(isolate, "PerformanceObserver").ToLocalChecked());
+		class_tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+		Local<FunctionTemplate> observe_tpl = FunctionTemplate::New(isolate, ObserveCallback);
+		Local<FunctionTemplate> disconnect_tpl = FunctionTemplate::New(isolate, DisconnectCallback);
+
+		Local<ObjectTemplate> proto_tpl = class_tpl->PrototypeTemplate();
+		proto_tpl->Set(String::NewFromUtf8(isolate, "observe").ToLocalChecked(), observe_tpl);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "disconnect").ToLocalChecked(), disconnect_tpl);
+
+		return handle_scope.Escape(class_tpl->GetFunction(context).ToLocalChecked());
+	}
+
+	void PerformanceObserver::ConstructorCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+
+		if (args.Length() < 1 || !args[0]->IsFunction()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to create instance: callback must be a function.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		if (args.IsConstructCall()) {
+			PerformanceObserver* instance = new PerformanceObserver(isolate, Local<Function>::Cast(args[0]));
+			instance->Wrap(args.This());
+			instance->MakeWeak();
+
+			args.GetReturnValue().Set(args.This());
+		}
+	}
+
+	void PerformanceObserver::ObserveCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+		PerformanceObserver* self = NativeClass::Unwrap(args.This());
+
+		set<string> entry_types;
+
+		// Accept both { entryTypes: [...] } and { type: "..." }
+		if (args.Length() > 0 && args[0]->IsObject()) {
+			Local<Object> options = Local<Object>::Cast(args[0]);
+			Local<Value> types = options->Get(context, String::NewFromUtf8(isolate, "entryTypes").ToLocalChecked()).ToLocalChecked();
+			Local<Value> type = options->Get(context, String::NewFromUtf8(isolate, "type").ToLocalChecked()).ToLocalChecked();
+
+			if (types->IsArray()) {
+				Local<Array> types_array = Local<Array>::Cast(types);
+
+				for (uint32_t i = 0; i < types_array->Length(); i++) {
+					String::Utf8Value value(isolate, types_array->Get(context, i).ToLocalChecked());
+					entry_types.insert(*value);
+				}
+			} else if (type->IsString()) {
+				String::Utf8Value value(isolate, type);
+				entry_types.insert(*value);
+			}
+		}
+
+		if (entry_types.empty()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: entryTypes or type must be specified.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		self->Observe(entry_types);
+	}
+
+	void PerformanceObserver::DisconnectCallback(const FunctionCallbackInfo<Value> &args) {
+		PerformanceObserver* self = NativeClass::Unwrap(args.This());
+		self->Disconnect();
+	}
+
+	void PerformanceObserver::ListGetEntriesCallback(const FunctionCallbackInfo<Value> &args) {
+		args.GetReturnValue().Set(args.Data());
+	}
+
+	Local<Module> PerformanceModule::Make(Isolate* isolate) {
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<Module> module = Module::CreateSyntheticModule(
+			isolate,
+			String::NewFromUtf8(isolate, "Performance").ToLocalChecked(),
+			{
+				String::NewFromUtf8(isolate, "default").ToLocalChecked(),
+				String::NewFromUtf8(isolate, "Performance").ToLocalChecked(),
+				String::NewFromUtf8(isolate, "PerformanceObserver").ToLocalChecked()
+			},
+			[](Local<Context> context, Local<Module> module) -> MaybeLocal<Value> {
+				Isolate* isolate = context->GetIsolate();
+				HandleScope handle_scope(isolate);
+
+				Local<Function> constructor = Performance::GetConstructor(context);
+
+				module->SetSyntheticModuleExport(
+					isolate,
+					String::NewFromUtf8(isolate, "default").ToLocalChecked(),
+					constructor
+				);
+
+				module->SetSyntheticModuleExport(
+					isolate,
+					String::NewFromUtf8(isolate, "Performance").ToLocalChecked(),
+					constructor
+				);
+
+				module->SetSyntheticModuleExport(
+					isolate,
+					String::NewFromUtf8(isolate, "PerformanceObserver").ToLocalChecked(),
+					PerformanceObserver::GetConstructor(context)
+				);
+
+				return MaybeLocal<Value>(True(isolate));
+			}
+		);
+
+		return handle_scope.Escape(module);
+	}
+}
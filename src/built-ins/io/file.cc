@@ -0,0 +1,811 @@
+#include <functional>
+#include <v8.h>
+#include <gtk-3.0/gtk/gtk.h>
+#include <piston_native_class.h>
+#include <piston_native_module.h>
+#include <built-ins/io/file.h>
+#include <built-ins/io/stream.h>
+#include <runtime/io_ring.h>
+#include <runtime/pending_promise.h>
+#include <runtime/task_pool.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "loader.h"
+
+using namespace v8;
+using namespace mosaic::runtime;
+
+namespace mosaic::io {
+	// Largest request handed to a single read or write
+	static const size_t max_transfer_size = 1 << 30;
+
+	struct ReadOperation {
+		string path;
+		int fd = -1;
+		struct statx stat;
+		char* data = nullptr;
+		size_t length = 0;
+		size_t offset = 0;
+		int error = 0;
+		File::ReadDone done;
+	};
+
+	struct WriteOperation {
+		string path;
+		int fd = -1;
+		shared_ptr<BackingStore> store;
+		const char* data;
+		size_t length;
+		size_t offset = 0;
+		int error = 0;
+		File::WriteDone done;
+	};
+
+	struct StatOperation {
+		string path;
+		struct statx stat;
+		File::StatDone done;
+	};
+
+	static void free_backing_store(void* data, size_t length, void* deleter_data) {
+		free(data);
+	}
+
+	static string describe_error(const char* action, const string& path, int error) {
+		return string("Failed to ") + action + " '" + path + "': " + strerror(error);
+	}
+
+	/* Blocking implementations used by the thread pool fallback */
+
+	static int read_blocking(const string& path, char** out_data, size_t* out_length) {
+		int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+		if (fd < 0) {
+			return errno;
+		}
+
+		struct stat st;
+		fstat(fd, &st);
+
+		// Pipes and pseudo files report no size, so grow the buffer as we go
+		size_t capacity = S_ISREG(st.st_mode) && st.st_size > 0 ? st.st_size : 64 * 1024;
+		size_t length = 0;
+		char* data = (char*)malloc(capacity);
+
+		if (data == NULL) {
+			close(fd);
+			return ENOMEM;
+		}
+
+		while (true) {
+			if (length == capacity) {
+				// The old buffer is still ours when growing it fails
+				char* grown = (char*)realloc(data, capacity * 2);
+
+				if (grown == NULL) {
+					free(data);
+					close(fd);
+					return ENOMEM;
+				}
+
+				capacity *= 2;
+				data = grown;
+			}
+
+			ssize_t count = read(fd, data + length, min(capacity - length, max_transfer_size));
+
+			if (count < 0) {
+				if (errno == EINTR) continue;
+
+				int error = errno;
+				free(data);
+				close(fd);
+				return error;
+			}
+
+			if (count == 0) {
+				break;
+			}
+
+			length += count;
+		}
+
+		close(fd);
+		*out_data = data;
+		*out_length = length;
+		return 0;
+	}
+
+	static int write_blocking(const string& path, const char* data, size_t length, size_t* out_written) {
+		int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+		if (fd < 0) {
+			return errno;
+		}
+
+		size_t offset = 0;
+
+		while (offset < length) {
+			ssize_t count = write(fd, data + offset, min(length - offset, max_transfer_size));
+
+			if (count < 0) {
+				if (errno == EINTR) continue;
+
+				int error = errno;
+				close(fd);
+				return error;
+			}
+
+			offset += count;
+		}
+
+		close(fd);
+		*out_written = offset;
+		return 0;
+	}
+
+	/* io_uring implementations, chained through completions on the main thread */
+
+	static void ring_read_next(shared_ptr<ReadOperation> op) {
+		IoRing::GetInstance()->Submit([op](io_uring_sqe* sqe) {
+			sqe->opcode = IORING_OP_READ;
+			sqe->fd = op->fd;
+			sqe->addr = (uint64_t)(op->data + op->offset);
+			sqe->len = min(op->length - op->offset, max_transfer_size);
+			sqe->off = op->offset;
+		}, [op](int result) {
+			if (result < 0) {
+				File::Close(op->fd);
+				free(op->data);
+				op->done(-result, nullptr, 0);
+				return;
+			}
+
+			op->offset += result;
+
+			// A zero read means the file shrank while we were reading it
+			if (result > 0 && op->offset < op->length) {
+				ring_read_next(op);
+				return;
+			}
+
+			File::Close(op->fd);
+			op->done(0, op->data, op->offset);
+		});
+	}
+
+	static void ring_read(shared_ptr<ReadOperation> op) {
+		IoRing* ring = IoRing::GetInstance();
+
+		ring->Submit([op](io_uring_sqe* sqe) {
+			sqe->opcode = IORING_OP_OPENAT;
+			sqe->fd = AT_FDCWD;
+			sqe->addr = (uint64_t)op->path.c_str();
+			sqe->open_flags = O_RDONLY | O_CLOEXEC;
+		}, [op, ring](int result) {
+			if (result < 0) {
+				op->done(-result, nullptr, 0);
+				return;
+			}
+
+			op->fd = result;
+
+			ring->Submit([op](io_uring_sqe* sqe) {
+				sqe->opcode = IORING_OP_STATX;
+				sqe->fd = op->fd;
+				sqe->addr = (uint64_t)"";
+				sqe->len = STATX_TYPE | STATX_SIZE;
+				sqe->off = (uint64_t)&op->stat;
+				sqe->statx_flags = AT_EMPTY_PATH;
+			}, [op](int result) {
+				if (result < 0) {
+					File::Close(op->fd);
+					op->done(-result, nullptr, 0);
+					return;
+				}
+
+				// Without a known size, let a worker read until end of file
+				if (!S_ISREG(op->stat.stx_mode) || op->stat.stx_size == 0) {
+					File::Close(op->fd);
+
+					TaskPool::GetInstance()->Post([op]() {
+						op->error = read_blocking(op->path, &op->data, &op->length);
+					}, [op]() {
+						op->done(op->error, op->data, op->length);
+					});
+
+					return;
+				}
+
+				// The file lands straight in the memory later owned by the ArrayBuffer
+				op->length = op->stat.stx_size;
+				op->data = (char*)malloc(op->length);
+
+				if (op->data == NULL) {
+					File::Close(op->fd);
+					op->done(ENOMEM, nullptr, 0);
+					return;
+				}
+
+				ring_read_next(op);
+			});
+		});
+	}
+
+	static void ring_write_next(shared_ptr<WriteOperation> op) {
+		IoRing::GetInstance()->Submit([op](io_uring_sqe* sqe) {
+			sqe->opcode = IORING_OP_WRITE;
+			sqe->fd = op->fd;
+			sqe->addr = (uint64_t)(op->data + op->offset);
+			sqe->len = min(op->length - op->offset, max_transfer_size);
+			sqe->off = op->offset;
+		}, [op](int result) {
+			if (result < 0) {
+				File::Close(op->fd);
+				op->done(-result, op->offset);
+				return;
+			}
+
+			op->offset += result;
+
+			if (op->offset < op->length) {
+				ring_write_next(op);
+				return;
+			}
+
+			File::Close(op->fd);
+			op->done(0, op->offset);
+		});
+	}
+
+	static void ring_write(shared_ptr<WriteOperation> op) {
+		IoRing::GetInstance()->Submit([op](io_uring_sqe* sqe) {
+			sqe->opcode = IORING_OP_OPENAT;
+			sqe->fd = AT_FDCWD;
+			sqe->addr = (uint64_t)op->path.c_str();
+			sqe->open_flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+			sqe->len = 0644;
+		}, [op](int result) {
+			if (result < 0) {
+				op->done(-result, 0);
+				return;
+			}
+
+			op->fd = result;
+
+			if (op->length == 0) {
+				File::Close(op->fd);
+				op->done(0, 0);
+				return;
+			}
+
+			ring_write_next(op);
+		});
+	}
+
+	bool File::IsUsingIoRing() {
+		return IoRing::GetInstance() != nullptr;
+	}
+
+	void File::Read(string path, ReadDone done) {
+		auto op = make_shared<ReadOperation>();
+		op->path = path;
+		op->done = done;
+
+		if (File::IsUsingIoRing()) {
+			ring_read(op);
+			return;
+		}
+
+		TaskPool::GetInstance()->Post([op]() {
+			op->error = read_blocking(op->path, &op->data, &op->length);
+		}, [op]() {
+			op->done(op->error, op->data, op->length);
+		});
+	}
+
+	void File::Write(string path, shared_ptr<BackingStore> store, const char* data, size_t length, WriteDone done) {
+		auto op = make_shared<WriteOperation>();
+		op->path = path;
+		op->store = store;
+		op->data = data;
+		op->length = length;
+		op->done = done;
+
+		if (File::IsUsingIoRing()) {
+			ring_write(op);
+			return;
+		}
+
+		TaskPool::GetInstance()->Post([op]() {
+			op->error = write_blocking(op->path, op->data, op->length, &op->offset);
+		}, [op]() {
+			op->done(op->error, op->offset);
+		});
+	}
+
+	void File::Stat(string path, StatDone done) {
+		auto op = make_shared<StatOperation>();
+		op->path = path;
+		op->done = done;
+
+		unsigned int mask = STATX_BASIC_STATS | STATX_BTIME;
+
+		// Links are described themselves rather than what they point to, like lstat()
+		int flags = AT_SYMLINK_NOFOLLOW;
+
+		if (File::IsUsingIoRing()) {
+			IoRing::GetInstance()->Submit([op, mask, flags](io_uring_sqe* sqe) {
+				sqe->opcode = IORING_OP_STATX;
+				sqe->fd = AT_FDCWD;
+				sqe->addr = (uint64_t)op->path.c_str();
+				sqe->len = mask;
+				sqe->off = (uint64_t)&op->stat;
+				sqe->statx_flags = flags;
+			}, [op](int result) {
+				op->done(result < 0 ? -result : 0, op->stat);
+			});
+
+			return;
+		}
+
+		auto error = make_shared<int>(0);
+
+		TaskPool::GetInstance()->Post([op, mask, flags, error]() {
+			*error = statx(AT_FDCWD, op->path.c_str(), flags, mask, &op->stat) < 0 ? errno : 0;
+		}, [op, error]() {
+			op->done(*error, op->stat);
+		});
+	}
+
+	void File::Open(string path, int flags, OpenDone done) {
+		auto shared_path = make_shared<string>(path);
+
+		if (File::IsUsingIoRing()) {
+			IoRing::GetInstance()->Submit([shared_path, flags](io_uring_sqe* sqe) {
+				sqe->opcode = IORING_OP_OPENAT;
+				sqe->fd = AT_FDCWD;
+				sqe->addr = (uint64_t)shared_path->c_str();
+				sqe->open_flags = flags | O_CLOEXEC;
+				sqe->len = 0644;
+			}, [shared_path, done](int result) {
+				done(result < 0 ? -result : 0, result);
+			});
+
+			return;
+		}
+
+		auto result = make_shared<int>(0);
+
+		TaskPool::GetInstance()->Post([shared_path, flags, result]() {
+			*result = open(shared_path->c_str(), flags | O_CLOEXEC, 0644);
+			*result = *result < 0 ? -errno : *result;
+		}, [done, result]() {
+			done(*result < 0 ? -*result : 0, *result);
+		});
+	}
+
+	void File::ReadSome(int fd, char* buffer, size_t size, off_t offset, TransferDone done) {
+		// Current position reads need IORING_FEAT_RW_CUR_POS, older kernels take the thread pool
+		if (File::IsUsingIoRing() && (offset >= 0 || IoRing::GetInstance()->HasFeature(IORING_FEAT_RW_CUR_POS))) {
+			IoRing::GetInstance()->Submit([fd, buffer, size, offset](io_uring_sqe* sqe) {
+				sqe->opcode = IORING_OP_READ;
+				sqe->fd = fd;
+				sqe->addr = (uint64_t)buffer;
+				sqe->len = min(size, max_transfer_size);
+				sqe->off = (uint64_t)offset;
+			}, [done](int result) {
+				done(result < 0 ? -result : 0, result < 0 ? 0 : result);
+			});
+
+			return;
+		}
+
+		auto result = make_shared<ssize_t>(0);
+
+		TaskPool::GetInstance()->Post([fd, buffer, size, offset, result]() {
+			do {
+				*result = offset < 0 ? read(fd, buffer, min(size, max_transfer_size)) : pread(fd, buffer, min(size, max_transfer_size), offset);
+			} while (*result < 0 && errno == EINTR);
+
+			*result = *result < 0 ? -errno : *result;
+		}, [done, result]() {
+			done(*result < 0 ? -*result : 0, *result < 0 ? 0 : *result);
+		});
+	}
+
+	void File::WriteSome(int fd, const char* data, size_t length, off_t offset, TransferDone done) {
+		if (File::IsUsingIoRing() && (offset >= 0 || IoRing::GetInstance()->HasFeature(IORING_FEAT_RW_CUR_POS))) {
+			IoRing::GetInstance()->Submit([fd, data, length, offset](io_uring_sqe* sqe) {
+				sqe->opcode = IORING_OP_WRITE;
+				sqe->fd = fd;
+				sqe->addr = (uint64_t)data;
+				sqe->len = min(length, max_transfer_size);
+				sqe->off = (uint64_t)offset;
+			}, [done](int result) {
+				done(result < 0 ? -result : 0, result < 0 ? 0 : result);
+			});
+
+			return;
+		}
+
+		auto result = make_shared<ssize_t>(0);
+
+		TaskPool::GetInstance()->Post([fd, data, length, offset, result]() {
+			do {
+				*result = offset < 0 ? write(fd, data, min(length, max_transfer_size)) : pwrite(fd, data, min(length, max_transfer_size), offset);
+			} while (*result < 0 && errno == EINTR);
+
+			*result = *result < 0 ? -errno : *result;
+		}, [done, result]() {
+			done(*result < 0 ? -*result : 0, *result < 0 ? 0 : *result);
+		});
+	}
+
+	void File::Close(int fd) {
+		if (File::IsUsingIoRing()) {
+			IoRing::GetInstance()->Submit([fd](io_uring_sqe* sqe) {
+				sqe->opcode = IORING_OP_CLOSE;
+				sqe->fd = fd;
+			}, [](int result) {});
+
+			return;
+		}
+
+		close(fd);
+	}
+
+	Local<Function> File::Make(Local<Context> context) {
+		Isolate* isolate = context->GetIsolate();
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<FunctionTemplate> class_tpl = FunctionTemplate::New(isolate, ConstructorCallback);
+		class_tpl->SetClassName(String::NewFromUtf8(isolate, "File").ToLocalChecked());
+		class_tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+		Local<FunctionTemplate> read_tpl = FunctionTemplate::New(isolate, ReadCallback);
+		Local<FunctionTemplate> read_text_tpl = FunctionTemplate::New(isolate, ReadTextCallback);
+		Local<FunctionTemplate> write_tpl = FunctionTemplate::New(isolate, WriteCallback);
+		Local<FunctionTemplate> stat_tpl = FunctionTemplate::New(isolate, StatCallback);
+		Local<FunctionTemplate> read_dir_tpl = FunctionTemplate::New(isolate, ReadDirCallback);
+		Local<FunctionTemplate> open_read_tpl = FunctionTemplate::New(isolate, OpenReadCallback);
+		Local<FunctionTemplate> open_write_tpl = FunctionTemplate::New(isolate, OpenWriteCallback);
+
+		// All file operations are static
+		class_tpl->Set(String::NewFromUtf8(isolate, "read").ToLocalChecked(), read_tpl);
+		class_tpl->Set(String::NewFromUtf8(isolate, "readText").ToLocalChecked(), read_text_tpl);
+		class_tpl->Set(String::NewFromUtf8(isolate, "write").ToLocalChecked(), write_tpl);
+		class_tpl->Set(String::NewFromUtf8(isolate, "stat").ToLocalChecked(), stat_tpl);
+		class_tpl->Set(String::NewFromUtf8(isolate, "readdir").ToLocalChecked(), read_dir_tpl);
+		class_tpl->Set(String::NewFromUtf8(isolate, "openRead").ToLocalChecked(), open_read_tpl);
+		class_tpl->Set(String::NewFromUtf8(isolate, "openWrite").ToLocalChecked(), open_write_tpl);
+		class_tpl->Set(
+			String::NewFromUtf8(isolate, "backend").ToLocalChecked(),
+			String::NewFromUtf8(isolate, File::IsUsingIoRing() ? "io_uring" : "threads").ToLocalChecked()
+		);
+
+		return handle_scope.Escape(class_tpl->GetFunction(context).ToLocalChecked());
+	}
+
+	void File::ConstructorCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		isolate->ThrowException(Exception::TypeError(
+			String::NewFromUtf8(isolate, "Unable to instantiate static class.").ToLocalChecked()
+		));
+	}
+
+	static bool get_path_argument(const FunctionCallbackInfo<Value> &args, string* path) {
+		Isolate* isolate = args.GetIsolate();
+
+		if (args.Length() < 1 || !args[0]->IsString()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: path must be a string.").ToLocalChecked()
+			));
+
+			return false;
+		}
+
+		String::Utf8Value path_str(isolate, args[0]);
+		*path = *path_str;
+		return true;
+	}
+
+	void File::ReadCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		string path;
+
+		if (!get_path_argument(args, &path)) return;
+
+		auto pending = make_shared<PendingPromise>(isolate->GetCurrentContext());
+
+		File::Read(path, [pending, path](int error, char* data, size_t length) {
+			Isolate* isolate = pending->GetIsolate();
+			Context::Scope context_scope(pending->GetContext());
+
+			if (error != 0) {
+				pending->Reject(describe_error("read", path, error));
+				return;
+			}
+
+			// Hand the buffer over to V8 without copying it
+			shared_ptr<BackingStore> store = ArrayBuffer::NewBackingStore(data, length, free_backing_store, nullptr);
+			pending->Resolve(ArrayBuffer::New(isolate, store));
+		});
+
+		args.GetReturnValue().Set(pending->GetPromise());
+	}
+
+	void File::ReadTextCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		string path;
+
+		if (!get_path_argument(args, &path)) return;
+
+		auto pending = make_shared<PendingPromise>(isolate->GetCurrentContext());
+
+		File::Read(path, [pending, path](int error, char* data, size_t length) {
+			Isolate* isolate = pending->GetIsolate();
+			Context::Scope context_scope(pending->GetContext());
+
+			if (error != 0) {
+				pending->Reject(describe_error("read", path, error));
+				return;
+			}
+
+			// Larger files can't become a single string, whatever their encoding
+			if (length > (size_t)String::kMaxLength) {
+				free(data);
+				pending->Reject(describe_error("read", path, EFBIG));
+				return;
+			}
+
+			MaybeLocal<String> text = String::NewFromUtf8(isolate, data, NewStringType::kNormal, length);
+			free(data);
+
+			if (text.IsEmpty()) {
+				pending->Reject(describe_error("decode", path, EINVAL));
+			} else {
+				pending->Resolve(text.ToLocalChecked());
+			}
+		});
+
+		args.GetReturnValue().Set(pending->GetPromise());
+	}
+
+	void File::WriteCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		string path;
+
+		if (!get_path_argument(args, &path)) return;
+
+		shared_ptr<BackingStore> store;
+		const char* data;
+		size_t length;
+
+		// Buffers are written in place, strings are copied once into a native buffer
+		if (args[1]->IsArrayBuffer()) {
+			store = Local<ArrayBuffer>::Cast(args[1])->GetBackingStore();
+			data = (const char*)store->Data();
+			length = store->ByteLength();
+		} else if (args[1]->IsArrayBufferView()) {
+			Local<ArrayBufferView> view = Local<ArrayBufferView>::Cast(args[1]);
+			store = view->Buffer()->GetBackingStore();
+			data = (const char*)store->Data() + view->ByteOffset();
+			length = view->ByteLength();
+		} else if (args[1]->IsString()) {
+			String::Utf8Value text(isolate, args[1]);
+			length = text.length();
+			store = ArrayBuffer::NewBackingStore(isolate, length);
+			memcpy(store->Data(), *text, length);
+			data = (const char*)store->Data();
+		} else {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: data must be a string, ArrayBuffer or typed array.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		auto pending = make_shared<PendingPromise>(isolate->GetCurrentContext());
+
+		File::Write(path, store, data, length, [pending, path](int error, size_t written) {
+			Isolate* isolate = pending->GetIsolate();
+			Context::Scope context_scope(pending->GetContext());
+
+			if (error != 0) {
+				pending->Reject(describe_error("write", path, error));
+			} else {
+				pending->Resolve(Number::New(isolate, written));
+			}
+		});
+
+		args.GetReturnValue().Set(pending->GetPromise());
+	}
+
+	void File::StatCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		string path;
+
+		if (!get_path_argument(args, &path)) return;
+
+		auto pending = make_shared<PendingPromise>(isolate->GetCurrentContext());
+
+		File::Stat(path, [pending, path](int error, const struct statx& stat) {
+			Isolate* isolate = pending->GetIsolate();
+			Local<Context> context = pending->GetContext();
+			Context::Scope context_scope(context);
+
+			if (error != 0) {
+				pending->Reject(describe_error("stat", path, error));
+				return;
+			}
+
+			auto to_millis = [](const statx_timestamp& time) {
+				return time.tv_sec * 1000.0 + time.tv_nsec / 1000000.0;
+			};
+
+			Local<Object> result = Object::New(isolate);
+			result->Set(context, String::NewFromUtf8(isolate, "size").ToLocalChecked(), Number::New(isolate, stat.stx_size)).Check();
+			result->Set(context, String::NewFromUtf8(isolate, "mode").ToLocalChecked(), Integer::NewFromUnsigned(isolate, stat.stx_mode)).Check();
+			result->Set(context, String::NewFromUtf8(isolate, "isFile").ToLocalChecked(), Boolean::New(isolate, S_ISREG(stat.stx_mode))).Check();
+			result->Set(context, String::NewFromUtf8(isolate, "isDirectory").ToLocalChecked(), Boolean::New(isolate, S_ISDIR(stat.stx_mode))).Check();
+			result->Set(context, String::NewFromUtf8(isolate, "isSymbolicLink").ToLocalChecked(), Boolean::New(isolate, S_ISLNK(stat.stx_mode))).Check();
+			result->Set(context, String::NewFromUtf8(isolate, "accessed").ToLocalChecked(), Date::New(context, to_millis(stat.stx_atime)).ToLocalChecked()).Check();
+			result->Set(context, String::NewFromUtf8(isolate, "modified").ToLocalChecked(), Date::New(context, to_millis(stat.stx_mtime)).ToLocalChecked()).Check();
+
+			if (stat.stx_mask & STATX_BTIME) {
+				result->Set(context, String::NewFromUtf8(isolate, "created").ToLocalChecked(), Date::New(context, to_millis(stat.stx_btime)).ToLocalChecked()).Check();
+			}
+
+			pending->Resolve(result);
+		});
+
+		args.GetReturnValue().Set(pending->GetPromise());
+	}
+
+	void File::ReadDirCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		string path;
+
+		if (!get_path_argument(args, &path)) return;
+
+		// There is no io_uring operation for directory listing, so this always uses a worker
+		auto entries = make_shared<vector<string>>();
+		auto error = make_shared<int>(0);
+
+		Local<Promise> promise = TaskPool::GetInstance()->Submit(isolate->GetCurrentContext(), [path, entries, error]() {
+			DIR* dir = opendir(path.c_str());
+
+			if (dir == NULL) {
+				*error = errno;
+				return;
+			}
+
+			while (struct dirent* entry = readdir(dir)) {
+				if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+					entries->push_back(entry->d_name);
+				}
+			}
+
+			closedir(dir);
+		}, [path, entries, error](Local<Context> context, Local<Promise::Resolver> resolver) {
+			Isolate* isolate = context->GetIsolate();
+
+			if (*error != 0) {
+				resolver->Reject(context, Exception::Error(
+					String::NewFromUtf8(isolate, describe_error("read directory", path, *error).c_str()).ToLocalChecked()
+				)).Check();
+
+				return;
+			}
+
+			Local<Array> result = Array::New(isolate, entries->size());
+
+			for (size_t i = 0; i < entries->size(); i++) {
+				result->Set(context, i, String::NewFromUtf8(isolate, (*entries)[i].c_str()).ToLocalChecked()).Check();
+			}
+
+			resolver->Resolve(context, result).Check();
+		});
+
+		args.GetReturnValue().Set(promise);
+	}
+
+	// Stream sizes past these would only pin memory, they are capped rather than allocated
+	static const size_t max_chunk_size = 16 * 1024 * 1024;
+	static const size_t max_high_water_mark = 256 * 1024 * 1024;
+
+	static size_t get_size_option(Local<Context> context, Local<Value> options, const char* name, size_t fallback, size_t limit) {
+		Isolate* isolate = context->GetIsolate();
+
+		if (!options->IsObject()) {
+			return fallback;
+		}
+
+		Local<Value> value;
+
+		if (!Local<Object>::Cast(options)->Get(context, String::NewFromUtf8(isolate, name).ToLocalChecked()).ToLocal(&value) || !value->IsNumber()) {
+			return fallback;
+		}
+
+		double number = value.As<Number>()->Value();
+		if (!(number >= 1)) {
+			return fallback;
+		}
+
+		return number < (double)limit ? (size_t)number : limit;
+	}
+
+	void File::OpenReadCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+		string path;
+
+		if (!get_path_argument(args, &path)) return;
+
+		// Defaults keep four 64 KiB chunks in flight
+		size_t chunk_size = get_size_option(context, args[1], "chunkSize", 64 * 1024, max_chunk_size);
+		size_t high_water_mark = get_size_option(context, args[1], "highWaterMark", chunk_size * 4, max_high_water_mark);
+
+		args.GetReturnValue().Set(ReadableStream::FromPath(context, path, chunk_size, high_water_mark));
+	}
+
+	void File::OpenWriteCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+		string path;
+
+		if (!get_path_argument(args, &path)) return;
+
+		size_t high_water_mark = get_size_option(context, args[1], "highWaterMark", 256 * 1024, max_high_water_mark);
+
+		args.GetReturnValue().Set(WritableStream::FromPath(context, path, high_water_mark));
+	}
+
+	Local<Module> FileModule::Make(Isolate* isolate) {
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<Module> module = Module::CreateSyntheticModule(
+			isolate,
+			String::NewFromUtf8(isolate, "File").ToLocalChecked(),
+			{
+				String::NewFromUtf8(isolate, "default").ToLocalChecked(),
+				String::NewFromUtf8(isolate, "File").ToLocalChecked()
+			},
+			[](Local<Context> context, Local<Module> module) -> MaybeLocal<Value> {
+				Isolate* isolate = context->GetIsolate();
+				HandleScope handle_scope(isolate);
+
+				Local<Function> constructor = File::GetConstructor(context);
+
+				module->SetSyntheticModuleExport(
+					isolate,
+					String::NewFromUtf8(isolate, "default").ToLocalChecked(),
+					constructor
+				);
+
+				module->SetSyntheticModuleExport(
+					isolate,
+					String::NewFromUtf8(isolate, "File").ToLocalChecked(),
+					constructor
+				);
+
+				return MaybeLocal<Value>(True(isolate));
+			}
+		);
+
+		return handle_scope.Escape(module);
+	}
+}
\ No newline at end of file
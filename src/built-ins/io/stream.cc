@@ -0,0 +1,731 @@
+#include <functional>
+#include <v8.h>
+#include <gtk-3.0/gtk/gtk.h>
+#include <piston_native_class.h>
+#include <piston_native_module.h>
+#include <built-ins/io/file.h>
+#include <built-ins/io/stream.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include "loader.h"
+
+using namespace v8;
+using namespace mosaic::runtime;
+
+namespace mosaic::io {
+	bool ReadableStream::lock_constructor_ = true;
+	bool WritableStream::lock_constructor_ = true;
+
+	// Seekable files are read and written at tracked offsets, pipes at their current position
+	static off_t get_start_position(int fd) {
+		return lseek(fd, 0, SEEK_CUR);
+	}
+
+	static Local<Object> create_iterator_result(Isolate* isolate, Local<Context> context, Local<Value> value, bool done) {
+		Local<Object> result = Object::New(isolate);
+		result->Set(context, String::NewFromUtf8(isolate, "value").ToLocalChecked(), value);
+		result->Set(context, String::NewFromUtf8(isolate, "done").ToLocalChecked(), Boolean::New(isolate, done));
+		return result;
+	}
+
+	static string describe_stream_error(const char* action, const string& path, int error) {
+		return string("Failed to ") + action + " '" + path + "': " + strerror(error);
+	}
+
+	ReadableStream::ReadableStream(string path, size_t chunk_size, size_t high_water_mark) {
+		this->path_ = path;
+		this->fd_ = -1;
+		this->position_ = -1;
+		this->opening_ = false;
+		this->reading_ = false;
+		this->ended_ = false;
+		this->error_ = 0;
+		this->pool_ = BufferPool::Get(chunk_size);
+		this->high_water_mark_ = high_water_mark;
+		this->queued_bytes_ = 0;
+	}
+
+	ReadableStream::~ReadableStream() {
+		for (Chunk& chunk : this->chunks_) {
+			this->pool_->Release(chunk.data);
+		}
+
+		if (this->fd_ >= 0) {
+			File::Close(this->fd_);
+		}
+	}
+
+	Local<Object> ReadableStream::FromPath(Local<Context> context, string path, size_t chunk_size, size_t high_water_mark) {
+		Isolate* isolate = context->GetIsolate();
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<Function> constructor = ReadableStream::GetConstructor(context);
+
+		ReadableStream::UnlockConstructor();
+		Local<Object> instance = constructor->NewInstance(context).ToLocalChecked();
+		ReadableStream::LockConstructor();
+
+		ReadableStream* native_instance = new ReadableStream(path, chunk_size, high_water_mark);
+		native_instance->Wrap(instance);
+		native_instance->MakeWeak();
+
+		// Start filling the queue right away
+		native_instance->Pump();
+
+		return handle_scope.Escape(instance);
+	}
+
+	void ReadableStream::Read(shared_ptr<PendingPromise> pending) {
+		this->pending_reads_.push_back(pending);
+		this->Settle();
+		this->Pump();
+	}
+
+	void ReadableStream::UpdateWeak() {
+		// Completions call back into this object, so it can't be collected while one is due
+		if (this->opening_ || this->reading_) {
+			this->ClearWeak();
+		} else {
+			this->MakeWeak();
+		}
+	}
+
+	void ReadableStream::Cancel() {
+		for (Chunk& chunk : this->chunks_) {
+			this->pool_->Release(chunk.data);
+		}
+
+		this->chunks_.clear();
+		this->queued_bytes_ = 0;
+		this->ended_ = true;
+
+		// An in-flight read or open closes the descriptor once it completes
+		if (this->fd_ >= 0 && !this->reading_) {
+			File::Close(this->fd_);
+			this->fd_ = -1;
+		}
+
+		this->Settle();
+	}
+
+	void ReadableStream::Pump() {
+		if (this->ended_ || this->error_ != 0 || this->reading_ || this->opening_) {
+			return;
+		}
+
+		if (this->fd_ < 0) {
+			this->opening_ = true;
+
+			File::Open(this->path_, O_RDONLY, [this](int error, int fd) {
+				this->opening_ = false;
+
+				if (error != 0) {
+					this->error_ = error;
+					this->Settle();
+				} else if (this->ended_) {
+					File::Close(fd);
+				} else {
+					this->fd_ = fd;
+					this->position_ = get_start_position(fd);
+					this->Pump();
+				}
+
+				this->UpdateWeak();
+			});
+
+			this->UpdateWeak();
+			return;
+		}
+
+		// Backpressure: stop reading once the queue is full and nobody is waiting
+		if (this->queued_bytes_ >= this->high_water_mark_ && this->pending_reads_.empty()) {
+			return;
+		}
+
+		char* buffer = this->pool_->Acquire();
+
+		if (buffer == NULL) {
+			this->error_ = ENOMEM;
+			this->ended_ = true;
+			File::Close(this->fd_);
+			this->fd_ = -1;
+			this->Settle();
+			return;
+		}
+
+		this->reading_ = true;
+
+		File::ReadSome(this->fd_, buffer, this->pool_->GetBufferSize(), this->position_, [this, buffer](int error, size_t count) {
+			this->OnRead(error, buffer, count);
+			this->UpdateWeak();
+		});
+
+		this->UpdateWeak();
+	}
+
+	void ReadableStream::OnRead(int error, char* buffer, size_t count) {
+		this->reading_ = false;
+
+		if (error != 0 || count == 0 || this->ended_) {
+			this->pool_->Release(buffer);
+
+			if (error != 0 && !this->ended_) {
+				this->error_ = error;
+			}
+
+			this->ended_ = true;
+			File::Close(this->fd_);
+			this->fd_ = -1;
+		} else {
+			this->chunks_.push_back({ buffer, count });
+			this->queued_bytes_ += count;
+
+			if (this->position_ >= 0) {
+				this->position_ += count;
+			}
+		}
+
+		this->Settle();
+		this->Pump();
+	}
+
+	void ReadableStream::Settle() {
+		while (!this->pending_reads_.empty()) {
+			shared_ptr<PendingPromise> pending = this->pending_reads_.front();
+
+			if (!this->chunks_.empty()) {
+				Chunk chunk = this->chunks_.front();
+				this->chunks_.pop_front();
+				this->queued_bytes_ -= chunk.length;
+				this->ResolveChunk(pending, chunk);
+			} else if (this->error_ != 0) {
+				Context::Scope context_scope(pending->GetContext());
+				pending->Reject(describe_stream_error("read", this->path_, this->error_));
+			} else if (this->ended_) {
+				this->ResolveDone(pending);
+			} else {
+				break;
+			}
+
+			this->pending_reads_.pop_front();
+		}
+	}
+
+	void ReadableStream::ResolveChunk(shared_ptr<PendingPromise> pending, Chunk chunk) {
+		Isolate* isolate = pending->GetIsolate();
+		Local<Context> context = pending->GetContext();
+		Context::Scope context_scope(context);
+
+		// The chunk goes back to the pool once JS drops the last reference to it
+		Local<ArrayBuffer> buffer = ArrayBuffer::New(isolate, this->pool_->NewBackingStore(chunk.data, chunk.length));
+		Local<Uint8Array> value = Uint8Array::New(buffer, 0, chunk.length);
+
+		pending->Resolve(create_iterator_result(isolate, context, value, false));
+	}
+
+	void ReadableStream::ResolveDone(shared_ptr<PendingPromise> pending) {
+		Isolate* isolate = pending->GetIsolate();
+		Local<Context> context = pending->GetContext();
+		Context::Scope context_scope(context);
+
+		pending->Resolve(create_iterator_result(isolate, context, Undefined(isolate), true));
+	}
+
+	Local<Function> ReadableStream::Make(Local<Context> context) {
+		Isolate* isolate = context->GetIsolate();
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<FunctionTemplate> class_tpl = FunctionTemplate::New(isolate, ConstructorCallback);
+		class_tpl->SetClassName(String::NewFromUtf8(isolate, "ReadableStream").ToLocalChecked());
+		class_tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+		Local<FunctionTemplate> read_tpl = FunctionTemplate::New(isolate, ReadCallback);
+		Local<FunctionTemplate> cancel_tpl = FunctionTemplate::New(isolate, CancelCallback);
+		Local<FunctionTemplate> get_reader_tpl = FunctionTemplate::New(isolate, GetReaderCallback);
+		Local<FunctionTemplate> release_lock_tpl = FunctionTemplate::New(isolate, ReleaseLockCallback);
+		Local<FunctionTemplate> async_iterator_tpl = FunctionTemplate::New(isolate, AsyncIteratorCallback);
+
+		Local<ObjectTemplate> proto_tpl = class_tpl->PrototypeTemplate();
+		proto_tpl->Set(String::NewFromUtf8(isolate, "read").ToLocalChecked(), read_tpl);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "cancel").ToLocalChecked(), cancel_tpl);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "getReader").ToLocalChecked(), get_reader_tpl);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "releaseLock").ToLocalChecked(), release_lock_tpl);
+		proto_tpl->Set(Symbol::GetAsyncIterator(isolate), async_iterator_tpl);
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "desiredSize").ToLocalChecked(), GetDesiredSizeCallback);
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "highWaterMark").ToLocalChecked(), GetHighWaterMarkCallback);
+
+		return handle_scope.Escape(class_tpl->GetFunction(context).ToLocalChecked());
+	}
+
+	void ReadableStream::ConstructorCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+
+		if (ReadableStream::IsConstructorLocked()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to instantiate protected class. Use File.openRead() instead.").ToLocalChecked()
+			));
+		} else if (args.IsConstructCall()) {
+			args.GetReturnValue().Set(args.This());
+		}
+	}
+
+	void ReadableStream::ReadCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		ReadableStream* self = NativeClass::Unwrap(args.This());
+
+		auto pending = make_shared<PendingPromise>(isolate->GetCurrentContext());
+		self->Read(pending);
+
+		args.GetReturnValue().Set(pending->GetPromise());
+	}
+
+	void ReadableStream::CancelCallback(const FunctionCallbackInfo<Value> &args) {
+		ReadableStream* self = NativeClass::Unwrap(args.This());
+		self->Cancel();
+	}
+
+	void ReadableStream::GetReaderCallback(const FunctionCallbackInfo<Value> &args) {
+		// The stream is its own reader
+		args.GetReturnValue().Set(args.This());
+	}
+
+	void ReadableStream::ReleaseLockCallback(const FunctionCallbackInfo<Value> &args) {
+	}
+
+	void ReadableStream::AsyncIteratorCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+
+		Local<Object> iterator = Object::New(isolate);
+		iterator->Set(context, String::NewFromUtf8(isolate, "next").ToLocalChecked(), Function::New(context, IteratorNextCallback, args.This()).ToLocalChecked());
+		iterator->Set(context, String::NewFromUtf8(isolate, "return").ToLocalChecked(), Function::New(context, IteratorReturnCallback, args.This()).ToLocalChecked());
+
+		args.GetReturnValue().Set(iterator);
+	}
+
+	void ReadableStream::IteratorNextCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		ReadableStream* self = NativeClass::Unwrap(Local<Object>::Cast(args.Data()));
+
+		auto pending = make_shared<PendingPromise>(isolate->GetCurrentContext());
+		self->Read(pending);
+
+		args.GetReturnValue().Set(pending->GetPromise());
+	}
+
+	void ReadableStream::IteratorReturnCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		ReadableStream* self = NativeClass::Unwrap(Local<Object>::Cast(args.Data()));
+
+		// Leaving a for-await loop early cancels the stream
+		self->Cancel();
+
+		auto pending = make_shared<PendingPromise>(isolate->GetCurrentContext());
+		self->ResolveDone(pending);
+
+		args.GetReturnValue().Set(pending->GetPromise());
+	}
+
+	void ReadableStream::GetDesiredSizeCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Isolate* isolate = info.GetIsolate();
+		HandleScope handle_scope(isolate);
+		ReadableStream* self = NativeClass::Unwrap(info.This());
+
+		Local<Number> value = Number::New(isolate, self->GetDesiredSize());
+		info.GetReturnValue().Set(value);
+	}
+
+	void ReadableStream::GetHighWaterMarkCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Isolate* isolate = info.GetIsolate();
+		HandleScope handle_scope(isolate);
+		ReadableStream* self = NativeClass::Unwrap(info.This());
+
+		Local<Number> value = Number::New(isolate, self->GetHighWaterMark());
+		info.GetReturnValue().Set(value);
+	}
+
+	WritableStream::WritableStream(string path, size_t high_water_mark) {
+		this->path_ = path;
+		this->fd_ = -1;
+		this->position_ = -1;
+		this->opening_ = false;
+		this->writing_ = false;
+		this->closing_ = false;
+		this->error_ = 0;
+		this->high_water_mark_ = high_water_mark;
+		this->queued_bytes_ = 0;
+	}
+
+	WritableStream::~WritableStream() {
+		if (this->fd_ >= 0) {
+			File::Close(this->fd_);
+		}
+	}
+
+	Local<Object> WritableStream::FromPath(Local<Context> context, string path, size_t high_water_mark) {
+		Isolate* isolate = context->GetIsolate();
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<Function> constructor = WritableStream::GetConstructor(context);
+
+		WritableStream::UnlockConstructor();
+		Local<Object> instance = constructor->NewInstance(context).ToLocalChecked();
+		WritableStream::LockConstructor();
+
+		WritableStream* native_instance = new WritableStream(path, high_water_mark);
+		native_instance->Wrap(instance);
+		native_instance->MakeWeak();
+
+		return handle_scope.Escape(instance);
+	}
+
+	void WritableStream::Write(shared_ptr<BackingStore> store, const char* data, size_t length, shared_ptr<PendingPromise> pending) {
+		if (this->error_ != 0) {
+			pending->Reject(describe_stream_error("write", this->path_, this->error_));
+			return;
+		}
+
+		if (this->closing_) {
+			pending->Reject(string("Unable to write to a closed stream."));
+			return;
+		}
+
+		this->chunks_.push_back({ store, data, length, 0, pending });
+		this->queued_bytes_ += length;
+		this->Flush();
+	}
+
+	void WritableStream::Close(shared_ptr<PendingPromise> pending) {
+		if (this->closing_ || this->error_ != 0) {
+			pending->Reject(string("Unable to close a closed or errored stream."));
+			return;
+		}
+
+		this->closing_ = true;
+		this->close_promise_ = pending;
+		this->Flush();
+	}
+
+	void WritableStream::Abort() {
+		this->Fail(ECANCELED);
+	}
+
+	void WritableStream::UpdateWeak() {
+		// Same as readable streams, pending completions hold on to this object
+		if (this->opening_ || this->writing_) {
+			this->ClearWeak();
+		} else {
+			this->MakeWeak();
+		}
+	}
+
+	void WritableStream::WhenReady(shared_ptr<PendingPromise> pending) {
+		this->ready_waiters_.push_back(pending);
+		this->NotifyReady();
+	}
+
+	void WritableStream::Flush() {
+		if (this->writing_ || this->opening_ || this->error_ != 0) {
+			return;
+		}
+
+		if (this->fd_ < 0) {
+			this->opening_ = true;
+
+			File::Open(this->path_, O_WRONLY | O_CREAT | O_TRUNC, [this](int error, int fd) {
+				this->opening_ = false;
+
+				if (error != 0) {
+					this->Fail(error);
+				} else if (this->error_ != 0) {
+					File::Close(fd);
+				} else {
+					this->fd_ = fd;
+					this->position_ = get_start_position(fd);
+					this->Flush();
+				}
+
+				this->UpdateWeak();
+			});
+
+			this->UpdateWeak();
+			return;
+		}
+
+		if (this->chunks_.empty()) {
+			if (this->closing_ && this->close_promise_) {
+				File::Close(this->fd_);
+				this->fd_ = -1;
+
+				Context::Scope context_scope(this->close_promise_->GetContext());
+				this->close_promise_->Resolve(Undefined(this->close_promise_->GetIsolate()));
+				this->close_promise_ = nullptr;
+			}
+
+			return;
+		}
+
+		Chunk& chunk = this->chunks_.front();
+		this->writing_ = true;
+
+		File::WriteSome(this->fd_, chunk.data + chunk.offset, chunk.length - chunk.offset, this->position_, [this](int error, size_t count) {
+			this->OnWrite(error, count);
+			this->UpdateWeak();
+		});
+
+		this->UpdateWeak();
+	}
+
+	void WritableStream::OnWrite(int error, size_t count) {
+		this->writing_ = false;
+
+		// Aborted or failed while this write was in flight, Fail() left the descriptor to us
+		if (this->error_ != 0) {
+			if (this->fd_ >= 0) {
+				File::Close(this->fd_);
+				this->fd_ = -1;
+			}
+
+			return;
+		}
+
+		if (error != 0) {
+			this->Fail(error);
+			return;
+		}
+
+		if (this->position_ >= 0) {
+			this->position_ += count;
+		}
+
+		if (this->chunks_.empty()) {
+			return;
+		}
+
+		Chunk& chunk = this->chunks_.front();
+		chunk.offset += count;
+
+		if (chunk.offset >= chunk.length) {
+			shared_ptr<PendingPromise> pending = chunk.pending;
+			this->queued_bytes_ -= chunk.length;
+			this->chunks_.pop_front();
+
+			Context::Scope context_scope(pending->GetContext());
+			pending->Resolve(Undefined(pending->GetIsolate()));
+			this->NotifyReady();
+		}
+
+		this->Flush();
+	}
+
+	void WritableStream::Fail(int error) {
+		this->error_ = error;
+
+		for (Chunk& chunk : this->chunks_) {
+			Context::Scope context_scope(chunk.pending->GetContext());
+			chunk.pending->Reject(describe_stream_error("write", this->path_, error));
+		}
+
+		this->chunks_.clear();
+		this->queued_bytes_ = 0;
+
+		if (this->close_promise_) {
+			Context::Scope context_scope(this->close_promise_->GetContext());
+			this->close_promise_->Reject(describe_stream_error("close", this->path_, error));
+			this->close_promise_ = nullptr;
+		}
+
+		while (!this->ready_waiters_.empty()) {
+			shared_ptr<PendingPromise> pending = this->ready_waiters_.front();
+			Context::Scope context_scope(pending->GetContext());
+			pending->Reject(describe_stream_error("write", this->path_, error));
+			this->ready_waiters_.pop_front();
+		}
+
+		if (this->fd_ >= 0 && !this->writing_) {
+			File::Close(this->fd_);
+			this->fd_ = -1;
+		}
+	}
+
+	void WritableStream::NotifyReady() {
+		while (!this->ready_waiters_.empty() && this->GetDesiredSize() > 0) {
+			shared_ptr<PendingPromise> pending = this->ready_waiters_.front();
+			Context::Scope context_scope(pending->GetContext());
+			pending->Resolve(Undefined(pending->GetIsolate()));
+			this->ready_waiters_.pop_front();
+		}
+	}
+
+	Local<Function> WritableStream::Make(Local<Context> context) {
+		Isolate* isolate = context->GetIsolate();
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<FunctionTemplate> class_tpl = FunctionTemplate::New(isolate, ConstructorCallback);
+		class_tpl->SetClassName(String::NewFromUtf8(isolate, "WritableStream").ToLocalChecked());
+		class_tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+		Local<FunctionTemplate> write_tpl = FunctionTemplate::New(isolate, WriteCallback);
+		Local<FunctionTemplate> close_tpl = FunctionTemplate::New(isolate, CloseCallback);
+		Local<FunctionTemplate> abort_tpl = FunctionTemplate::New(isolate, AbortCallback);
+		Local<FunctionTemplate> get_writer_tpl = FunctionTemplate::New(isolate, GetWriterCallback);
+		Local<FunctionTemplate> release_lock_tpl = FunctionTemplate::New(isolate, ReleaseLockCallback);
+
+		Local<ObjectTemplate> proto_tpl = class_tpl->PrototypeTemplate();
+		proto_tpl->Set(String::NewFromUtf8(isolate, "write").ToLocalChecked(), write_tpl);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "close").ToLocalChecked(), close_tpl);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "abort").ToLocalChecked(), abort_tpl);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "getWriter").ToLocalChecked(), get_writer_tpl);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "releaseLock").ToLocalChecked(), release_lock_tpl);
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "ready").ToLocalChecked(), GetReadyCallback);
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "desiredSize").ToLocalChecked(), GetDesiredSizeCallback);
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "highWaterMark").ToLocalChecked(), GetHighWaterMarkCallback);
+
+		return handle_scope.Escape(class_tpl->GetFunction(context).ToLocalChecked());
+	}
+
+	void WritableStream::ConstructorCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+
+		if (WritableStream::IsConstructorLocked()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to instantiate protected class. Use File.openWrite() instead.").ToLocalChecked()
+			));
+		} else if (args.IsConstructCall()) {
+			args.GetReturnValue().Set(args.This());
+		}
+	}
+
+	void WritableStream::WriteCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		WritableStream* self = NativeClass::Unwrap(args.This());
+
+		shared_ptr<BackingStore> store;
+		const char* data;
+		size_t length;
+
+		// Buffers are written in place, strings are encoded once into a native buffer
+		if (args[0]->IsArrayBuffer()) {
+			store = Local<ArrayBuffer>::Cast(args[0])->GetBackingStore();
+			data = (const char*)store->Data();
+			length = store->ByteLength();
+		} else if (args[0]->IsArrayBufferView()) {
+			Local<ArrayBufferView> view = Local<ArrayBufferView>::Cast(args[0]);
+			store = view->Buffer()->GetBackingStore();
+			data = (const char*)store->Data() + view->ByteOffset();
+			length = view->ByteLength();
+		} else if (args[0]->IsString()) {
+			String::Utf8Value text(isolate, args[0]);
+			length = text.length();
+			store = ArrayBuffer::NewBackingStore(isolate, length);
+			memcpy(store->Data(), *text, length);
+			data = (const char*)store->Data();
+		} else {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: chunk must be a string, ArrayBuffer or typed array.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		auto pending = make_shared<PendingPromise>(isolate->GetCurrentContext());
+		self->Write(store, data, length, pending);
+
+		args.GetReturnValue().Set(pending->GetPromise());
+	}
+
+	void WritableStream::CloseCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		WritableStream* self = NativeClass::Unwrap(args.This());
+
+		auto pending = make_shared<PendingPromise>(isolate->GetCurrentContext());
+		self->Close(pending);
+
+		args.GetReturnValue().Set(pending->GetPromise());
+	}
+
+	void WritableStream::AbortCallback(const FunctionCallbackInfo<Value> &args) {
+		WritableStream* self = NativeClass::Unwrap(args.This());
+		self->Abort();
+	}
+
+	void WritableStream::GetWriterCallback(const FunctionCallbackInfo<Value> &args) {
+		// The stream is its own writer
+		args.GetReturnValue().Set(args.This());
+	}
+
+	void WritableStream::ReleaseLockCallback(const FunctionCallbackInfo<Value> &args) {
+	}
+
+	void WritableStream::GetReadyCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Isolate* isolate = info.GetIsolate();
+		HandleScope handle_scope(isolate);
+		WritableStream* self = NativeClass::Unwrap(info.This());
+
+		auto pending = make_shared<PendingPromise>(isolate->GetCurrentContext());
+		self->WhenReady(pending);
+
+		info.GetReturnValue().Set(pending->GetPromise());
+	}
+
+	void WritableStream::GetDesiredSizeCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Isolate* isolate = info.GetIsolate();
+		HandleScope handle_scope(isolate);
+		WritableStream* self = NativeClass::Unwrap(info.This());
+
+		Local<Number> value = Number::New(isolate, self->GetDesiredSize());
+		info.GetReturnValue().Set(value);
+	}
+
+	void WritableStream::GetHighWaterMarkCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Isolate* isolate = info.GetIsolate();
+		HandleScope handle_scope(isolate);
+		WritableStream* self = NativeClass::Unwrap(info.This());
+
+		Local<Number> value = Number::New(isolate, self->GetHighWaterMark());
+		info.GetReturnValue().Set(value);
+	}
+
+	Local<Module> StreamModule::Make(Isolate* isolate) {
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<Module> module = Module::CreateSyntheticModule(
+			isolate,
+			String::NewFromUtf8(isolate, "Stream").ToLocalChecked(),
+			{
+				String::NewFromUtf8(isolate, "ReadableStream").ToLocalChecked(),
+				String::NewFromUtf8(isolate, "WritableStream").ToLocalChecked()
+			},
+			[](Local<Context> context, Local<Module> module) -> MaybeLocal<Value> {
+				Isolate* isolate = context->GetIsolate();
+				HandleScope handle_scope(isolate);
+
+				module->SetSyntheticModuleExport(
+					isolate,
+					String::NewFromUtf8(isolate, "ReadableStream").ToLocalChecked(),
+					ReadableStream::GetConstructor(context)
+				);
+
+				module->SetSyntheticModuleExport(
+					isolate,
+					String::NewFromUtf8(isolate, "WritableStream").ToLocalChecked(),
+					WritableStream::GetConstructor(context)
+				);
+
+				return MaybeLocal<Value>(True(isolate));
+			}
+		);
+
+		return handle_scope.Escape(module);
+	}
+}
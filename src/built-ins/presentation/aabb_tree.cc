@@ -0,0 +1,346 @@
+#include <built-ins/presentation/aabb_tree.h>
+#include <math.h>
+#include <algorithm>
+
+using namespace std;
+
+namespace mosaic::presentation {
+	// Room for shapes to move before their leaf has to be reinserted, in pixels
+	static const float box_margin = 4;
+
+	static inline AabbTree::Rect combine(const AabbTree::Rect& a, const AabbTree::Rect& b) {
+		return { min(a.min_x, b.min_x), min(a.min_y, b.min_y), max(a.max_x, b.max_x), max(a.max_y, b.max_y) };
+	}
+
+	static inline float perimeter(const AabbTree::Rect& rect) {
+		return 2 * ((rect.max_x - rect.min_x) + (rect.max_y - rect.min_y));
+	}
+
+	static inline bool contains(const AabbTree::Rect& outer, const AabbTree::Rect& inner) {
+		return outer.min_x <= inner.min_x && outer.min_y <= inner.min_y && inner.max_x <= outer.max_x && inner.max_y <= outer.max_y;
+	}
+
+	static inline bool overlaps(const AabbTree::Rect& a, const AabbTree::Rect& b) {
+		return a.min_x <= b.max_x && b.min_x <= a.max_x && a.min_y <= b.max_y && b.min_y <= a.max_y;
+	}
+
+	static inline bool contains_point(const AabbTree::Rect& rect, float x, float y) {
+		return rect.min_x <= x && x <= rect.max_x && rect.min_y <= y && y <= rect.max_y;
+	}
+
+	AabbTree::AabbTree() {
+		this->root_ = null_node;
+		this->free_list_ = null_node;
+		this->next_order_ = 0;
+	}
+
+	int AabbTree::AllocateNode() {
+		if (this->free_list_ == null_node) {
+			this->nodes_.push_back(Node());
+			this->nodes_.back().parent = this->free_list_;
+			this->free_list_ = (int)this->nodes_.size() - 1;
+		}
+
+		int node = this->free_list_;
+		this->free_list_ = this->nodes_[node].parent;
+
+		Node& allocated = this->nodes_[node];
+		allocated.parent = null_node;
+		allocated.child1 = null_node;
+		allocated.child2 = null_node;
+		allocated.height = 0;
+
+		return node;
+	}
+
+	void AabbTree::FreeNode(int node) {
+		this->nodes_[node].parent = this->free_list_;
+		this->nodes_[node].height = -1;
+		this->free_list_ = node;
+	}
+
+	void AabbTree::Set(int32_t id, const Rect& bounds) {
+		auto found = this->leaves_.find(id);
+		int leaf;
+
+		if (found != this->leaves_.end()) {
+			leaf = found->second;
+			this->nodes_[leaf].bounds = bounds;
+
+			// Small moves stay inside the margin and cost nothing more
+			if (contains(this->nodes_[leaf].box, bounds)) {
+				return;
+			}
+
+			this->RemoveLeaf(leaf);
+		} else {
+			leaf = this->AllocateNode();
+			this->nodes_[leaf].id = id;
+			this->nodes_[leaf].bounds = bounds;
+			this->nodes_[leaf].order = this->next_order_++;
+			this->leaves_[id] = leaf;
+		}
+
+		this->nodes_[leaf].box = { bounds.min_x - box_margin, bounds.min_y - box_margin, bounds.max_x + box_margin, bounds.max_y + box_margin };
+		this->InsertLeaf(leaf);
+	}
+
+	bool AabbTree::Remove(int32_t id) {
+		auto found = this->leaves_.find(id);
+
+		if (found == this->leaves_.end()) {
+			return false;
+		}
+
+		this->RemoveLeaf(found->second);
+		this->FreeNode(found->second);
+		this->leaves_.erase(found);
+
+		return true;
+	}
+
+	void AabbTree::Clear() {
+		this->nodes_.clear();
+		this->leaves_.clear();
+		this->root_ = null_node;
+		this->free_list_ = null_node;
+		this->next_order_ = 0;
+	}
+
+	size_t AabbTree::GetMemorySize() {
+		// Hash nodes hold the pair and a next pointer, buckets one pointer each
+		size_t leaves = this->leaves_.size() * (sizeof(std::pair<int32_t, int>) + sizeof(void*)) + this->leaves_.bucket_count() * sizeof(void*);
+		return this->nodes_.capacity() * sizeof(Node) + this->stack_.capacity() * sizeof(int) + leaves;
+	}
+
+	bool AabbTree::GetBounds(int32_t id, Rect* bounds) {
+		auto found = this->leaves_.find(id);
+
+		if (found == this->leaves_.end()) {
+			return false;
+		}
+
+		*bounds = this->nodes_[found->second].bounds;
+		return true;
+	}
+
+	void AabbTree::InsertLeaf(int leaf) {
+		if (this->root_ == null_node) {
+			this->root_ = leaf;
+			this->nodes_[leaf].parent = null_node;
+			return;
+		}
+
+		// Walk down to the sibling whose merge grows the tree's total perimeter the least
+		Rect leaf_box = this->nodes_[leaf].box;
+		int index = this->root_;
+
+		while (this->nodes_[index].height > 0) {
+			Node& node = this->nodes_[index];
+			float area = perimeter(node.box);
+			float combined_area = perimeter(combine(node.box, leaf_box));
+
+			// Cost of pairing with this node, and the minimum growth pushed down to either child
+			float cost = 2 * combined_area;
+			float inheritance_cost = 2 * (combined_area - area);
+			float child_costs[2];
+			int children[2] = { node.child1, node.child2 };
+
+			for (int i = 0; i < 2; i++) {
+				Node& child = this->nodes_[children[i]];
+				float grown = perimeter(combine(child.box, leaf_box));
+				child_costs[i] = (child.height == 0 ? grown : grown - perimeter(child.box)) + inheritance_cost;
+			}
+
+			if (cost < child_costs[0] && cost < child_costs[1]) {
+				break;
+			}
+
+			index = child_costs[0] < child_costs[1] ? children[0] : children[1];
+		}
+
+		int sibling = index;
+		int old_parent = this->nodes_[sibling].parent;
+		int new_parent = this->AllocateNode();
+
+		this->nodes_[new_parent].parent = old_parent;
+		this->nodes_[new_parent].box = combine(leaf_box, this->nodes_[sibling].box);
+		this->nodes_[new_parent].height = this->nodes_[sibling].height + 1;
+		this->nodes_[new_parent].child1 = sibling;
+		this->nodes_[new_parent].child2 = leaf;
+		this->nodes_[sibling].parent = new_parent;
+		this->nodes_[leaf].parent = new_parent;
+
+		if (old_parent == null_node) {
+			this->root_ = new_parent;
+		} else if (this->nodes_[old_parent].child1 == sibling) {
+			this->nodes_[old_parent].child1 = new_parent;
+		} else {
+			this->nodes_[old_parent].child2 = new_parent;
+		}
+
+		this->Refit(this->nodes_[leaf].parent);
+	}
+
+	void AabbTree::RemoveLeaf(int leaf) {
+		if (leaf == this->root_) {
+			this->root_ = null_node;
+			return;
+		}
+
+		// The parent goes away and the sibling takes its place
+		int parent = this->nodes_[leaf].parent;
+		int grand_parent = this->nodes_[parent].parent;
+		int sibling = this->nodes_[parent].child1 == leaf ? this->nodes_[parent].child2 : this->nodes_[parent].child1;
+
+		if (grand_parent == null_node) {
+			this->root_ = sibling;
+			this->nodes_[sibling].parent = null_node;
+		} else {
+			if (this->nodes_[grand_parent].child1 == parent) {
+				this->nodes_[grand_parent].child1 = sibling;
+			} else {
+				this->nodes_[grand_parent].child2 = sibling;
+			}
+
+			this->nodes_[sibling].parent = grand_parent;
+			this->Refit(grand_parent);
+		}
+
+		this->FreeNode(parent);
+		this->nodes_[leaf].parent = null_node;
+	}
+
+	void AabbTree::Refit(int node) {
+		while (node != null_node) {
+			node = this->Balance(node);
+
+			Node& current = this->nodes_[node];
+			current.height = 1 + max(this->nodes_[current.child1].height, this->nodes_[current.child2].height);
+			current.box = combine(this->nodes_[current.child1].box, this->nodes_[current.child2].box);
+
+			node = current.parent;
+		}
+	}
+
+	/**
+	 * Rotate the taller grandchild up when a node's children differ in height by more than one.
+	 * @returns The node now at this position.
+	 */
+	int AabbTree::Balance(int a) {
+		Node* nodes = this->nodes_.data();
+
+		if (nodes[a].height < 2) {
+			return a;
+		}
+
+		int b = nodes[a].child1;
+		int c = nodes[a].child2;
+		int balance = nodes[c].height - nodes[b].height;
+
+		if (balance >= -1 && balance <= 1) {
+			return a;
+		}
+
+		// Same rotation either way, with the taller child promoted
+		bool promote_c = balance > 1;
+		int up = promote_c ? c : b;
+		int other = promote_c ? b : c;
+		int f = nodes[up].child1;
+		int g = nodes[up].child2;
+
+		nodes[up].child1 = a;
+		nodes[up].parent = nodes[a].parent;
+		nodes[a].parent = up;
+
+		if (nodes[up].parent == null_node) {
+			this->root_ = up;
+		} else if (nodes[nodes[up].parent].child1 == a) {
+			nodes[nodes[up].parent].child1 = up;
+		} else {
+			nodes[nodes[up].parent].child2 = up;
+		}
+
+		// The taller grandchild stays with the promoted node, the shorter one moves down to a
+		int kept = nodes[f].height > nodes[g].height ? f : g;
+		int moved = kept == f ? g : f;
+
+		nodes[up].child2 = kept;
+
+		if (promote_c) {
+			nodes[a].child2 = moved;
+		} else {
+			nodes[a].child1 = moved;
+		}
+
+		nodes[moved].parent = a;
+		nodes[a].box = combine(nodes[other].box, nodes[moved].box);
+		nodes[up].box = combine(nodes[a].box, nodes[kept].box);
+		nodes[a].height = 1 + max(nodes[other].height, nodes[moved].height);
+		nodes[up].height = 1 + max(nodes[a].height, nodes[kept].height);
+
+		return up;
+	}
+
+	bool AabbTree::HitTest(float x, float y, int32_t* id) {
+		if (this->root_ == null_node) {
+			return false;
+		}
+
+		bool found = false;
+		uint64_t top_order = 0;
+
+		this->stack_.clear();
+		this->stack_.push_back(this->root_);
+
+		while (!this->stack_.empty()) {
+			const Node& node = this->nodes_[this->stack_.back()];
+			this->stack_.pop_back();
+
+			if (!contains_point(node.box, x, y)) {
+				continue;
+			}
+
+			if (node.height == 0) {
+				if (contains_point(node.bounds, x, y) && (!found || node.order > top_order)) {
+					found = true;
+					top_order = node.order;
+					*id = node.id;
+				}
+			} else {
+				this->stack_.push_back(node.child1);
+				this->stack_.push_back(node.child2);
+			}
+		}
+
+		return found;
+	}
+
+	void AabbTree::Query(const Rect& area, function<void(int32_t id)> callback) {
+		if (this->root_ == null_node) {
+			return;
+		}
+
+		// Callbacks may query again, so this one gets a stack of its own
+		vector<int> stack;
+		stack.push_back(this->root_);
+
+		while (!stack.empty()) {
+			const Node& node = this->nodes_[stack.back()];
+			stack.pop_back();
+
+			if (!overlaps(node.box, area)) {
+				continue;
+			}
+
+			if (node.height == 0) {
+				if (overlaps(node.bounds, area)) {
+					callback(node.id);
+				}
+			} else {
+				stack.push_back(node.child1);
+				stack.push_back(node.child2);
+			}
+		}
+	}
+}
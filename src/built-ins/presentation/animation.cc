@@ -0,0 +1,525 @@
+#include <functional>
+#include <v8.h>
+#include <gtk-3.0/gtk/gtk.h>
+#include <piston_native_class.h>
+#include <piston_native_module.h>
+#include <built-ins/presentation/animation.h>
+#include <built-ins/presentation/layer.h>
+#include <built-ins/presentation/drawing_area.h>
+#include <built-ins/presentation/window.h>
+#include <built-ins/presentation/headless.h>
+#include <runtime/event_dispatcher.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+using namespace v8;
+using namespace std;
+
+namespace mosaic::presentation {
+	double Easing::Evaluate(double t) const {
+		if (t <= 0) {
+			return 0;
+		} else if (t >= 1) {
+			return 1;
+		}
+
+		// Polynomial coefficients of both coordinates, with P0 = (0, 0) and P3 = (1, 1)
+		double cx = 3 * this->x1;
+		double bx = 3 * (this->x2 - this->x1) - cx;
+		double ax = 1 - cx - bx;
+		double cy = 3 * this->y1;
+		double by = 3 * (this->y2 - this->y1) - cy;
+		double ay = 1 - cy - by;
+
+		// Find the curve parameter whose x is t, Newton first and bisection when it stalls
+		double s = t;
+
+		for (int i = 0; i < 8; i++) {
+			double x = ((ax * s + bx) * s + cx) * s - t;
+			double slope = (3 * ax * s + 2 * bx) * s + cx;
+
+			if (fabs(x) < 1e-6) {
+				return ((ay * s + by) * s + cy) * s;
+			}
+
+			if (fabs(slope) < 1e-6) {
+				break;
+			}
+
+			s -= x / slope;
+		}
+
+		double low = 0;
+		double high = 1;
+		s = t;
+
+		while (high - low > 1e-6) {
+			double x = ((ax * s + bx) * s + cx) * s;
+
+			if (x < t) {
+				low = s;
+			} else {
+				high = s;
+			}
+
+			s = (low + high) / 2;
+		}
+
+		return ((ay * s + by) * s + cy) * s;
+	}
+
+	bool Easing::FromName(const char* name, Easing* easing) {
+		static const struct {
+			const char* name;
+			Easing easing;
+		} named[] = {
+			{ "linear", { 0, 0, 1, 1 } },
+			{ "ease", { 0.25, 0.1, 0.25, 1 } },
+			{ "ease-in", { 0.42, 0, 1, 1 } },
+			{ "ease-out", { 0, 0, 0.58, 1 } },
+			{ "ease-in-out", { 0.42, 0, 0.58, 1 } }
+		};
+
+		for (auto& entry : named) {
+			if (strcmp(entry.name, name) == 0) {
+				*easing = entry.easing;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	Animation::Animation() {
+		this->clock_widget_ = NULL;
+		this->tick_id_ = 0;
+		this->release_source_id_ = 0;
+		this->running_ = false;
+		this->start_time_ = -1;
+		this->has_from_ = false;
+		this->from_ = 0;
+		this->start_value_ = 0;
+		this->to_ = 0;
+		this->duration_ = 250;
+		this->delay_ = 0;
+		this->iterations_ = 1;
+		this->alternate_ = false;
+		Easing::FromName("ease", &this->easing_);
+	}
+
+	Animation::~Animation() {
+		this->RemoveTick();
+		this->SetClockWidget(NULL);
+
+		if (this->release_source_id_ != 0) {
+			g_source_remove(this->release_source_id_);
+		}
+
+		this->finish_callback_.Reset();
+		this->target_.Reset();
+	}
+
+	void Animation::SetClockWidget(GtkWidget* widget) {
+		// Closing a window destroys its widget while ticks may still have to be removed from it
+		if (widget != NULL) {
+			g_object_ref(widget);
+		}
+
+		if (this->clock_widget_ != NULL) {
+			g_object_unref(this->clock_widget_);
+		}
+
+		this->clock_widget_ = widget;
+	}
+
+	bool Animation::BindProperty(Local<Context> context, Local<Object> target, const char* property) {
+		this->target_.Reset(context->GetIsolate(), target);
+
+		if (Layer::HasInstance(context->GetIsolate(), target)) {
+			Layer* layer = Layer::Unwrap(target);
+			this->SetClockWidget(layer->GetOwner()->GetGtkWidget());
+
+			if (strcmp(property, "x") == 0) {
+				this->getter_ = [layer]() { return layer->GetX(); };
+				this->setter_ = [layer](double value) { layer->SetPosition(value, layer->GetY()); };
+			} else if (strcmp(property, "y") == 0) {
+				this->getter_ = [layer]() { return layer->GetY(); };
+				this->setter_ = [layer](double value) { layer->SetPosition(layer->GetX(), value); };
+			} else if (strcmp(property, "opacity") == 0) {
+				this->getter_ = [layer]() { return layer->GetOpacity(); };
+				this->setter_ = [layer](double value) { layer->SetOpacity(clamp(value, 0.0, 1.0)); };
+			} else {
+				return false;
+			}
+
+			return true;
+		}
+
+		if (Window::HasInstance(context->GetIsolate(), target)) {
+			Window* window = Window::Unwrap(target);
+			this->SetClockWidget(window->GetGtkWidget());
+
+			if (strcmp(property, "width") == 0) {
+				this->getter_ = [window]() { return (double)window->GetWidth(); };
+				this->setter_ = [window](double value) { window->SetWidth((int)round(value)); };
+			} else if (strcmp(property, "height") == 0) {
+				this->getter_ = [window]() { return (double)window->GetHeight(); };
+				this->setter_ = [window](double value) { window->SetHeight((int)round(value)); };
+			} else {
+				return false;
+			}
+
+			return true;
+		}
+
+		return false;
+	}
+
+	void Animation::Start() {
+		this->RemoveTick();
+
+		// Without 'from', animations pick up from wherever the property is now
+		this->start_value_ = this->has_from_ ? this->from_ : this->getter_();
+		this->start_time_ = -1;
+		this->running_ = true;
+
+		// Ticks point at this object, a running animation can't be collected
+		this->ClearWeak();
+
+		if (this->clock_widget_ == NULL) {
+			this->tick_id_ = Headless::AddTickCallback([this](gint64 frame_time) {
+				return this->Tick(frame_time);
+			});
+		} else {
+			this->tick_id_ = gtk_widget_add_tick_callback(this->clock_widget_, +[](GtkWidget* widget, GdkFrameClock* clock, gpointer user_data) -> gboolean {
+				Animation* self = (Animation*)user_data;
+				return self->Tick(gdk_frame_clock_get_frame_time(clock)) ? G_SOURCE_CONTINUE : G_SOURCE_REMOVE;
+			}, this, NULL);
+		}
+	}
+
+	void Animation::Cancel() {
+		this->RemoveTick();
+		this->running_ = false;
+		this->MakeWeak();
+	}
+
+	void Animation::Finish() {
+		if (this->running_) {
+			this->RemoveTick();
+			this->Complete();
+		}
+	}
+
+	bool Animation::Tick(gint64 frame_time) {
+		// Time starts at the first frame, not at start(), so nothing is skipped while a frame is pending
+		if (this->start_time_ < 0) {
+			this->start_time_ = frame_time;
+		}
+
+		double elapsed = (frame_time - this->start_time_) / 1000.0 - this->delay_;
+
+		if (elapsed < 0) {
+			return true;
+		}
+
+		double progress = this->duration_ > 0 ? elapsed / this->duration_ : this->iterations_;
+
+		if (progress >= this->iterations_) {
+			// The clock drops the tick itself once it returns false
+			this->tick_id_ = 0;
+			this->Complete();
+
+			return false;
+		}
+
+		this->setter_(this->Sample(progress));
+		return true;
+	}
+
+	double Animation::Sample(double progress) {
+		double iteration = floor(progress);
+		double t = progress - iteration;
+
+		// The end of an iteration belongs to it, not to the start of the next one
+		if (t == 0 && progress > 0) {
+			iteration -= 1;
+			t = 1;
+		}
+
+		if (this->alternate_ && fmod(iteration, 2) == 1) {
+			t = 1 - t;
+		}
+
+		return this->start_value_ + (this->to_ - this->start_value_) * this->easing_.Evaluate(t);
+	}
+
+	void Animation::Complete() {
+		this->running_ = false;
+		this->setter_(this->Sample(this->iterations_));
+
+		if (this->finish_callback_.IsEmpty()) {
+			this->MakeWeak();
+			return;
+		}
+
+		mosaic::runtime::EventDispatcher::GetInstance()->Post("animation-finish", &this->finish_callback_, {});
+
+		// The event points at finish_callback_, so stay alive until after events were dispatched
+		if (this->release_source_id_ == 0) {
+			this->release_source_id_ = g_idle_add(ReleaseCallback, this);
+		}
+	}
+
+	gboolean Animation::ReleaseCallback(gpointer user_data) {
+		Animation* self = (Animation*)user_data;
+		self->release_source_id_ = 0;
+
+		if (!self->running_) {
+			self->MakeWeak();
+		}
+
+		return G_SOURCE_REMOVE;
+	}
+
+	void Animation::RemoveTick() {
+		if (this->tick_id_ == 0) {
+			return;
+		}
+
+		if (this->clock_widget_ == NULL) {
+			Headless::RemoveTickCallback(this->tick_id_);
+		} else {
+			gtk_widget_remove_tick_callback(this->clock_widget_, this->tick_id_);
+		}
+
+		this->tick_id_ = 0;
+	}
+
+	Local<Function> Animation::Make(Local<Context> context) {
+		Isolate* isolate = context->GetIsolate();
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<FunctionTemplate> class_tpl = FunctionTemplate::New(isolate, ConstructorCallback);
+		class_tpl->SetClassName(String::NewFromUtf8(isolate, "Animation").ToLocalChecked());
+		class_tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+		Local<ObjectTemplate> proto_tpl = class_tpl->PrototypeTemplate();
+		proto_tpl->Set(String::NewFromUtf8(isolate, "start").ToLocalChecked(), FunctionTemplate::New(isolate, StartCallback));
+		proto_tpl->Set(String::NewFromUtf8(isolate, "cancel").ToLocalChecked(), FunctionTemplate::New(isolate, CancelCallback));
+		proto_tpl->Set(String::NewFromUtf8(isolate, "finish").ToLocalChecked(), FunctionTemplate::New(isolate, FinishCallback));
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "running").ToLocalChecked(), GetRunningCallback);
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "onFinish").ToLocalChecked(), GetOnFinishCallback, SetOnFinishCallback);
+
+		return handle_scope.Escape(class_tpl->GetFunction(context).ToLocalChecked());
+	}
+
+	static bool get_number_option(Local<Context> context, Local<Object> options, const char* name, double* value) {
+		Isolate* isolate = context->GetIsolate();
+		Local<Value> option = options->Get(context, String::NewFromUtf8(isolate, name).ToLocalChecked()).ToLocalChecked();
+
+		if (option->IsUndefined()) {
+			return false;
+		}
+
+		*value = option->NumberValue(context).FromMaybe(*value);
+		return true;
+	}
+
+	static bool get_easing_option(Local<Context> context, Local<Object> options, Easing* easing) {
+		Isolate* isolate = context->GetIsolate();
+		Local<Value> option = options->Get(context, String::NewFromUtf8(isolate, "easing").ToLocalChecked()).ToLocalChecked();
+
+		if (option->IsUndefined()) {
+			return Easing::FromName("ease", easing);
+		}
+
+		if (option->IsString()) {
+			String::Utf8Value name(isolate, option);
+			return Easing::FromName(*name, easing);
+		}
+
+		// Control points of a cubic-bezier(), as [x1, y1, x2, y2]
+		if (option->IsArray() && Local<Array>::Cast(option)->Length() == 4) {
+			Local<Array> points = Local<Array>::Cast(option);
+			double values[4];
+
+			for (uint32_t i = 0; i < 4; i++) {
+				values[i] = points->Get(context, i).ToLocalChecked()->NumberValue(context).FromMaybe(0.0);
+			}
+
+			*easing = { clamp(values[0], 0.0, 1.0), values[1], clamp(values[2], 0.0, 1.0), values[3] };
+			return true;
+		}
+
+		return false;
+	}
+
+	void Animation::ConstructorCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+
+		if (!args.IsConstructCall()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Please use the 'new' operator, this constructor cannot be called as a function.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		if (args.Length() < 3 || !args[0]->IsObject() || !args[1]->IsString() || !args[2]->IsObject()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to instantiate class: expected a target, a property name and options.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		Animation* instance = new Animation();
+
+		String::Utf8Value property(isolate, args[1]);
+
+		if (!instance->BindProperty(context, Local<Object>::Cast(args[0]), *property)) {
+			delete instance;
+
+			string message = string("Unable to instantiate class: '") + *property + "' can't be animated on this object.";
+			isolate->ThrowException(Exception::TypeError(String::NewFromUtf8(isolate, message.c_str()).ToLocalChecked()));
+
+			return;
+		}
+
+		Local<Object> options = Local<Object>::Cast(args[2]);
+
+		if (!get_number_option(context, options, "to", &instance->to_)) {
+			delete instance;
+
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to instantiate class: the 'to' option is required.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		if (!get_easing_option(context, options, &instance->easing_)) {
+			delete instance;
+
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to instantiate class: easing must be a curve name or four control point coordinates.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		instance->has_from_ = get_number_option(context, options, "from", &instance->from_);
+		get_number_option(context, options, "duration", &instance->duration_);
+		get_number_option(context, options, "delay", &instance->delay_);
+		get_number_option(context, options, "iterations", &instance->iterations_);
+		instance->alternate_ = options->Get(context, String::NewFromUtf8(isolate, "alternate").ToLocalChecked()).ToLocalChecked()->BooleanValue(isolate);
+
+		if (!(instance->duration_ >= 0) || !(instance->iterations_ > 0)) {
+			delete instance;
+
+			isolate->ThrowException(Exception::RangeError(
+				String::NewFromUtf8(isolate, "Unable to instantiate class: duration can't be negative and iterations must be positive.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		instance->Wrap(args.This());
+		instance->MakeWeak();
+		args.GetReturnValue().Set(args.This());
+	}
+
+	void Animation::StartCallback(const FunctionCallbackInfo<Value> &args) {
+		Animation* self = NativeClass::Unwrap(args.This());
+		self->Start();
+	}
+
+	void Animation::CancelCallback(const FunctionCallbackInfo<Value> &args) {
+		Animation* self = NativeClass::Unwrap(args.This());
+		self->Cancel();
+	}
+
+	void Animation::FinishCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		Animation* self = NativeClass::Unwrap(args.This());
+
+		if (isinf(self->iterations_)) {
+			isolate->ThrowException(Exception::RangeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: endless animations can't be finished.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		self->Finish();
+	}
+
+	void Animation::GetRunningCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Animation* self = NativeClass::Unwrap(info.This());
+		info.GetReturnValue().Set(Boolean::New(info.GetIsolate(), self->IsRunning()));
+	}
+
+	void Animation::GetOnFinishCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Isolate* isolate = info.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Animation* self = NativeClass::Unwrap(info.This());
+
+		Local<Function> callback = Local<Function>::New(isolate, self->finish_callback_);
+		info.GetReturnValue().Set(callback);
+	}
+
+	void Animation::SetOnFinishCallback(Local<String> property, Local<Value> value, const PropertyCallbackInfo<void>& info) {
+		Isolate* isolate = info.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Animation* self = NativeClass::Unwrap(info.This());
+
+		if (value->IsFunction()) {
+			self->finish_callback_.Reset(isolate, Local<Function>::Cast(value));
+		} else if (value->IsNullOrUndefined()) {
+			self->finish_callback_.Reset();
+		} else {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Failed to set callback. It must be a function.").ToLocalChecked()
+			));
+		}
+	}
+
+	Local<Module> AnimationModule::Make(Isolate* isolate) {
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<Module> module = Module::CreateSyntheticModule(
+			isolate,
+			String::NewFromUtf8(isolate, "Animation").ToLocalChecked(),
+			{
+				String::NewFromUtf8(isolate, "default").ToLocalChecked(),
+				String::NewFromUtf8(isolate, "Animation").ToLocalChecked()
+			},
+			[](Local<Context> context, Local<Module> module) -> MaybeLocal<Value> {
+				Isolate* isolate = context->GetIsolate();
+				HandleScope handle_scope(isolate);
+
+				Local<Function> constructor = Animation::GetConstructor(context);
+
+				module->SetSyntheticModuleExport(
+					isolate,
+					String::NewFromUtf8(isolate, "default").ToLocalChecked(),
+					constructor
+				);
+
+				module->SetSyntheticModuleExport(
+					isolate,
+					String::NewFromUtf8(isolate, "Animation").ToLocalChecked(),
+					constructor
+				);
+
+				return MaybeLocal<Value>(True(isolate));
+			}
+		);
+
+		return handle_scope.Escape(module);
+	}
+}
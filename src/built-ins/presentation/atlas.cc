@@ -0,0 +1,396 @@
+#include <functional>
+#include <v8.h>
+#include <gtk-3.0/gtk/gtk.h>
+#include <piston_native_class.h>
+#include <piston_native_module.h>
+#include <built-ins/presentation/atlas.h>
+#include <built-ins/presentation/image.h>
+#include <built-ins/presentation/image_data.h>
+#include <cairo.h>
+#include <limits.h>
+#include <math.h>
+#include "loader.h"
+
+using namespace v8;
+using namespace std;
+
+namespace mosaic::presentation {
+	// Transparent gutter right and below each sprite, so filtering never samples a neighbour
+	static const int sprite_padding = 1;
+
+	Atlas::Atlas(int page_width, int page_height) {
+		this->page_width_ = page_width;
+		this->page_height_ = page_height;
+	}
+
+	Atlas::~Atlas() {
+		this->Clear();
+	}
+
+	bool Atlas::IsAtlas(Local<Context> context, Local<Value> value) {
+		return Atlas::HasInstance(context->GetIsolate(), value);
+	}
+
+	Local<Function> Atlas::Make(Local<Context> context) {
+		Isolate* isolate = context->GetIsolate();
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<FunctionTemplate> class_tpl = FunctionTemplate::New(isolate, ConstructorCallback);
+		class_tpl->SetClassName(String::NewFromUtf8(isolate, "Atlas").ToLocalChecked());
+		class_tpl->InstanceTemplate()->SetInternalFieldCount(1);
+		AddTemplate(isolate, class_tpl);
+
+		Local<ObjectTemplate> proto_tpl = class_tpl->PrototypeTemplate();
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "count").ToLocalChecked(), GetCountCallback);
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "pageCount").ToLocalChecked(), GetPageCountCallback);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "add").ToLocalChecked(), FunctionTemplate::New(isolate, AddCallback));
+		proto_tpl->Set(String::NewFromUtf8(isolate, "clear").ToLocalChecked(), FunctionTemplate::New(isolate, ClearCallback));
+		proto_tpl->Set(String::NewFromUtf8(isolate, "getSprite").ToLocalChecked(), FunctionTemplate::New(isolate, GetSpriteCallback));
+
+		return handle_scope.Escape(class_tpl->GetFunction(context).ToLocalChecked());
+	}
+
+	/**
+	 * Height the skyline would reach with a rectangle placed at a node's left edge.
+	 * @returns -1 when it doesn't fit there.
+	 */
+	int Atlas::FitSkyline(Page& page, size_t index, int width, int height) {
+		vector<SkylineNode>& skyline = page.skyline;
+		int x = skyline[index].x;
+		int y = 0;
+		int remaining = width;
+
+		if (x + width > this->page_width_) {
+			return -1;
+		}
+
+		// The rectangle rests on the highest span it covers
+		for (size_t i = index; remaining > 0; i++) {
+			y = max(y, skyline[i].y);
+
+			if (y + height > this->page_height_) {
+				return -1;
+			}
+
+			remaining -= skyline[i].width;
+		}
+
+		return y;
+	}
+
+	bool Atlas::Pack(Page& page, int width, int height, int* x, int* y) {
+		vector<SkylineNode>& skyline = page.skyline;
+		size_t best_index = SIZE_MAX;
+		int best_bottom = INT_MAX;
+		int best_width = INT_MAX;
+
+		// Bottom-left: lowest resulting top edge, then the narrowest span to waste less
+		for (size_t i = 0; i < skyline.size(); i++) {
+			int top = this->FitSkyline(page, i, width, height);
+
+			if (top >= 0 && (top + height < best_bottom || (top + height == best_bottom && skyline[i].width < best_width))) {
+				best_index = i;
+				best_bottom = top + height;
+				best_width = skyline[i].width;
+				*x = skyline[i].x;
+				*y = top;
+			}
+		}
+
+		if (best_index == SIZE_MAX) {
+			return false;
+		}
+
+		skyline.insert(skyline.begin() + best_index, { *x, best_bottom, width });
+
+		// Spans now under the new one shrink or go away
+		for (size_t i = best_index + 1; i < skyline.size(); i++) {
+			int covered = skyline[i - 1].x + skyline[i - 1].width - skyline[i].x;
+
+			if (covered <= 0) {
+				break;
+			}
+
+			skyline[i].x += covered;
+			skyline[i].width -= covered;
+
+			if (skyline[i].width > 0) {
+				break;
+			}
+
+			skyline.erase(skyline.begin() + i);
+			i--;
+		}
+
+		for (size_t i = 1; i < skyline.size(); i++) {
+			if (skyline[i - 1].y == skyline[i].y) {
+				skyline[i - 1].width += skyline[i].width;
+				skyline.erase(skyline.begin() + i);
+				i--;
+			}
+		}
+
+		return true;
+	}
+
+	int Atlas::Add(cairo_surface_t* surface) {
+		int width = cairo_image_surface_get_width(surface);
+		int height = cairo_image_surface_get_height(surface);
+		int padded_width = width + sprite_padding;
+		int padded_height = height + sprite_padding;
+
+		if (width > this->page_width_ || height > this->page_height_) {
+			return -1;
+		}
+
+		// A page too small for the gutter can still hold the sprite at its edge
+		padded_width = min(padded_width, this->page_width_);
+		padded_height = min(padded_height, this->page_height_);
+
+		Sprite sprite = { -1, 0, 0, width, height };
+
+		for (size_t i = 0; i < this->pages_.size() && sprite.page < 0; i++) {
+			if (this->Pack(this->pages_[i], padded_width, padded_height, &sprite.x, &sprite.y)) {
+				sprite.page = i;
+			}
+		}
+
+		if (sprite.page < 0) {
+			Page page;
+			page.surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, this->page_width_, this->page_height_);
+			page.pattern = cairo_pattern_create_for_surface(page.surface);
+			page.skyline.push_back({ 0, 0, this->page_width_ });
+
+			this->Pack(page, padded_width, padded_height, &sprite.x, &sprite.y);
+			this->pages_.push_back(page);
+			sprite.page = this->pages_.size() - 1;
+
+			// Pixels live outside of the V8 heap, tell the GC about them
+			Isolate::GetCurrent()->AdjustAmountOfExternalAllocatedMemory((int64_t)cairo_image_surface_get_stride(page.surface) * this->page_height_);
+		}
+
+		cairo_t* cr = cairo_create(this->pages_[sprite.page].surface);
+		cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+		cairo_set_source_surface(cr, surface, sprite.x, sprite.y);
+		cairo_rectangle(cr, sprite.x, sprite.y, width, height);
+		cairo_fill(cr);
+		cairo_destroy(cr);
+
+		this->sprites_.push_back(sprite);
+		return this->sprites_.size() - 1;
+	}
+
+	void Atlas::Clear() {
+		int64_t size = 0;
+
+		for (Page& page : this->pages_) {
+			size += (int64_t)cairo_image_surface_get_stride(page.surface) * this->page_height_;
+			cairo_pattern_destroy(page.pattern);
+			cairo_surface_destroy(page.surface);
+		}
+
+		this->pages_.clear();
+		this->sprites_.clear();
+		Isolate::GetCurrent()->AdjustAmountOfExternalAllocatedMemory(-size);
+	}
+
+	void Atlas::Draw(cairo_t* cairo_context, const float* instances, size_t count) {
+		cairo_t* cr = cairo_context;
+		cairo_matrix_t base;
+		cairo_matrix_t offset;
+
+		cairo_save(cr);
+		cairo_get_matrix(cr, &base);
+		cairo_new_path(cr);
+
+		for (size_t i = 0; i < count; i++) {
+			const float* instance = instances + i * instance_stride;
+			float index = instance[0];
+			float scale = instance[3];
+			float alpha = instance[5];
+
+			// Converting NaN or out of range floats to integers is undefined, so the range is checked as floats
+			if (!(index >= 0 && index < (float)this->sprites_.size()) || scale == 0 || !(alpha > 0)) {
+				continue;
+			}
+
+			// Cairo puts the whole context in an error state for non-finite matrices
+			if (!isfinite(instance[1]) || !isfinite(instance[2]) || !isfinite(instance[4]) || !isfinite(scale)) {
+				continue;
+			}
+
+			const Sprite& sprite = this->sprites_[(size_t)index];
+			cairo_pattern_t* pattern = this->pages_[sprite.page].pattern;
+
+			// Sprite space, origin at its top left corner, mapped onto the instance
+			cairo_set_matrix(cr, &base);
+			cairo_translate(cr, instance[1], instance[2]);
+
+			if (instance[4] != 0) {
+				cairo_rotate(cr, instance[4]);
+			}
+
+			if (scale != 1) {
+				cairo_scale(cr, scale, scale);
+			}
+
+			cairo_translate(cr, -sprite.width / 2.0, -sprite.height / 2.0);
+
+			// Page patterns are shared by every sprite, only the offset into the page changes
+			cairo_matrix_init_translate(&offset, sprite.x, sprite.y);
+			cairo_pattern_set_matrix(pattern, &offset);
+			cairo_set_source(cr, pattern);
+			cairo_rectangle(cr, 0, 0, sprite.width, sprite.height);
+
+			if (alpha >= 1) {
+				cairo_fill(cr);
+			} else {
+				cairo_save(cr);
+				cairo_clip(cr);
+				cairo_paint_with_alpha(cr, alpha);
+				cairo_restore(cr);
+			}
+		}
+
+		cairo_restore(cr);
+	}
+
+	void Atlas::ConstructorCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+
+		if (!args.IsConstructCall()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Please use the 'new' operator, this constructor cannot be called as a function.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		int page_width = args.Length() > 0 ? args[0]->Int32Value(context).FromMaybe(0) : 1024;
+		int page_height = args.Length() > 1 ? args[1]->Int32Value(context).FromMaybe(0) : page_width;
+
+		if (page_width <= 0 || page_height <= 0) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to instantiate class: page width and height must be positive numbers.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		Atlas* instance = new Atlas(page_width, page_height);
+		instance->Wrap(args.This());
+		instance->MakeWeak();
+		args.GetReturnValue().Set(args.This());
+	}
+
+	void Atlas::AddCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+		Atlas* self = Atlas::Unwrap(args.This());
+		cairo_surface_t* surface = NULL;
+
+		if (args.Length() > 0 && Image::IsImage(context, args[0])) {
+			surface = Image::Unwrap(Local<Object>::Cast(args[0]))->GetSurface();
+		} else if (args.Length() > 0 && ImageData::IsImageData(context, args[0])) {
+			ImageData* image_data = ImageData::Unwrap(Local<Object>::Cast(args[0]));
+
+			// Its pixels may have been written from JS since cairo last looked
+			image_data->MarkDirty();
+			surface = image_data->GetSurface();
+		} else {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: first argument must be an Image or an ImageData.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		int index = self->Add(surface);
+
+		if (index < 0) {
+			isolate->ThrowException(Exception::RangeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: image is larger than an atlas page.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		args.GetReturnValue().Set(Integer::New(isolate, index));
+	}
+
+	void Atlas::ClearCallback(const FunctionCallbackInfo<Value> &args) {
+		Atlas::Unwrap(args.This())->Clear();
+	}
+
+	void Atlas::GetSpriteCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+		Atlas* self = Atlas::Unwrap(args.This());
+
+		int index = args.Length() > 0 ? args[0]->Int32Value(context).FromMaybe(-1) : -1;
+
+		if (index < 0 || (size_t)index >= self->sprites_.size()) {
+			args.GetReturnValue().SetUndefined();
+			return;
+		}
+
+		const Sprite& sprite = self->sprites_[index];
+		Local<Object> object = Object::New(isolate);
+		object->Set(context, String::NewFromUtf8(isolate, "page").ToLocalChecked(), Integer::New(isolate, sprite.page)).Check();
+		object->Set(context, String::NewFromUtf8(isolate, "x").ToLocalChecked(), Integer::New(isolate, sprite.x)).Check();
+		object->Set(context, String::NewFromUtf8(isolate, "y").ToLocalChecked(), Integer::New(isolate, sprite.y)).Check();
+		object->Set(context, String::NewFromUtf8(isolate, "width").ToLocalChecked(), Integer::New(isolate, sprite.width)).Check();
+		object->Set(context, String::NewFromUtf8(isolate, "height").ToLocalChecked(), Integer::New(isolate, sprite.height)).Check();
+
+		args.GetReturnValue().Set(object);
+	}
+
+	void Atlas::GetCountCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Atlas* self = Atlas::Unwrap(info.This());
+		info.GetReturnValue().Set(Integer::New(info.GetIsolate(), self->GetSpriteCount()));
+	}
+
+	void Atlas::GetPageCountCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Atlas* self = Atlas::Unwrap(info.This());
+		info.GetReturnValue().Set(Integer::New(info.GetIsolate(), self->GetPageCount()));
+	}
+
+	Local<Module> AtlasModule::Make(Isolate* isolate) {
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<Module> module = Module::CreateSyntheticModule(
+			isolate,
+			String::NewFromUtf8(isolate, "Atlas").ToLocalChecked(),
+			{
+				String::NewFromUtf8(isolate, "default").ToLocalChecked(),
+				String::NewFromUtf8(isolate, "Atlas").ToLocalChecked()
+			},
+			[](Local<Context> context, Local<Module> module) -> MaybeLocal<Value> {
+				Isolate* isolate = context->GetIsolate();
+				HandleScope handle_scope(isolate);
+
+				Local<Function> constructor = Atlas::GetConstructor(context);
+
+				module->SetSyntheticModuleExport(
+					isolate,
+					String::NewFromUtf8(isolate, "default").ToLocalChecked(),
+					constructor
+				);
+
+				module->SetSyntheticModuleExport(
+					isolate,
+					String::NewFromUtf8(isolate, "Atlas").ToLocalChecked(),
+					constructor
+				);
+
+				return MaybeLocal<Value>(True(isolate));
+			}
+		);
+
+		return handle_scope.Escape(module);
+	}
+}
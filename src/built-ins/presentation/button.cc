@@ -4,6 +4,8 @@
 #include <piston_native_class.h>
 #include <piston_native_module.h>
 #include <built-ins/presentation/button.h>
+#include <built-ins/presentation/headless.h>
+#include <runtime/event_dispatcher.h>
 #include <stdio.h>
 #include <glib.h>
 #include "loader.h"
@@ -17,15 +19,10 @@ namespace mosaic::presentation {
 		gtk_widget_show(this->GetGtkWidget());
 
 		g_signal_connect(this->GetGtkWidget(), "clicked", G_CALLBACK(+[](GtkButton* button, gpointer user_data) {
-			Isolate* isolate = Isolate::GetCurrent();
-			HandleScope handle_scope(isolate);
-			Local<Context> context = isolate->GetCurrentContext();
-
 			Button* self = (Button*)user_data;
-			Local<Function> callback = Local<Function>::New(isolate, self->click_callback_);
 
-			if (!callback.IsEmpty()) {
-				callback->Call(context, context->Global(), 0, NULL);
+			if (!self->click_callback_.IsEmpty()) {
+				mosaic::runtime::EventDispatcher::GetInstance()->Post("click", &self->click_callback_, {});
 			}
 		}), this);
 	}
@@ -57,6 +54,14 @@ namespace mosaic::presentation {
 		Isolate* isolate = args.GetIsolate();
 		HandleScope handle_scope(isolate);
 
+		if (Headless::IsEnabled()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to instantiate class: buttons need a display, they aren't available in headless mode.").ToLocalChecked()
+			));
+
+			return;
+		}
+
 		if (args.IsConstructCall()) {
 			if (args.Length() < 1) {
 				isolate->ThrowException(Exception::TypeError(
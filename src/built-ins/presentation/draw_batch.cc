@@ -0,0 +1,354 @@
+#include <gtk-3.0/gtk/gtk.h>
+#include <cairo.h>
+#include <math.h>
+#include <unordered_map>
+#include <built-ins/presentation/draw_batch.h>
+#include <built-ins/presentation/draw_commands.h>
+
+using namespace std;
+
+namespace mosaic::presentation {
+	static inline uint32_t get_color(const uint32_t* colors, size_t color_count, size_t index) {
+		return color_count == 1 ? colors[0] : colors[index];
+	}
+
+	static inline bool is_transparent(uint32_t color) {
+		return (color & 0xff) == 0;
+	}
+
+	static inline bool is_opaque(uint32_t color) {
+		return (color & 0xff) == 0xff;
+	}
+
+	static inline bool is_integer(double value) {
+		return value == floor(value);
+	}
+
+	static void set_source_color(cairo_t* cr, uint32_t color) {
+		cairo_set_source_rgba(cr, (color >> 24) / 255.0, ((color >> 16) & 0xff) / 255.0, ((color >> 8) & 0xff) / 255.0, (color & 0xff) / 255.0);
+	}
+
+	static void encode_color(vector<float>* commands, uint32_t color) {
+		commands->insert(commands->end(), {
+			DRAW_COMMAND_SET_COLOR,
+			(float)(color >> 24),
+			(float)((color >> 16) & 0xff),
+			(float)((color >> 8) & 0xff),
+			(color & 0xff) / 255.0f
+		});
+	}
+
+	/* Whether user space maps whole units onto whole device pixels. */
+	static bool is_pixel_aligned(cairo_t* cr) {
+		cairo_matrix_t matrix;
+		cairo_get_matrix(cr, &matrix);
+
+		return matrix.xx == 1 && matrix.yy == 1 && matrix.xy == 0 && matrix.yx == 0 && is_integer(matrix.x0) && is_integer(matrix.y0);
+	}
+
+	/**
+	 * Call visit once per distinct color with the indices of its primitives.
+	 * Groups come in order of first appearance, indices keep array order.
+	 *
+	 * Ordered batches keep array order instead: only runs of one opaque color
+	 * are grouped, so each primitive still covers the ones before it.
+	 */
+	template<typename Visitor>
+	static void for_each_color(const uint32_t* colors, size_t color_count, size_t count, bool ordered, Visitor visit) {
+		static thread_local vector<uint32_t> order;
+		order.resize(count);
+
+		if (ordered) {
+			for (size_t i = 0; i < count; i++) {
+				order[i] = i;
+			}
+
+			for (size_t start = 0, end; start < count; start = end) {
+				uint32_t color = get_color(colors, color_count, start);
+				end = start + 1;
+
+				// Translucent primitives blend with each other, so those go one at a time
+				while (is_opaque(color) && end < count && get_color(colors, color_count, end) == color) {
+					end++;
+				}
+
+				visit(color, order.data() + start, end - start);
+			}
+
+			return;
+		}
+
+		if (color_count == 1) {
+			for (size_t i = 0; i < count; i++) {
+				order[i] = i;
+			}
+
+			visit(colors[0], order.data(), count);
+			return;
+		}
+
+		// Counting sort keyed by color, the last color is cached since runs are common.
+		// Scratch containers are kept per thread, cleared ones hold on to their storage.
+		static thread_local unordered_map<uint32_t, size_t> group_of;
+		static thread_local vector<uint32_t> group_colors;
+		static thread_local vector<size_t> offsets;
+		static thread_local vector<size_t> ends;
+		static thread_local vector<uint32_t> groups;
+		group_of.clear();
+		group_colors.clear();
+		offsets.clear();
+		groups.resize(count);
+
+		uint32_t last_color = 0;
+		size_t last_group = SIZE_MAX;
+
+		for (size_t i = 0; i < count; i++) {
+			uint32_t color = colors[i];
+
+			if (last_group == SIZE_MAX || color != last_color) {
+				auto found = group_of.find(color);
+
+				if (found == group_of.end()) {
+					found = group_of.emplace(color, group_colors.size()).first;
+					group_colors.push_back(color);
+					offsets.push_back(0);
+				}
+
+				last_color = color;
+				last_group = found->second;
+			}
+
+			groups[i] = last_group;
+			offsets[last_group]++;
+		}
+
+		size_t start = 0;
+
+		for (size_t& offset : offsets) {
+			size_t size = offset;
+			offset = start;
+			start += size;
+		}
+
+		ends.assign(offsets.begin(), offsets.end());
+
+		for (size_t i = 0; i < count; i++) {
+			order[ends[groups[i]]++] = i;
+		}
+
+		for (size_t group = 0; group < group_colors.size(); group++) {
+			visit(group_colors[group], order.data() + offsets[group], ends[group] - offsets[group]);
+		}
+	}
+
+	/**
+	 * Rectangle covered by an axis-aligned line with butt caps.
+	 * @returns false for diagonal and empty lines.
+	 */
+	static bool get_line_box(const float* line, double line_width, double* box) {
+		double half = line_width / 2;
+
+		if (line[1] == line[3] && line[0] != line[2]) {
+			box[0] = fmin(line[0], line[2]);
+			box[1] = line[1] - half;
+			box[2] = fabs(line[2] - line[0]);
+			box[3] = line_width;
+			return true;
+		}
+
+		if (line[0] == line[2] && line[1] != line[3]) {
+			box[0] = line[0] - half;
+			box[1] = fmin(line[1], line[3]);
+			box[2] = line_width;
+			box[3] = fabs(line[3] - line[1]);
+			return true;
+		}
+
+		return false;
+	}
+
+	void DrawBatch::FillRects(cairo_t* cr, const float* coords, size_t count, const uint32_t* colors, size_t color_count, bool ordered) {
+		bool aligned_transform = is_pixel_aligned(cr);
+
+		cairo_save(cr);
+		cairo_new_path(cr);
+		cairo_antialias_t antialias = cairo_get_antialias(cr);
+
+		for_each_color(colors, color_count, count, ordered, [&](uint32_t color, const uint32_t* indices, size_t size) {
+			if (is_transparent(color)) {
+				return;
+			}
+
+			bool aligned = aligned_transform;
+
+			for (size_t i = 0; i < size; i++) {
+				const float* rect = coords + (size_t)indices[i] * 4;
+				double x = rect[0], y = rect[1], width = rect[2], height = rect[3];
+
+				// Mixed windings would punch holes where rectangles overlap
+				if (width < 0) { x += width; width = -width; }
+				if (height < 0) { y += height; height = -height; }
+
+				cairo_rectangle(cr, x, y, width, height);
+				aligned = aligned && is_integer(x) && is_integer(y) && is_integer(width) && is_integer(height);
+			}
+
+			// Whole-pixel rectangles have no edges to smooth, this keeps cairo on its plain box fill
+			set_source_color(cr, color);
+			cairo_set_antialias(cr, aligned ? CAIRO_ANTIALIAS_NONE : antialias);
+			cairo_fill(cr);
+		});
+
+		cairo_restore(cr);
+	}
+
+	void DrawBatch::StrokeLines(cairo_t* cr, const float* coords, size_t count, const uint32_t* colors, size_t color_count, double line_width, bool ordered) {
+		bool aligned_transform = is_pixel_aligned(cr);
+
+		cairo_save(cr);
+		cairo_new_path(cr);
+		cairo_set_line_width(cr, line_width);
+		cairo_set_line_cap(cr, CAIRO_LINE_CAP_BUTT);
+		cairo_antialias_t antialias = cairo_get_antialias(cr);
+
+		static thread_local vector<double> boxes;
+
+		for_each_color(colors, color_count, count, ordered, [&](uint32_t color, const uint32_t* indices, size_t size) {
+			if (is_transparent(color)) {
+				return;
+			}
+
+			// Splitting translucent lines in two passes would blend their crossings twice
+			bool use_boxes = aligned_transform && is_opaque(color);
+			bool has_lines = false;
+			boxes.clear();
+
+			for (size_t i = 0; i < size; i++) {
+				const float* line = coords + (size_t)indices[i] * 4;
+				double box[4];
+
+				if (use_boxes && get_line_box(line, line_width, box) && is_integer(box[0]) && is_integer(box[1]) && is_integer(box[2]) && is_integer(box[3])) {
+					boxes.insert(boxes.end(), box, box + 4);
+				} else {
+					cairo_move_to(cr, line[0], line[1]);
+					cairo_line_to(cr, line[2], line[3]);
+					has_lines = true;
+				}
+			}
+
+			set_source_color(cr, color);
+
+			if (has_lines) {
+				cairo_set_antialias(cr, antialias);
+				cairo_stroke(cr);
+			}
+
+			if (!boxes.empty()) {
+				for (size_t i = 0; i < boxes.size(); i += 4) {
+					cairo_rectangle(cr, boxes[i], boxes[i + 1], boxes[i + 2], boxes[i + 3]);
+				}
+
+				cairo_set_antialias(cr, CAIRO_ANTIALIAS_NONE);
+				cairo_fill(cr);
+			}
+		});
+
+		cairo_restore(cr);
+	}
+
+	void DrawBatch::FillCircles(cairo_t* cr, const float* coords, size_t count, const uint32_t* colors, size_t color_count, bool ordered) {
+		cairo_save(cr);
+		cairo_new_path(cr);
+
+		for_each_color(colors, color_count, count, ordered, [&](uint32_t color, const uint32_t* indices, size_t size) {
+			if (is_transparent(color)) {
+				return;
+			}
+
+			for (size_t i = 0; i < size; i++) {
+				const float* circle = coords + (size_t)indices[i] * 3;
+
+				if (circle[2] > 0) {
+					cairo_new_sub_path(cr);
+					cairo_arc(cr, circle[0], circle[1], circle[2], 0, 2 * M_PI);
+				}
+			}
+
+			set_source_color(cr, color);
+			cairo_fill(cr);
+		});
+
+		cairo_restore(cr);
+	}
+
+	void DrawBatch::EncodeFillRects(vector<float>* commands, const float* coords, size_t count, const uint32_t* colors, size_t color_count, bool ordered) {
+		commands->push_back(DRAW_COMMAND_SAVE);
+
+		for_each_color(colors, color_count, count, ordered, [&](uint32_t color, const uint32_t* indices, size_t size) {
+			if (is_transparent(color)) {
+				return;
+			}
+
+			encode_color(commands, color);
+
+			for (size_t i = 0; i < size; i++) {
+				const float* rect = coords + (size_t)indices[i] * 4;
+				float x = rect[0], y = rect[1], width = rect[2], height = rect[3];
+
+				if (width < 0) { x += width; width = -width; }
+				if (height < 0) { y += height; height = -height; }
+
+				commands->insert(commands->end(), { DRAW_COMMAND_RECT, x, y, width, height });
+			}
+
+			commands->push_back(DRAW_COMMAND_FILL);
+		});
+
+		commands->push_back(DRAW_COMMAND_RESTORE);
+	}
+
+	void DrawBatch::EncodeStrokeLines(vector<float>* commands, const float* coords, size_t count, const uint32_t* colors, size_t color_count, double line_width, bool ordered) {
+		commands->insert(commands->end(), { DRAW_COMMAND_SAVE, DRAW_COMMAND_SET_LINE_WIDTH, (float)line_width });
+
+		for_each_color(colors, color_count, count, ordered, [&](uint32_t color, const uint32_t* indices, size_t size) {
+			if (is_transparent(color)) {
+				return;
+			}
+
+			encode_color(commands, color);
+
+			for (size_t i = 0; i < size; i++) {
+				const float* line = coords + (size_t)indices[i] * 4;
+				commands->insert(commands->end(), { DRAW_COMMAND_MOVE_TO, line[0], line[1], DRAW_COMMAND_LINE_TO, line[2], line[3] });
+			}
+
+			commands->push_back(DRAW_COMMAND_STROKE);
+		});
+
+		commands->push_back(DRAW_COMMAND_RESTORE);
+	}
+
+	void DrawBatch::EncodeFillCircles(vector<float>* commands, const float* coords, size_t count, const uint32_t* colors, size_t color_count, bool ordered) {
+		commands->push_back(DRAW_COMMAND_SAVE);
+
+		for_each_color(colors, color_count, count, ordered, [&](uint32_t color, const uint32_t* indices, size_t size) {
+			if (is_transparent(color)) {
+				return;
+			}
+
+			encode_color(commands, color);
+
+			for (size_t i = 0; i < size; i++) {
+				const float* circle = coords + (size_t)indices[i] * 3;
+
+				if (circle[2] > 0) {
+					commands->insert(commands->end(), { DRAW_COMMAND_CIRCLE, circle[0], circle[1], circle[2] });
+				}
+			}
+
+			commands->push_back(DRAW_COMMAND_FILL);
+		});
+
+		commands->push_back(DRAW_COMMAND_RESTORE);
+	}
+}
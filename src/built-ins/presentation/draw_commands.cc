@@ -0,0 +1,178 @@
+#include <gtk-3.0/gtk/gtk.h>
+#include <cairo.h>
+#include <math.h>
+#include <built-ins/presentation/draw_commands.h>
+
+namespace mosaic::presentation {
+	static const int argument_counts[DRAW_COMMAND_COUNT] = {
+		-1,	// Unused, keeps zeroed buffers from being valid
+		4,	// RECT
+		4,	// SET_COLOR
+		0,	// FILL
+		4,	// FILL_RECT
+		0,	// STROKE
+		1,	// SET_LINE_WIDTH
+		2,	// MOVE_TO
+		2,	// LINE_TO
+		0,	// CLOSE_PATH
+		0,	// SAVE
+		0,	// RESTORE
+		2,	// TRANSLATE
+		2,	// SCALE
+		4,	// CLEAR
+		3,	// CIRCLE
+		6	// CURVE_TO
+	};
+
+	static const char* names[DRAW_COMMAND_COUNT] = {
+		NULL,
+		"RECT",
+		"SET_COLOR",
+		"FILL",
+		"FILL_RECT",
+		"STROKE",
+		"SET_LINE_WIDTH",
+		"MOVE_TO",
+		"LINE_TO",
+		"CLOSE_PATH",
+		"SAVE",
+		"RESTORE",
+		"TRANSLATE",
+		"SCALE",
+		"CLEAR",
+		"CIRCLE",
+		"CURVE_TO"
+	};
+
+	int DrawCommands::GetArgumentCount(int command) {
+		if (command <= 0 || command >= DRAW_COMMAND_COUNT) {
+			return -1;
+		}
+
+		return argument_counts[command];
+	}
+
+	const char* DrawCommands::GetName(int command) {
+		if (command <= 0 || command >= DRAW_COMMAND_COUNT) {
+			return NULL;
+		}
+
+		return names[command];
+	}
+
+	int DrawCommands::Decode(float value) {
+		// Casting NaN, infinities or out of range floats to int is undefined
+		if (!isfinite(value) || value <= 0 || value >= DRAW_COMMAND_COUNT || value != floorf(value)) {
+			return 0;
+		}
+
+		return (int)value;
+	}
+
+	long DrawCommands::Validate(const float* data, size_t length) {
+		size_t i = 0;
+
+		while (i < length) {
+			int argc = GetArgumentCount(Decode(data[i]));
+
+			if (argc < 0 || i + 1 + argc > length) {
+				return i;
+			}
+
+			i += 1 + argc;
+		}
+
+		return -1;
+	}
+
+	long DrawCommands::Replay(cairo_t* cr, const float* data, size_t length) {
+		size_t i = 0;
+
+		while (i < length) {
+			int command = Decode(data[i]);
+			int argc = GetArgumentCount(command);
+
+			if (argc < 0 || i + 1 + argc > length) {
+				return i;
+			}
+
+			const float* a = data + i + 1;
+
+			switch (command) {
+				case DRAW_COMMAND_RECT:
+					cairo_rectangle(cr, a[0], a[1], a[2], a[3]);
+					break;
+
+				case DRAW_COMMAND_SET_COLOR:
+					cairo_set_source_rgba(cr, a[0] / 255, a[1] / 255, a[2] / 255, a[3]);
+					break;
+
+				case DRAW_COMMAND_FILL:
+					cairo_fill(cr);
+					break;
+
+				case DRAW_COMMAND_FILL_RECT:
+					cairo_rectangle(cr, a[0], a[1], a[2], a[3]);
+					cairo_fill(cr);
+					break;
+
+				case DRAW_COMMAND_STROKE:
+					cairo_stroke(cr);
+					break;
+
+				case DRAW_COMMAND_SET_LINE_WIDTH:
+					cairo_set_line_width(cr, a[0]);
+					break;
+
+				case DRAW_COMMAND_MOVE_TO:
+					cairo_move_to(cr, a[0], a[1]);
+					break;
+
+				case DRAW_COMMAND_LINE_TO:
+					cairo_line_to(cr, a[0], a[1]);
+					break;
+
+				case DRAW_COMMAND_CLOSE_PATH:
+					cairo_close_path(cr);
+					break;
+
+				case DRAW_COMMAND_SAVE:
+					cairo_save(cr);
+					break;
+
+				case DRAW_COMMAND_RESTORE:
+					cairo_restore(cr);
+					break;
+
+				case DRAW_COMMAND_TRANSLATE:
+					cairo_translate(cr, a[0], a[1]);
+					break;
+
+				case DRAW_COMMAND_SCALE:
+					cairo_scale(cr, a[0], a[1]);
+					break;
+
+				case DRAW_COMMAND_CLEAR:
+					cairo_save(cr);
+					cairo_set_source_rgba(cr, a[0] / 255, a[1] / 255, a[2] / 255, a[3]);
+					cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+					cairo_paint(cr);
+					cairo_restore(cr);
+					break;
+
+				case DRAW_COMMAND_CIRCLE:
+					cairo_new_sub_path(cr);
+					cairo_arc(cr, a[0], a[1], a[2], 0, 2 * M_PI);
+					break;
+
+				case DRAW_COMMAND_CURVE_TO:
+					cairo_curve_to(cr, a[0], a[1], a[2], a[3], a[4], a[5]);
+					break;
+			}
+
+			i += 1 + argc;
+		}
+
+		return -1;
+	}
+}
@@ -5,40 +5,576 @@
 #include <piston_native_module.h>
 #include <built-ins/presentation/drawing_area.h>
 #include <built-ins/presentation/drawing_context.h>
+#include <built-ins/presentation/image_data.h>
+#include <built-ins/presentation/path_2d.h>
+#include <built-ins/presentation/layer.h>
+#include <built-ins/presentation/draw_commands.h>
+#include <built-ins/presentation/headless.h>
+#include <runtime/event_dispatcher.h>
+#include <runtime/task_pool.h>
 #include <stdio.h>
 #include <glib.h>
+#include <cairo.h>
+#include <math.h>
+#include <algorithm>
 #include "loader.h"
 
 using namespace v8;
 using namespace std::placeholders;
+using namespace mosaic::runtime;
 
 namespace mosaic::presentation {
+	// Small enough to spread a window over every core, large enough to keep per-tile replay cheap
+	static const int tile_size = 256;
+
+	// Each patch replays the list before it, past this many onDraw records the whole area again
+	static const int max_display_list_patches = 8;
+
+	int DrawingArea::count_ = 0;
+
 	DrawingArea::DrawingArea() {
+		this->retained_ = false;
+		this->dirty_ = true;
+		this->display_list_ = NULL;
+		this->display_list_width_ = 0;
+		this->display_list_height_ = 0;
+		this->damage_ = cairo_region_create();
+		this->display_list_patches_ = 0;
+		this->tiled_ = false;
+		this->persistent_ = false;
+		this->back_buffer_ = NULL;
+		this->tiles_width_ = 0;
+		this->tiles_height_ = 0;
+		this->frame_stats_ = new FrameStats("DrawingArea #" + to_string(++count_));
+		this->headless_width_ = 0;
+		this->headless_height_ = 0;
+
+		if (Headless::IsEnabled()) {
+			this->SetGtkWidget(NULL);
+			return;
+		}
+
 		this->SetGtkWidget(gtk_drawing_area_new());
 		gtk_widget_show(this->GetGtkWidget());
 
-		g_signal_connect(this->GetGtkWidget(), "draw", G_CALLBACK(+[](GtkWidget* widget, cairo_t* cairo_context, gpointer user_data) {
-			Isolate* isolate = Isolate::GetCurrent();
-			HandleScope handle_scope(isolate);
-			Local<Context> context = isolate->GetCurrentContext();
+		// Lets containers find drawing areas among their GTK children
+		g_object_set_data(G_OBJECT(this->GetGtkWidget()), "mosaic-drawing-area", this);
 
+		g_signal_connect(this->GetGtkWidget(), "draw", G_CALLBACK(+[](GtkWidget* widget, cairo_t* cairo_context, gpointer user_data) {
 			DrawingArea* self = (DrawingArea*)user_data;
-			Local<Function> callback = Local<Function>::New(isolate, self->draw_callback_);
 
-			if (!callback.IsEmpty()) {
-				Local<Value> args[1];
-				args[0] = DrawingContext::FromCairoContext(context, cairo_context);
+			self->frame_stats_->BeginFrame();
+			self->Draw(cairo_context);
+			self->frame_stats_->EndFrame(gtk_widget_get_frame_clock(widget));
+		}), this);
+	}
+
+	static cairo_rectangle_int_t get_clip_rectangle(cairo_t* cairo_context) {
+		double x1, y1, x2, y2;
+		cairo_clip_extents(cairo_context, &x1, &y1, &x2, &y2);
+
+		int left = (int)floor(x1);
+		int top = (int)floor(y1);
+
+		return { left, top, (int)ceil(x2) - left, (int)ceil(y2) - top };
+	}
+
+	static bool region_intersects(const cairo_region_t* region, const cairo_rectangle_int_t& rectangle) {
+		if (cairo_region_is_empty(region)) {
+			return false;
+		}
+
+		cairo_region_t* intersection = cairo_region_copy(region);
+		cairo_region_intersect_rectangle(intersection, &rectangle);
+
+		bool result = !cairo_region_is_empty(intersection);
+		cairo_region_destroy(intersection);
 
-				callback->Call(context, context->Global(), 1, args);
+		return result;
+	}
+
+	static void clear_region(cairo_region_t** region) {
+		cairo_region_destroy(*region);
+		*region = cairo_region_create();
+	}
+
+	static bool rectangles_intersect(const cairo_rectangle_int_t& a, const cairo_rectangle_int_t& b) {
+		return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+	}
+
+	void DrawingArea::Draw(cairo_t* cairo_context) {
+		this->DrawContent(cairo_context);
+		this->CompositeLayers(cairo_context);
+	}
+
+	void DrawingArea::CompositeLayers(cairo_t* cairo_context) {
+		for (Layer* layer : this->attached_layers_) {
+			// Only invalidated layers run their onDraw, the rest is a single paint
+			if (layer->IsDirty()) {
+				layer->Render();
 			}
-		}), this);
+
+			layer->Composite(cairo_context, layer->GetX(), layer->GetY(), layer->GetOpacity());
+		}
+	}
+
+	void DrawingArea::DrawContent(cairo_t* cairo_context) {
+		// GTK already clipped the context to everything that needs repainting
+		cairo_rectangle_int_t clip = get_clip_rectangle(cairo_context);
+
+		if (this->persistent_) {
+			this->DrawPersistent(cairo_context);
+			return;
+		}
+
+		// Tiles keep their own pixels, whether or not the area is retained
+		if (this->tiled_) {
+			this->DrawTiled(cairo_context, clip);
+			return;
+		}
+
+		// Only the damage that falls inside of what is being repainted
+		cairo_region_t* damage = this->damage_;
+		cairo_region_intersect_rectangle(damage, &clip);
+		this->damage_ = cairo_region_create();
+
+		bool damaged = !cairo_region_is_empty(damage);
+		cairo_rectangle_int_t damage_extents;
+		cairo_region_get_extents(damage, &damage_extents);
+		cairo_region_destroy(damage);
+
+		if (!this->retained_) {
+			this->RunDrawCallback(cairo_context, clip);
+			return;
+		}
+
+		int width = this->GetWidth();
+		int height = this->GetHeight();
+		bool has_display_list = this->display_list_ != NULL && !this->dirty_ && width == this->display_list_width_ && height == this->display_list_height_;
+
+		// Record a new display list when the content or the size changed, or patches piled up
+		if (!has_display_list || (damaged && this->display_list_patches_ >= max_display_list_patches)) {
+			this->DiscardDisplayList();
+
+			cairo_rectangle_t extents = { 0, 0, (double)width, (double)height };
+			this->display_list_ = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, &extents);
+			this->display_list_width_ = width;
+			this->display_list_height_ = height;
+			this->display_list_patches_ = 0;
+
+			// Cleared first, so onDraw calling invalidate() records once more
+			this->dirty_ = false;
+
+			cairo_rectangle_int_t full = { 0, 0, width, height };
+			cairo_t* recorder = cairo_create(this->display_list_);
+			this->RunDrawCallback(recorder, full);
+			cairo_destroy(recorder);
+		} else if (damaged) {
+			// Patch the list: the old one with the damage cut out, then JS drawing only there
+			cairo_rectangle_t extents = { 0, 0, (double)width, (double)height };
+			cairo_surface_t* patched = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, &extents);
+			cairo_t* recorder = cairo_create(patched);
+
+			cairo_save(recorder);
+			cairo_set_fill_rule(recorder, CAIRO_FILL_RULE_EVEN_ODD);
+			cairo_rectangle(recorder, 0, 0, width, height);
+			cairo_rectangle(recorder, damage_extents.x, damage_extents.y, damage_extents.width, damage_extents.height);
+			cairo_clip(recorder);
+			cairo_set_source_surface(recorder, this->display_list_, 0, 0);
+			cairo_paint(recorder);
+			cairo_restore(recorder);
+
+			cairo_rectangle(recorder, damage_extents.x, damage_extents.y, damage_extents.width, damage_extents.height);
+			cairo_clip(recorder);
+			this->RunDrawCallback(recorder, damage_extents);
+			cairo_destroy(recorder);
+
+			// The old list lives on as the source of the new one
+			this->DiscardDisplayList();
+			this->display_list_ = patched;
+			this->display_list_patches_++;
+		}
+
+		// Replay the recorded operations without calling into JS
+		cairo_set_source_surface(cairo_context, this->display_list_, 0, 0);
+		cairo_paint(cairo_context);
+	}
+
+	void DrawingArea::DrawTiled(cairo_t* cairo_context, const cairo_rectangle_int_t& clip) {
+		int width = this->GetWidth();
+		int height = this->GetHeight();
+
+		if (width != this->tiles_width_ || height != this->tiles_height_) {
+			this->DiscardTiles();
+
+			for (int y = 0; y < height; y += tile_size) {
+				for (int x = 0; x < width; x += tile_size) {
+					cairo_rectangle_int_t area = { x, y, min(tile_size, width - x), min(tile_size, height - y) };
+					this->tiles_.push_back({ area, cairo_image_surface_create(CAIRO_FORMAT_ARGB32, area.width, area.height), true });
+				}
+			}
+
+			this->tiles_width_ = width;
+			this->tiles_height_ = height;
+		}
+
+		// Only tiles touched by an invalidation get rasterized again
+		vector<Tile*> dirty_tiles;
+		cairo_region_t* dirty_area = cairo_region_create();
+
+		for (Tile& tile : this->tiles_) {
+			if (this->dirty_ || region_intersects(this->damage_, tile.area)) {
+				tile.dirty = true;
+			}
+
+			if (tile.dirty) {
+				dirty_tiles.push_back(&tile);
+				cairo_region_union_rectangle(dirty_area, &tile.area);
+			}
+		}
+
+		clear_region(&this->damage_);
+		this->dirty_ = false;
+
+		if (!dirty_tiles.empty()) {
+			// JS runs once, everything it draws over the dirty tiles becomes a command list
+			cairo_rectangle_int_t extents;
+			cairo_region_get_extents(dirty_area, &extents);
+
+			this->frame_.clear();
+			this->RunDrawCallback(NULL, extents, &this->frame_);
+
+			// Tiles share nothing but the read-only command list, so each can be rasterized on its own thread
+			const float* commands = this->frame_.data();
+			size_t length = this->frame_.size();
+
+			TaskPool::GetInstance()->ParallelFor(dirty_tiles.size(), [&dirty_tiles, commands, length](size_t index) {
+				Tile* tile = dirty_tiles[index];
+				cairo_t* cr = cairo_create(tile->surface);
+
+				cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+				cairo_paint(cr);
+				cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+				cairo_translate(cr, -tile->area.x, -tile->area.y);
+				DrawCommands::Replay(cr, commands, length);
+
+				cairo_destroy(cr);
+				cairo_surface_flush(tile->surface);
+				tile->dirty = false;
+			});
+		}
+
+		cairo_region_destroy(dirty_area);
+
+		for (Tile& tile : this->tiles_) {
+			if (rectangles_intersect(tile.area, clip)) {
+				cairo_set_source_surface(cairo_context, tile.surface, tile.area.x, tile.area.y);
+				cairo_rectangle(cairo_context, tile.area.x, tile.area.y, tile.area.width, tile.area.height);
+				cairo_fill(cairo_context);
+			}
+		}
+	}
+
+	void DrawingArea::DrawPersistent(cairo_t* cairo_context) {
+		int width = this->GetWidth();
+		int height = this->GetHeight();
+		bool preserved = this->back_buffer_ != NULL;
+		cairo_region_t* pending = cairo_region_create();
+
+		if (!preserved) {
+			this->back_buffer_ = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, max(width, 0), max(height, 0));
+
+			cairo_rectangle_int_t full = { 0, 0, width, height };
+			cairo_region_union_rectangle(pending, &full);
+		} else if (width != cairo_image_surface_get_width(this->back_buffer_) || height != cairo_image_surface_get_height(this->back_buffer_)) {
+			// Keep the old pixels where they were, only the area the allocation grew by needs onDraw
+			cairo_surface_t* old_buffer = this->back_buffer_;
+			cairo_rectangle_int_t kept = { 0, 0, cairo_image_surface_get_width(old_buffer), cairo_image_surface_get_height(old_buffer) };
+			cairo_rectangle_int_t full = { 0, 0, width, height };
+
+			this->back_buffer_ = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, max(width, 0), max(height, 0));
+
+			cairo_t* cr = cairo_create(this->back_buffer_);
+			cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+			cairo_set_source_surface(cr, old_buffer, 0, 0);
+			cairo_paint(cr);
+			cairo_destroy(cr);
+			cairo_surface_destroy(old_buffer);
+
+			cairo_region_union_rectangle(pending, &full);
+			cairo_region_subtract_rectangle(pending, &kept);
+
+			// The clip spans the new pixels too, and those never held anything
+			preserved = cairo_region_is_empty(pending);
+		}
+
+		if (this->dirty_) {
+			cairo_rectangle_int_t full = { 0, 0, width, height };
+			cairo_region_union_rectangle(pending, &full);
+		}
+
+		cairo_region_union(pending, this->damage_);
+		clear_region(&this->damage_);
+		this->dirty_ = false;
+
+		if (!cairo_region_is_empty(pending)) {
+			cairo_rectangle_int_t extents;
+			cairo_region_get_extents(pending, &extents);
+
+			// Everything outside of the clip is left as the previous draws made it
+			cairo_t* cr = cairo_create(this->back_buffer_);
+			cairo_rectangle(cr, extents.x, extents.y, extents.width, extents.height);
+			cairo_clip(cr);
+			this->RunDrawCallback(cr, extents, NULL, preserved);
+			cairo_destroy(cr);
+			cairo_surface_flush(this->back_buffer_);
+		}
+
+		cairo_region_destroy(pending);
+
+		// Exposes without an invalidation, such as an uncovered window, need no JS at all
+		cairo_set_source_surface(cairo_context, this->back_buffer_, 0, 0);
+		cairo_paint(cairo_context);
+	}
+
+	void DrawingArea::RunDrawCallback(cairo_t* cairo_context, const cairo_rectangle_int_t& clip, vector<float>* commands, bool preserved) {
+		Isolate* isolate = Isolate::GetCurrent();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+
+		Local<Function> callback = Local<Function>::New(isolate, this->draw_callback_);
+
+		if (!callback.IsEmpty()) {
+			// Lets apps skip work that falls outside of the repainted area
+			Local<Object> clip_object = Object::New(isolate);
+			clip_object->Set(context, String::NewFromUtf8(isolate, "x").ToLocalChecked(), Integer::New(isolate, clip.x));
+			clip_object->Set(context, String::NewFromUtf8(isolate, "y").ToLocalChecked(), Integer::New(isolate, clip.y));
+			clip_object->Set(context, String::NewFromUtf8(isolate, "width").ToLocalChecked(), Integer::New(isolate, clip.width));
+			clip_object->Set(context, String::NewFromUtf8(isolate, "height").ToLocalChecked(), Integer::New(isolate, clip.height));
+
+			// Whether the target still holds what earlier draws painted, only ever with persistent areas
+			clip_object->Set(context, String::NewFromUtf8(isolate, "preserved").ToLocalChecked(), Boolean::New(isolate, preserved));
+
+			// One wrapper per area, rebound every frame instead of allocated
+			if (this->drawing_context_.IsEmpty()) {
+				this->drawing_context_.Reset(isolate, DrawingContext::New(context));
+			}
+
+			Local<Object> drawing_context = Local<Object>::New(isolate, this->drawing_context_);
+			DrawingContext* native_context = DrawingContext::Unwrap(drawing_context);
+
+			if (commands != NULL) {
+				native_context->Bind(commands);
+			} else {
+				native_context->Bind(cairo_context);
+			}
+
+			Local<Value> args[2];
+			args[0] = drawing_context;
+			args[1] = clip_object;
+
+			// The cairo context only lives for this signal, so draws can't be queued
+			gint64 start = FrameStats::BeginScript();
+			mosaic::runtime::EventDispatcher::GetInstance()->Dispatch("draw", callback, 2, args);
+			FrameStats::EndScript(start);
+
+			// Scripts holding on to the context get an exception instead of a dangling cairo_t
+			native_context->Unbind();
+		}
+	}
+
+	void DrawingArea::DiscardDisplayList() {
+		if (this->display_list_ != NULL) {
+			cairo_surface_destroy(this->display_list_);
+			this->display_list_ = NULL;
+		}
+	}
+
+	void DrawingArea::DiscardTiles() {
+		for (Tile& tile : this->tiles_) {
+			cairo_surface_destroy(tile.surface);
+		}
+
+		this->tiles_.clear();
+		this->tiles_width_ = 0;
+		this->tiles_height_ = 0;
+	}
+
+	void DrawingArea::Invalidate() {
+		this->dirty_ = true;
+		this->frame_stats_->MarkInvalidated();
+
+		if (this->IsHeadless()) {
+			Headless::QueueFrame();
+			return;
+		}
+
+		gtk_widget_queue_draw(this->GetGtkWidget());
+	}
+
+	void DrawingArea::Repaint() {
+		this->frame_stats_->MarkInvalidated();
+
+		if (this->IsHeadless()) {
+			Headless::QueueFrame();
+			return;
+		}
+
+		gtk_widget_queue_draw(this->GetGtkWidget());
+	}
+
+	void DrawingArea::AttachLayer(Layer* layer) {
+		if (!layer->IsAttached()) {
+			layer->SetAttached(true);
+			this->attached_layers_.push_back(layer);
+			this->Repaint();
+		}
+	}
+
+	void DrawingArea::DetachLayer(Layer* layer) {
+		if (layer->IsAttached()) {
+			layer->SetAttached(false);
+			this->attached_layers_.erase(remove(this->attached_layers_.begin(), this->attached_layers_.end(), layer), this->attached_layers_.end());
+			this->Repaint();
+		}
+	}
+
+	void DrawingArea::InvalidateRect(int x, int y, int width, int height) {
+		this->AddDamage(x, y, width, height);
+		this->frame_stats_->MarkInvalidated();
+
+		if (this->IsHeadless()) {
+			Headless::QueueFrame();
+			return;
+		}
+
+		gtk_widget_queue_draw_area(this->GetGtkWidget(), x, y, width, height);
+	}
+
+	void DrawingArea::AddDamage(int x, int y, int width, int height) {
+		cairo_rectangle_int_t rectangle = { x, y, width, height };
+		cairo_region_union_rectangle(this->damage_, &rectangle);
+	}
+
+	void DrawingArea::SetRetained(bool value) {
+		this->retained_ = value;
+
+		if (!value) {
+			this->DiscardDisplayList();
+		}
+
+		this->Invalidate();
+	}
+
+	void DrawingArea::SetTiled(bool value) {
+		this->tiled_ = value;
+
+		// Each mode keeps its own copy of the frame, drop the one going unused
+		if (value) {
+			this->DiscardDisplayList();
+		} else {
+			this->DiscardTiles();
+			this->frame_ = vector<float>();
+		}
+
+		this->Invalidate();
+	}
+
+	void DrawingArea::SetPersistent(bool value) {
+		this->persistent_ = value;
+
+		// The back buffer replaces the display list and tiles, and is only kept while in use
+		if (value) {
+			this->DiscardDisplayList();
+			this->DiscardTiles();
+		} else if (this->back_buffer_ != NULL) {
+			cairo_surface_destroy(this->back_buffer_);
+			this->back_buffer_ = NULL;
+		}
+
+		this->Invalidate();
+	}
+
+	void DrawingArea::ClearBuffer() {
+		if (this->back_buffer_ != NULL) {
+			cairo_surface_destroy(this->back_buffer_);
+			this->back_buffer_ = NULL;
+		}
+
+		this->Invalidate();
+	}
+
+	void DrawingArea::InvalidateDescendants(GtkWidget* widget) {
+		DrawingArea* drawing_area = (DrawingArea*)g_object_get_data(G_OBJECT(widget), "mosaic-drawing-area");
+
+		if (drawing_area != NULL) {
+			drawing_area->dirty_ = true;
+			drawing_area->frame_stats_->MarkInvalidated();
+		}
+
+		if (GTK_IS_CONTAINER(widget)) {
+			gtk_container_forall(GTK_CONTAINER(widget), [](GtkWidget* child, gpointer user_data) {
+				DrawingArea::InvalidateDescendants(child);
+			}, NULL);
+		}
+	}
+
+	void DrawingArea::InvalidateDescendantsRect(GtkWidget* root, int x, int y, int width, int height) {
+		// Walks the tree below root, damaging every drawing area in its own coordinates
+		function<void(GtkWidget*)> visit = [&](GtkWidget* widget) {
+			DrawingArea* drawing_area = (DrawingArea*)g_object_get_data(G_OBJECT(widget), "mosaic-drawing-area");
+			int local_x, local_y;
+
+			if (drawing_area != NULL && gtk_widget_translate_coordinates(root, widget, x, y, &local_x, &local_y)) {
+				// Areas the rectangle misses keep their display list
+				GdkRectangle bounds = { 0, 0, gtk_widget_get_allocated_width(widget), gtk_widget_get_allocated_height(widget) };
+				GdkRectangle damage = { local_x, local_y, width, height };
+
+				if (gdk_rectangle_intersect(&bounds, &damage, &damage)) {
+					drawing_area->AddDamage(damage.x, damage.y, damage.width, damage.height);
+					drawing_area->frame_stats_->MarkInvalidated();
+				}
+			}
+
+			if (GTK_IS_CONTAINER(widget)) {
+				gtk_container_forall(GTK_CONTAINER(widget), [](GtkWidget* child, gpointer user_data) {
+					(*(function<void(GtkWidget*)>*)user_data)(child);
+				}, &visit);
+			}
+		};
+
+		visit(root);
+	}
+
+	void DrawingArea::RenderHeadless(cairo_t* cairo_context, int width, int height) {
+		this->headless_width_ = width;
+		this->headless_height_ = height;
+
+		// Same clip GTK would set up for a full repaint
+		cairo_save(cairo_context);
+		cairo_rectangle(cairo_context, 0, 0, width, height);
+		cairo_clip(cairo_context);
+
+		this->frame_stats_->BeginFrame();
+		this->Draw(cairo_context);
+		this->frame_stats_->EndFrame(NULL);
+
+		cairo_restore(cairo_context);
 	}
 
 	int DrawingArea::GetWidth() {
+		if (this->IsHeadless()) {
+			return this->headless_width_;
+		}
+
     	return gtk_widget_get_allocated_width(this->GetGtkWidget());
 	}
 
 	int DrawingArea::GetHeight() {
+		if (this->IsHeadless()) {
+			return this->headless_height_;
+		}
+
     	return gtk_widget_get_allocated_height(this->GetGtkWidget());
 	}
 
@@ -49,11 +585,26 @@ namespace mosaic::presentation {
 		Local<FunctionTemplate> class_tpl = FunctionTemplate::New(isolate, ConstructorCallback);
 		class_tpl->SetClassName(String::NewFromUtf8(isolate, "DrawingArea").ToLocalChecked());
 		class_tpl->InstanceTemplate()->SetInternalFieldCount(1);
+		AddTemplate(isolate, class_tpl);
 
 		Local<ObjectTemplate> proto_tpl = class_tpl->PrototypeTemplate();
 		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "width").ToLocalChecked(), GetWidthCallback);
 		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "height").ToLocalChecked(), GetHeightCallback);
 		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "onDraw").ToLocalChecked(), GetOnDrawCallback, SetOnDrawCallback);
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "retained").ToLocalChecked(), GetRetainedCallback, SetRetainedCallback);
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "tiled").ToLocalChecked(), GetTiledCallback, SetTiledCallback);
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "persistent").ToLocalChecked(), GetPersistentCallback, SetPersistentCallback);
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "frameStats").ToLocalChecked(), GetFrameStatsCallback);
+
+		Local<FunctionTemplate> invalidate_tpl = FunctionTemplate::New(isolate, InvalidateCallback);
+		Local<FunctionTemplate> invalidate_rect_tpl = FunctionTemplate::New(isolate, InvalidateRectCallback);
+		Local<FunctionTemplate> create_layer_tpl = FunctionTemplate::New(isolate, CreateLayerCallback);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "invalidate").ToLocalChecked(), invalidate_tpl);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "invalidateRect").ToLocalChecked(), invalidate_rect_tpl);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "createLayer").ToLocalChecked(), create_layer_tpl);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "attachLayer").ToLocalChecked(), FunctionTemplate::New(isolate, AttachLayerCallback));
+		proto_tpl->Set(String::NewFromUtf8(isolate, "detachLayer").ToLocalChecked(), FunctionTemplate::New(isolate, DetachLayerCallback));
+		proto_tpl->Set(String::NewFromUtf8(isolate, "clearBuffer").ToLocalChecked(), FunctionTemplate::New(isolate, ClearBufferCallback));
 
 		return handle_scope.Escape(class_tpl->GetFunction(context).ToLocalChecked());
 	}
@@ -108,6 +659,7 @@ namespace mosaic::presentation {
 
 		if (value->IsFunction()) {
 			self->draw_callback_.Reset(isolate, Local<Function>::Cast(value));
+			self->Invalidate();
 		} else if (value->IsNullOrUndefined()) {
 			self->draw_callback_.Empty();
 		} else {
@@ -117,6 +669,158 @@ namespace mosaic::presentation {
 		}
 	}
 
+	void DrawingArea::GetRetainedCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Isolate* isolate = info.GetIsolate();
+		HandleScope handle_scope(isolate);
+		DrawingArea* self = NativeClass::Unwrap(info.This());
+
+		info.GetReturnValue().Set(Boolean::New(isolate, self->IsRetained()));
+	}
+
+	void DrawingArea::SetRetainedCallback(Local<String> property, Local<Value> value, const PropertyCallbackInfo<void>& info) {
+		Isolate* isolate = info.GetIsolate();
+		HandleScope handle_scope(isolate);
+		DrawingArea* self = NativeClass::Unwrap(info.This());
+
+		self->SetRetained(value->BooleanValue(isolate));
+	}
+
+	void DrawingArea::GetTiledCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Isolate* isolate = info.GetIsolate();
+		HandleScope handle_scope(isolate);
+		DrawingArea* self = NativeClass::Unwrap(info.This());
+
+		info.GetReturnValue().Set(Boolean::New(isolate, self->IsTiled()));
+	}
+
+	void DrawingArea::SetTiledCallback(Local<String> property, Local<Value> value, const PropertyCallbackInfo<void>& info) {
+		Isolate* isolate = info.GetIsolate();
+		HandleScope handle_scope(isolate);
+		DrawingArea* self = NativeClass::Unwrap(info.This());
+
+		self->SetTiled(value->BooleanValue(isolate));
+	}
+
+	void DrawingArea::GetPersistentCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Isolate* isolate = info.GetIsolate();
+		HandleScope handle_scope(isolate);
+		DrawingArea* self = NativeClass::Unwrap(info.This());
+
+		info.GetReturnValue().Set(Boolean::New(isolate, self->IsPersistent()));
+	}
+
+	void DrawingArea::SetPersistentCallback(Local<String> property, Local<Value> value, const PropertyCallbackInfo<void>& info) {
+		Isolate* isolate = info.GetIsolate();
+		HandleScope handle_scope(isolate);
+		DrawingArea* self = NativeClass::Unwrap(info.This());
+
+		self->SetPersistent(value->BooleanValue(isolate));
+	}
+
+	void DrawingArea::ClearBufferCallback(const FunctionCallbackInfo<Value> &args) {
+		DrawingArea* self = NativeClass::Unwrap(args.This());
+		self->ClearBuffer();
+	}
+
+	void DrawingArea::GetFrameStatsCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Isolate* isolate = info.GetIsolate();
+		HandleScope handle_scope(isolate);
+		DrawingArea* self = NativeClass::Unwrap(info.This());
+
+		info.GetReturnValue().Set(self->frame_stats_->ToObject(isolate->GetCurrentContext()));
+	}
+
+	void DrawingArea::InvalidateCallback(const FunctionCallbackInfo<Value> &args) {
+		DrawingArea* self = NativeClass::Unwrap(args.This());
+		self->Invalidate();
+	}
+
+	void DrawingArea::InvalidateRectCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		DrawingArea* self = NativeClass::Unwrap(args.This());
+
+		if (args.Length() < 4) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: 4 arguments required.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		int x = args[0]->Int32Value(isolate->GetCurrentContext()).FromMaybe(0);
+		int y = args[1]->Int32Value(isolate->GetCurrentContext()).FromMaybe(0);
+		int width = args[2]->Int32Value(isolate->GetCurrentContext()).FromMaybe(0);
+		int height = args[3]->Int32Value(isolate->GetCurrentContext()).FromMaybe(0);
+
+		self->InvalidateRect(x, y, width, height);
+	}
+
+	void DrawingArea::CreateLayerCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+		DrawingArea* self = NativeClass::Unwrap(args.This());
+
+		int width = args[0]->Int32Value(context).FromMaybe(0);
+		int height = args[1]->Int32Value(context).FromMaybe(0);
+
+		if (args.Length() < 2 || width <= 0 || height <= 0) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: width and height must be positive numbers.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		args.GetReturnValue().Set(Layer::FromDrawingArea(context, self, width, height));
+	}
+
+	static Layer* get_own_layer(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		DrawingArea* self = DrawingArea::Unwrap(args.This());
+
+		if (args.Length() < 1 || !Layer::HasInstance(isolate, args[0])) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: first argument must be a Layer.").ToLocalChecked()
+			));
+
+			return NULL;
+		}
+
+		Layer* layer = Layer::Unwrap(Local<Object>::Cast(args[0]));
+
+		if (layer->GetOwner() != self) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: the layer was created by another drawing area.").ToLocalChecked()
+			));
+
+			return NULL;
+		}
+
+		return layer;
+	}
+
+	void DrawingArea::AttachLayerCallback(const FunctionCallbackInfo<Value> &args) {
+		HandleScope handle_scope(args.GetIsolate());
+		DrawingArea* self = NativeClass::Unwrap(args.This());
+		Layer* layer = get_own_layer(args);
+
+		if (layer != NULL) {
+			self->AttachLayer(layer);
+		}
+	}
+
+	void DrawingArea::DetachLayerCallback(const FunctionCallbackInfo<Value> &args) {
+		HandleScope handle_scope(args.GetIsolate());
+		DrawingArea* self = NativeClass::Unwrap(args.This());
+		Layer* layer = get_own_layer(args);
+
+		if (layer != NULL) {
+			self->DetachLayer(layer);
+		}
+	}
+
 	Local<Module> DrawingAreaModule::Make(Isolate* isolate) {
 		EscapableHandleScope handle_scope(isolate);
 
@@ -126,7 +830,10 @@ namespace mosaic::presentation {
 			{
 				String::NewFromUtf8(isolate, "default").ToLocalChecked(),
 				String::NewFromUtf8(isolate, "DrawingArea").ToLocalChecked() ,
-				String::NewFromUtf8(isolate, "DrawingContext").ToLocalChecked() 
+				String::NewFromUtf8(isolate, "DrawingContext").ToLocalChecked(),
+				String::NewFromUtf8(isolate, "Layer").ToLocalChecked(),
+				String::NewFromUtf8(isolate, "ImageData").ToLocalChecked(),
+				String::NewFromUtf8(isolate, "Path2D").ToLocalChecked()
 			},
 			[](Local<Context> context, Local<Module> module) -> MaybeLocal<Value> {
 				Isolate* isolate = context->GetIsolate();
@@ -151,6 +858,24 @@ namespace mosaic::presentation {
 					String::NewFromUtf8(isolate, "DrawingContext").ToLocalChecked(), 
 					DrawingContext::GetConstructor(context)
 				);
+
+				module->SetSyntheticModuleExport(
+					isolate,
+					String::NewFromUtf8(isolate, "Layer").ToLocalChecked(),
+					Layer::GetConstructor(context)
+				);
+
+				module->SetSyntheticModuleExport(
+					isolate,
+					String::NewFromUtf8(isolate, "ImageData").ToLocalChecked(),
+					ImageData::GetConstructor(context)
+				);
+
+				module->SetSyntheticModuleExport(
+					isolate,
+					String::NewFromUtf8(isolate, "Path2D").ToLocalChecked(),
+					Path2D::GetConstructor(context)
+				);
 				
 				return MaybeLocal<Value>(True(isolate));
 			}
@@ -4,9 +4,18 @@
 #include <piston_native_class.h>
 #include <piston_native_module.h>
 #include <built-ins/presentation/drawing_context.h>
+#include <built-ins/presentation/atlas.h>
+#include <built-ins/presentation/draw_batch.h>
+#include <built-ins/presentation/draw_commands.h>
+#include <built-ins/presentation/image.h>
+#include <built-ins/presentation/image_data.h>
+#include <built-ins/presentation/layer.h>
+#include <built-ins/presentation/path_2d.h>
+#include <built-ins/presentation/text_layout_cache.h>
 #include <stdio.h>
 #include <glib.h>
 #include <cairo.h>
+#include <pango/pangocairo.h>
 #include "loader.h"
 
 using namespace v8;
@@ -15,27 +24,49 @@ using namespace std::placeholders;
 namespace mosaic::presentation {
 	bool DrawingContext::lock_constructor_ = true;
 
-	DrawingContext::DrawingContext(cairo_t* cairo_context) {
-		this->SetCairoContext(cairo_context);
+	DrawingContext::DrawingContext() {
+		this->cairo_context_ = NULL;
+		this->commands_ = NULL;
+		this->font_ = "Sans 10";
 	}
 
-	Local<Object> DrawingContext::FromCairoContext(Local<Context> context, cairo_t* cairo_context) {
+	Local<Object> DrawingContext::New(Local<Context> context) {
 		Isolate* isolate = context->GetIsolate();
 		EscapableHandleScope handle_scope(isolate);
 
-		// TODO: Cache constructor per context
 		Local<Function> constructor = DrawingContext::GetConstructor(context);
 
 		DrawingContext::UnlockConstructor();
 		Local<Object> instance = constructor->NewInstance(context).ToLocalChecked();
 		DrawingContext::LockConstructor();
 
-		DrawingContext* native_instance = new DrawingContext(cairo_context);
+		DrawingContext* native_instance = new DrawingContext();
 		native_instance->Wrap(instance);
 
+		// Owners keep their context in a persistent handle, it goes away with them
+		native_instance->MakeWeak();
+
 		return handle_scope.Escape(instance);
 	}
 
+	// Fast call descriptors must outlive the templates that reference them
+	static const CFunction fast_rect = CFunction::MakeWithFallbackSupport(DrawingContext::FastRect);
+	static const CFunction fast_set_color = CFunction::MakeWithFallbackSupport(DrawingContext::FastSetColor);
+	static const CFunction fast_fill = CFunction::MakeWithFallbackSupport(DrawingContext::FastFill);
+
+	static Local<FunctionTemplate> new_fast_method_template(Isolate* isolate, Local<Signature> signature, FunctionCallback slow_callback, const CFunction* fast_callback, int length) {
+		return FunctionTemplate::New(
+			isolate,
+			slow_callback,
+			Local<Value>(),
+			signature,
+			length,
+			ConstructorBehavior::kThrow,
+			SideEffectType::kHasSideEffect,
+			fast_callback
+		);
+	}
+
 	Local<Function> DrawingContext::Make(Local<Context> context) {
 		Isolate* isolate = context->GetIsolate();
 		EscapableHandleScope handle_scope(isolate);
@@ -44,39 +75,212 @@ namespace mosaic::presentation {
 		class_tpl->SetClassName(String::NewFromUtf8(isolate, "DrawingContext").ToLocalChecked());
 		class_tpl->InstanceTemplate()->SetInternalFieldCount(1);
 
-		Local<FunctionTemplate> rect_tpl = FunctionTemplate::New(isolate, RectCallback);
-		Local<FunctionTemplate> set_color_tpl = FunctionTemplate::New(isolate, SetColorCallback);
-		Local<FunctionTemplate> fill_tpl = FunctionTemplate::New(isolate, FillCallback);
+		// The signature guarantees fast calls only ever see DrawingContext receivers
+		Local<Signature> signature = Signature::New(isolate, class_tpl);
+
+		Local<FunctionTemplate> rect_tpl = new_fast_method_template(isolate, signature, RectCallback, &fast_rect, 4);
+		Local<FunctionTemplate> set_color_tpl = new_fast_method_template(isolate, signature, SetColorCallback, &fast_set_color, 4);
+		Local<FunctionTemplate> fill_tpl = new_fast_method_template(isolate, signature, FillCallback, &fast_fill, 0);
+		Local<FunctionTemplate> submit_tpl = FunctionTemplate::New(isolate, SubmitCallback);
+		Local<FunctionTemplate> draw_layer_tpl = FunctionTemplate::New(isolate, DrawLayerCallback);
+		Local<FunctionTemplate> fill_rects_tpl = FunctionTemplate::New(isolate, FillRectsCallback);
+		Local<FunctionTemplate> stroke_lines_tpl = FunctionTemplate::New(isolate, StrokeLinesCallback);
+		Local<FunctionTemplate> fill_circles_tpl = FunctionTemplate::New(isolate, FillCirclesCallback);
+		Local<FunctionTemplate> create_image_data_tpl = FunctionTemplate::New(isolate, CreateImageDataCallback);
+		Local<FunctionTemplate> get_image_data_tpl = FunctionTemplate::New(isolate, GetImageDataCallback);
+		Local<FunctionTemplate> put_image_data_tpl = FunctionTemplate::New(isolate, PutImageDataCallback);
+		Local<FunctionTemplate> draw_image_tpl = FunctionTemplate::New(isolate, DrawImageCallback);
+		Local<FunctionTemplate> draw_sprites_tpl = FunctionTemplate::New(isolate, DrawSpritesCallback);
+		Local<FunctionTemplate> fill_path_tpl = FunctionTemplate::New(isolate, FillPathCallback);
+		Local<FunctionTemplate> stroke_path_tpl = FunctionTemplate::New(isolate, StrokePathCallback);
+		Local<FunctionTemplate> fill_text_tpl = FunctionTemplate::New(isolate, FillTextCallback);
+		Local<FunctionTemplate> measure_text_tpl = FunctionTemplate::New(isolate, MeasureTextCallback);
 
 		Local<ObjectTemplate> proto_tpl = class_tpl->PrototypeTemplate();
 		proto_tpl->Set(String::NewFromUtf8(isolate, "rect").ToLocalChecked(), rect_tpl);
 		proto_tpl->Set(String::NewFromUtf8(isolate, "setColor").ToLocalChecked(), set_color_tpl);
 		proto_tpl->Set(String::NewFromUtf8(isolate, "fill").ToLocalChecked(), fill_tpl);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "submit").ToLocalChecked(), submit_tpl);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "drawLayer").ToLocalChecked(), draw_layer_tpl);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "fillRects").ToLocalChecked(), fill_rects_tpl);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "strokeLines").ToLocalChecked(), stroke_lines_tpl);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "fillCircles").ToLocalChecked(), fill_circles_tpl);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "createImageData").ToLocalChecked(), create_image_data_tpl);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "getImageData").ToLocalChecked(), get_image_data_tpl);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "putImageData").ToLocalChecked(), put_image_data_tpl);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "drawImage").ToLocalChecked(), draw_image_tpl);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "drawSprites").ToLocalChecked(), draw_sprites_tpl);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "fillPath").ToLocalChecked(), fill_path_tpl);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "strokePath").ToLocalChecked(), stroke_path_tpl);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "fillText").ToLocalChecked(), fill_text_tpl);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "measureText").ToLocalChecked(), measure_text_tpl);
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "font").ToLocalChecked(), GetFontCallback, SetFontCallback);
+
+		// Expose opcodes as DrawingContext.Commands so JS encoders don't hardcode them
+		Local<ObjectTemplate> commands_tpl = ObjectTemplate::New(isolate);
+
+		for (int command = 1; command < DRAW_COMMAND_COUNT; command++) {
+			commands_tpl->Set(String::NewFromUtf8(isolate, DrawCommands::GetName(command)).ToLocalChecked(), Integer::New(isolate, command));
+		}
+
+		class_tpl->Set(String::NewFromUtf8(isolate, "Commands").ToLocalChecked(), commands_tpl);
 
 		Local<Function> constructor = class_tpl->GetFunction(context).ToLocalChecked();
 		return handle_scope.Escape(constructor);
 	}
 
 	void DrawingContext::Rect(int x, int y, int width, int height) {
+		if (this->IsRecording()) {
+			this->commands_->insert(this->commands_->end(), { DRAW_COMMAND_RECT, (float)x, (float)y, (float)width, (float)height });
+			return;
+		}
+
 		cairo_t* cr = this->GetCairoContext();
 		cairo_rectangle(cr, x, y, width, height);
 	}
 
 	void DrawingContext::SetColor(double r, double g, double b) {
+		if (this->IsRecording()) {
+			this->SetColor(r, g, b, 1);
+			return;
+		}
+
 		cairo_t* cr = this->GetCairoContext();
 		cairo_set_source_rgb(cr, r / 255, g / 255, b / 255);
 	}
 
 	void DrawingContext::SetColor(double r, double g, double b, double a) {
+		if (this->IsRecording()) {
+			this->commands_->insert(this->commands_->end(), { DRAW_COMMAND_SET_COLOR, (float)r, (float)g, (float)b, (float)a });
+			return;
+		}
+
 		cairo_t* cr = this->GetCairoContext();
 		cairo_set_source_rgba(cr, r / 255, g / 255, b / 255, a);
 	}
 
 	void DrawingContext::Fill() {
+		if (this->IsRecording()) {
+			this->commands_->push_back(DRAW_COMMAND_FILL);
+			return;
+		}
+
 		cairo_t* cr = this->GetCairoContext();
 		cairo_fill(cr);
 	}
 
+	long DrawingContext::Submit(const float* commands, size_t length) {
+		if (this->IsRecording()) {
+			long error_offset = DrawCommands::Validate(commands, length);
+
+			if (error_offset < 0) {
+				this->commands_->insert(this->commands_->end(), commands, commands + length);
+			}
+
+			return error_offset;
+		}
+
+		cairo_t* cr = this->GetCairoContext();
+		return DrawCommands::Replay(cr, commands, length);
+	}
+
+	void DrawingContext::FillRects(const float* coords, size_t count, const uint32_t* colors, size_t color_count, bool ordered) {
+		if (this->IsRecording()) {
+			DrawBatch::EncodeFillRects(this->commands_, coords, count, colors, color_count, ordered);
+		} else {
+			DrawBatch::FillRects(this->GetCairoContext(), coords, count, colors, color_count, ordered);
+		}
+	}
+
+	void DrawingContext::StrokeLines(const float* coords, size_t count, const uint32_t* colors, size_t color_count, double line_width, bool ordered) {
+		if (this->IsRecording()) {
+			DrawBatch::EncodeStrokeLines(this->commands_, coords, count, colors, color_count, line_width, ordered);
+		} else {
+			DrawBatch::StrokeLines(this->GetCairoContext(), coords, count, colors, color_count, line_width, ordered);
+		}
+	}
+
+	void DrawingContext::FillCircles(const float* coords, size_t count, const uint32_t* colors, size_t color_count, bool ordered) {
+		if (this->IsRecording()) {
+			DrawBatch::EncodeFillCircles(this->commands_, coords, count, colors, color_count, ordered);
+		} else {
+			DrawBatch::FillCircles(this->GetCairoContext(), coords, count, colors, color_count, ordered);
+		}
+	}
+
+	/**
+	 * Take the path being built through this context out of the way of a
+	 * draw with a path of its own. Cairo doesn't save paths with the rest of
+	 * its state.
+	 * @returns A copy to give to restore_current_path(), or NULL if there was none.
+	 */
+	static cairo_path_t* take_current_path(cairo_t* cr) {
+		if (!cairo_has_current_point(cr)) {
+			return NULL;
+		}
+
+		cairo_path_t* current = cairo_copy_path(cr);
+		cairo_new_path(cr);
+		return current;
+	}
+
+	static void restore_current_path(cairo_t* cr, cairo_path_t* current) {
+		if (current == NULL) {
+			return;
+		}
+
+		cairo_append_path(cr, current);
+		cairo_path_destroy(current);
+	}
+
+	void DrawingContext::FillPath(Path2D* path) {
+		if (this->IsRecording()) {
+			path->EncodeCommands(this->commands_);
+			this->commands_->push_back(DRAW_COMMAND_FILL);
+			return;
+		}
+
+		cairo_t* cr = this->GetCairoContext();
+		cairo_path_t* current = take_current_path(cr);
+
+		cairo_append_path(cr, path->GetCairoPath());
+		cairo_fill(cr);
+		restore_current_path(cr, current);
+	}
+
+	void DrawingContext::StrokePath(Path2D* path, double line_width) {
+		if (this->IsRecording()) {
+			this->commands_->insert(this->commands_->end(), { DRAW_COMMAND_SAVE, DRAW_COMMAND_SET_LINE_WIDTH, (float)line_width });
+			path->EncodeCommands(this->commands_);
+			this->commands_->insert(this->commands_->end(), { DRAW_COMMAND_STROKE, DRAW_COMMAND_RESTORE });
+			return;
+		}
+
+		cairo_t* cr = this->GetCairoContext();
+		cairo_path_t* current = take_current_path(cr);
+
+		cairo_save(cr);
+		cairo_set_line_width(cr, line_width);
+		cairo_append_path(cr, path->GetCairoPath());
+		cairo_stroke(cr);
+		cairo_restore(cr);
+		restore_current_path(cr, current);
+	}
+
+	void DrawingContext::FillText(const string& text, double x, double y, int max_width) {
+		cairo_t* cr = this->GetCairoContext();
+		PangoLayout* layout = TextLayoutCache::GetInstance()->Get(text, this->font_, max_width);
+
+		// Moving to the text origin must not disturb a path the script is still building
+		cairo_path_t* path = take_current_path(cr);
+
+		// Layouts are shaped against the cache's context, not this one, so their glyph runs stay valid across frames
+		cairo_move_to(cr, x, y - (double)pango_layout_get_baseline(layout) / PANGO_SCALE);
+		pango_cairo_show_layout(cr, layout);
+		cairo_new_path(cr);
+		restore_current_path(cr, path);
+	}
+
 	void DrawingContext::ConstructorCallback(const FunctionCallbackInfo<Value> &args) {
 		Isolate* isolate = args.GetIsolate();
 		HandleScope handle_scope(isolate);
@@ -96,15 +300,40 @@ namespace mosaic::presentation {
 		}
 	}
 
+	/**
+	 * Unwrap the receiver of a drawing method.
+	 * @returns NULL, with an exception thrown, when called outside of the draw callback it was given to.
+	 */
+	static DrawingContext* get_bound_context(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		DrawingContext* self = DrawingContext::Unwrap(args.This());
+
+		if (!self->IsBound()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: drawing contexts can only be used during their draw callback.").ToLocalChecked()
+			));
+
+			return NULL;
+		}
+
+		return self;
+	}
+
 	void DrawingContext::RectCallback(const FunctionCallbackInfo<Value> &args) {
 		Isolate* isolate = args.GetIsolate();
 		HandleScope handle_scope(isolate);
-		DrawingContext* self = DrawingContext::Unwrap(args.This());
+		DrawingContext* self = get_bound_context(args);
+
+		if (self == NULL) {
+			return;
+		}
 
 		if (args.Length() < 4) {
 			isolate->ThrowException(Exception::TypeError(
 				String::NewFromUtf8(isolate, "Unable to execute method: 4 arguments required.").ToLocalChecked()
 			));
+
+			return;
 		}
 
 		int x = args[0]->Int32Value(isolate->GetCurrentContext()).FromMaybe(0);
@@ -118,32 +347,636 @@ namespace mosaic::presentation {
 	void DrawingContext::SetColorCallback(const FunctionCallbackInfo<Value> &args) {
 		Isolate* isolate = args.GetIsolate();
 		HandleScope handle_scope(isolate);
-		DrawingContext* self = DrawingContext::Unwrap(args.This());
+		DrawingContext* self = get_bound_context(args);
+
+		if (self == NULL) {
+			return;
+		}
 
 		if (args.Length() < 3) {
 			isolate->ThrowException(Exception::TypeError(
 				String::NewFromUtf8(isolate, "Unable to execute method: at least 3 arguments required.").ToLocalChecked()
 			));
+
+			return;
 		}
 
 		if (args.Length() == 3) {
-			int r = args[0]->NumberValue(isolate->GetCurrentContext()).FromMaybe(0.0);
-			int g = args[1]->NumberValue(isolate->GetCurrentContext()).FromMaybe(0.0);
-			int b = args[2]->NumberValue(isolate->GetCurrentContext()).FromMaybe(0.0);
+			double r = args[0]->NumberValue(isolate->GetCurrentContext()).FromMaybe(0.0);
+			double g = args[1]->NumberValue(isolate->GetCurrentContext()).FromMaybe(0.0);
+			double b = args[2]->NumberValue(isolate->GetCurrentContext()).FromMaybe(0.0);
 
 			self->SetColor(r, g, b);
 		} else if (args.Length() == 4) {
-			int r = args[0]->NumberValue(isolate->GetCurrentContext()).FromMaybe(0.0);
-			int g = args[1]->NumberValue(isolate->GetCurrentContext()).FromMaybe(0.0);
-			int b = args[2]->NumberValue(isolate->GetCurrentContext()).FromMaybe(0.0);
-			int a = args[3]->NumberValue(isolate->GetCurrentContext()).FromMaybe(0.0);
+			double r = args[0]->NumberValue(isolate->GetCurrentContext()).FromMaybe(0.0);
+			double g = args[1]->NumberValue(isolate->GetCurrentContext()).FromMaybe(0.0);
+			double b = args[2]->NumberValue(isolate->GetCurrentContext()).FromMaybe(0.0);
+			double a = args[3]->NumberValue(isolate->GetCurrentContext()).FromMaybe(0.0);
 
 			self->SetColor(r, g, b, a);
 		}
 	}
 
 	void DrawingContext::FillCallback(const FunctionCallbackInfo<Value> &args) {
+		DrawingContext* self = get_bound_context(args);
+
+		if (self == NULL) {
+			return;
+		}
+
+		self->Fill();
+	}
+
+	void DrawingContext::SubmitCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		DrawingContext* self = get_bound_context(args);
+
+		if (self == NULL) {
+			return;
+		}
+
+		if (args.Length() < 1 || !(args[0]->IsFloat32Array() || args[0]->IsArrayBuffer())) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: commands must be a Float32Array or an ArrayBuffer.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		// Read the floats in place, the buffer is only borrowed for this call
+		const float* data;
+		size_t length;
+
+		if (args[0]->IsFloat32Array()) {
+			Local<Float32Array> commands = Local<Float32Array>::Cast(args[0]);
+			const char* base = (const char*)commands->Buffer()->GetBackingStore()->Data();
+			data = (const float*)(base + commands->ByteOffset());
+			length = commands->Length();
+		} else {
+			// Plain buffers are read as whole floats, a trailing partial one is ignored
+			shared_ptr<BackingStore> store = Local<ArrayBuffer>::Cast(args[0])->GetBackingStore();
+			data = (const float*)store->Data();
+			length = store->ByteLength() / sizeof(float);
+		}
+
+		if (args.Length() > 1 && args[1]->IsNumber()) {
+			double used = args[1]->NumberValue(isolate->GetCurrentContext()).FromMaybe(0.0);
+			length = used < 0 ? 0 : (used < length ? (size_t)used : length);
+		}
+
+		long error_offset = self->Submit(data, length);
+
+		if (error_offset >= 0) {
+			string message = "Unable to execute method: malformed command at offset " + to_string(error_offset) + ".";
+
+			isolate->ThrowException(Exception::RangeError(
+				String::NewFromUtf8(isolate, message.c_str()).ToLocalChecked()
+			));
+		}
+	}
+
+	void DrawingContext::DrawLayerCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+		DrawingContext* self = get_bound_context(args);
+
+		if (self == NULL) {
+			return;
+		}
+
+		if (args.Length() < 1 || !Layer::HasInstance(isolate, args[0])) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: first argument must be a Layer.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		// Recorded commands are replayed on worker threads, which can't render layers
+		if (self->IsRecording()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: layers can't be drawn into tiled drawing areas.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		Layer* layer = Layer::Unwrap(Local<Object>::Cast(args[0]));
+
+		// Only invalidated layers run their onDraw, the rest is a single paint
+		if (layer->IsDirty()) {
+			layer->Render();
+		}
+
+		double x = args.Length() > 1 ? args[1]->NumberValue(context).FromMaybe(0.0) : layer->GetX();
+		double y = args.Length() > 2 ? args[2]->NumberValue(context).FromMaybe(0.0) : layer->GetY();
+
+		layer->Composite(self->GetCairoContext(), x, y, layer->GetOpacity());
+	}
+
+	/**
+	 * Read the (coords, colors) arguments shared by the batched primitives,
+	 * throwing and returning false when they are invalid.
+	 */
+	static bool get_batch_arguments(const FunctionCallbackInfo<Value> &args, size_t stride, const float** coords, size_t* count, const uint32_t** colors, size_t* color_count) {
+		Isolate* isolate = args.GetIsolate();
+
+		if (args.Length() < 2 || !args[0]->IsFloat32Array() || !args[1]->IsUint32Array()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: expected a Float32Array of coordinates and a Uint32Array of colors.").ToLocalChecked()
+			));
+
+			return false;
+		}
+
+		Local<Float32Array> coords_array = Local<Float32Array>::Cast(args[0]);
+		Local<Uint32Array> colors_array = Local<Uint32Array>::Cast(args[1]);
+
+		*count = coords_array->Length() / stride;
+		*color_count = colors_array->Length();
+
+		if (*color_count != 1 && *color_count < *count) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: colors must hold one color, or one per primitive.").ToLocalChecked()
+			));
+
+			return false;
+		}
+
+		// Both arrays are read in place, they are only borrowed for this call
+		*coords = (const float*)((const char*)coords_array->Buffer()->GetBackingStore()->Data() + coords_array->ByteOffset());
+		*colors = (const uint32_t*)((const char*)colors_array->Buffer()->GetBackingStore()->Data() + colors_array->ByteOffset());
+
+		return true;
+	}
+
+	/**
+	 * Read the optional { ordered } argument of the batched primitives. Ordered
+	 * batches overlap in array order, at the cost of fewer merged fills.
+	 */
+	static bool get_batch_ordered(const FunctionCallbackInfo<Value> &args, int index) {
+		Isolate* isolate = args.GetIsolate();
+		Local<Context> context = isolate->GetCurrentContext();
+
+		if (args.Length() <= index || !args[index]->IsObject()) {
+			return false;
+		}
+
+		Local<Value> ordered;
+
+		if (!Local<Object>::Cast(args[index])->Get(context, String::NewFromUtf8(isolate, "ordered").ToLocalChecked()).ToLocal(&ordered)) {
+			return false;
+		}
+
+		return ordered->BooleanValue(isolate);
+	}
+
+	void DrawingContext::FillRectsCallback(const FunctionCallbackInfo<Value> &args) {
+		HandleScope handle_scope(args.GetIsolate());
+		DrawingContext* self = get_bound_context(args);
+
+		if (self == NULL) {
+			return;
+		}
+
+		const float* coords;
+		const uint32_t* colors;
+		size_t count, color_count;
+
+		if (get_batch_arguments(args, 4, &coords, &count, &colors, &color_count) && count > 0) {
+			self->FillRects(coords, count, colors, color_count, get_batch_ordered(args, 2));
+		}
+	}
+
+	void DrawingContext::StrokeLinesCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		DrawingContext* self = get_bound_context(args);
+
+		if (self == NULL) {
+			return;
+		}
+
+		const float* coords;
+		const uint32_t* colors;
+		size_t count, color_count;
+
+		if (get_batch_arguments(args, 4, &coords, &count, &colors, &color_count) && count > 0) {
+			double line_width = args.Length() > 2 ? args[2]->NumberValue(isolate->GetCurrentContext()).FromMaybe(1.0) : 1.0;
+			self->StrokeLines(coords, count, colors, color_count, line_width, get_batch_ordered(args, 3));
+		}
+	}
+
+	void DrawingContext::FillCirclesCallback(const FunctionCallbackInfo<Value> &args) {
+		HandleScope handle_scope(args.GetIsolate());
+		DrawingContext* self = get_bound_context(args);
+
+		if (self == NULL) {
+			return;
+		}
+
+		const float* coords;
+		const uint32_t* colors;
+		size_t count, color_count;
+
+		if (get_batch_arguments(args, 3, &coords, &count, &colors, &color_count) && count > 0) {
+			self->FillCircles(coords, count, colors, color_count, get_batch_ordered(args, 2));
+		}
+	}
+
+	void DrawingContext::CreateImageDataCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+
+		int width = args[0]->Int32Value(context).FromMaybe(0);
+		int height = args[1]->Int32Value(context).FromMaybe(0);
+
+		if (args.Length() < 2 || width <= 0 || height <= 0) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: width and height must be positive numbers.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		args.GetReturnValue().Set(ImageData::FromSurface(context, cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height)));
+	}
+
+	void DrawingContext::GetImageDataCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+		DrawingContext* self = get_bound_context(args);
+
+		if (self == NULL) {
+			return;
+		}
+
+		if (self->IsRecording()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: pixels can't be read from tiled drawing areas.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		if (args.Length() < 4) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: 4 arguments required.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		double x = args[0]->NumberValue(context).FromMaybe(0.0);
+		double y = args[1]->NumberValue(context).FromMaybe(0.0);
+		int width = args[2]->Int32Value(context).FromMaybe(0);
+		int height = args[3]->Int32Value(context).FromMaybe(0);
+
+		if (width <= 0 || height <= 0) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: width and height must be positive numbers.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		// The pixels live in the target surface, which may be a recording or a window, so they are copied once
+		cairo_t* cr = self->GetCairoContext();
+		cairo_user_to_device(cr, &x, &y);
+
+		cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+		cairo_t* copy = cairo_create(surface);
+
+		cairo_surface_flush(cairo_get_target(cr));
+		cairo_set_source_surface(copy, cairo_get_target(cr), -x, -y);
+		cairo_set_operator(copy, CAIRO_OPERATOR_SOURCE);
+		cairo_paint(copy);
+		cairo_destroy(copy);
+
+		args.GetReturnValue().Set(ImageData::FromSurface(context, surface));
+	}
+
+	void DrawingContext::PutImageDataCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+		DrawingContext* self = get_bound_context(args);
+
+		if (self == NULL) {
+			return;
+		}
+
+		if (args.Length() < 1 || !ImageData::IsImageData(context, args[0])) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: first argument must be an ImageData.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		if (self->IsRecording()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: pixels can't be put into tiled drawing areas.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		ImageData* image_data = ImageData::Unwrap(Local<Object>::Cast(args[0]));
+		double x = args.Length() > 1 ? args[1]->NumberValue(context).FromMaybe(0.0) : 0;
+		double y = args.Length() > 2 ? args[2]->NumberValue(context).FromMaybe(0.0) : 0;
+
+		// JS may have written to the pixels since cairo last saw them
+		image_data->MarkDirty();
+
+		// Replaces the pixels like on the web, but still follows the current transform
+		cairo_t* cr = self->GetCairoContext();
+		cairo_save(cr);
+		cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+		cairo_set_source_surface(cr, image_data->GetSurface(), x, y);
+		cairo_rectangle(cr, x, y, image_data->GetWidth(), image_data->GetHeight());
+		cairo_fill(cr);
+		cairo_restore(cr);
+	}
+
+	void DrawingContext::DrawImageCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+		DrawingContext* self = get_bound_context(args);
+
+		if (self == NULL) {
+			return;
+		}
+
+		if (args.Length() < 1 || !Image::IsImage(context, args[0])) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: first argument must be an Image.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		if (self->IsRecording()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: images can't be drawn into tiled drawing areas.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		Image* image = Image::Unwrap(Local<Object>::Cast(args[0]));
+		double x = args.Length() > 1 ? args[1]->NumberValue(context).FromMaybe(0.0) : 0;
+		double y = args.Length() > 2 ? args[2]->NumberValue(context).FromMaybe(0.0) : 0;
+
+		if (args.Length() > 4) {
+			double width = args[3]->NumberValue(context).FromMaybe(0.0);
+			double height = args[4]->NumberValue(context).FromMaybe(0.0);
+
+			image->Draw(self->GetCairoContext(), x, y, width, height);
+		} else {
+			image->Draw(self->GetCairoContext(), x, y);
+		}
+	}
+
+	void DrawingContext::DrawSpritesCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+		DrawingContext* self = get_bound_context(args);
+
+		if (self == NULL) {
+			return;
+		}
+
+		if (args.Length() < 2 || !Atlas::IsAtlas(context, args[0]) || !args[1]->IsFloat32Array()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: expected an Atlas and a Float32Array of instances.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		if (self->IsRecording()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: sprites can't be drawn into tiled drawing areas.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		Atlas* atlas = Atlas::Unwrap(Local<Object>::Cast(args[0]));
+		Local<Float32Array> instances = Local<Float32Array>::Cast(args[1]);
+		size_t count = instances->Length() / Atlas::instance_stride;
+
+		// Lets a reused, oversized array be drawn partially
+		if (args.Length() > 2 && !args[2]->IsUndefined()) {
+			count = min(count, (size_t)max(args[2]->IntegerValue(context).FromMaybe(0), (int64_t)0));
+		}
+
+		const float* data = (const float*)((const char*)instances->Buffer()->GetBackingStore()->Data() + instances->ByteOffset());
+		atlas->Draw(self->GetCairoContext(), data, count);
+	}
+
+	/**
+	 * Read the Path2D argument shared by fillPath() and strokePath().
+	 * @returns NULL, with an exception thrown, when it's missing.
+	 */
+	static Path2D* get_path_argument(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+
+		if (args.Length() < 1 || !Path2D::IsPath2D(isolate->GetCurrentContext(), args[0])) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: first argument must be a Path2D.").ToLocalChecked()
+			));
+
+			return NULL;
+		}
+
+		return Path2D::Unwrap(Local<Object>::Cast(args[0]));
+	}
+
+	void DrawingContext::FillPathCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		DrawingContext* self = get_bound_context(args);
+
+		if (self == NULL) {
+			return;
+		}
+
+		Path2D* path = get_path_argument(args);
+
+		if (path != NULL) {
+			self->FillPath(path);
+		}
+	}
+
+	void DrawingContext::StrokePathCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		DrawingContext* self = get_bound_context(args);
+
+		if (self == NULL) {
+			return;
+		}
+
+		Path2D* path = get_path_argument(args);
+
+		if (path != NULL) {
+			double line_width = args.Length() > 1 ? args[1]->NumberValue(isolate->GetCurrentContext()).FromMaybe(1.0) : 1.0;
+			self->StrokePath(path, line_width);
+		}
+	}
+
+	void DrawingContext::GetFontCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Isolate* isolate = info.GetIsolate();
+		DrawingContext* self = DrawingContext::Unwrap(info.This());
+		info.GetReturnValue().Set(String::NewFromUtf8(isolate, self->font_.c_str()).ToLocalChecked());
+	}
+
+	void DrawingContext::SetFontCallback(Local<String> property, Local<Value> value, const PropertyCallbackInfo<void>& info) {
+		Isolate* isolate = info.GetIsolate();
+		HandleScope handle_scope(isolate);
+		DrawingContext* self = DrawingContext::Unwrap(info.This());
+
+		if (!value->IsString()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to set property: font must be a string.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		self->font_ = *String::Utf8Value(isolate, value);
+	}
+
+	/**
+	 * Read the text and optional wrapping width shared by fillText() and measureText().
+	 * @returns false, with an exception thrown, when the text is missing.
+	 */
+	static bool get_text_arguments(const FunctionCallbackInfo<Value> &args, int max_width_index, string* text, int* max_width) {
+		Isolate* isolate = args.GetIsolate();
+		Local<Context> context = isolate->GetCurrentContext();
+
+		if (args.Length() < 1 || !args[0]->IsString()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: first argument must be a string.").ToLocalChecked()
+			));
+
+			return false;
+		}
+
+		*text = *String::Utf8Value(isolate, args[0]);
+		*max_width = -1;
+
+		if (args.Length() > max_width_index && !args[max_width_index]->IsUndefined()) {
+			*max_width = max(args[max_width_index]->Int32Value(context).FromMaybe(-1), -1);
+		}
+
+		return true;
+	}
+
+	void DrawingContext::FillTextCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+		DrawingContext* self = get_bound_context(args);
+
+		if (self == NULL) {
+			return;
+		}
+
+		string text;
+		int max_width;
+
+		if (!get_text_arguments(args, 3, &text, &max_width)) {
+			return;
+		}
+
+		if (self->IsRecording()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: text can't be drawn into tiled drawing areas.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		double x = args.Length() > 1 ? args[1]->NumberValue(context).FromMaybe(0.0) : 0;
+		double y = args.Length() > 2 ? args[2]->NumberValue(context).FromMaybe(0.0) : 0;
+
+		self->FillText(text, x, y, max_width);
+	}
+
+	void DrawingContext::MeasureTextCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
 		DrawingContext* self = DrawingContext::Unwrap(args.This());
+		string text;
+		int max_width;
+
+		if (!get_text_arguments(args, 1, &text, &max_width)) {
+			return;
+		}
+
+		// Measuring shapes the layout, so a following fillText() of the same text is a cache hit
+		PangoLayout* layout = TextLayoutCache::GetInstance()->Get(text, self->font_, max_width);
+		PangoRectangle logical;
+		pango_layout_get_extents(layout, NULL, &logical);
+		double baseline = (double)pango_layout_get_baseline(layout) / PANGO_SCALE;
+		double height = (double)logical.height / PANGO_SCALE;
+
+		Local<Object> metrics = Object::New(isolate);
+		metrics->Set(context, String::NewFromUtf8(isolate, "width").ToLocalChecked(), Number::New(isolate, (double)logical.width / PANGO_SCALE)).Check();
+		metrics->Set(context, String::NewFromUtf8(isolate, "height").ToLocalChecked(), Number::New(isolate, height)).Check();
+		metrics->Set(context, String::NewFromUtf8(isolate, "ascent").ToLocalChecked(), Number::New(isolate, baseline)).Check();
+		metrics->Set(context, String::NewFromUtf8(isolate, "descent").ToLocalChecked(), Number::New(isolate, height - baseline)).Check();
+
+		args.GetReturnValue().Set(metrics);
+	}
+
+	DrawingContext* DrawingContext::FromApiObject(ApiObject receiver) {
+		Object* object = reinterpret_cast<Object*>(&receiver);
+		NativeClass* wrap = static_cast<NativeClass*>(object->GetAlignedPointerFromInternalField(0));
+		return static_cast<DrawingContext*>(wrap);
+	}
+
+	void DrawingContext::FastRect(ApiObject receiver, int32_t x, int32_t y, int32_t width, int32_t height, FastApiCallbackOptions& options) {
+		DrawingContext* self = FromApiObject(receiver);
+
+		// Let the slow path report the error
+		if (!self->IsBound()) {
+			options.fallback = true;
+			return;
+		}
+
+		self->Rect(x, y, width, height);
+	}
+
+	void DrawingContext::FastSetColor(ApiObject receiver, double r, double g, double b, double a, FastApiCallbackOptions& options) {
+		DrawingContext* self = FromApiObject(receiver);
+
+		if (!self->IsBound()) {
+			options.fallback = true;
+			return;
+		}
+
+		self->SetColor(r, g, b, a);
+	}
+
+	void DrawingContext::FastFill(ApiObject receiver, FastApiCallbackOptions& options) {
+		DrawingContext* self = FromApiObject(receiver);
+
+		if (!self->IsBound()) {
+			options.fallback = true;
+			return;
+		}
+
 		self->Fill();
 	}
 }
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include <functional>
+#include <v8.h>
+#include <piston_native_class.h>
+#include <piston_native_module.h>
+#include <built-ins/presentation/events.h>
+#include <runtime/event_dispatcher.h>
+
+using namespace v8;
+using namespace mosaic::runtime;
+
+namespace mosaic::presentation {
+	Local<Function> Events::Make(Local<Context> context) {
+		Isolate * isolate = context->GetIsolate();
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<FunctionTemplate> class_tpl = FunctionTemplate::New(isolate, ConstructorCallback);
+		class_tpl->SetClassName(String::NewFromUtf8(isolate, "Events").ToLocalChecked());
+
+		Local<FunctionTemplate> batched_tpl = FunctionTemplate::New(isolate, BatchedCallback);
+		class_tpl->Set(String::NewFromUtf8(isolate, "batched").ToLocalChecked(), batched_tpl);
+
+		return handle_scope.Escape(class_tpl->GetFunction(context).ToLocalChecked());
+	}
+
+	void Events::ConstructorCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		isolate->ThrowException(Exception::TypeError(
+			String::NewFromUtf8(isolate, "Unable to instantiate static class.").ToLocalChecked()
+		));
+	}
+
+	/**
+	 * Mark a handler so it receives every event queued during a main loop
+	 * iteration in a single call, as an array of argument lists.
+	 */
+	void Events::BatchedCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+
+		if (args.Length() < 1 || !args[0]->IsFunction()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: handler must be a function.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		Local<Function> handler = Local<Function>::Cast(args[0]);
+		EventDispatcher::SetBatched(isolate, handler);
+
+		args.GetReturnValue().Set(handler);
+	}
+
+	Local<Module> EventsModule::Make(Isolate* isolate) {
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<Module> module = Module::CreateSyntheticModule(
+			isolate,
+			String::NewFromUtf8(isolate, "Events").ToLocalChecked(),
+			{
+				String::NewFromUtf8(isolate, "default").ToLocalChecked(),
+				String::NewFromUtf8(isolate, "Events").ToLocalChecked(),
+				String::NewFromUtf8(isolate, "batched").ToLocalChecked()
+			},
+			[](Local<Context> context, Local<Module> module) -> MaybeLocal<Value> {
+				Isolate* isolate = context->GetIsolate();
+				HandleScope handle_scope(isolate);
+
+				Local<Function> constructor = Events::GetConstructor(context);
+
+				module->SetSyntheticModuleExport(
+					isolate,
+					String::NewFromUtf8(isolate, "default").ToLocalChecked(),
+					constructor
+				);
+
+				module->SetSyntheticModuleExport(
+					isolate,
+					String::NewFromUtf8(isolate, "Events").ToLocalChecked(),
+					constructor
+				);
+
+				module->SetSyntheticModuleExport(
+					isolate,
+					String::NewFromUtf8(isolate, "batched").ToLocalChecked(),
+					constructor->Get(context, String::NewFromUtf8(isolate, "batched").ToLocalChecked()).ToLocalChecked()
+				);
+
+				return MaybeLocal<Value>(True(isolate));
+			}
+		);
+
+		return handle_scope.Escape(module);
+	}
+}
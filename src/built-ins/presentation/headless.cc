@@ -0,0 +1,207 @@
+#include <functional>
+#include <v8.h>
+#include <gtk-3.0/gtk/gtk.h>
+#include <piston_native_class.h>
+#include <piston_native_module.h>
+#include <built-ins/presentation/headless.h>
+#include <built-ins/presentation/window.h>
+#include <glib.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+using namespace v8;
+using namespace std;
+
+namespace mosaic::presentation {
+	vector<Window*> Headless::windows_;
+	vector<pair<guint, function<bool(gint64)>>> Headless::tick_callbacks_;
+	guint Headless::next_tick_callback_id_ = 1;
+	bool Headless::frame_queued_ = false;
+	gint64 Headless::frame_ = 0;
+	GMainLoop* Headless::loop_ = NULL;
+	int Headless::exit_status_ = 0;
+
+	bool Headless::IsEnabled() {
+		static const char* value = getenv("MOSAIC_HEADLESS");
+		static bool enabled = value != NULL && value[0] != '\0' && strcmp(value, "0") != 0;
+
+		return enabled;
+	}
+
+	void Headless::AddWindow(Window* window) {
+		if (find(windows_.begin(), windows_.end(), window) == windows_.end()) {
+			windows_.push_back(window);
+		}
+
+		QueueFrame();
+	}
+
+	void Headless::RemoveWindow(Window* window) {
+		windows_.erase(remove(windows_.begin(), windows_.end(), window), windows_.end());
+	}
+
+	guint Headless::AddTickCallback(function<bool(gint64)> callback) {
+		guint id = next_tick_callback_id_++;
+		tick_callbacks_.push_back({ id, callback });
+
+		return id;
+	}
+
+	void Headless::RemoveTickCallback(guint id) {
+		tick_callbacks_.erase(remove_if(tick_callbacks_.begin(), tick_callbacks_.end(), [id](const pair<guint, function<bool(gint64)>>& entry) {
+			return entry.first == id;
+		}), tick_callbacks_.end());
+	}
+
+	void Headless::Step(int count) {
+		for (int i = 0; i < count; i++) {
+			frame_++;
+
+			// Callbacks may add or remove others while running
+			vector<pair<guint, function<bool(gint64)>>> tick_callbacks = tick_callbacks_;
+			gint64 frame_time = frame_ * G_USEC_PER_SEC / frame_rate;
+
+			for (pair<guint, function<bool(gint64)>>& entry : tick_callbacks) {
+				bool removed = none_of(tick_callbacks_.begin(), tick_callbacks_.end(), [&entry](const pair<guint, function<bool(gint64)>>& other) {
+					return other.first == entry.first;
+				});
+
+				if (!removed && !entry.second(frame_time)) {
+					RemoveTickCallback(entry.first);
+				}
+			}
+
+			// Like a display, a frame where nothing changed paints nothing
+			if (!frame_queued_) {
+				continue;
+			}
+
+			frame_queued_ = false;
+
+			// Painting can close windows or queue the next frame
+			vector<Window*> windows = windows_;
+
+			for (Window* window : windows) {
+				window->Render();
+			}
+		}
+	}
+
+	int Headless::Run(function<void()> start) {
+		loop_ = g_main_loop_new(NULL, FALSE);
+
+		// Started from the loop, so anything the script schedules right away finds it running
+		function<void()>* start_ptr = new function<void()>(start);
+
+		g_idle_add(+[](gpointer user_data) -> gboolean {
+			function<void()>* start = (function<void()>*)user_data;
+			(*start)();
+			delete start;
+
+			return G_SOURCE_REMOVE;
+		}, start_ptr);
+
+		g_main_loop_run(loop_);
+		g_main_loop_unref(loop_);
+		loop_ = NULL;
+
+		return exit_status_;
+	}
+
+	void Headless::Quit(int status) {
+		exit_status_ = status;
+
+		if (loop_ != NULL) {
+			g_main_loop_quit(loop_);
+		}
+	}
+
+	Local<Function> Headless::Make(Local<Context> context) {
+		Isolate* isolate = context->GetIsolate();
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<FunctionTemplate> class_tpl = FunctionTemplate::New(isolate, ConstructorCallback);
+		class_tpl->SetClassName(String::NewFromUtf8(isolate, "Headless").ToLocalChecked());
+
+		class_tpl->Set(String::NewFromUtf8(isolate, "step").ToLocalChecked(), FunctionTemplate::New(isolate, StepCallback));
+		class_tpl->SetNativeDataProperty(String::NewFromUtf8(isolate, "enabled").ToLocalChecked(), GetEnabledCallback);
+		class_tpl->SetNativeDataProperty(String::NewFromUtf8(isolate, "frame").ToLocalChecked(), GetFrameCallback);
+		class_tpl->SetNativeDataProperty(String::NewFromUtf8(isolate, "frameTime").ToLocalChecked(), GetFrameTimeCallback);
+
+		return handle_scope.Escape(class_tpl->GetFunction(context).ToLocalChecked());
+	}
+
+	void Headless::ConstructorCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		isolate->ThrowException(Exception::TypeError(
+			String::NewFromUtf8(isolate, "Unable to instantiate static class.").ToLocalChecked()
+		));
+	}
+
+	void Headless::StepCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+
+		if (!IsEnabled()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: frames can only be stepped in headless mode.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		int count = args.Length() > 0 ? args[0]->Int32Value(isolate->GetCurrentContext()).FromMaybe(1) : 1;
+		Step(max(count, 0));
+
+		args.GetReturnValue().Set(Number::New(isolate, frame_));
+	}
+
+	void Headless::GetEnabledCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		info.GetReturnValue().Set(Boolean::New(info.GetIsolate(), IsEnabled()));
+	}
+
+	void Headless::GetFrameCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		info.GetReturnValue().Set(Number::New(info.GetIsolate(), frame_));
+	}
+
+	void Headless::GetFrameTimeCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		// Milliseconds, so animations driven by it come out the same on every run
+		info.GetReturnValue().Set(Number::New(info.GetIsolate(), frame_ * 1000.0 / frame_rate));
+	}
+
+	Local<Module> HeadlessModule::Make(Isolate* isolate) {
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<Module> module = Module::CreateSyntheticModule(
+			isolate,
+			String::NewFromUtf8(isolate, "Headless").ToLocalChecked(),
+			{
+				String::NewFromUtf8(isolate, "default").ToLocalChecked(),
+				String::NewFromUtf8(isolate, "Headless").ToLocalChecked()
+			},
+			[](Local<Context> context, Local<Module> module) -> MaybeLocal<Value> {
+				Isolate* isolate = context->GetIsolate();
+				HandleScope handle_scope(isolate);
+
+				Local<Function> constructor = Headless::GetConstructor(context);
+
+				module->SetSyntheticModuleExport(
+					isolate,
+					String::NewFromUtf8(isolate, "default").ToLocalChecked(),
+					constructor
+				);
+
+				module->SetSyntheticModuleExport(
+					isolate,
+					String::NewFromUtf8(isolate, "Headless").ToLocalChecked(),
+					constructor
+				);
+
+				return MaybeLocal<Value>(True(isolate));
+			}
+		);
+
+		return handle_scope.Escape(module);
+	}
+}
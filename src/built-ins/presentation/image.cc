@@ -0,0 +1,337 @@
+#include <functional>
+#include <v8.h>
+#include <gtk-3.0/gtk/gtk.h>
+#include <piston_native_class.h>
+#include <piston_native_module.h>
+#include <built-ins/presentation/image.h>
+#include <built-ins/presentation/image_cache.h>
+#include <built-ins/presentation/pixel_kernels.h>
+#include <runtime/task_pool.h>
+#include <cairo.h>
+#include <filesystem>
+#include "loader.h"
+
+using namespace v8;
+using namespace mosaic::runtime;
+
+namespace mosaic::presentation {
+	bool Image::lock_constructor_ = true;
+	unordered_map<string, vector<shared_ptr<PendingPromise>>> Image::loading_;
+
+	static cairo_user_data_key_t external_memory_key;
+
+	static void report_external_memory(int64_t change) {
+		Isolate* isolate = Isolate::GetCurrent();
+
+		if (isolate != NULL) {
+			isolate->AdjustAmountOfExternalAllocatedMemory(change);
+		}
+	}
+
+	// The cache and any number of images share one surface, so its pixels are counted until the last of them lets go
+	static void track_external_memory(cairo_surface_t* surface) {
+		size_t size = (size_t)cairo_image_surface_get_stride(surface) * cairo_image_surface_get_height(surface);
+
+		report_external_memory((int64_t)size);
+		cairo_surface_set_user_data(surface, &external_memory_key, (void*)size, [](void* data) {
+			report_external_memory(-(int64_t)(size_t)data);
+		});
+	}
+
+	Image::Image(cairo_surface_t* surface, const string& src) {
+		this->surface_ = surface;
+		this->src_ = src;
+	}
+
+	Image::~Image() {
+		cairo_surface_destroy(this->surface_);
+	}
+
+	Local<Object> Image::FromSurface(Local<Context> context, cairo_surface_t* surface, const string& src) {
+		Isolate* isolate = context->GetIsolate();
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<Function> constructor = Image::GetConstructor(context);
+
+		Image::UnlockConstructor();
+		Local<Object> instance = constructor->NewInstance(context).ToLocalChecked();
+		Image::LockConstructor();
+
+		Image* native_instance = new Image(surface, src);
+		native_instance->Wrap(instance);
+		native_instance->MakeWeak();
+
+		return handle_scope.Escape(instance);
+	}
+
+	bool Image::IsImage(Local<Context> context, Local<Value> value) {
+		return Image::HasInstance(context->GetIsolate(), value);
+	}
+
+	cairo_surface_t* Image::Decode(const string& path, string* error) {
+		GError* gerror = NULL;
+		GdkPixbuf* pixbuf = gdk_pixbuf_new_from_file(path.c_str(), &gerror);
+
+		if (pixbuf == NULL) {
+			*error = "Failed to decode '" + path + "': " + (gerror != NULL ? gerror->message : "unknown error");
+
+			if (gerror != NULL) {
+				g_error_free(gerror);
+			}
+
+			return NULL;
+		}
+
+		int width = gdk_pixbuf_get_width(pixbuf);
+		int height = gdk_pixbuf_get_height(pixbuf);
+		int channels = gdk_pixbuf_get_n_channels(pixbuf);
+		int pixbuf_stride = gdk_pixbuf_get_rowstride(pixbuf);
+		bool has_alpha = gdk_pixbuf_get_has_alpha(pixbuf);
+		const guchar* pixbuf_pixels = gdk_pixbuf_get_pixels(pixbuf);
+
+		// Opaque images use RGB24, which cairo blits without blending
+		cairo_surface_t* surface = cairo_image_surface_create(has_alpha ? CAIRO_FORMAT_ARGB32 : CAIRO_FORMAT_RGB24, width, height);
+		cairo_status_t status = cairo_surface_status(surface);
+
+		if (status != CAIRO_STATUS_SUCCESS) {
+			*error = "Failed to decode '" + path + "': " + cairo_status_to_string(status);
+
+			cairo_surface_destroy(surface);
+			g_object_unref(pixbuf);
+
+			return NULL;
+		}
+
+		uint8_t* pixels = cairo_image_surface_get_data(surface);
+		int stride = cairo_image_surface_get_stride(surface);
+
+		// Pixbufs are R, G, B(, A) bytes with straight alpha, cairo wants native endian words
+		for (int y = 0; y < height; y++) {
+			const guchar* in = pixbuf_pixels + (size_t)y * pixbuf_stride;
+			uint32_t* out = (uint32_t*)(pixels + (size_t)y * stride);
+
+			for (int x = 0; x < width; x++, in += channels) {
+				uint32_t alpha = has_alpha ? in[3] : 0xff;
+				out[x] = alpha << 24 | (uint32_t)in[0] << 16 | (uint32_t)in[1] << 8 | in[2];
+			}
+		}
+
+		if (has_alpha) {
+			PixelKernels::Premultiply(pixels, width, height, stride);
+		}
+
+		cairo_surface_mark_dirty(surface);
+		g_object_unref(pixbuf);
+
+		return surface;
+	}
+
+	void Image::Draw(cairo_t* cairo_context, double x, double y) {
+		// Filling just the image bounds keeps cairo from walking the whole clip
+		cairo_save(cairo_context);
+		cairo_set_source_surface(cairo_context, this->surface_, x, y);
+		cairo_rectangle(cairo_context, x, y, this->GetWidth(), this->GetHeight());
+		cairo_fill(cairo_context);
+		cairo_restore(cairo_context);
+	}
+
+	void Image::Draw(cairo_t* cairo_context, double x, double y, double width, double height) {
+		if (width <= 0 || height <= 0) {
+			return;
+		}
+
+		cairo_save(cairo_context);
+		cairo_translate(cairo_context, x, y);
+		cairo_scale(cairo_context, width / this->GetWidth(), height / this->GetHeight());
+		cairo_set_source_surface(cairo_context, this->surface_, 0, 0);
+		cairo_rectangle(cairo_context, 0, 0, this->GetWidth(), this->GetHeight());
+		cairo_fill(cairo_context);
+		cairo_restore(cairo_context);
+	}
+
+	Local<Function> Image::Make(Local<Context> context) {
+		Isolate* isolate = context->GetIsolate();
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<FunctionTemplate> class_tpl = FunctionTemplate::New(isolate, ConstructorCallback);
+		class_tpl->SetClassName(String::NewFromUtf8(isolate, "Image").ToLocalChecked());
+		class_tpl->InstanceTemplate()->SetInternalFieldCount(1);
+		AddTemplate(isolate, class_tpl);
+
+		Local<FunctionTemplate> load_tpl = FunctionTemplate::New(isolate, LoadCallback);
+		Local<FunctionTemplate> clear_cache_tpl = FunctionTemplate::New(isolate, ClearCacheCallback);
+
+		class_tpl->Set(String::NewFromUtf8(isolate, "load").ToLocalChecked(), load_tpl);
+		class_tpl->Set(String::NewFromUtf8(isolate, "clearCache").ToLocalChecked(), clear_cache_tpl);
+		class_tpl->SetNativeDataProperty(String::NewFromUtf8(isolate, "cacheBudget").ToLocalChecked(), GetCacheBudgetCallback, SetCacheBudgetCallback);
+		class_tpl->SetNativeDataProperty(String::NewFromUtf8(isolate, "cacheSize").ToLocalChecked(), GetCacheSizeCallback);
+
+		Local<ObjectTemplate> proto_tpl = class_tpl->PrototypeTemplate();
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "width").ToLocalChecked(), GetWidthCallback);
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "height").ToLocalChecked(), GetHeightCallback);
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "src").ToLocalChecked(), GetSrcCallback);
+
+		return handle_scope.Escape(class_tpl->GetFunction(context).ToLocalChecked());
+	}
+
+	void Image::ConstructorCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+
+		if (Image::IsConstructorLocked()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to instantiate protected class. Use Image.load() instead.").ToLocalChecked()
+			));
+		} else if (args.IsConstructCall()) {
+			args.GetReturnValue().Set(args.This());
+		}
+	}
+
+	void Image::LoadCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+
+		if (args.Length() < 1 || !args[0]->IsString()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: path must be a string.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		String::Utf8Value path_value(isolate, args[0]);
+		string path = *path_value;
+
+		// Different spellings of one file share a cache entry
+		string key = filesystem::absolute(path).lexically_normal().string();
+		auto pending = make_shared<PendingPromise>(context);
+		args.GetReturnValue().Set(pending->GetPromise());
+
+		cairo_surface_t* cached = ImageCache::GetInstance()->Get(key);
+
+		if (cached != NULL) {
+			pending->Resolve(Image::FromSurface(context, cached, path));
+			return;
+		}
+
+		bool is_loading = loading_.count(key) > 0;
+		loading_[key].push_back(pending);
+
+		if (is_loading) {
+			return;
+		}
+
+		auto surface = make_shared<cairo_surface_t*>(nullptr);
+		auto error = make_shared<string>();
+
+		TaskPool::GetInstance()->Post([key, surface, error]() {
+			*surface = Image::Decode(key, error.get());
+		}, [key, path, surface, error]() {
+			vector<shared_ptr<PendingPromise>> waiting;
+			waiting.swap(loading_[key]);
+			loading_.erase(key);
+
+			Isolate* isolate = waiting[0]->GetIsolate();
+			HandleScope handle_scope(isolate);
+			Local<Context> context = waiting[0]->GetContext();
+			Context::Scope context_scope(context);
+
+			if (*surface == NULL) {
+				for (auto& pending : waiting) {
+					pending->Reject(*error);
+				}
+
+				return;
+			}
+
+			track_external_memory(*surface);
+			ImageCache::GetInstance()->Put(key, *surface);
+
+			// Everyone who asked while decoding gets the same image
+			Local<Object> image = Image::FromSurface(context, *surface, path);
+
+			for (auto& pending : waiting) {
+				pending->Resolve(image);
+			}
+		});
+	}
+
+	void Image::ClearCacheCallback(const FunctionCallbackInfo<Value> &args) {
+		ImageCache::GetInstance()->Clear();
+	}
+
+	void Image::GetCacheBudgetCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		info.GetReturnValue().Set(Number::New(info.GetIsolate(), ImageCache::GetInstance()->GetBudget()));
+	}
+
+	void Image::SetCacheBudgetCallback(Local<String> property, Local<Value> value, const PropertyCallbackInfo<void>& info) {
+		Isolate* isolate = info.GetIsolate();
+		double budget = value->NumberValue(isolate->GetCurrentContext()).FromMaybe(-1);
+
+		if (budget < 0) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Failed to set cache budget. It must be a number of bytes.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		ImageCache::GetInstance()->SetBudget((size_t)budget);
+	}
+
+	void Image::GetCacheSizeCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		info.GetReturnValue().Set(Number::New(info.GetIsolate(), ImageCache::GetInstance()->GetSize()));
+	}
+
+	void Image::GetWidthCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Image* self = NativeClass::Unwrap(info.This());
+		info.GetReturnValue().Set(Integer::New(info.GetIsolate(), self->GetWidth()));
+	}
+
+	void Image::GetHeightCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Image* self = NativeClass::Unwrap(info.This());
+		info.GetReturnValue().Set(Integer::New(info.GetIsolate(), self->GetHeight()));
+	}
+
+	void Image::GetSrcCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Isolate* isolate = info.GetIsolate();
+		Image* self = NativeClass::Unwrap(info.This());
+		info.GetReturnValue().Set(String::NewFromUtf8(isolate, self->src_.c_str()).ToLocalChecked());
+	}
+
+	Local<Module> ImageModule::Make(Isolate* isolate) {
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<Module> module = Module::CreateSyntheticModule(
+			isolate,
+			String::NewFromUtf8(isolate, "Image").ToLocalChecked(),
+			{
+				String::NewFromUtf8(isolate, "default").ToLocalChecked(),
+				String::NewFromUtf8(isolate, "Image").ToLocalChecked()
+			},
+			[](Local<Context> context, Local<Module> module) -> MaybeLocal<Value> {
+				Isolate* isolate = context->GetIsolate();
+				HandleScope handle_scope(isolate);
+
+				Local<Function> constructor = Image::GetConstructor(context);
+
+				module->SetSyntheticModuleExport(
+					isolate,
+					String::NewFromUtf8(isolate, "default").ToLocalChecked(),
+					constructor
+				);
+
+				module->SetSyntheticModuleExport(
+					isolate,
+					String::NewFromUtf8(isolate, "Image").ToLocalChecked(),
+					constructor
+				);
+
+				return MaybeLocal<Value>(True(isolate));
+			}
+		);
+
+		return handle_scope.Escape(module);
+	}
+}
@@ -0,0 +1,86 @@
+#include <gtk-3.0/gtk/gtk.h>
+#include <cairo.h>
+#include <built-ins/presentation/image_cache.h>
+
+using namespace std;
+
+namespace mosaic::presentation {
+	ImageCache* ImageCache::instance_ = nullptr;
+
+	// Enough for a few hundred sprites or a handful of full screen backgrounds
+	static const size_t default_budget = 64 * 1024 * 1024;
+
+	ImageCache::ImageCache(size_t budget) {
+		this->budget_ = budget;
+		this->size_ = 0;
+	}
+
+	ImageCache::~ImageCache() {
+		this->Clear();
+	}
+
+	ImageCache* ImageCache::GetInstance() {
+		if (instance_ == nullptr) {
+			instance_ = new ImageCache(default_budget);
+		}
+
+		return instance_;
+	}
+
+	void ImageCache::Shutdown() {
+		delete instance_;
+		instance_ = nullptr;
+	}
+
+	cairo_surface_t* ImageCache::Get(const string& key) {
+		auto found = this->index_.find(key);
+
+		if (found == this->index_.end()) {
+			return NULL;
+		}
+
+		// Move to the front without reallocating the entry
+		this->entries_.splice(this->entries_.begin(), this->entries_, found->second);
+		return cairo_surface_reference(found->second->surface);
+	}
+
+	void ImageCache::Put(const string& key, cairo_surface_t* surface) {
+		auto found = this->index_.find(key);
+
+		if (found != this->index_.end()) {
+			this->Remove(found->second);
+		}
+
+		size_t size = (size_t)cairo_image_surface_get_stride(surface) * cairo_image_surface_get_height(surface);
+
+		this->entries_.push_front({ key, cairo_surface_reference(surface), size });
+		this->index_[key] = this->entries_.begin();
+		this->size_ += size;
+
+		this->Evict(this->budget_);
+	}
+
+	void ImageCache::Clear() {
+		this->Evict(0);
+	}
+
+	void ImageCache::SetBudget(size_t bytes) {
+		this->budget_ = bytes;
+		this->Evict(bytes);
+	}
+
+	void ImageCache::Evict(size_t budget) {
+		while (this->size_ > budget && !this->entries_.empty()) {
+			this->Remove(prev(this->entries_.end()));
+		}
+	}
+
+	void ImageCache::Remove(list<Entry>::iterator entry) {
+		// Images handed out keep their own reference, so only the cache's copy goes away
+		cairo_surface_destroy(entry->surface);
+		this->size_ -= entry->size;
+
+		this->index_.erase(entry->key);
+		this->entries_.erase(entry);
+	}
+}
@@ -0,0 +1,303 @@
+#include <functional>
+#include <v8.h>
+#include <gtk-3.0/gtk/gtk.h>
+#include <piston_native_class.h>
+#include <piston_native_module.h>
+#include <built-ins/presentation/image_data.h>
+#include <built-ins/presentation/pixel_kernels.h>
+#include <cairo.h>
+#include <math.h>
+#include <algorithm>
+#include "loader.h"
+
+using namespace v8;
+using namespace std;
+
+namespace mosaic::presentation {
+	cairo_surface_t* ImageData::adopted_surface_ = NULL;
+
+	ImageData::ImageData(Isolate* isolate, cairo_surface_t* surface) {
+		this->surface_ = surface;
+		this->width_ = cairo_image_surface_get_width(surface);
+		this->height_ = cairo_image_surface_get_height(surface);
+
+		// Pixels live outside of the V8 heap, tell the GC about them
+		isolate->AdjustAmountOfExternalAllocatedMemory((int64_t)this->GetStride() * this->height_);
+	}
+
+	ImageData::~ImageData() {
+		Isolate* isolate = Isolate::GetCurrent();
+
+		// The 'data' buffer holds its own reference, pixels stay valid for as long as it lives
+		isolate->AdjustAmountOfExternalAllocatedMemory(-(int64_t)this->GetStride() * this->height_);
+		cairo_surface_destroy(this->surface_);
+
+		this->data_.Reset();
+	}
+
+	Local<Object> ImageData::FromSurface(Local<Context> context, cairo_surface_t* surface) {
+		Isolate* isolate = context->GetIsolate();
+		EscapableHandleScope handle_scope(isolate);
+
+		adopted_surface_ = surface;
+		MaybeLocal<Object> instance = ImageData::GetConstructor(context)->NewInstance(context);
+		adopted_surface_ = NULL;
+
+		// Empty when the surface couldn't be created, with the exception already thrown
+		return handle_scope.Escape(instance.FromMaybe(Local<Object>()));
+	}
+
+	bool ImageData::IsImageData(Local<Context> context, Local<Value> value) {
+		return ImageData::HasInstance(context->GetIsolate(), value);
+	}
+
+	Local<Function> ImageData::Make(Local<Context> context) {
+		Isolate* isolate = context->GetIsolate();
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<FunctionTemplate> class_tpl = FunctionTemplate::New(isolate, ConstructorCallback);
+		class_tpl->SetClassName(String::NewFromUtf8(isolate, "ImageData").ToLocalChecked());
+		class_tpl->InstanceTemplate()->SetInternalFieldCount(1);
+		AddTemplate(isolate, class_tpl);
+		class_tpl->SetNativeDataProperty(String::NewFromUtf8(isolate, "simd").ToLocalChecked(), GetSimdCallback);
+
+		Local<ObjectTemplate> proto_tpl = class_tpl->PrototypeTemplate();
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "width").ToLocalChecked(), GetWidthCallback);
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "height").ToLocalChecked(), GetHeightCallback);
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "stride").ToLocalChecked(), GetStrideCallback);
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "data").ToLocalChecked(), GetDataCallback);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "fill").ToLocalChecked(), FunctionTemplate::New(isolate, FillCallback));
+		proto_tpl->Set(String::NewFromUtf8(isolate, "blend").ToLocalChecked(), FunctionTemplate::New(isolate, BlendCallback));
+		proto_tpl->Set(String::NewFromUtf8(isolate, "premultiply").ToLocalChecked(), FunctionTemplate::New(isolate, PremultiplyCallback));
+		proto_tpl->Set(String::NewFromUtf8(isolate, "unpremultiply").ToLocalChecked(), FunctionTemplate::New(isolate, UnpremultiplyCallback));
+		proto_tpl->Set(String::NewFromUtf8(isolate, "blur").ToLocalChecked(), FunctionTemplate::New(isolate, BlurCallback));
+		proto_tpl->Set(String::NewFromUtf8(isolate, "savePng").ToLocalChecked(), FunctionTemplate::New(isolate, SavePngCallback));
+
+		return handle_scope.Escape(class_tpl->GetFunction(context).ToLocalChecked());
+	}
+
+	void ImageData::ConstructorCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+
+		if (!args.IsConstructCall()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Please use the 'new' operator, this constructor cannot be called as a function.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		cairo_surface_t* surface = adopted_surface_;
+
+		if (surface == NULL) {
+			int width = args[0]->Int32Value(context).FromMaybe(0);
+			int height = args[1]->Int32Value(context).FromMaybe(0);
+
+			if (args.Length() < 2 || width <= 0 || height <= 0) {
+				isolate->ThrowException(Exception::TypeError(
+					String::NewFromUtf8(isolate, "Unable to instantiate class: width and height must be positive numbers.").ToLocalChecked()
+				));
+
+				return;
+			}
+
+			surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+		}
+
+		// Cairo hands back an error surface instead of NULL, for sizes it can't allocate
+		cairo_status_t status = cairo_surface_status(surface);
+
+		if (status != CAIRO_STATUS_SUCCESS) {
+			string message = string("Unable to instantiate class: ") + cairo_status_to_string(status) + ".";
+			cairo_surface_destroy(surface);
+
+			isolate->ThrowException(Exception::RangeError(
+				String::NewFromUtf8(isolate, message.c_str()).ToLocalChecked()
+			));
+
+			return;
+		}
+
+		ImageData* instance = new ImageData(isolate, surface);
+		instance->Wrap(args.This());
+		instance->MakeWeak();
+		args.GetReturnValue().Set(args.This());
+	}
+
+	void ImageData::GetWidthCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		ImageData* self = NativeClass::Unwrap(info.This());
+		info.GetReturnValue().Set(Integer::New(info.GetIsolate(), self->GetWidth()));
+	}
+
+	void ImageData::GetHeightCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		ImageData* self = NativeClass::Unwrap(info.This());
+		info.GetReturnValue().Set(Integer::New(info.GetIsolate(), self->GetHeight()));
+	}
+
+	void ImageData::GetStrideCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		ImageData* self = NativeClass::Unwrap(info.This());
+		info.GetReturnValue().Set(Integer::New(info.GetIsolate(), self->GetStride()));
+	}
+
+	void ImageData::GetDataCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Isolate* isolate = info.GetIsolate();
+		HandleScope handle_scope(isolate);
+		ImageData* self = NativeClass::Unwrap(info.This());
+
+		if (self->data_.IsEmpty()) {
+			size_t length = (size_t)self->GetStride() * self->GetHeight();
+
+			// Cairo may still have drawing queued for the surface
+			cairo_surface_flush(self->surface_);
+
+			// The buffer holds its own reference, the surface outlives it even if detached elsewhere
+			shared_ptr<BackingStore> backing_store = ArrayBuffer::NewBackingStore(
+				self->GetPixels(),
+				length,
+				[](void* data, size_t length, void* deleter_data) {
+					cairo_surface_destroy((cairo_surface_t*)deleter_data);
+				},
+				cairo_surface_reference(self->surface_)
+			);
+
+			Local<ArrayBuffer> buffer = ArrayBuffer::New(isolate, backing_store);
+			self->data_.Reset(isolate, Uint8ClampedArray::New(buffer, 0, length));
+		}
+
+		info.GetReturnValue().Set(Local<Uint8ClampedArray>::New(isolate, self->data_));
+	}
+
+	void ImageData::FillCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+		ImageData* self = NativeClass::Unwrap(args.This());
+
+		if (args.Length() < 3) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: at least 3 arguments required.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		// Same arguments as DrawingContext.setColor(), stored premultiplied
+		double alpha = args.Length() > 3 ? args[3]->NumberValue(context).FromMaybe(1.0) : 1.0;
+		uint32_t a = (uint32_t)round(clamp(alpha, 0.0, 1.0) * 255);
+		uint32_t color = a << 24;
+
+		for (int i = 0; i < 3; i++) {
+			double channel = clamp(args[i]->NumberValue(context).FromMaybe(0.0), 0.0, 255.0);
+			color |= (uint32_t)round(channel * a / 255) << (16 - i * 8);
+		}
+
+		cairo_surface_flush(self->surface_);
+		PixelKernels::Fill(self->GetPixels(), self->GetWidth(), self->GetHeight(), self->GetStride(), color);
+		self->MarkDirty();
+	}
+
+	void ImageData::BlendCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+		ImageData* self = NativeClass::Unwrap(args.This());
+
+		if (args.Length() < 1 || !IsImageData(context, args[0])) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: first argument must be an ImageData.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		ImageData* source = NativeClass::Unwrap(Local<Object>::Cast(args[0]));
+		int x = args.Length() > 1 ? args[1]->Int32Value(context).FromMaybe(0) : 0;
+		int y = args.Length() > 2 ? args[2]->Int32Value(context).FromMaybe(0) : 0;
+		double opacity = args.Length() > 3 ? args[3]->NumberValue(context).FromMaybe(1.0) : 1.0;
+
+		// Only the overlapping part of both images is touched
+		int left = max(x, 0);
+		int top = max(y, 0);
+		int right = min(x + source->GetWidth(), self->GetWidth());
+		int bottom = min(y + source->GetHeight(), self->GetHeight());
+
+		if (right <= left || bottom <= top) {
+			return;
+		}
+
+		cairo_surface_flush(self->surface_);
+		cairo_surface_flush(source->surface_);
+
+		PixelKernels::Blend(
+			self->GetPixels() + (size_t)top * self->GetStride() + left * 4,
+			self->GetStride(),
+			source->GetPixels() + (size_t)(top - y) * source->GetStride() + (left - x) * 4,
+			source->GetStride(),
+			right - left,
+			bottom - top,
+			(uint8_t)round(clamp(opacity, 0.0, 1.0) * 255)
+		);
+
+		self->MarkDirty();
+	}
+
+	void ImageData::PremultiplyCallback(const FunctionCallbackInfo<Value> &args) {
+		ImageData* self = NativeClass::Unwrap(args.This());
+
+		cairo_surface_flush(self->surface_);
+		PixelKernels::Premultiply(self->GetPixels(), self->GetWidth(), self->GetHeight(), self->GetStride());
+		self->MarkDirty();
+	}
+
+	void ImageData::UnpremultiplyCallback(const FunctionCallbackInfo<Value> &args) {
+		ImageData* self = NativeClass::Unwrap(args.This());
+
+		cairo_surface_flush(self->surface_);
+		PixelKernels::Unpremultiply(self->GetPixels(), self->GetWidth(), self->GetHeight(), self->GetStride());
+		self->MarkDirty();
+	}
+
+	void ImageData::BlurCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		ImageData* self = NativeClass::Unwrap(args.This());
+
+		int radius = args.Length() > 0 ? args[0]->Int32Value(isolate->GetCurrentContext()).FromMaybe(0) : 0;
+
+		cairo_surface_flush(self->surface_);
+		PixelKernels::BoxBlur(self->GetPixels(), self->GetWidth(), self->GetHeight(), self->GetStride(), radius);
+		self->MarkDirty();
+	}
+
+	void ImageData::SavePngCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		ImageData* self = NativeClass::Unwrap(args.This());
+
+		if (args.Length() < 1 || !args[0]->IsString()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: first argument must be a path.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		String::Utf8Value path(isolate, args[0]);
+		cairo_status_t status = cairo_surface_write_to_png(self->surface_, *path);
+
+		if (status != CAIRO_STATUS_SUCCESS) {
+			string message = string("Unable to execute method: ") + cairo_status_to_string(status) + ".";
+
+			isolate->ThrowException(Exception::Error(
+				String::NewFromUtf8(isolate, message.c_str()).ToLocalChecked()
+			));
+		}
+	}
+
+	void ImageData::GetSimdCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Isolate* isolate = info.GetIsolate();
+		info.GetReturnValue().Set(String::NewFromUtf8(isolate, PixelKernels::GetSimdLevelName()).ToLocalChecked());
+	}
+}
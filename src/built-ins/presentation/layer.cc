@@ -0,0 +1,278 @@
+#include <functional>
+#include <v8.h>
+#include <gtk-3.0/gtk/gtk.h>
+#include <piston_native_class.h>
+#include <piston_native_module.h>
+#include <built-ins/presentation/layer.h>
+#include <built-ins/presentation/drawing_area.h>
+#include <built-ins/presentation/drawing_context.h>
+#include <runtime/event_dispatcher.h>
+#include <runtime/frame_stats.h>
+#include <cairo.h>
+#include "loader.h"
+
+using namespace v8;
+using namespace mosaic::runtime;
+
+namespace mosaic::presentation {
+	bool Layer::lock_constructor_ = true;
+
+	Layer::Layer(DrawingArea* owner, int width, int height) {
+		this->owner_ = owner;
+		this->width_ = width;
+		this->height_ = height;
+		this->x_ = 0;
+		this->y_ = 0;
+		this->opacity_ = 1;
+		this->dirty_ = true;
+		this->attached_ = false;
+		this->surface_ = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+	}
+
+	Layer::~Layer() {
+		Isolate* isolate = Isolate::GetCurrent();
+		isolate->AdjustAmountOfExternalAllocatedMemory(-(int64_t)cairo_image_surface_get_stride(this->surface_) * this->height_);
+		cairo_surface_destroy(this->surface_);
+
+		this->draw_callback_.Reset();
+		this->drawing_context_.Reset();
+	}
+
+	Local<Object> Layer::FromDrawingArea(Local<Context> context, DrawingArea* owner, int width, int height) {
+		Isolate* isolate = context->GetIsolate();
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<Function> constructor = Layer::GetConstructor(context);
+
+		Layer::UnlockConstructor();
+		Local<Object> instance = constructor->NewInstance(context).ToLocalChecked();
+		Layer::LockConstructor();
+
+		Layer* native_instance = new Layer(owner, width, height);
+		native_instance->Wrap(instance);
+
+		// Pixels live outside of the V8 heap, tell the GC about them
+		isolate->AdjustAmountOfExternalAllocatedMemory((int64_t)cairo_image_surface_get_stride(native_instance->surface_) * height);
+		native_instance->MakeWeak();
+
+		return handle_scope.Escape(instance);
+	}
+
+	void Layer::SetAttached(bool value) {
+		this->attached_ = value;
+
+		// The owner composites attached layers every frame, JS dropping them must not free them
+		if (value) {
+			this->ClearWeak();
+		} else {
+			this->MakeWeak();
+		}
+	}
+
+	void Layer::Invalidate() {
+		this->dirty_ = true;
+
+		if (this->attached_) {
+			this->owner_->Repaint();
+		} else {
+			// The owner's display list still holds the old pixels
+			this->owner_->Invalidate();
+		}
+	}
+
+	void Layer::Render() {
+		Isolate* isolate = Isolate::GetCurrent();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+
+		this->dirty_ = false;
+
+		cairo_t* cr = cairo_create(this->surface_);
+		cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+		cairo_paint(cr);
+		cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+
+		Local<Function> callback = Local<Function>::New(isolate, this->draw_callback_);
+
+		if (!callback.IsEmpty()) {
+			Local<Object> clip_object = Object::New(isolate);
+			clip_object->Set(context, String::NewFromUtf8(isolate, "x").ToLocalChecked(), Integer::New(isolate, 0));
+			clip_object->Set(context, String::NewFromUtf8(isolate, "y").ToLocalChecked(), Integer::New(isolate, 0));
+			clip_object->Set(context, String::NewFromUtf8(isolate, "width").ToLocalChecked(), Integer::New(isolate, this->width_));
+			clip_object->Set(context, String::NewFromUtf8(isolate, "height").ToLocalChecked(), Integer::New(isolate, this->height_));
+
+			if (this->drawing_context_.IsEmpty()) {
+				this->drawing_context_.Reset(isolate, DrawingContext::New(context));
+			}
+
+			Local<Object> drawing_context = Local<Object>::New(isolate, this->drawing_context_);
+			DrawingContext::Unwrap(drawing_context)->Bind(cr);
+
+			Local<Value> args[2];
+			args[0] = drawing_context;
+			args[1] = clip_object;
+
+			// Layers render inside their owner's frame, so their JS counts as that frame's script time
+			gint64 start = FrameStats::BeginScript();
+			EventDispatcher::GetInstance()->Dispatch("layer-draw", callback, 2, args);
+			FrameStats::EndScript(start);
+
+			DrawingContext::Unwrap(drawing_context)->Unbind();
+		}
+
+		cairo_destroy(cr);
+		cairo_surface_flush(this->surface_);
+	}
+
+	void Layer::Composite(cairo_t* cairo_context, double x, double y, double opacity) {
+		cairo_save(cairo_context);
+		cairo_set_source_surface(cairo_context, this->surface_, x, y);
+
+		if (opacity >= 1) {
+			cairo_paint(cairo_context);
+		} else if (opacity > 0) {
+			cairo_paint_with_alpha(cairo_context, opacity);
+		}
+
+		cairo_restore(cairo_context);
+	}
+
+	void Layer::SetPosition(double x, double y) {
+		if (x != this->x_ || y != this->y_) {
+			this->x_ = x;
+			this->y_ = y;
+
+			// Attached layers move without the owner's onDraw running again
+			if (this->attached_) {
+				this->owner_->Repaint();
+			} else {
+				this->owner_->Invalidate();
+			}
+		}
+	}
+
+	void Layer::SetOpacity(double opacity) {
+		if (opacity != this->opacity_) {
+			this->opacity_ = opacity;
+
+			if (this->attached_) {
+				this->owner_->Repaint();
+			} else {
+				this->owner_->Invalidate();
+			}
+		}
+	}
+
+	Local<Function> Layer::Make(Local<Context> context) {
+		Isolate* isolate = context->GetIsolate();
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<FunctionTemplate> class_tpl = FunctionTemplate::New(isolate, ConstructorCallback);
+		class_tpl->SetClassName(String::NewFromUtf8(isolate, "Layer").ToLocalChecked());
+		class_tpl->InstanceTemplate()->SetInternalFieldCount(1);
+		AddTemplate(isolate, class_tpl);
+
+		Local<FunctionTemplate> invalidate_tpl = FunctionTemplate::New(isolate, InvalidateCallback);
+
+		Local<ObjectTemplate> proto_tpl = class_tpl->PrototypeTemplate();
+		proto_tpl->Set(String::NewFromUtf8(isolate, "invalidate").ToLocalChecked(), invalidate_tpl);
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "width").ToLocalChecked(), GetWidthCallback);
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "height").ToLocalChecked(), GetHeightCallback);
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "x").ToLocalChecked(), GetXCallback, SetXCallback);
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "y").ToLocalChecked(), GetYCallback, SetYCallback);
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "opacity").ToLocalChecked(), GetOpacityCallback, SetOpacityCallback);
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "onDraw").ToLocalChecked(), GetOnDrawCallback, SetOnDrawCallback);
+
+		return handle_scope.Escape(class_tpl->GetFunction(context).ToLocalChecked());
+	}
+
+	void Layer::ConstructorCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+
+		if (Layer::IsConstructorLocked()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to instantiate protected class. Use DrawingArea.createLayer() instead.").ToLocalChecked()
+			));
+		} else if (args.IsConstructCall()) {
+			args.GetReturnValue().Set(args.This());
+		}
+	}
+
+	void Layer::InvalidateCallback(const FunctionCallbackInfo<Value> &args) {
+		Layer* self = NativeClass::Unwrap(args.This());
+		self->Invalidate();
+	}
+
+	void Layer::GetWidthCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Layer* self = NativeClass::Unwrap(info.This());
+		info.GetReturnValue().Set(Integer::New(info.GetIsolate(), self->GetWidth()));
+	}
+
+	void Layer::GetHeightCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Layer* self = NativeClass::Unwrap(info.This());
+		info.GetReturnValue().Set(Integer::New(info.GetIsolate(), self->GetHeight()));
+	}
+
+	void Layer::GetXCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Layer* self = NativeClass::Unwrap(info.This());
+		info.GetReturnValue().Set(Number::New(info.GetIsolate(), self->GetX()));
+	}
+
+	void Layer::SetXCallback(Local<String> property, Local<Value> value, const PropertyCallbackInfo<void>& info) {
+		Isolate* isolate = info.GetIsolate();
+		Layer* self = NativeClass::Unwrap(info.This());
+		self->SetPosition(value->NumberValue(isolate->GetCurrentContext()).FromMaybe(0.0), self->GetY());
+	}
+
+	void Layer::GetYCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Layer* self = NativeClass::Unwrap(info.This());
+		info.GetReturnValue().Set(Number::New(info.GetIsolate(), self->GetY()));
+	}
+
+	void Layer::SetYCallback(Local<String> property, Local<Value> value, const PropertyCallbackInfo<void>& info) {
+		Isolate* isolate = info.GetIsolate();
+		Layer* self = NativeClass::Unwrap(info.This());
+		self->SetPosition(self->GetX(), value->NumberValue(isolate->GetCurrentContext()).FromMaybe(0.0));
+	}
+
+	void Layer::GetOpacityCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Layer* self = NativeClass::Unwrap(info.This());
+		info.GetReturnValue().Set(Number::New(info.GetIsolate(), self->GetOpacity()));
+	}
+
+	void Layer::SetOpacityCallback(Local<String> property, Local<Value> value, const PropertyCallbackInfo<void>& info) {
+		Isolate* isolate = info.GetIsolate();
+		Layer* self = NativeClass::Unwrap(info.This());
+		double opacity = value->NumberValue(isolate->GetCurrentContext()).FromMaybe(1.0);
+
+		self->SetOpacity(opacity < 0 ? 0 : (opacity > 1 ? 1 : opacity));
+	}
+
+	void Layer::GetOnDrawCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Isolate* isolate = info.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Layer* self = NativeClass::Unwrap(info.This());
+
+		Local<Function> callback = Local<Function>::New(isolate, self->draw_callback_);
+		info.GetReturnValue().Set(callback);
+	}
+
+	void Layer::SetOnDrawCallback(Local<String> property, Local<Value> value, const PropertyCallbackInfo<void>& info) {
+		Isolate* isolate = info.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Layer* self = NativeClass::Unwrap(info.This());
+
+		if (value->IsFunction()) {
+			self->draw_callback_.Reset(isolate, Local<Function>::Cast(value));
+			self->Invalidate();
+		} else if (value->IsNullOrUndefined()) {
+			self->draw_callback_.Reset();
+			self->Invalidate();
+		} else {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Failed to set callback. It must be a function.").ToLocalChecked()
+			));
+		}
+	}
+}
@@ -0,0 +1,335 @@
+#include <functional>
+#include <v8.h>
+#include <gtk-3.0/gtk/gtk.h>
+#include <piston_native_class.h>
+#include <piston_native_module.h>
+#include <built-ins/presentation/path_2d.h>
+#include <built-ins/presentation/draw_commands.h>
+#include <cairo.h>
+#include <math.h>
+#include "loader.h"
+
+using namespace v8;
+using namespace std;
+
+namespace mosaic::presentation {
+	Path2D::Path2D() {
+		this->has_current_point_ = false;
+		this->current_x_ = 0;
+		this->current_y_ = 0;
+		this->start_x_ = 0;
+		this->start_y_ = 0;
+	}
+
+	bool Path2D::IsPath2D(Local<Context> context, Local<Value> value) {
+		return Path2D::HasInstance(context->GetIsolate(), value);
+	}
+
+	Local<Function> Path2D::Make(Local<Context> context) {
+		Isolate* isolate = context->GetIsolate();
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<FunctionTemplate> class_tpl = FunctionTemplate::New(isolate, ConstructorCallback);
+		class_tpl->SetClassName(String::NewFromUtf8(isolate, "Path2D").ToLocalChecked());
+		class_tpl->InstanceTemplate()->SetInternalFieldCount(1);
+		AddTemplate(isolate, class_tpl);
+
+		Local<ObjectTemplate> proto_tpl = class_tpl->PrototypeTemplate();
+		proto_tpl->Set(String::NewFromUtf8(isolate, "moveTo").ToLocalChecked(), FunctionTemplate::New(isolate, MoveToCallback));
+		proto_tpl->Set(String::NewFromUtf8(isolate, "lineTo").ToLocalChecked(), FunctionTemplate::New(isolate, LineToCallback));
+		proto_tpl->Set(String::NewFromUtf8(isolate, "bezierCurveTo").ToLocalChecked(), FunctionTemplate::New(isolate, BezierCurveToCallback));
+		proto_tpl->Set(String::NewFromUtf8(isolate, "quadraticCurveTo").ToLocalChecked(), FunctionTemplate::New(isolate, QuadraticCurveToCallback));
+		proto_tpl->Set(String::NewFromUtf8(isolate, "arc").ToLocalChecked(), FunctionTemplate::New(isolate, ArcCallback));
+		proto_tpl->Set(String::NewFromUtf8(isolate, "rect").ToLocalChecked(), FunctionTemplate::New(isolate, RectCallback));
+		proto_tpl->Set(String::NewFromUtf8(isolate, "closePath").ToLocalChecked(), FunctionTemplate::New(isolate, ClosePathCallback));
+
+		return handle_scope.Escape(class_tpl->GetFunction(context).ToLocalChecked());
+	}
+
+	static inline void push_header(vector<cairo_path_data_t>& data, cairo_path_data_type_t type, int length) {
+		cairo_path_data_t header;
+		header.header.type = type;
+		header.header.length = length;
+		data.push_back(header);
+	}
+
+	static inline void push_point(vector<cairo_path_data_t>& data, double x, double y) {
+		cairo_path_data_t point;
+		point.point.x = x;
+		point.point.y = y;
+		data.push_back(point);
+	}
+
+	void Path2D::MoveTo(double x, double y) {
+		push_header(this->data_, CAIRO_PATH_MOVE_TO, 2);
+		push_point(this->data_, x, y);
+		this->has_current_point_ = true;
+		this->current_x_ = this->start_x_ = x;
+		this->current_y_ = this->start_y_ = y;
+	}
+
+	void Path2D::LineTo(double x, double y) {
+		// Like canvas paths, a segment without a current point starts a new subpath
+		if (!this->has_current_point_) {
+			this->MoveTo(x, y);
+			return;
+		}
+
+		push_header(this->data_, CAIRO_PATH_LINE_TO, 2);
+		push_point(this->data_, x, y);
+		this->current_x_ = x;
+		this->current_y_ = y;
+	}
+
+	void Path2D::CurveTo(double x1, double y1, double x2, double y2, double x, double y) {
+		if (!this->has_current_point_) {
+			this->MoveTo(x1, y1);
+		}
+
+		push_header(this->data_, CAIRO_PATH_CURVE_TO, 4);
+		push_point(this->data_, x1, y1);
+		push_point(this->data_, x2, y2);
+		push_point(this->data_, x, y);
+		this->current_x_ = x;
+		this->current_y_ = y;
+	}
+
+	void Path2D::QuadraticCurveTo(double cx, double cy, double x, double y) {
+		if (!this->has_current_point_) {
+			this->MoveTo(cx, cy);
+		}
+
+		// Exact cubic equivalent, control points 2/3 of the way to the quadratic one
+		double x0 = this->current_x_;
+		double y0 = this->current_y_;
+
+		this->CurveTo(
+			x0 + 2.0 / 3 * (cx - x0), y0 + 2.0 / 3 * (cy - y0),
+			x + 2.0 / 3 * (cx - x), y + 2.0 / 3 * (cy - y),
+			x, y
+		);
+	}
+
+	void Path2D::Arc(double x, double y, double radius, double start, double end, bool counterclockwise) {
+		double sweep = end - start;
+
+		// Same sweep rules as canvas: a full turn or more draws a circle, anything else wraps
+		if (!counterclockwise) {
+			sweep = sweep >= 2 * M_PI ? 2 * M_PI : fmod(sweep, 2 * M_PI);
+			if (sweep < 0) sweep += 2 * M_PI;
+		} else {
+			sweep = sweep <= -2 * M_PI ? -2 * M_PI : fmod(sweep, 2 * M_PI);
+			if (sweep > 0) sweep -= 2 * M_PI;
+		}
+
+		double start_x = x + radius * cos(start);
+		double start_y = y + radius * sin(start);
+
+		if (this->has_current_point_) {
+			this->LineTo(start_x, start_y);
+		} else {
+			this->MoveTo(start_x, start_y);
+		}
+
+		// Quarter turns at most, a cubic curve is visually exact at that span
+		int segments = (int)ceil(fabs(sweep) / (M_PI / 2) - 1e-9);
+		double step = segments > 0 ? sweep / segments : 0;
+		double k = 4.0 / 3 * tan(step / 4) * radius;
+		double angle = start;
+
+		for (int i = 0; i < segments; i++) {
+			double next = angle + step;
+
+			this->CurveTo(
+				x + radius * cos(angle) - k * sin(angle), y + radius * sin(angle) + k * cos(angle),
+				x + radius * cos(next) + k * sin(next), y + radius * sin(next) - k * cos(next),
+				x + radius * cos(next), y + radius * sin(next)
+			);
+
+			angle = next;
+		}
+	}
+
+	void Path2D::Rect(double x, double y, double width, double height) {
+		this->MoveTo(x, y);
+		this->LineTo(x + width, y);
+		this->LineTo(x + width, y + height);
+		this->LineTo(x, y + height);
+		this->ClosePath();
+	}
+
+	void Path2D::ClosePath() {
+		if (!this->has_current_point_) {
+			return;
+		}
+
+		push_header(this->data_, CAIRO_PATH_CLOSE_PATH, 1);
+		this->current_x_ = this->start_x_;
+		this->current_y_ = this->start_y_;
+	}
+
+	cairo_path_t* Path2D::GetCairoPath() {
+		// The vector may have moved since the last draw
+		this->path_.status = CAIRO_STATUS_SUCCESS;
+		this->path_.data = this->data_.data();
+		this->path_.num_data = this->data_.size();
+
+		return &this->path_;
+	}
+
+	void Path2D::EncodeCommands(vector<float>* commands) {
+		const cairo_path_data_t* data = this->data_.data();
+		size_t length = this->data_.size();
+
+		// Segments are only ever written by this class, so every one is complete
+		for (size_t i = 0; i < length; i += data[i].header.length) {
+			const cairo_path_data_t* p = data + i + 1;
+
+			switch (data[i].header.type) {
+				case CAIRO_PATH_MOVE_TO:
+					commands->insert(commands->end(), { DRAW_COMMAND_MOVE_TO, (float)p[0].point.x, (float)p[0].point.y });
+					break;
+
+				case CAIRO_PATH_LINE_TO:
+					commands->insert(commands->end(), { DRAW_COMMAND_LINE_TO, (float)p[0].point.x, (float)p[0].point.y });
+					break;
+
+				case CAIRO_PATH_CURVE_TO:
+					commands->insert(commands->end(), {
+						DRAW_COMMAND_CURVE_TO,
+						(float)p[0].point.x, (float)p[0].point.y,
+						(float)p[1].point.x, (float)p[1].point.y,
+						(float)p[2].point.x, (float)p[2].point.y
+					});
+					break;
+
+				case CAIRO_PATH_CLOSE_PATH:
+					commands->push_back(DRAW_COMMAND_CLOSE_PATH);
+					break;
+			}
+		}
+	}
+
+	void Path2D::ConstructorCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+
+		if (!args.IsConstructCall()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Please use the 'new' operator, this constructor cannot be called as a function.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		Path2D* instance = new Path2D();
+
+		// new Path2D(path) starts from a copy of another path
+		if (args.Length() > 0 && IsPath2D(context, args[0])) {
+			Path2D* source = Path2D::Unwrap(Local<Object>::Cast(args[0]));
+			instance->data_ = source->data_;
+			instance->has_current_point_ = source->has_current_point_;
+			instance->current_x_ = source->current_x_;
+			instance->current_y_ = source->current_y_;
+			instance->start_x_ = source->start_x_;
+			instance->start_y_ = source->start_y_;
+		}
+
+		instance->Wrap(args.This());
+		instance->MakeWeak();
+		args.GetReturnValue().Set(args.This());
+	}
+
+	/**
+	 * Read the leading numeric arguments of a path method.
+	 * @returns false, with an exception thrown, when some are missing.
+	 */
+	static bool get_numbers(const FunctionCallbackInfo<Value> &args, int count, double* numbers) {
+		Isolate* isolate = args.GetIsolate();
+		Local<Context> context = isolate->GetCurrentContext();
+
+		if (args.Length() < count) {
+			string message = "Unable to execute method: at least " + to_string(count) + " arguments required.";
+			isolate->ThrowException(Exception::TypeError(String::NewFromUtf8(isolate, message.c_str()).ToLocalChecked()));
+			return false;
+		}
+
+		for (int i = 0; i < count; i++) {
+			numbers[i] = args[i]->NumberValue(context).FromMaybe(0.0);
+		}
+
+		return true;
+	}
+
+	void Path2D::MoveToCallback(const FunctionCallbackInfo<Value> &args) {
+		double n[2];
+
+		if (get_numbers(args, 2, n)) {
+			Path2D::Unwrap(args.This())->MoveTo(n[0], n[1]);
+		}
+	}
+
+	void Path2D::LineToCallback(const FunctionCallbackInfo<Value> &args) {
+		double n[2];
+
+		if (get_numbers(args, 2, n)) {
+			Path2D::Unwrap(args.This())->LineTo(n[0], n[1]);
+		}
+	}
+
+	void Path2D::BezierCurveToCallback(const FunctionCallbackInfo<Value> &args) {
+		double n[6];
+
+		if (get_numbers(args, 6, n)) {
+			Path2D::Unwrap(args.This())->CurveTo(n[0], n[1], n[2], n[3], n[4], n[5]);
+		}
+	}
+
+	void Path2D::QuadraticCurveToCallback(const FunctionCallbackInfo<Value> &args) {
+		double n[4];
+
+		if (get_numbers(args, 4, n)) {
+			Path2D::Unwrap(args.This())->QuadraticCurveTo(n[0], n[1], n[2], n[3]);
+		}
+	}
+
+	void Path2D::ArcCallback(const FunctionCallbackInfo<Value> &args) {
+		double n[5];
+
+		if (get_numbers(args, 5, n)) {
+			bool counterclockwise = args.Length() > 5 && args[5]->BooleanValue(args.GetIsolate());
+
+			// Infinite angles would spin the segment loop forever, NaN would poison the whole path
+			if (!isfinite(n[0]) || !isfinite(n[1]) || !isfinite(n[2]) || !isfinite(n[3]) || !isfinite(n[4])) {
+				args.GetIsolate()->ThrowException(Exception::RangeError(
+					String::NewFromUtf8(args.GetIsolate(), "Unable to execute method: arc arguments must be finite numbers.").ToLocalChecked()
+				));
+
+				return;
+			}
+
+			if (n[2] < 0) {
+				args.GetIsolate()->ThrowException(Exception::RangeError(
+					String::NewFromUtf8(args.GetIsolate(), "Unable to execute method: radius can't be negative.").ToLocalChecked()
+				));
+
+				return;
+			}
+
+			Path2D::Unwrap(args.This())->Arc(n[0], n[1], n[2], n[3], n[4], counterclockwise);
+		}
+	}
+
+	void Path2D::RectCallback(const FunctionCallbackInfo<Value> &args) {
+		double n[4];
+
+		if (get_numbers(args, 4, n)) {
+			Path2D::Unwrap(args.This())->Rect(n[0], n[1], n[2], n[3]);
+		}
+	}
+
+	void Path2D::ClosePathCallback(const FunctionCallbackInfo<Value> &args) {
+		Path2D::Unwrap(args.This())->ClosePath();
+	}
+}
@@ -0,0 +1,653 @@
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include <built-ins/presentation/pixel_kernels.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MOSAIC_X86 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace mosaic::presentation {
+	/* Scalar kernels, also used for the tails of vector loops */
+
+	static inline uint32_t div255(uint32_t value) {
+		// Rounded value / 255, exact for every product of two bytes
+		value += 128;
+		return (value + (value >> 8)) >> 8;
+	}
+
+	static inline uint32_t get_channel(uint32_t pixel, int shift) {
+		return (pixel >> shift) & 0xff;
+	}
+
+	static inline uint32_t scale_pixel(uint32_t pixel, uint32_t factor) {
+		return div255(get_channel(pixel, 24) * factor) << 24
+			| div255(get_channel(pixel, 16) * factor) << 16
+			| div255(get_channel(pixel, 8) * factor) << 8
+			| div255(get_channel(pixel, 0) * factor);
+	}
+
+	static inline uint32_t blend_pixel(uint32_t dst, uint32_t src, uint32_t opacity) {
+		if (opacity != 255) {
+			src = scale_pixel(src, opacity);
+		}
+
+		dst = scale_pixel(dst, 255 - get_channel(src, 24));
+		uint32_t result = 0;
+
+		// Saturate like the vector paths, in case the source isn't properly premultiplied
+		for (int shift = 0; shift < 32; shift += 8) {
+			result |= min(255u, get_channel(src, shift) + get_channel(dst, shift)) << shift;
+		}
+
+		return result;
+	}
+
+	static inline uint32_t premultiply_pixel(uint32_t pixel) {
+		uint32_t alpha = get_channel(pixel, 24);
+
+		return alpha << 24
+			| div255(get_channel(pixel, 16) * alpha) << 16
+			| div255(get_channel(pixel, 8) * alpha) << 8
+			| div255(get_channel(pixel, 0) * alpha);
+	}
+
+	static void fill_row_scalar(uint32_t* row, int width, uint32_t color) {
+		for (int x = 0; x < width; x++) {
+			row[x] = color;
+		}
+	}
+
+	static void blend_row_scalar(uint32_t* dst, const uint32_t* src, int width, uint32_t opacity) {
+		for (int x = 0; x < width; x++) {
+			dst[x] = blend_pixel(dst[x], src[x], opacity);
+		}
+	}
+
+	static void premultiply_row_scalar(uint32_t* row, int width) {
+		for (int x = 0; x < width; x++) {
+			row[x] = premultiply_pixel(row[x]);
+		}
+	}
+
+	/* Division has no integer vector instruction, 16.16 reciprocals keep it a multiply and shift */
+	struct UnpremultiplyTable {
+		uint32_t reciprocals[256];
+
+		// The same reciprocals split in halves, over the B, G and R lanes of a pixel widened to 16 bits.
+		// The alpha lane gets a factor of exactly 1, so it stays the same.
+		uint64_t high[256];
+		uint64_t low[256];
+
+		UnpremultiplyTable() {
+			for (uint32_t alpha = 0; alpha < 256; alpha++) {
+				uint32_t reciprocal = alpha == 0 ? 0 : (255 * 65536 + alpha / 2) / alpha;
+				uint64_t high_lane = reciprocal >> 16;
+				uint64_t low_lane = reciprocal & 0xffff;
+
+				reciprocals[alpha] = reciprocal;
+				high[alpha] = high_lane | high_lane << 16 | high_lane << 32 | (uint64_t)1 << 48;
+				low[alpha] = low_lane | low_lane << 16 | low_lane << 32;
+			}
+		}
+	};
+
+	static const UnpremultiplyTable& get_unpremultiply_table() {
+		static const UnpremultiplyTable table;
+		return table;
+	}
+
+	static void unpremultiply_row_scalar(uint32_t* row, int width) {
+		const uint32_t* reciprocals = get_unpremultiply_table().reciprocals;
+
+		for (int x = 0; x < width; x++) {
+			uint32_t pixel = row[x];
+			uint32_t alpha = get_channel(pixel, 24);
+
+			if (alpha == 255) {
+				continue;
+			}
+
+			uint32_t reciprocal = reciprocals[alpha];
+
+			row[x] = alpha << 24
+				| min(255u, (get_channel(pixel, 16) * reciprocal + 32768) >> 16) << 16
+				| min(255u, (get_channel(pixel, 8) * reciprocal + 32768) >> 16) << 8
+				| min(255u, (get_channel(pixel, 0) * reciprocal + 32768) >> 16);
+		}
+	}
+
+	static void blur_row_scalar(const uint32_t* in, uint32_t* out, int width, int radius, float scale) {
+		int sums[4] = { 0, 0, 0, 0 };
+
+		for (int i = -radius; i <= radius; i++) {
+			uint32_t pixel = in[clamp(i, 0, width - 1)];
+
+			for (int c = 0; c < 4; c++) {
+				sums[c] += get_channel(pixel, c * 8);
+			}
+		}
+
+		for (int x = 0; x < width; x++) {
+			uint32_t result = 0;
+
+			for (int c = 0; c < 4; c++) {
+				result |= (uint32_t)(sums[c] * scale + 0.5f) << (c * 8);
+			}
+
+			out[x] = result;
+
+			uint32_t entering = in[min(x + radius + 1, width - 1)];
+			uint32_t leaving = in[max(x - radius, 0)];
+
+			for (int c = 0; c < 4; c++) {
+				sums[c] += (int)get_channel(entering, c * 8) - (int)get_channel(leaving, c * 8);
+			}
+		}
+	}
+
+	static void accumulate_row_scalar(int32_t* sums, const uint32_t* entering, const uint32_t* leaving, int width) {
+		for (int x = 0; x < width; x++) {
+			for (int c = 0; c < 4; c++) {
+				sums[x * 4 + c] += (int)get_channel(entering[x], c * 8) - (leaving ? (int)get_channel(leaving[x], c * 8) : 0);
+			}
+		}
+	}
+
+	static void store_row_scalar(const int32_t* sums, uint32_t* out, int width, float scale) {
+		for (int x = 0; x < width; x++) {
+			uint32_t result = 0;
+
+			for (int c = 0; c < 4; c++) {
+				result |= (uint32_t)(sums[x * 4 + c] * scale + 0.5f) << (c * 8);
+			}
+
+			out[x] = result;
+		}
+	}
+
+#ifdef MOSAIC_X86
+	/* SSE2 kernels, always available on x86-64 */
+
+	static inline __m128i div255_epi16(__m128i value) {
+		value = _mm_add_epi16(value, _mm_set1_epi16(128));
+		return _mm_srli_epi16(_mm_add_epi16(value, _mm_srli_epi16(value, 8)), 8);
+	}
+
+	static inline __m128i broadcast_alpha_epi16(__m128i pixels) {
+		pixels = _mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3));
+		return _mm_shufflehi_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3));
+	}
+
+	static inline __m128i widen_pixel_epi32(uint32_t pixel) {
+		__m128i zero = _mm_setzero_si128();
+		return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128((int)pixel), zero), zero);
+	}
+
+	static inline uint32_t narrow_pixel_epi32(__m128i sums, __m128 scale) {
+		__m128i value = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(sums), scale));
+		value = _mm_packs_epi32(value, value);
+		return (uint32_t)_mm_cvtsi128_si32(_mm_packus_epi16(value, value));
+	}
+
+	static void fill_row_sse2(uint32_t* row, int width, uint32_t color) {
+		__m128i value = _mm_set1_epi32((int)color);
+		int x = 0;
+
+		for (; x + 4 <= width; x += 4) {
+			_mm_storeu_si128((__m128i*)(row + x), value);
+		}
+
+		fill_row_scalar(row + x, width - x, color);
+	}
+
+	static void blend_row_sse2(uint32_t* dst, const uint32_t* src, int width, uint32_t opacity) {
+		__m128i zero = _mm_setzero_si128();
+		__m128i max = _mm_set1_epi16(255);
+		__m128i factor = _mm_set1_epi16(opacity);
+		int x = 0;
+
+		for (; x + 4 <= width; x += 4) {
+			__m128i s = _mm_loadu_si128((const __m128i*)(src + x));
+
+			// Fully transparent runs are common in sprites and leave dst untouched
+			if (_mm_movemask_epi8(_mm_cmpeq_epi32(s, zero)) == 0xffff) {
+				continue;
+			}
+
+			__m128i d = _mm_loadu_si128((const __m128i*)(dst + x));
+			__m128i s_lo = _mm_unpacklo_epi8(s, zero);
+			__m128i s_hi = _mm_unpackhi_epi8(s, zero);
+
+			if (opacity != 255) {
+				s_lo = div255_epi16(_mm_mullo_epi16(s_lo, factor));
+				s_hi = div255_epi16(_mm_mullo_epi16(s_hi, factor));
+			}
+
+			__m128i d_lo = div255_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_sub_epi16(max, broadcast_alpha_epi16(s_lo))));
+			__m128i d_hi = div255_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_sub_epi16(max, broadcast_alpha_epi16(s_hi))));
+
+			__m128i result = _mm_packus_epi16(_mm_add_epi16(s_lo, d_lo), _mm_add_epi16(s_hi, d_hi));
+			_mm_storeu_si128((__m128i*)(dst + x), result);
+		}
+
+		blend_row_scalar(dst + x, src + x, width - x, opacity);
+	}
+
+	static void premultiply_row_sse2(uint32_t* row, int width) {
+		__m128i zero = _mm_setzero_si128();
+		__m128i max = _mm_set1_epi16(255);
+		__m128i alpha_lanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+		int x = 0;
+
+		for (; x + 4 <= width; x += 4) {
+			__m128i pixels = _mm_loadu_si128((const __m128i*)(row + x));
+			__m128i lo = _mm_unpacklo_epi8(pixels, zero);
+			__m128i hi = _mm_unpackhi_epi8(pixels, zero);
+
+			// Color lanes are scaled by alpha, the alpha lane by 255 so it stays the same
+			__m128i factor_lo = _mm_or_si128(_mm_andnot_si128(alpha_lanes, broadcast_alpha_epi16(lo)), _mm_and_si128(alpha_lanes, max));
+			__m128i factor_hi = _mm_or_si128(_mm_andnot_si128(alpha_lanes, broadcast_alpha_epi16(hi)), _mm_and_si128(alpha_lanes, max));
+
+			lo = div255_epi16(_mm_mullo_epi16(lo, factor_lo));
+			hi = div255_epi16(_mm_mullo_epi16(hi, factor_hi));
+
+			_mm_storeu_si128((__m128i*)(row + x), _mm_packus_epi16(lo, hi));
+		}
+
+		premultiply_row_scalar(row + x, width - x);
+	}
+
+	static inline __m128i unpremultiply_epi16(__m128i channels, __m128i high, __m128i low) {
+		// (channels * reciprocal + 32768) >> 16 from both halves of the reciprocal, as the scalar path rounds
+		__m128i rounding = _mm_srli_epi16(_mm_mullo_epi16(channels, low), 15);
+		__m128i value = _mm_add_epi16(_mm_mullo_epi16(channels, high), _mm_add_epi16(_mm_mulhi_epu16(channels, low), rounding));
+
+		// Colors brighter than their alpha go past 255, and past what packus reads as positive
+		return _mm_sub_epi16(value, _mm_subs_epu16(value, _mm_set1_epi16(255)));
+	}
+
+	static void unpremultiply_row_sse2(uint32_t* row, int width) {
+		const UnpremultiplyTable& table = get_unpremultiply_table();
+		__m128i zero = _mm_setzero_si128();
+		int x = 0;
+
+		for (; x + 4 <= width; x += 4) {
+			__m128i pixels = _mm_loadu_si128((const __m128i*)(row + x));
+			__m128i lo = _mm_unpacklo_epi8(pixels, zero);
+			__m128i hi = _mm_unpackhi_epi8(pixels, zero);
+			uint32_t a0 = row[x] >> 24, a1 = row[x + 1] >> 24, a2 = row[x + 2] >> 24, a3 = row[x + 3] >> 24;
+
+			lo = unpremultiply_epi16(lo, _mm_set_epi64x(table.high[a1], table.high[a0]), _mm_set_epi64x(table.low[a1], table.low[a0]));
+			hi = unpremultiply_epi16(hi, _mm_set_epi64x(table.high[a3], table.high[a2]), _mm_set_epi64x(table.low[a3], table.low[a2]));
+
+			_mm_storeu_si128((__m128i*)(row + x), _mm_packus_epi16(lo, hi));
+		}
+
+		unpremultiply_row_scalar(row + x, width - x);
+	}
+
+	static void blur_row_sse2(const uint32_t* in, uint32_t* out, int width, int radius, float scale) {
+		__m128 factor = _mm_set1_ps(scale);
+		__m128i sums = _mm_setzero_si128();
+
+		for (int i = -radius; i <= radius; i++) {
+			sums = _mm_add_epi32(sums, widen_pixel_epi32(in[clamp(i, 0, width - 1)]));
+		}
+
+		for (int x = 0; x < width; x++) {
+			out[x] = narrow_pixel_epi32(sums, factor);
+			sums = _mm_add_epi32(sums, widen_pixel_epi32(in[min(x + radius + 1, width - 1)]));
+			sums = _mm_sub_epi32(sums, widen_pixel_epi32(in[max(x - radius, 0)]));
+		}
+	}
+
+	static void accumulate_row_sse2(int32_t* sums, const uint32_t* entering, const uint32_t* leaving, int width) {
+		for (int x = 0; x < width; x++) {
+			__m128i value = _mm_loadu_si128((const __m128i*)(sums + x * 4));
+			value = _mm_add_epi32(value, widen_pixel_epi32(entering[x]));
+
+			if (leaving) {
+				value = _mm_sub_epi32(value, widen_pixel_epi32(leaving[x]));
+			}
+
+			_mm_storeu_si128((__m128i*)(sums + x * 4), value);
+		}
+	}
+
+	static void store_row_sse2(const int32_t* sums, uint32_t* out, int width, float scale) {
+		__m128 factor = _mm_set1_ps(scale);
+
+		for (int x = 0; x < width; x++) {
+			out[x] = narrow_pixel_epi32(_mm_loadu_si128((const __m128i*)(sums + x * 4)), factor);
+		}
+	}
+
+	/* AVX2 kernels, twice the pixels per iteration of the SSE2 ones */
+
+	__attribute__((target("avx2")))
+	static inline __m256i div255_epi16_avx2(__m256i value) {
+		value = _mm256_add_epi16(value, _mm256_set1_epi16(128));
+		return _mm256_srli_epi16(_mm256_add_epi16(value, _mm256_srli_epi16(value, 8)), 8);
+	}
+
+	__attribute__((target("avx2")))
+	static inline __m256i broadcast_alpha_epi16_avx2(__m256i pixels) {
+		pixels = _mm256_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3));
+		return _mm256_shufflehi_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3));
+	}
+
+	__attribute__((target("avx2")))
+	static void fill_row_avx2(uint32_t* row, int width, uint32_t color) {
+		__m256i value = _mm256_set1_epi32((int)color);
+		int x = 0;
+
+		for (; x + 8 <= width; x += 8) {
+			_mm256_storeu_si256((__m256i*)(row + x), value);
+		}
+
+		fill_row_scalar(row + x, width - x, color);
+	}
+
+	__attribute__((target("avx2")))
+	static void blend_row_avx2(uint32_t* dst, const uint32_t* src, int width, uint32_t opacity) {
+		__m256i zero = _mm256_setzero_si256();
+		__m256i max = _mm256_set1_epi16(255);
+		__m256i factor = _mm256_set1_epi16(opacity);
+		int x = 0;
+
+		for (; x + 8 <= width; x += 8) {
+			__m256i s = _mm256_loadu_si256((const __m256i*)(src + x));
+
+			if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(s, zero)) == -1) {
+				continue;
+			}
+
+			// Unpacking and packing both work within 128-bit lanes, so pixel order is kept
+			__m256i d = _mm256_loadu_si256((const __m256i*)(dst + x));
+			__m256i s_lo = _mm256_unpacklo_epi8(s, zero);
+			__m256i s_hi = _mm256_unpackhi_epi8(s, zero);
+
+			if (opacity != 255) {
+				s_lo = div255_epi16_avx2(_mm256_mullo_epi16(s_lo, factor));
+				s_hi = div255_epi16_avx2(_mm256_mullo_epi16(s_hi, factor));
+			}
+
+			__m256i d_lo = div255_epi16_avx2(_mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), _mm256_sub_epi16(max, broadcast_alpha_epi16_avx2(s_lo))));
+			__m256i d_hi = div255_epi16_avx2(_mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), _mm256_sub_epi16(max, broadcast_alpha_epi16_avx2(s_hi))));
+
+			__m256i result = _mm256_packus_epi16(_mm256_add_epi16(s_lo, d_lo), _mm256_add_epi16(s_hi, d_hi));
+			_mm256_storeu_si256((__m256i*)(dst + x), result);
+		}
+
+		blend_row_sse2(dst + x, src + x, width - x, opacity);
+	}
+
+	__attribute__((target("avx2")))
+	static void premultiply_row_avx2(uint32_t* row, int width) {
+		__m256i zero = _mm256_setzero_si256();
+		__m256i max = _mm256_set1_epi16(255);
+		__m256i alpha_lanes = _mm256_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0);
+		int x = 0;
+
+		for (; x + 8 <= width; x += 8) {
+			__m256i pixels = _mm256_loadu_si256((const __m256i*)(row + x));
+			__m256i lo = _mm256_unpacklo_epi8(pixels, zero);
+			__m256i hi = _mm256_unpackhi_epi8(pixels, zero);
+
+			__m256i factor_lo = _mm256_or_si256(_mm256_andnot_si256(alpha_lanes, broadcast_alpha_epi16_avx2(lo)), _mm256_and_si256(alpha_lanes, max));
+			__m256i factor_hi = _mm256_or_si256(_mm256_andnot_si256(alpha_lanes, broadcast_alpha_epi16_avx2(hi)), _mm256_and_si256(alpha_lanes, max));
+
+			lo = div255_epi16_avx2(_mm256_mullo_epi16(lo, factor_lo));
+			hi = div255_epi16_avx2(_mm256_mullo_epi16(hi, factor_hi));
+
+			_mm256_storeu_si256((__m256i*)(row + x), _mm256_packus_epi16(lo, hi));
+		}
+
+		premultiply_row_sse2(row + x, width - x);
+	}
+
+	__attribute__((target("avx2")))
+	static inline __m256i unpremultiply_epi16_avx2(__m256i channels, __m256i high, __m256i low) {
+		__m256i rounding = _mm256_srli_epi16(_mm256_mullo_epi16(channels, low), 15);
+		__m256i value = _mm256_add_epi16(_mm256_mullo_epi16(channels, high), _mm256_add_epi16(_mm256_mulhi_epu16(channels, low), rounding));
+
+		return _mm256_sub_epi16(value, _mm256_subs_epu16(value, _mm256_set1_epi16(255)));
+	}
+
+	__attribute__((target("avx2")))
+	static void unpremultiply_row_avx2(uint32_t* row, int width) {
+		const UnpremultiplyTable& table = get_unpremultiply_table();
+		__m256i zero = _mm256_setzero_si256();
+		int x = 0;
+
+		for (; x + 8 <= width; x += 8) {
+			__m256i pixels = _mm256_loadu_si256((const __m256i*)(row + x));
+			__m256i lo = _mm256_unpacklo_epi8(pixels, zero);
+			__m256i hi = _mm256_unpackhi_epi8(pixels, zero);
+			uint32_t a[8];
+
+			for (int i = 0; i < 8; i++) {
+				a[i] = row[x + i] >> 24;
+			}
+
+			// Unpacking stays within 128-bit halves, 'lo' holds pixels 0, 1, 4 and 5
+			lo = unpremultiply_epi16_avx2(
+				lo,
+				_mm256_set_epi64x(table.high[a[5]], table.high[a[4]], table.high[a[1]], table.high[a[0]]),
+				_mm256_set_epi64x(table.low[a[5]], table.low[a[4]], table.low[a[1]], table.low[a[0]])
+			);
+
+			hi = unpremultiply_epi16_avx2(
+				hi,
+				_mm256_set_epi64x(table.high[a[7]], table.high[a[6]], table.high[a[3]], table.high[a[2]]),
+				_mm256_set_epi64x(table.low[a[7]], table.low[a[6]], table.low[a[3]], table.low[a[2]])
+			);
+
+			_mm256_storeu_si256((__m256i*)(row + x), _mm256_packus_epi16(lo, hi));
+		}
+
+		unpremultiply_row_sse2(row + x, width - x);
+	}
+
+	__attribute__((target("avx2")))
+	static void accumulate_row_avx2(int32_t* sums, const uint32_t* entering, const uint32_t* leaving, int width) {
+		int x = 0;
+
+		// Two pixels, eight channel sums, per iteration
+		for (; x + 2 <= width; x += 2) {
+			__m256i value = _mm256_loadu_si256((const __m256i*)(sums + x * 4));
+			value = _mm256_add_epi32(value, _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(entering + x))));
+
+			if (leaving) {
+				value = _mm256_sub_epi32(value, _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(leaving + x))));
+			}
+
+			_mm256_storeu_si256((__m256i*)(sums + x * 4), value);
+		}
+
+		accumulate_row_sse2(sums + x * 4, entering + x, leaving ? leaving + x : NULL, width - x);
+	}
+
+	__attribute__((target("avx2")))
+	static void store_row_avx2(const int32_t* sums, uint32_t* out, int width, float scale) {
+		__m256 factor = _mm256_set1_ps(scale);
+		int x = 0;
+
+		for (; x + 2 <= width; x += 2) {
+			__m256i value = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(sums + x * 4))), factor));
+			value = _mm256_packs_epi32(value, value);
+			value = _mm256_packus_epi16(value, value);
+
+			// Each 128-bit lane now starts with one of the two pixels
+			out[x] = (uint32_t)_mm_cvtsi128_si32(_mm256_castsi256_si128(value));
+			out[x + 1] = (uint32_t)_mm_cvtsi128_si32(_mm256_extracti128_si256(value, 1));
+		}
+
+		store_row_sse2(sums + x * 4, out + x, width - x, scale);
+	}
+#endif
+
+	static PixelKernels::SimdLevel detect_simd_level() {
+		PixelKernels::SimdLevel level = PixelKernels::SIMD_SCALAR;
+
+#ifdef MOSAIC_X86
+		__builtin_cpu_init();
+
+		if (__builtin_cpu_supports("avx2")) {
+			level = PixelKernels::SIMD_AVX2;
+		} else if (__builtin_cpu_supports("sse2")) {
+			level = PixelKernels::SIMD_SSE2;
+		}
+#endif
+
+		// Lets benchmarks and tests compare implementations on the same machine
+		const char* cap = getenv("MOSAIC_SIMD");
+
+		if (cap != NULL) {
+			if (strcmp(cap, "scalar") == 0) {
+				level = PixelKernels::SIMD_SCALAR;
+			} else if (strcmp(cap, "sse2") == 0) {
+				level = min(level, PixelKernels::SIMD_SSE2);
+			}
+		}
+
+		return level;
+	}
+
+	PixelKernels::SimdLevel PixelKernels::GetSimdLevel() {
+		static SimdLevel level = detect_simd_level();
+		return level;
+	}
+
+	const char* PixelKernels::GetSimdLevelName() {
+		switch (GetSimdLevel()) {
+			case SIMD_AVX2: return "avx2";
+			case SIMD_SSE2: return "sse2";
+			default: return "scalar";
+		}
+	}
+
+	static inline uint32_t* get_row(uint8_t* pixels, int stride, int y) {
+		return (uint32_t*)(pixels + (size_t)y * stride);
+	}
+
+	void PixelKernels::Fill(uint8_t* pixels, int width, int height, int stride, uint32_t color) {
+		auto fill_row = fill_row_scalar;
+
+#ifdef MOSAIC_X86
+		if (GetSimdLevel() == SIMD_AVX2) {
+			fill_row = fill_row_avx2;
+		} else if (GetSimdLevel() == SIMD_SSE2) {
+			fill_row = fill_row_sse2;
+		}
+#endif
+
+		for (int y = 0; y < height; y++) {
+			fill_row(get_row(pixels, stride, y), width, color);
+		}
+	}
+
+	void PixelKernels::Blend(uint8_t* dst, int dst_stride, const uint8_t* src, int src_stride, int width, int height, uint8_t opacity) {
+		if (opacity == 0) {
+			return;
+		}
+
+		auto blend_row = blend_row_scalar;
+
+#ifdef MOSAIC_X86
+		if (GetSimdLevel() == SIMD_AVX2) {
+			blend_row = blend_row_avx2;
+		} else if (GetSimdLevel() == SIMD_SSE2) {
+			blend_row = blend_row_sse2;
+		}
+#endif
+
+		for (int y = 0; y < height; y++) {
+			blend_row(get_row(dst, dst_stride, y), (const uint32_t*)(src + (size_t)y * src_stride), width, opacity);
+		}
+	}
+
+	void PixelKernels::Premultiply(uint8_t* pixels, int width, int height, int stride) {
+		auto premultiply_row = premultiply_row_scalar;
+
+#ifdef MOSAIC_X86
+		if (GetSimdLevel() == SIMD_AVX2) {
+			premultiply_row = premultiply_row_avx2;
+		} else if (GetSimdLevel() == SIMD_SSE2) {
+			premultiply_row = premultiply_row_sse2;
+		}
+#endif
+
+		for (int y = 0; y < height; y++) {
+			premultiply_row(get_row(pixels, stride, y), width);
+		}
+	}
+
+	void PixelKernels::Unpremultiply(uint8_t* pixels, int width, int height, int stride) {
+		auto unpremultiply_row = unpremultiply_row_scalar;
+
+#ifdef MOSAIC_X86
+		if (GetSimdLevel() == SIMD_AVX2) {
+			unpremultiply_row = unpremultiply_row_avx2;
+		} else if (GetSimdLevel() == SIMD_SSE2) {
+			unpremultiply_row = unpremultiply_row_sse2;
+		}
+#endif
+
+		for (int y = 0; y < height; y++) {
+			unpremultiply_row(get_row(pixels, stride, y), width);
+		}
+	}
+
+	void PixelKernels::BoxBlur(uint8_t* pixels, int width, int height, int stride, int radius) {
+		if (radius <= 0 || width <= 0 || height <= 0) {
+			return;
+		}
+
+		// A window past the image only repeats its edges, and a huge one would overflow the kernel size
+		radius = min(radius, max(width, height));
+
+		auto blur_row = blur_row_scalar;
+		auto accumulate_row = accumulate_row_scalar;
+		auto store_row = store_row_scalar;
+
+#ifdef MOSAIC_X86
+		// The horizontal pass walks one pixel at a time, so it gains nothing past SSE2
+		if (GetSimdLevel() >= SIMD_SSE2) {
+			blur_row = blur_row_sse2;
+			accumulate_row = accumulate_row_sse2;
+			store_row = store_row_sse2;
+		}
+
+		if (GetSimdLevel() == SIMD_AVX2) {
+			accumulate_row = accumulate_row_avx2;
+			store_row = store_row_avx2;
+		}
+#endif
+
+		float scale = 1.0f / (2 * radius + 1);
+		vector<uint32_t> horizontal((size_t)width * height);
+
+		for (int y = 0; y < height; y++) {
+			blur_row(get_row(pixels, stride, y), horizontal.data() + (size_t)y * width, width, radius, scale);
+		}
+
+		// The vertical pass keeps running sums for a whole row, so it streams rows instead of columns
+		vector<int32_t> sums((size_t)width * 4, 0);
+		auto get_horizontal_row = [&](int y) { return horizontal.data() + (size_t)clamp(y, 0, height - 1) * width; };
+
+		for (int i = -radius; i <= radius; i++) {
+			accumulate_row(sums.data(), get_horizontal_row(i), NULL, width);
+		}
+
+		for (int y = 0; y < height; y++) {
+			store_row(sums.data(), get_row(pixels, stride, y), width, scale);
+			accumulate_row(sums.data(), get_horizontal_row(y + radius + 1), get_horizontal_row(y - radius), width);
+		}
+	}
+}
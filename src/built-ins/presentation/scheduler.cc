@@ -0,0 +1,158 @@
+#include <functional>
+#include <v8.h>
+#include <gtk-3.0/gtk/gtk.h>
+#include <piston_native_class.h>
+#include <piston_native_module.h>
+#include <built-ins/presentation/scheduler.h>
+#include <runtime/frame_scheduler.h>
+#include <runtime/performance_monitor.h>
+#include <memory>
+#include <algorithm>
+#include <math.h>
+
+using namespace v8;
+using namespace std;
+using namespace mosaic::runtime;
+
+namespace mosaic::presentation {
+	Local<Function> Scheduler::Make(Local<Context> context) {
+		Isolate* isolate = context->GetIsolate();
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<FunctionTemplate> class_tpl = FunctionTemplate::New(isolate, ConstructorCallback);
+		class_tpl->SetClassName(String::NewFromUtf8(isolate, "Scheduler").ToLocalChecked());
+
+		class_tpl->Set(String::NewFromUtf8(isolate, "postTask").ToLocalChecked(), FunctionTemplate::New(isolate, PostTaskCallback));
+		class_tpl->Set(String::NewFromUtf8(isolate, "shouldYield").ToLocalChecked(), FunctionTemplate::New(isolate, ShouldYieldCallback));
+
+		return handle_scope.Escape(class_tpl->GetFunction(context).ToLocalChecked());
+	}
+
+	void Scheduler::ConstructorCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		isolate->ThrowException(Exception::TypeError(
+			String::NewFromUtf8(isolate, "Unable to instantiate static class.").ToLocalChecked()
+		));
+	}
+
+	void Scheduler::PostTaskCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+
+		if (args.Length() < 1 || !args[0]->IsFunction()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: first argument must be a function.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		FrameScheduler::Priority priority = FrameScheduler::PRIORITY_USER_VISIBLE;
+		double delay = 0;
+
+		if (args.Length() > 1 && args[1]->IsObject()) {
+			Local<Object> options = Local<Object>::Cast(args[1]);
+			Local<Value> priority_value = options->Get(context, String::NewFromUtf8(isolate, "priority").ToLocalChecked()).ToLocalChecked();
+			Local<Value> delay_value = options->Get(context, String::NewFromUtf8(isolate, "delay").ToLocalChecked()).ToLocalChecked();
+
+			if (!priority_value->IsUndefined()) {
+				String::Utf8Value priority_name(isolate, priority_value);
+
+				if (!FrameScheduler::ParsePriority(*priority_name, &priority)) {
+					isolate->ThrowException(Exception::TypeError(
+						String::NewFromUtf8(isolate, "Unable to execute method: priority must be 'user-blocking', 'user-visible' or 'background'.").ToLocalChecked()
+					));
+
+					return;
+				}
+			}
+
+			delay = delay_value->NumberValue(context).FromMaybe(0.0);
+
+			if (!delay_value->IsUndefined() && !isfinite(delay)) {
+				isolate->ThrowException(Exception::RangeError(
+					String::NewFromUtf8(isolate, "Unable to execute method: delay must be a finite number.").ToLocalChecked()
+				));
+
+				return;
+			}
+		}
+
+		// GLib timeouts take 32-bit milliseconds, longer delays wait as long as they can
+		guint delay_ms = delay > 0 ? (guint)min(delay, (double)G_MAXUINT) : 0;
+
+		Local<Promise::Resolver> resolver = Promise::Resolver::New(context).ToLocalChecked();
+
+		// Globals are not copyable, so share them with the task closure
+		auto persistent_context = make_shared<Global<Context>>(isolate, context);
+		auto persistent_callback = make_shared<Global<Function>>(isolate, Local<Function>::Cast(args[0]));
+		auto persistent_resolver = make_shared<Global<Promise::Resolver>>(isolate, resolver);
+
+		FrameScheduler::GetInstance()->Post(priority, [isolate, persistent_context, persistent_callback, persistent_resolver]() {
+			HandleScope handle_scope(isolate);
+			Local<Context> context = persistent_context->Get(isolate);
+			Local<Function> callback = persistent_callback->Get(isolate);
+			Local<Promise::Resolver> resolver = persistent_resolver->Get(isolate);
+			Context::Scope context_scope(context);
+			TryCatch try_catch(isolate);
+
+			MaybeLocal<Value> result;
+
+			{
+				PerformanceMonitor::Scope measure("task", callback);
+				result = callback->Call(context, context->Global(), 0, NULL);
+			}
+
+			if (try_catch.HasCaught()) {
+				resolver->Reject(context, try_catch.Exception()).Check();
+			} else {
+				resolver->Resolve(context, result.ToLocalChecked()).Check();
+			}
+
+			// Continuations of the task belong to its slice
+			isolate->PerformMicrotaskCheckpoint();
+		}, delay_ms);
+
+		args.GetReturnValue().Set(resolver->GetPromise());
+	}
+
+	void Scheduler::ShouldYieldCallback(const FunctionCallbackInfo<Value> &args) {
+		args.GetReturnValue().Set(Boolean::New(args.GetIsolate(), FrameScheduler::GetInstance()->ShouldYield()));
+	}
+
+	Local<Module> SchedulerModule::Make(Isolate* isolate) {
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<Module> module = Module::CreateSyntheticModule(
+			isolate,
+			String::NewFromUtf8(isolate, "Scheduler").ToLocalChecked(),
+			{
+				String::NewFromUtf8(isolate, "default").ToLocalChecked(),
+				String::NewFromUtf8(isolate, "Scheduler").ToLocalChecked()
+			},
+			[](Local<Context> context, Local<Module> module) -> MaybeLocal<Value> {
+				Isolate* isolate = context->GetIsolate();
+				HandleScope handle_scope(isolate);
+
+				Local<Function> constructor = Scheduler::GetConstructor(context);
+
+				module->SetSyntheticModuleExport(
+					isolate,
+					String::NewFromUtf8(isolate, "default").ToLocalChecked(),
+					constructor
+				);
+
+				module->SetSyntheticModuleExport(
+					isolate,
+					String::NewFromUtf8(isolate, "Scheduler").ToLocalChecked(),
+					constructor
+				);
+
+				return MaybeLocal<Value>(True(isolate));
+			}
+		);
+
+		return handle_scope.Escape(module);
+	}
+}
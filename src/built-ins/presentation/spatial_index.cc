@@ -0,0 +1,298 @@
+#include <functional>
+#include <v8.h>
+#include <gtk-3.0/gtk/gtk.h>
+#include <piston_native_class.h>
+#include <piston_native_module.h>
+#include <built-ins/presentation/spatial_index.h>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <math.h>
+
+using namespace v8;
+using namespace std;
+
+namespace mosaic::presentation {
+	static AabbTree::Rect make_rect(float x, float y, float width, float height) {
+		// Negative sizes extend to the left or top, like cairo rectangles
+		return { min(x, x + width), min(y, y + height), max(x, x + width), max(y, y + height) };
+	}
+
+	// NaN or infinite bounds would poison every box above them in the tree
+	static inline bool is_finite_rect(const AabbTree::Rect& rect) {
+		return isfinite(rect.min_x) && isfinite(rect.min_y) && isfinite(rect.max_x) && isfinite(rect.max_y);
+	}
+
+	SpatialIndex::SpatialIndex() {
+		this->reported_memory_ = 0;
+	}
+
+	SpatialIndex::~SpatialIndex() {
+		Isolate::GetCurrent()->AdjustAmountOfExternalAllocatedMemory(-(int64_t)this->reported_memory_);
+	}
+
+	void SpatialIndex::ReportMemory(Isolate* isolate) {
+		size_t memory = this->tree_.GetMemorySize();
+
+		if (memory != this->reported_memory_) {
+			isolate->AdjustAmountOfExternalAllocatedMemory((int64_t)memory - (int64_t)this->reported_memory_);
+			this->reported_memory_ = memory;
+		}
+	}
+
+	Local<Function> SpatialIndex::Make(Local<Context> context) {
+		Isolate* isolate = context->GetIsolate();
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<FunctionTemplate> class_tpl = FunctionTemplate::New(isolate, ConstructorCallback);
+		class_tpl->SetClassName(String::NewFromUtf8(isolate, "SpatialIndex").ToLocalChecked());
+		class_tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+		Local<ObjectTemplate> proto_tpl = class_tpl->PrototypeTemplate();
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "size").ToLocalChecked(), GetSizeCallback);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "set").ToLocalChecked(), FunctionTemplate::New(isolate, SetCallback));
+		proto_tpl->Set(String::NewFromUtf8(isolate, "setMany").ToLocalChecked(), FunctionTemplate::New(isolate, SetManyCallback));
+		proto_tpl->Set(String::NewFromUtf8(isolate, "delete").ToLocalChecked(), FunctionTemplate::New(isolate, DeleteCallback));
+		proto_tpl->Set(String::NewFromUtf8(isolate, "has").ToLocalChecked(), FunctionTemplate::New(isolate, HasCallback));
+		proto_tpl->Set(String::NewFromUtf8(isolate, "clear").ToLocalChecked(), FunctionTemplate::New(isolate, ClearCallback));
+		proto_tpl->Set(String::NewFromUtf8(isolate, "getBounds").ToLocalChecked(), FunctionTemplate::New(isolate, GetBoundsCallback));
+		proto_tpl->Set(String::NewFromUtf8(isolate, "hitTest").ToLocalChecked(), FunctionTemplate::New(isolate, HitTestCallback));
+		proto_tpl->Set(String::NewFromUtf8(isolate, "query").ToLocalChecked(), FunctionTemplate::New(isolate, QueryCallback));
+
+		return handle_scope.Escape(class_tpl->GetFunction(context).ToLocalChecked());
+	}
+
+	void SpatialIndex::ConstructorCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+
+		if (!args.IsConstructCall()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Please use the 'new' operator, this constructor cannot be called as a function.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		SpatialIndex* instance = new SpatialIndex();
+		instance->Wrap(args.This());
+		instance->MakeWeak();
+		args.GetReturnValue().Set(args.This());
+	}
+
+	void SpatialIndex::SetCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+		SpatialIndex* self = NativeClass::Unwrap(args.This());
+
+		if (args.Length() < 5) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: 5 arguments required.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		int32_t id = args[0]->Int32Value(context).FromMaybe(0);
+		float x = (float)args[1]->NumberValue(context).FromMaybe(0.0);
+		float y = (float)args[2]->NumberValue(context).FromMaybe(0.0);
+		float width = (float)args[3]->NumberValue(context).FromMaybe(0.0);
+		float height = (float)args[4]->NumberValue(context).FromMaybe(0.0);
+
+		AabbTree::Rect rect = make_rect(x, y, width, height);
+
+		if (!is_finite_rect(rect)) {
+			isolate->ThrowException(Exception::RangeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: bounds must be finite numbers.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		self->tree_.Set(id, rect);
+		self->ReportMemory(isolate);
+	}
+
+	void SpatialIndex::SetManyCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		SpatialIndex* self = NativeClass::Unwrap(args.This());
+
+		if (args.Length() < 2 || !args[0]->IsInt32Array() || !args[1]->IsFloat32Array()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: expected an Int32Array of ids and a Float32Array of bounds.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		Local<Int32Array> ids_array = Local<Int32Array>::Cast(args[0]);
+		Local<Float32Array> bounds_array = Local<Float32Array>::Cast(args[1]);
+
+		// x, y, width and height for every id
+		if (bounds_array->Length() < ids_array->Length() * 4) {
+			isolate->ThrowException(Exception::RangeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: bounds must hold 4 numbers per id.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		const int32_t* ids = (const int32_t*)((const char*)ids_array->Buffer()->GetBackingStore()->Data() + ids_array->ByteOffset());
+		const float* bounds = (const float*)((const char*)bounds_array->Buffer()->GetBackingStore()->Data() + bounds_array->ByteOffset());
+		size_t count = ids_array->Length();
+
+		// Checked up front, so a bad entry leaves the index as it was
+		for (size_t i = 0; i < count; i++) {
+			const float* values = bounds + i * 4;
+
+			if (!is_finite_rect(make_rect(values[0], values[1], values[2], values[3]))) {
+				string message = "Unable to execute method: bounds of entry " + to_string(i) + " must be finite numbers.";
+				isolate->ThrowException(Exception::RangeError(String::NewFromUtf8(isolate, message.c_str()).ToLocalChecked()));
+
+				return;
+			}
+		}
+
+		for (size_t i = 0; i < count; i++) {
+			const float* values = bounds + i * 4;
+			self->tree_.Set(ids[i], make_rect(values[0], values[1], values[2], values[3]));
+		}
+
+		self->ReportMemory(isolate);
+	}
+
+	void SpatialIndex::DeleteCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		SpatialIndex* self = NativeClass::Unwrap(args.This());
+
+		int32_t id = args[0]->Int32Value(isolate->GetCurrentContext()).FromMaybe(0);
+		args.GetReturnValue().Set(Boolean::New(isolate, args.Length() > 0 && self->tree_.Remove(id)));
+		self->ReportMemory(isolate);
+	}
+
+	void SpatialIndex::HasCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		SpatialIndex* self = NativeClass::Unwrap(args.This());
+
+		int32_t id = args[0]->Int32Value(isolate->GetCurrentContext()).FromMaybe(0);
+		args.GetReturnValue().Set(Boolean::New(isolate, args.Length() > 0 && self->tree_.Has(id)));
+	}
+
+	void SpatialIndex::ClearCallback(const FunctionCallbackInfo<Value> &args) {
+		SpatialIndex* self = NativeClass::Unwrap(args.This());
+		self->tree_.Clear();
+		self->ReportMemory(args.GetIsolate());
+	}
+
+	void SpatialIndex::GetBoundsCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+		SpatialIndex* self = NativeClass::Unwrap(args.This());
+
+		int32_t id = args[0]->Int32Value(context).FromMaybe(0);
+		AabbTree::Rect bounds;
+
+		if (args.Length() < 1 || !self->tree_.GetBounds(id, &bounds)) {
+			args.GetReturnValue().Set(Undefined(isolate));
+			return;
+		}
+
+		Local<Object> result = Object::New(isolate);
+		result->Set(context, String::NewFromUtf8(isolate, "x").ToLocalChecked(), Number::New(isolate, bounds.min_x)).Check();
+		result->Set(context, String::NewFromUtf8(isolate, "y").ToLocalChecked(), Number::New(isolate, bounds.min_y)).Check();
+		result->Set(context, String::NewFromUtf8(isolate, "width").ToLocalChecked(), Number::New(isolate, bounds.max_x - bounds.min_x)).Check();
+		result->Set(context, String::NewFromUtf8(isolate, "height").ToLocalChecked(), Number::New(isolate, bounds.max_y - bounds.min_y)).Check();
+
+		args.GetReturnValue().Set(result);
+	}
+
+	void SpatialIndex::HitTestCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		Local<Context> context = isolate->GetCurrentContext();
+		SpatialIndex* self = NativeClass::Unwrap(args.This());
+
+		float x = (float)args[0]->NumberValue(context).FromMaybe(0.0);
+		float y = (float)args[1]->NumberValue(context).FromMaybe(0.0);
+		int32_t id;
+
+		if (args.Length() >= 2 && self->tree_.HitTest(x, y, &id)) {
+			args.GetReturnValue().Set(Integer::New(isolate, id));
+		} else {
+			args.GetReturnValue().Set(Undefined(isolate));
+		}
+	}
+
+	void SpatialIndex::QueryCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+		SpatialIndex* self = NativeClass::Unwrap(args.This());
+
+		if (args.Length() < 4) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: 4 arguments required.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		float x = (float)args[0]->NumberValue(context).FromMaybe(0.0);
+		float y = (float)args[1]->NumberValue(context).FromMaybe(0.0);
+		float width = (float)args[2]->NumberValue(context).FromMaybe(0.0);
+		float height = (float)args[3]->NumberValue(context).FromMaybe(0.0);
+
+		vector<int32_t> ids;
+		self->tree_.Query(make_rect(x, y, width, height), [&ids](int32_t id) {
+			ids.push_back(id);
+		});
+
+		// One typed array instead of an array of boxed numbers
+		Local<ArrayBuffer> buffer = ArrayBuffer::New(isolate, ids.size() * sizeof(int32_t));
+		copy(ids.begin(), ids.end(), (int32_t*)buffer->GetBackingStore()->Data());
+
+		args.GetReturnValue().Set(Int32Array::New(buffer, 0, ids.size()));
+	}
+
+	void SpatialIndex::GetSizeCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		SpatialIndex* self = NativeClass::Unwrap(info.This());
+		info.GetReturnValue().Set(Number::New(info.GetIsolate(), (double)self->tree_.GetCount()));
+	}
+
+	Local<Module> SpatialIndexModule::Make(Isolate* isolate) {
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<Module> module = Module::CreateSyntheticModule(
+			isolate,
+			String::NewFromUtf8(isolate, "SpatialIndex").ToLocalChecked(),
+			{
+				String::NewFromUtf8(isolate, "default").ToLocalChecked(),
+				String::NewFromUtf8(isolate, "SpatialIndex").ToLocalChecked()
+			},
+			[](Local<Context> context, Local<Module> module) -> MaybeLocal<Value> {
+				Isolate* isolate = context->GetIsolate();
+				HandleScope handle_scope(isolate);
+
+				Local<Function> constructor = SpatialIndex::GetConstructor(context);
+
+				module->SetSyntheticModuleExport(
+					isolate,
+					String::NewFromUtf8(isolate, "default").ToLocalChecked(),
+					constructor
+				);
+
+				module->SetSyntheticModuleExport(
+					isolate,
+					String::NewFromUtf8(isolate, "SpatialIndex").ToLocalChecked(),
+					constructor
+				);
+
+				return MaybeLocal<Value>(True(isolate));
+			}
+		);
+
+		return handle_scope.Escape(module);
+	}
+}
@@ -0,0 +1,106 @@
+#include <gtk-3.0/gtk/gtk.h>
+#include <pango/pangocairo.h>
+#include <built-ins/presentation/text_layout_cache.h>
+
+using namespace std;
+
+namespace mosaic::presentation {
+	TextLayoutCache* TextLayoutCache::instance_ = nullptr;
+
+	// Comfortably more labels than a dense table shows at once
+	static const size_t default_capacity = 8192;
+
+	// Layouts copy their description, so dropping one only costs a parse the next time
+	static const size_t font_capacity = 64;
+
+	TextLayoutCache::TextLayoutCache(size_t capacity) {
+		this->capacity_ = capacity;
+		this->context_ = pango_font_map_create_context(pango_cairo_font_map_get_default());
+	}
+
+	TextLayoutCache::~TextLayoutCache() {
+		this->Clear();
+
+		for (FontEntry& font : this->fonts_) {
+			pango_font_description_free(font.description);
+		}
+
+		g_object_unref(this->context_);
+	}
+
+	TextLayoutCache* TextLayoutCache::GetInstance() {
+		if (instance_ == nullptr) {
+			instance_ = new TextLayoutCache(default_capacity);
+		}
+
+		return instance_;
+	}
+
+	void TextLayoutCache::Shutdown() {
+		delete instance_;
+		instance_ = nullptr;
+	}
+
+	PangoLayout* TextLayoutCache::Get(const string& text, const string& font, int max_width) {
+		// Fonts and widths never contain NUL, so the key can't be ambiguous
+		string key = font + '\0' + to_string(max_width) + '\0' + text;
+		auto found = this->index_.find(key);
+
+		if (found != this->index_.end()) {
+			this->entries_.splice(this->entries_.begin(), this->entries_, found->second);
+			return found->second->layout;
+		}
+
+		PangoLayout* layout = pango_layout_new(this->context_);
+		pango_layout_set_font_description(layout, this->GetFontDescription(font));
+		pango_layout_set_text(layout, text.c_str(), text.size());
+
+		if (max_width >= 0) {
+			pango_layout_set_width(layout, max_width * PANGO_SCALE);
+			pango_layout_set_wrap(layout, PANGO_WRAP_WORD_CHAR);
+		}
+
+		this->entries_.push_front({ key, layout });
+		this->index_[key] = this->entries_.begin();
+
+		if (this->entries_.size() > this->capacity_) {
+			Entry& oldest = this->entries_.back();
+			g_object_unref(oldest.layout);
+			this->index_.erase(oldest.key);
+			this->entries_.pop_back();
+		}
+
+		return layout;
+	}
+
+	void TextLayoutCache::Clear() {
+		for (Entry& entry : this->entries_) {
+			g_object_unref(entry.layout);
+		}
+
+		this->entries_.clear();
+		this->index_.clear();
+	}
+
+	PangoFontDescription* TextLayoutCache::GetFontDescription(const string& font) {
+		auto found = this->font_index_.find(font);
+
+		if (found != this->font_index_.end()) {
+			this->fonts_.splice(this->fonts_.begin(), this->fonts_, found->second);
+			return found->second->description;
+		}
+
+		PangoFontDescription* description = pango_font_description_from_string(font.c_str());
+		this->fonts_.push_front({ font, description });
+		this->font_index_[font] = this->fonts_.begin();
+
+		if (this->fonts_.size() > font_capacity) {
+			FontEntry& oldest = this->fonts_.back();
+			pango_font_description_free(oldest.description);
+			this->font_index_.erase(oldest.font);
+			this->fonts_.pop_back();
+		}
+
+		return description;
+	}
+}
\ No newline at end of file
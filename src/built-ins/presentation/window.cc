@@ -5,7 +5,13 @@
 #include <piston_native_module.h>
 #include <built-ins/presentation/window.h>
 #include <built-ins/presentation/button.h>
+#include <built-ins/presentation/drawing_area.h>
+#include <built-ins/presentation/headless.h>
+#include <built-ins/presentation/image_data.h>
+#include <runtime/event_dispatcher.h>
+#include <runtime/frame_scheduler.h>
 #include <stdio.h>
+#include <algorithm>
 #include <glib.h>
 #include "loader.h"
 
@@ -14,42 +20,91 @@ using namespace std::placeholders;
 
 namespace mosaic::presentation {
 	Window::Window(char* title, int width, int height) {
+		this->frame_stats_ = new FrameStats(string("Window '") + title + "'");
+		this->painted_ = false;
+		this->child_ = NULL;
+		this->surface_ = NULL;
+
+		if (Headless::IsEnabled()) {
+			this->SetGtkWidget(NULL);
+			this->_last_width = width;
+			this->_last_height = height;
+			this->title_ = title;
+			this->width_ = width;
+			this->height_ = height;
+			this->min_width_ = -1;
+			this->min_height_ = -1;
+			this->resizable_ = true;
+			this->shown_ = false;
+			return;
+		}
+
 		this->SetGtkWidget(gtk_application_window_new(gtk_app));
 		gtk_window_set_title(GTK_WINDOW(this->GetGtkWidget()), title);
 		gtk_window_set_default_size(GTK_WINDOW(this->GetGtkWidget()), width, height);
 
-		g_signal_connect(this->GetGtkWidget(), "configure-event", G_CALLBACK(+[](GtkWidget* widget, GdkEvent* event, gpointer user_data) {
-			Isolate* isolate = Isolate::GetCurrent();
-			HandleScope handle_scope(isolate);
-			Local<Context> context = isolate->GetCurrentContext();
+		// The frame clock only exists once the window is realized
+		g_signal_connect(this->GetGtkWidget(), "realize", G_CALLBACK(+[](GtkWidget* widget, gpointer user_data) {
+			GdkFrameClock* clock = gtk_widget_get_frame_clock(widget);
+
+			g_signal_connect(clock, "before-paint", G_CALLBACK(+[](GdkFrameClock* clock, gpointer user_data) {
+				Window* self = (Window*)user_data;
+				self->painted_ = false;
+				self->frame_stats_->BeginFrame();
+				mosaic::runtime::FrameScheduler::GetInstance()->BeginFrame(clock);
+			}), user_data);
+
+			g_signal_connect(clock, "after-paint", G_CALLBACK(+[](GdkFrameClock* clock, gpointer user_data) {
+				Window* self = (Window*)user_data;
+				mosaic::runtime::FrameScheduler::GetInstance()->EndFrame(clock);
+
+				if (self->painted_) {
+					self->frame_stats_->EndFrame(clock);
+				} else {
+					self->frame_stats_->CancelFrame();
+				}
+			}), user_data);
+		}), this);
+
+		g_signal_connect(this->GetGtkWidget(), "draw", G_CALLBACK(+[](GtkWidget* widget, cairo_t* cairo_context, gpointer user_data) {
+			((Window*)user_data)->painted_ = true;
+			return FALSE;
+		}), this);
 
+		g_signal_connect(this->GetGtkWidget(), "configure-event", G_CALLBACK(+[](GtkWidget* widget, GdkEvent* event, gpointer user_data) {
 			Window* self = (Window*)user_data;
 
 			int width = self->GetWidth();
 			int height = self->GetHeight();
 
 			if (width != self->_last_width || height != self->_last_height) {
-				Local<Function> resize_callback = Local<Function>::New(isolate, self->resize_callback_);
-
 				self->_last_width = width;
 				self->_last_height = height;
 
-				if (!resize_callback.IsEmpty()) {
-					Local<Value> args[2];
-					args[0] = Number::New(isolate, width);
-					args[1] = Number::New(isolate, height);
-
-					resize_callback->Call(context, context->Global(), 2, args);
+				if (!self->resize_callback_.IsEmpty()) {
+					mosaic::runtime::EventDispatcher::GetInstance()->Post("resize", &self->resize_callback_, { (double)width, (double)height });
 				}
 			}
 		}), this);
 	}
 
 	void Window::Show() {
+		if (this->IsHeadless()) {
+			this->shown_ = true;
+			Headless::AddWindow(this);
+			return;
+		}
+
 		gtk_window_present(GTK_WINDOW(this->GetGtkWidget()));
 	}
 
 	void Window::Close() {
+		if (this->IsHeadless()) {
+			this->shown_ = false;
+			Headless::RemoveWindow(this);
+			return;
+		}
+
 		gtk_window_close(GTK_WINDOW(this->GetGtkWidget()));
 	}
 	
@@ -57,59 +112,223 @@ namespace mosaic::presentation {
 		gtk_container_add(GTK_CONTAINER(widget_), widget);
 	}
 
+	void Window::AddChild(DrawingArea* drawing_area) {
+		// Like a GtkWindow, the single child fills the whole window
+		this->child_ = drawing_area;
+		this->Invalidate();
+	}
+
 	void Window::Invalidate() {
+		this->frame_stats_->MarkInvalidated();
+
+		if (this->IsHeadless()) {
+			if (this->child_ != NULL) {
+				this->child_->Invalidate();
+			}
+
+			Headless::QueueFrame();
+			return;
+		}
+
+		// Retained drawing areas would otherwise replay their old display list
+		DrawingArea::InvalidateDescendants(this->GetGtkWidget());
 		gtk_widget_queue_draw(this->GetGtkWidget());
 	}
 
+	void Window::InvalidateRect(int x, int y, int width, int height) {
+		this->frame_stats_->MarkInvalidated();
+
+		if (this->IsHeadless()) {
+			// The child fills the whole window, so only the part over the window concerns it
+			GdkRectangle bounds = { 0, 0, this->width_, this->height_ };
+			GdkRectangle damage = { x, y, width, height };
+
+			if (this->child_ != NULL && gdk_rectangle_intersect(&bounds, &damage, &damage)) {
+				this->child_->InvalidateRect(damage.x, damage.y, damage.width, damage.height);
+			}
+
+			Headless::QueueFrame();
+			return;
+		}
+
+		DrawingArea::InvalidateDescendantsRect(this->GetGtkWidget(), x, y, width, height);
+		gtk_widget_queue_draw_area(this->GetGtkWidget(), x, y, width, height);
+	}
+
+	void Window::Resize(int width, int height) {
+		width = max(width, this->min_width_);
+		height = max(height, this->min_height_);
+
+		if (width == this->width_ && height == this->height_) {
+			return;
+		}
+
+		this->width_ = width;
+		this->height_ = height;
+		this->_last_width = width;
+		this->_last_height = height;
+		this->Invalidate();
+
+		if (!this->resize_callback_.IsEmpty()) {
+			mosaic::runtime::EventDispatcher::GetInstance()->Post("resize", &this->resize_callback_, { (double)width, (double)height });
+		}
+	}
+
+	void Window::Render() {
+		if (this->surface_ == NULL || cairo_image_surface_get_width(this->surface_) != this->width_ || cairo_image_surface_get_height(this->surface_) != this->height_) {
+			if (this->surface_ != NULL) {
+				cairo_surface_destroy(this->surface_);
+			}
+
+			this->surface_ = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, max(this->width_, 0), max(this->height_, 0));
+		}
+
+		this->frame_stats_->BeginFrame();
+
+		// A plain background instead of the GTK theme's, so captures match on every machine
+		cairo_t* cr = cairo_create(this->surface_);
+		cairo_set_source_rgb(cr, 1, 1, 1);
+		cairo_paint(cr);
+
+		if (this->child_ != NULL) {
+			this->child_->RenderHeadless(cr, this->width_, this->height_);
+		}
+
+		cairo_destroy(cr);
+		cairo_surface_flush(this->surface_);
+
+		this->frame_stats_->EndFrame(NULL);
+	}
+
+	cairo_surface_t* Window::Capture() {
+		int width = this->GetWidth();
+		int height = this->GetHeight();
+		cairo_surface_t* capture = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, max(width, 0), max(height, 0));
+		cairo_t* cr = cairo_create(capture);
+
+		if (this->IsHeadless()) {
+			// The last frame, or a first one when none was stepped yet
+			if (this->surface_ == NULL) {
+				this->Render();
+			}
+
+			cairo_set_source_surface(cr, this->surface_, 0, 0);
+			cairo_paint(cr);
+		} else if (gtk_widget_get_realized(this->GetGtkWidget())) {
+			gtk_widget_draw(this->GetGtkWidget(), cr);
+		}
+
+		cairo_destroy(cr);
+		cairo_surface_flush(capture);
+
+		return capture;
+	}
+
 	int Window::GetWidth() {
+		if (this->IsHeadless()) {
+			return this->width_;
+		}
+
     	return gtk_widget_get_allocated_width(this->GetGtkWidget());
 	}
 
 	void Window::SetWidth(int value) {
+		if (this->IsHeadless()) {
+			this->Resize(value, this->height_);
+			return;
+		}
+
 		gtk_window_resize(GTK_WINDOW(this->GetGtkWidget()), value, this->GetHeight());
 	}
 
 	int Window::GetHeight() {
+		if (this->IsHeadless()) {
+			return this->height_;
+		}
+
     	return gtk_widget_get_allocated_height(this->GetGtkWidget());
 	}
 
 	void Window::SetHeight(int value) {
+		if (this->IsHeadless()) {
+			this->Resize(this->width_, value);
+			return;
+		}
+
 		gtk_window_resize(GTK_WINDOW(this->GetGtkWidget()), this->GetWidth(), value);
 	}
 
 	int Window::GetMinWidth() {
+		if (this->IsHeadless()) {
+			return this->min_width_;
+		}
+
 		gint requested_width;
 		gtk_widget_get_size_request(this->GetGtkWidget(), &requested_width, NULL);
 		return requested_width;
 	}
 
 	void Window::SetMinWidth(int value) {
+		if (this->IsHeadless()) {
+			this->min_width_ = value;
+			this->Resize(this->width_, this->height_);
+			return;
+		}
+
 		gtk_widget_set_size_request(this->GetGtkWidget(), value, this->GetMinHeight());
 	}
 
 	int Window::GetMinHeight() {
+		if (this->IsHeadless()) {
+			return this->min_height_;
+		}
+
 		gint requested_height;
 		gtk_widget_get_size_request(this->GetGtkWidget(), NULL, &requested_height);
 		return requested_height;
 	}
 
 	void Window::SetMinHeight(int value) {
+		if (this->IsHeadless()) {
+			this->min_height_ = value;
+			this->Resize(this->width_, this->height_);
+			return;
+		}
+
 		gtk_widget_set_size_request(this->GetGtkWidget(), this->GetMinWidth(), value);
 	}
 
 	bool Window::GetResizable() {
+		if (this->IsHeadless()) {
+			return this->resizable_;
+		}
+
 		return gtk_window_get_resizable(GTK_WINDOW(this->GetGtkWidget()));
 	}
 
 	void Window::SetResizable(bool value) {
+		if (this->IsHeadless()) {
+			this->resizable_ = value;
+			return;
+		}
+
 		gtk_window_set_resizable(GTK_WINDOW(this->GetGtkWidget()), value);
 	}
 
 	const char* Window::GetTitle() {
+		if (this->IsHeadless()) {
+			return this->title_.c_str();
+		}
+
 		return gtk_window_get_title(GTK_WINDOW(this->GetGtkWidget()));
 	}
 
 	void Window::SetTitle(const char* value) {
+		if (this->IsHeadless()) {
+			this->title_ = value;
+			return;
+		}
+
 		gtk_window_set_title(GTK_WINDOW(this->GetGtkWidget()), value);
 	}
 
@@ -120,17 +339,22 @@ namespace mosaic::presentation {
 		Local<FunctionTemplate> class_tpl = FunctionTemplate::New(isolate, ConstructorCallback);
 		class_tpl->SetClassName(String::NewFromUtf8(isolate, "Window").ToLocalChecked());
 		class_tpl->InstanceTemplate()->SetInternalFieldCount(1);
+		AddTemplate(isolate, class_tpl);
 
 		Local<FunctionTemplate> show_tpl = FunctionTemplate::New(isolate, ShowCallback);
 		Local<FunctionTemplate> close_tpl = FunctionTemplate::New(isolate, CloseCallback);
 		Local<FunctionTemplate> add_child_tpl = FunctionTemplate::New(isolate, AddChildCallback);
 		Local<FunctionTemplate> invalidate_tpl = FunctionTemplate::New(isolate, InvalidateCallback);
+		Local<FunctionTemplate> invalidate_rect_tpl = FunctionTemplate::New(isolate, InvalidateRectCallback);
+		Local<FunctionTemplate> capture_tpl = FunctionTemplate::New(isolate, CaptureCallback);
 
 		Local<ObjectTemplate> proto_tpl = class_tpl->PrototypeTemplate();
 		proto_tpl->Set(String::NewFromUtf8(isolate, "show").ToLocalChecked(), show_tpl);
 		proto_tpl->Set(String::NewFromUtf8(isolate, "close").ToLocalChecked(), close_tpl);
 		proto_tpl->Set(String::NewFromUtf8(isolate, "addChild").ToLocalChecked(), add_child_tpl);
 		proto_tpl->Set(String::NewFromUtf8(isolate, "invalidate").ToLocalChecked(), invalidate_tpl);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "invalidateRect").ToLocalChecked(), invalidate_rect_tpl);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "capture").ToLocalChecked(), capture_tpl);
 		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "width").ToLocalChecked(), GetWidthCallback, SetWidthCallback);
 		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "height").ToLocalChecked(), GetHeightCallback, SetHeightCallback);
 		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "minWidth").ToLocalChecked(), GetMinWidthCallback, SetMinWidthCallback);
@@ -138,6 +362,7 @@ namespace mosaic::presentation {
 		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "resizable").ToLocalChecked(), GetResizableCallback, SetResizableCallback);
 		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "title").ToLocalChecked(), GetTitleCallback, SetTitleCallback);
 		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "onResize").ToLocalChecked(), GetOnResizeCallback, SetOnResizeCallback);
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "frameStats").ToLocalChecked(), GetFrameStatsCallback);
 
 		return handle_scope.Escape(class_tpl->GetFunction(context).ToLocalChecked());
 	}
@@ -187,6 +412,21 @@ namespace mosaic::presentation {
 			isolate->ThrowException(Exception::TypeError(
 				String::NewFromUtf8(isolate, "Unable to execute method: 1 argument required.").ToLocalChecked()
 			));
+
+			return;
+		}
+
+		if (self->IsHeadless()) {
+			if (!DrawingArea::HasInstance(isolate, args[0])) {
+				isolate->ThrowException(Exception::TypeError(
+					String::NewFromUtf8(isolate, "Unable to execute method: only drawing areas can be added to headless windows.").ToLocalChecked()
+				));
+
+				return;
+			}
+
+			self->AddChild(DrawingArea::Unwrap(Local<Object>::Cast(args[0])));
+			return;
 		}
 
 		if (args[0]->IsObject()) {
@@ -207,6 +447,27 @@ namespace mosaic::presentation {
 		self->Invalidate();
 	}
 
+	void Window::InvalidateRectCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Window* self = NativeClass::Unwrap(args.This());
+
+		if (args.Length() < 4) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: 4 arguments required.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		int x = args[0]->Int32Value(isolate->GetCurrentContext()).FromMaybe(0);
+		int y = args[1]->Int32Value(isolate->GetCurrentContext()).FromMaybe(0);
+		int width = args[2]->Int32Value(isolate->GetCurrentContext()).FromMaybe(0);
+		int height = args[3]->Int32Value(isolate->GetCurrentContext()).FromMaybe(0);
+
+		self->InvalidateRect(x, y, width, height);
+	}
+
 	void Window::GetWidthCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
 		Isolate* isolate = info.GetIsolate();
 		HandleScope handle_scope(isolate);
@@ -354,6 +615,22 @@ namespace mosaic::presentation {
 		}
 	}
 
+	void Window::CaptureCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Window* self = NativeClass::Unwrap(args.This());
+
+		args.GetReturnValue().Set(ImageData::FromSurface(isolate->GetCurrentContext(), self->Capture()));
+	}
+
+	void Window::GetFrameStatsCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Isolate* isolate = info.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Window* self = NativeClass::Unwrap(info.This());
+
+		info.GetReturnValue().Set(self->frame_stats_->ToObject(isolate->GetCurrentContext()));
+	}
+
 	Local<Module> WindowModule::Make(Isolate* isolate) {
 		EscapableHandleScope handle_scope(isolate);
 
@@ -0,0 +1,234 @@
+#include <functional>
+#include <v8.h>
+#include <piston_native_class.h>
+#include <piston_native_module.h>
+#include <built-ins/simulation/entities.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace v8;
+using namespace std;
+
+namespace mosaic::simulation {
+	// Fields start on cache line boundaries, 16 floats apart at least
+	static const size_t field_alignment = 64;
+	static const size_t field_step = field_alignment / sizeof(float);
+
+	static const char* field_names[Entities::FIELD_COUNT] = { "x", "y", "vx", "vy", "width", "height", "colors", "rects" };
+
+	static inline size_t get_field_stride(size_t count) {
+		return (count + field_step - 1) / field_step * field_step;
+	}
+
+	Entities::Entities(Isolate* isolate, size_t count, void* memory) {
+		HandleScope handle_scope(isolate);
+
+		this->count_ = count;
+
+		size_t stride = get_field_stride(count);
+		float* data = (float*)memory;
+		size_t length = stride * (FIELD_RECTS + 4) * sizeof(float);
+
+		// One allocation for every field, rects taking 4 floats per entity
+		this->fields_.x = data;
+		this->fields_.y = data + stride;
+		this->fields_.vx = data + stride * 2;
+		this->fields_.vy = data + stride * 3;
+		this->fields_.width = data + stride * 4;
+		this->fields_.height = data + stride * 5;
+		this->fields_.rects = data + stride * 7;
+
+		// The buffer owns the memory, and the views keep it alive as long as this object
+		isolate->AdjustAmountOfExternalAllocatedMemory((int64_t)length);
+
+		// The deleter may run on a sweeper thread, lowering the count is safe from there
+		shared_ptr<BackingStore> backing_store = ArrayBuffer::NewBackingStore(
+			memory,
+			length,
+			[](void* data, size_t length, void* deleter_data) {
+				((Isolate*)deleter_data)->AdjustAmountOfExternalAllocatedMemory(-(int64_t)length);
+				free(data);
+			},
+			isolate
+		);
+
+		Local<ArrayBuffer> buffer = ArrayBuffer::New(isolate, backing_store);
+
+		for (int field = 0; field < FIELD_COLORS; field++) {
+			this->views_[field].Reset(isolate, Float32Array::New(buffer, field * stride * sizeof(float), count));
+		}
+
+		this->views_[FIELD_COLORS].Reset(isolate, Uint32Array::New(buffer, FIELD_COLORS * stride * sizeof(float), count));
+		this->views_[FIELD_RECTS].Reset(isolate, Float32Array::New(buffer, FIELD_RECTS * stride * sizeof(float), count * 4));
+	}
+
+	Entities::~Entities() {
+		// Views JS still holds keep the memory, the buffer frees it after the last one
+		for (int field = 0; field < FIELD_COUNT; field++) {
+			this->views_[field].Reset();
+		}
+	}
+
+	Local<Function> Entities::Make(Local<Context> context) {
+		Isolate* isolate = context->GetIsolate();
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<FunctionTemplate> class_tpl = FunctionTemplate::New(isolate, ConstructorCallback);
+		class_tpl->SetClassName(String::NewFromUtf8(isolate, "Entities").ToLocalChecked());
+		class_tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+		Local<ObjectTemplate> proto_tpl = class_tpl->PrototypeTemplate();
+		proto_tpl->SetAccessor(String::NewFromUtf8(isolate, "count").ToLocalChecked(), GetCountCallback);
+		proto_tpl->Set(String::NewFromUtf8(isolate, "step").ToLocalChecked(), FunctionTemplate::New(isolate, StepCallback));
+		proto_tpl->Set(String::NewFromUtf8(isolate, "pack").ToLocalChecked(), FunctionTemplate::New(isolate, PackCallback));
+
+		for (int field = 0; field < FIELD_COUNT; field++) {
+			proto_tpl->SetAccessor(
+				String::NewFromUtf8(isolate, field_names[field]).ToLocalChecked(),
+				GetFieldCallback,
+				nullptr,
+				Integer::New(isolate, field)
+			);
+		}
+
+		return handle_scope.Escape(class_tpl->GetFunction(context).ToLocalChecked());
+	}
+
+	void Entities::ConstructorCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+
+		if (!args.IsConstructCall()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Please use the 'new' operator, this constructor cannot be called as a function.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		if (args.Length() < 1 || !args[0]->IsNumber()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to create entities: expected a count.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		double count = args[0]->NumberValue(context).FromMaybe(0.0);
+
+		// 'rects' is the largest view, at 4 floats per entity
+		if (count < 1 || count * 4 > (double)TypedArray::kMaxLength || count != floor(count)) {
+			isolate->ThrowException(Exception::RangeError(
+				String::NewFromUtf8(isolate, "Unable to create entities: count must be a positive integer within typed array limits.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		size_t length = get_field_stride((size_t)count) * (FIELD_RECTS + 4) * sizeof(float);
+		void* memory = aligned_alloc(field_alignment, length);
+
+		if (memory == NULL) {
+			isolate->ThrowException(Exception::RangeError(
+				String::NewFromUtf8(isolate, "Unable to create entities: out of memory.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		memset(memory, 0, length);
+
+		Entities* instance = new Entities(isolate, (size_t)count, memory);
+		instance->Wrap(args.This());
+		instance->MakeWeak();
+		args.GetReturnValue().Set(args.This());
+	}
+
+	void Entities::StepCallback(const FunctionCallbackInfo<Value> &args) {
+		Isolate* isolate = args.GetIsolate();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+		Entities* self = NativeClass::Unwrap(args.This());
+
+		if (args.Length() > 1 && args.Length() < 5) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Unable to execute method: bounds need x, y, width and height.").ToLocalChecked()
+			));
+
+			return;
+		}
+
+		// Velocities are per step unless a time delta says otherwise
+		float dt = args.Length() > 0 && !args[0]->IsUndefined() ? (float)args[0]->NumberValue(context).FromMaybe(1.0) : 1.0f;
+
+		if (args.Length() < 5) {
+			EntityKernels::Step(self->fields_, self->count_, dt, NULL);
+			return;
+		}
+
+		EntityKernels::Bounds bounds = {
+			(float)args[1]->NumberValue(context).FromMaybe(0.0),
+			(float)args[2]->NumberValue(context).FromMaybe(0.0),
+			(float)args[3]->NumberValue(context).FromMaybe(0.0),
+			(float)args[4]->NumberValue(context).FromMaybe(0.0)
+		};
+
+		EntityKernels::Step(self->fields_, self->count_, dt, &bounds);
+	}
+
+	void Entities::PackCallback(const FunctionCallbackInfo<Value> &args) {
+		Entities* self = NativeClass::Unwrap(args.This());
+		EntityKernels::Pack(self->fields_, self->count_);
+	}
+
+	void Entities::GetCountCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Entities* self = NativeClass::Unwrap(info.This());
+		info.GetReturnValue().Set(Number::New(info.GetIsolate(), (double)self->count_));
+	}
+
+	void Entities::GetFieldCallback(Local<String> property, const PropertyCallbackInfo<Value>& info) {
+		Isolate* isolate = info.GetIsolate();
+		Entities* self = NativeClass::Unwrap(info.This());
+		int field = info.Data()->Int32Value(isolate->GetCurrentContext()).FromMaybe(0);
+
+		// Same view every time, so JS can keep it around
+		info.GetReturnValue().Set(Local<Object>::New(isolate, self->views_[field]));
+	}
+
+	Local<Module> EntitiesModule::Make(Isolate* isolate) {
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<Module> module = Module::CreateSyntheticModule(
+			isolate,
+			String::NewFromUtf8(isolate, "Entities").ToLocalChecked(),
+			{
+				String::NewFromUtf8(isolate, "default").ToLocalChecked(),
+				String::NewFromUtf8(isolate, "Entities").ToLocalChecked()
+			},
+			[](Local<Context> context, Local<Module> module) -> MaybeLocal<Value> {
+				Isolate* isolate = context->GetIsolate();
+				HandleScope handle_scope(isolate);
+
+				Local<Function> constructor = Entities::GetConstructor(context);
+
+				module->SetSyntheticModuleExport(
+					isolate,
+					String::NewFromUtf8(isolate, "default").ToLocalChecked(),
+					constructor
+				);
+
+				module->SetSyntheticModuleExport(
+					isolate,
+					String::NewFromUtf8(isolate, "Entities").ToLocalChecked(),
+					constructor
+				);
+
+				return MaybeLocal<Value>(True(isolate));
+			}
+		);
+
+		return handle_scope.Escape(module);
+	}
+}
@@ -0,0 +1,236 @@
+#include <math.h>
+#include <built-ins/simulation/entity_kernels.h>
+#include <built-ins/presentation/pixel_kernels.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MOSAIC_X86 1
+#include <immintrin.h>
+#endif
+
+using namespace mosaic::presentation;
+
+namespace mosaic::simulation {
+	/* Scalar kernels, also used for the tails of vector loops */
+
+	static inline void reflect_scalar(float& position, float& velocity, float size, float start, float end) {
+		float last = end - size;
+		float speed = fabsf(velocity);
+
+		if (position < start) {
+			position = start + (start - position);
+			velocity = speed;
+		}
+
+		if (position > last) {
+			position = last - (position - last);
+			velocity = -speed;
+		}
+
+		// Mirroring can't undo moves over twice the free space, those end at the edge
+		position = position < last ? position : last;
+		position = start > position ? start : position;
+	}
+
+	static inline void pack_scalar(const EntityKernels::Fields& fields, size_t i) {
+		float* rect = fields.rects + i * 4;
+
+		rect[0] = fields.x[i];
+		rect[1] = fields.y[i];
+		rect[2] = fields.width[i];
+		rect[3] = fields.height[i];
+	}
+
+	static void step_scalar(const EntityKernels::Fields& fields, size_t start, size_t count, float dt, const EntityKernels::Bounds* bounds) {
+		for (size_t i = start; i < count; i++) {
+			fields.x[i] = fields.x[i] + fields.vx[i] * dt;
+			fields.y[i] = fields.y[i] + fields.vy[i] * dt;
+
+			if (bounds) {
+				reflect_scalar(fields.x[i], fields.vx[i], fields.width[i], bounds->x, bounds->x + bounds->width);
+				reflect_scalar(fields.y[i], fields.vy[i], fields.height[i], bounds->y, bounds->y + bounds->height);
+			}
+
+			pack_scalar(fields, i);
+		}
+	}
+
+	static void pack_range_scalar(const EntityKernels::Fields& fields, size_t start, size_t count) {
+		for (size_t i = start; i < count; i++) {
+			pack_scalar(fields, i);
+		}
+	}
+
+#ifdef MOSAIC_X86
+	/* SSE2 kernels, four entities per iteration */
+
+	static inline __m128 select_ps(__m128 mask, __m128 a, __m128 b) {
+		return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+	}
+
+	static inline void reflect_sse2(__m128& position, __m128& velocity, __m128 size, __m128 start, __m128 end) {
+		__m128 sign = _mm_set1_ps(-0.0f);
+		__m128 last = _mm_sub_ps(end, size);
+		__m128 speed = _mm_andnot_ps(sign, velocity);
+
+		__m128 under = _mm_cmplt_ps(position, start);
+		position = select_ps(under, _mm_add_ps(start, _mm_sub_ps(start, position)), position);
+		velocity = select_ps(under, speed, velocity);
+
+		__m128 over = _mm_cmpgt_ps(position, last);
+		position = select_ps(over, _mm_sub_ps(last, _mm_sub_ps(position, last)), position);
+		velocity = select_ps(over, _mm_xor_ps(speed, sign), velocity);
+
+		position = _mm_max_ps(start, _mm_min_ps(position, last));
+	}
+
+	static inline void pack_sse2(float* rects, __m128 x, __m128 y, __m128 width, __m128 height) {
+		// Four rows of fields become four rectangles
+		_MM_TRANSPOSE4_PS(x, y, width, height);
+
+		_mm_storeu_ps(rects, x);
+		_mm_storeu_ps(rects + 4, y);
+		_mm_storeu_ps(rects + 8, width);
+		_mm_storeu_ps(rects + 12, height);
+	}
+
+	static void step_sse2(const EntityKernels::Fields& fields, size_t start, size_t count, float dt, const EntityKernels::Bounds* bounds) {
+		__m128 factor = _mm_set1_ps(dt);
+		__m128 start_x = _mm_set1_ps(bounds ? bounds->x : 0);
+		__m128 start_y = _mm_set1_ps(bounds ? bounds->y : 0);
+		__m128 end_x = _mm_set1_ps(bounds ? bounds->x + bounds->width : 0);
+		__m128 end_y = _mm_set1_ps(bounds ? bounds->y + bounds->height : 0);
+		size_t i = start;
+
+		for (; i + 4 <= count; i += 4) {
+			__m128 vx = _mm_loadu_ps(fields.vx + i);
+			__m128 vy = _mm_loadu_ps(fields.vy + i);
+			__m128 x = _mm_add_ps(_mm_loadu_ps(fields.x + i), _mm_mul_ps(vx, factor));
+			__m128 y = _mm_add_ps(_mm_loadu_ps(fields.y + i), _mm_mul_ps(vy, factor));
+			__m128 width = _mm_loadu_ps(fields.width + i);
+			__m128 height = _mm_loadu_ps(fields.height + i);
+
+			if (bounds) {
+				reflect_sse2(x, vx, width, start_x, end_x);
+				reflect_sse2(y, vy, height, start_y, end_y);
+
+				_mm_storeu_ps(fields.vx + i, vx);
+				_mm_storeu_ps(fields.vy + i, vy);
+			}
+
+			_mm_storeu_ps(fields.x + i, x);
+			_mm_storeu_ps(fields.y + i, y);
+			pack_sse2(fields.rects + i * 4, x, y, width, height);
+		}
+
+		step_scalar(fields, i, count, dt, bounds);
+	}
+
+	static void pack_range_sse2(const EntityKernels::Fields& fields, size_t start, size_t count) {
+		size_t i = start;
+
+		for (; i + 4 <= count; i += 4) {
+			pack_sse2(fields.rects + i * 4, _mm_loadu_ps(fields.x + i), _mm_loadu_ps(fields.y + i), _mm_loadu_ps(fields.width + i), _mm_loadu_ps(fields.height + i));
+		}
+
+		pack_range_scalar(fields, i, count);
+	}
+
+	/* AVX2 kernels, twice the entities per iteration of the SSE2 ones */
+
+	__attribute__((target("avx2")))
+	static inline void reflect_avx2(__m256& position, __m256& velocity, __m256 size, __m256 start, __m256 end) {
+		__m256 sign = _mm256_set1_ps(-0.0f);
+		__m256 last = _mm256_sub_ps(end, size);
+		__m256 speed = _mm256_andnot_ps(sign, velocity);
+
+		__m256 under = _mm256_cmp_ps(position, start, _CMP_LT_OQ);
+		position = _mm256_blendv_ps(position, _mm256_add_ps(start, _mm256_sub_ps(start, position)), under);
+		velocity = _mm256_blendv_ps(velocity, speed, under);
+
+		__m256 over = _mm256_cmp_ps(position, last, _CMP_GT_OQ);
+		position = _mm256_blendv_ps(position, _mm256_sub_ps(last, _mm256_sub_ps(position, last)), over);
+		velocity = _mm256_blendv_ps(velocity, _mm256_xor_ps(speed, sign), over);
+
+		position = _mm256_max_ps(start, _mm256_min_ps(position, last));
+	}
+
+	__attribute__((target("avx2")))
+	static inline void pack_avx2(float* rects, __m256 x, __m256 y, __m256 width, __m256 height) {
+		// Transposes don't cross 128-bit lanes, so each half packs on its own
+		pack_sse2(rects, _mm256_castps256_ps128(x), _mm256_castps256_ps128(y), _mm256_castps256_ps128(width), _mm256_castps256_ps128(height));
+		pack_sse2(rects + 16, _mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1), _mm256_extractf128_ps(width, 1), _mm256_extractf128_ps(height, 1));
+	}
+
+	__attribute__((target("avx2")))
+	static void step_avx2(const EntityKernels::Fields& fields, size_t start, size_t count, float dt, const EntityKernels::Bounds* bounds) {
+		__m256 factor = _mm256_set1_ps(dt);
+		__m256 start_x = _mm256_set1_ps(bounds ? bounds->x : 0);
+		__m256 start_y = _mm256_set1_ps(bounds ? bounds->y : 0);
+		__m256 end_x = _mm256_set1_ps(bounds ? bounds->x + bounds->width : 0);
+		__m256 end_y = _mm256_set1_ps(bounds ? bounds->y + bounds->height : 0);
+		size_t i = start;
+
+		for (; i + 8 <= count; i += 8) {
+			__m256 vx = _mm256_loadu_ps(fields.vx + i);
+			__m256 vy = _mm256_loadu_ps(fields.vy + i);
+			__m256 x = _mm256_add_ps(_mm256_loadu_ps(fields.x + i), _mm256_mul_ps(vx, factor));
+			__m256 y = _mm256_add_ps(_mm256_loadu_ps(fields.y + i), _mm256_mul_ps(vy, factor));
+			__m256 width = _mm256_loadu_ps(fields.width + i);
+			__m256 height = _mm256_loadu_ps(fields.height + i);
+
+			if (bounds) {
+				reflect_avx2(x, vx, width, start_x, end_x);
+				reflect_avx2(y, vy, height, start_y, end_y);
+
+				_mm256_storeu_ps(fields.vx + i, vx);
+				_mm256_storeu_ps(fields.vy + i, vy);
+			}
+
+			_mm256_storeu_ps(fields.x + i, x);
+			_mm256_storeu_ps(fields.y + i, y);
+			pack_avx2(fields.rects + i * 4, x, y, width, height);
+		}
+
+		step_sse2(fields, i, count, dt, bounds);
+	}
+
+	__attribute__((target("avx2")))
+	static void pack_range_avx2(const EntityKernels::Fields& fields, size_t start, size_t count) {
+		size_t i = start;
+
+		for (; i + 8 <= count; i += 8) {
+			pack_avx2(fields.rects + i * 4, _mm256_loadu_ps(fields.x + i), _mm256_loadu_ps(fields.y + i), _mm256_loadu_ps(fields.width + i), _mm256_loadu_ps(fields.height + i));
+		}
+
+		pack_range_sse2(fields, i, count);
+	}
+#endif
+
+	void EntityKernels::Step(const Fields& fields, size_t count, float dt, const Bounds* bounds) {
+		auto step = step_scalar;
+
+#ifdef MOSAIC_X86
+		if (PixelKernels::GetSimdLevel() == PixelKernels::SIMD_AVX2) {
+			step = step_avx2;
+		} else if (PixelKernels::GetSimdLevel() == PixelKernels::SIMD_SSE2) {
+			step = step_sse2;
+		}
+#endif
+
+		step(fields, 0, count, dt, bounds);
+	}
+
+	void EntityKernels::Pack(const Fields& fields, size_t count) {
+		auto pack_range = pack_range_scalar;
+
+#ifdef MOSAIC_X86
+		if (PixelKernels::GetSimdLevel() == PixelKernels::SIMD_AVX2) {
+			pack_range = pack_range_avx2;
+		} else if (PixelKernels::GetSimdLevel() == PixelKernels::SIMD_SSE2) {
+			pack_range = pack_range_sse2;
+		}
+#endif
+
+		pack_range(fields, 0, count);
+	}
+}
@@ -20,6 +20,25 @@
 #include <built-ins/presentation/window.h>
 #include <built-ins/presentation/button.h>
 #include <built-ins/presentation/drawing_area.h>
+#include <built-ins/presentation/events.h>
+#include <built-ins/presentation/image.h>
+#include <built-ins/presentation/atlas.h>
+#include <built-ins/presentation/headless.h>
+#include <built-ins/presentation/animation.h>
+#include <built-ins/presentation/scheduler.h>
+#include <built-ins/presentation/spatial_index.h>
+#include <built-ins/presentation/image_cache.h>
+#include <built-ins/presentation/text_layout_cache.h>
+#include <built-ins/diagnostics/performance.h>
+#include <built-ins/simulation/entities.h>
+#include <built-ins/io/file.h>
+#include <built-ins/io/stream.h>
+#include <runtime/task_pool.h>
+#include <runtime/io_ring.h>
+#include <runtime/event_dispatcher.h>
+#include <runtime/performance_monitor.h>
+#include <runtime/frame_stats.h>
+#include <runtime/frame_scheduler.h>
 
 #include "loader.h"
 
@@ -141,9 +160,15 @@ string resolve_module_specifier(string specifier, string referrer = string()) {
 }
 
 void report_exception(Isolate* isolate, TryCatch* try_catch) {
+	report_exception(isolate, try_catch->Exception());
+}
+
+void report_exception(Isolate* isolate, Local<Value> exception) {
 	HandleScope handle_scope(isolate);
-	String::Utf8Value exception_str(isolate, try_catch->Exception());
-	printf("\x1b[31m%s\x1b[0m\n", *exception_str);
+	String::Utf8Value exception_str(isolate, exception);
+
+	// Errors go to stderr, so they aren't mixed into output a script prints on purpose
+	fprintf(stderr, "\x1b[31m%s\x1b[0m\n", *exception_str);
 }
 
 void initialize_import_meta_object_callback(Local<Context> context, Local<Module> module, Local<Object> meta) {
@@ -171,7 +196,9 @@ Local<Context> create_global_context(Isolate* isolate) {
 	return handle_scope.Escape(context);
 }
 
-void run_application() {
+int run_application() {
+	int status = 0;
+
 	// Initialize V8
 	v8_platform = initialize_v8(executable_path);
 
@@ -201,12 +228,21 @@ void run_application() {
 		// Set meta object init callback.
 		v8_isolate->SetHostInitializeImportMetaObjectCallback(initialize_import_meta_object_callback);
 
-		// Initialize GTK application
-		initialize_gtk_app("dev.wazy.mosaic", 0, NULL);
+		if (mosaic::presentation::Headless::IsEnabled()) {
+			// No display, the main module runs on a plain main loop
+			status = mosaic::presentation::Headless::Run([]() {
+				run_module(v8_isolate, v8_context, string(main_src));
+			});
+		} else {
+			// Initialize GTK application
+			initialize_gtk_app("dev.wazy.mosaic", 0, NULL);
+		}
 
 		// TODO: Use GApplication instead of GTKApplication to keep app running
 		// while there are timers set even without GTKWindow instances present
 	}
+
+	return status;
 }
 
 ModuleRepository* setup_module_repository(Local<Context> context) {
@@ -224,9 +260,20 @@ void setup_builtin_modules(ModuleRepository* repository) {
 	Isolate* isolate = repository->GetIsolate();
 
 	repository->Add("@mosaic/diagnostics/Debug", mosaic::diagnostics::DebugModule::GetInstance(isolate));
+	repository->Add("@mosaic/diagnostics/Performance", mosaic::diagnostics::PerformanceModule::GetInstance(isolate));
 	repository->Add("@mosaic/presentation/Window", mosaic::presentation::WindowModule::GetInstance(isolate));
 	repository->Add("@mosaic/presentation/Button", mosaic::presentation::ButtonModule::GetInstance(isolate));
 	repository->Add("@mosaic/presentation/DrawingArea", mosaic::presentation::DrawingAreaModule::GetInstance(isolate));
+	repository->Add("@mosaic/presentation/Events", mosaic::presentation::EventsModule::GetInstance(isolate));
+	repository->Add("@mosaic/presentation/Image", mosaic::presentation::ImageModule::GetInstance(isolate));
+	repository->Add("@mosaic/presentation/Atlas", mosaic::presentation::AtlasModule::GetInstance(isolate));
+	repository->Add("@mosaic/presentation/Headless", mosaic::presentation::HeadlessModule::GetInstance(isolate));
+	repository->Add("@mosaic/presentation/Animation", mosaic::presentation::AnimationModule::GetInstance(isolate));
+	repository->Add("@mosaic/presentation/Scheduler", mosaic::presentation::SchedulerModule::GetInstance(isolate));
+	repository->Add("@mosaic/presentation/SpatialIndex", mosaic::presentation::SpatialIndexModule::GetInstance(isolate));
+	repository->Add("@mosaic/simulation/Entities", mosaic::simulation::EntitiesModule::GetInstance(isolate));
+	repository->Add("@mosaic/io/File", mosaic::io::FileModule::GetInstance(isolate));
+	repository->Add("@mosaic/io/Stream", mosaic::io::StreamModule::GetInstance(isolate));
 }
 
 /**
@@ -236,6 +283,7 @@ void setup_builtin_modules(ModuleRepository* repository) {
  */
 std::unique_ptr<Platform> initialize_v8(const char* exec_path) {
 	V8::SetFlagsFromString("--harmony-top-level-await");
+	V8::SetFlagsFromString("--turbo-fast-api-calls");
 	V8::InitializeICUDefaultLocation(exec_path);
 	V8::InitializeExternalStartupData(exec_path);
 
@@ -270,16 +318,37 @@ int main(int argc, char* argv[]) {
 	main_src = argv[1];
 
 	// Create GTK application
-	run_application();
+	int status = run_application();
+
+	// Stop native workers before the isolate goes away
+	mosaic::runtime::TaskPool::Shutdown();
+	mosaic::runtime::IoRing::Shutdown();
+	mosaic::runtime::EventDispatcher::Shutdown();
+	mosaic::runtime::FrameScheduler::Shutdown();
+	mosaic::runtime::PerformanceMonitor::Shutdown();
+	mosaic::runtime::FrameStats::Shutdown();
+	mosaic::presentation::ImageCache::Shutdown();
+	mosaic::presentation::TextLayoutCache::Shutdown();
 
 	// Tear down V8
 	shutdown_v8();
 	
 	// Tear down GTK
-	g_object_unref(gtk_app);
-	gtk_app = NULL;
+	if (gtk_app != NULL) {
+		g_object_unref(gtk_app);
+		gtk_app = NULL;
+	}
 
-	return 0;
+	return status;
+}
+
+static void headless_module_fulfilled_callback(const FunctionCallbackInfo<Value> &args) {
+	mosaic::presentation::Headless::Quit(0);
+}
+
+static void headless_module_rejected_callback(const FunctionCallbackInfo<Value> &args) {
+	report_exception(args.GetIsolate(), args[0]);
+	mosaic::presentation::Headless::Quit(1);
 }
 
 void run_module(Isolate* isolate, Local<Context> context, string path) {
@@ -291,7 +360,16 @@ void run_module(Isolate* isolate, Local<Context> context, string path) {
 	if (maybe_module.ToLocal(&module)) {
 		Local<Promise> promise = Local<Promise>::Cast(module->Evaluate(context).ToLocalChecked());
 
-		if (promise->State() == Promise::PromiseState::kRejected) {
+		if (mosaic::presentation::Headless::IsEnabled()) {
+			// Headless runs last as long as the main module, top-level awaits included
+			promise->Then(
+				context,
+				Function::New(context, headless_module_fulfilled_callback).ToLocalChecked(),
+				Function::New(context, headless_module_rejected_callback).ToLocalChecked()
+			).ToLocalChecked();
+
+			isolate->PerformMicrotaskCheckpoint();
+		} else if (promise->State() == Promise::PromiseState::kRejected) {
 			Local<Value> result = promise->Result();
 			isolate->ThrowException(result);
 		}
@@ -300,6 +378,12 @@ void run_module(Isolate* isolate, Local<Context> context, string path) {
 	if (v8_trycatch->HasCaught()) {
 		// Print thrown exception
 		report_exception(isolate, v8_trycatch);
+
+		if (mosaic::presentation::Headless::IsEnabled()) {
+			mosaic::presentation::Headless::Quit(1);
+			return;
+		}
+
 		exit(0);
 	}
 }
@@ -324,6 +408,7 @@ int global_set_timeout_g_callback(void* callback_ptr) {
 	Local<Function> callback = v8_set_timeout_latest_callback.Get(v8_isolate);
 	Local<Context> context = v8_context;
 
+	mosaic::runtime::PerformanceMonitor::Scope measure("timeout", callback);
 	callback->Call(context, context->Global(), 0, NULL);
 
 	if (v8_trycatch->HasCaught()) {
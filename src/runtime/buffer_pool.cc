@@ -0,0 +1,68 @@
+#include <v8.h>
+#include <stdlib.h>
+#include <runtime/buffer_pool.h>
+
+using namespace v8;
+using namespace std;
+
+namespace mosaic::runtime {
+	vector<BufferPool*> BufferPool::pools_;
+	mutex BufferPool::pools_mutex_;
+
+	BufferPool::BufferPool(size_t buffer_size, size_t max_idle) {
+		this->buffer_size_ = buffer_size;
+		this->max_idle_ = max_idle;
+	}
+
+	BufferPool* BufferPool::Get(size_t buffer_size) {
+		lock_guard<mutex> lock(pools_mutex_);
+
+		for (BufferPool* pool : pools_) {
+			if (pool->GetBufferSize() == buffer_size) {
+				return pool;
+			}
+		}
+
+		// Pools live for the whole process, backing stores may outlive any stream
+		BufferPool* pool = new BufferPool(buffer_size, 64);
+		pools_.push_back(pool);
+		return pool;
+	}
+
+	char* BufferPool::Acquire() {
+		{
+			lock_guard<mutex> lock(this->mutex_);
+
+			if (!this->idle_.empty()) {
+				char* buffer = this->idle_.back();
+				this->idle_.pop_back();
+				return buffer;
+			}
+		}
+
+		return (char*)malloc(this->buffer_size_);
+	}
+
+	void BufferPool::Release(char* buffer) {
+		{
+			lock_guard<mutex> lock(this->mutex_);
+
+			if (this->idle_.size() < this->max_idle_) {
+				this->idle_.push_back(buffer);
+				return;
+			}
+		}
+
+		free(buffer);
+	}
+
+	shared_ptr<BackingStore> BufferPool::NewBackingStore(char* buffer, size_t length) {
+		return ArrayBuffer::NewBackingStore(buffer, length, BackingStoreDeleter, this);
+	}
+
+	void BufferPool::BackingStoreDeleter(void* data, size_t length, void* deleter_data) {
+		// May run on a V8 background thread
+		BufferPool* pool = (BufferPool*)deleter_data;
+		pool->Release((char*)data);
+	}
+}
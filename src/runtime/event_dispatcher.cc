@@ -0,0 +1,164 @@
+#include <v8.h>
+#include <gtk-3.0/gtk/gtk.h>
+#include <glib.h>
+#include <map>
+#include <runtime/event_dispatcher.h>
+#include <runtime/performance_monitor.h>
+#include "loader.h"
+
+using namespace v8;
+using namespace std;
+
+namespace mosaic::runtime {
+	EventDispatcher* EventDispatcher::instance_ = nullptr;
+
+	EventDispatcher::EventDispatcher() {
+		this->flush_source_id_ = 0;
+	}
+
+	EventDispatcher::~EventDispatcher() {
+		if (this->flush_source_id_ != 0) {
+			g_source_remove(this->flush_source_id_);
+		}
+	}
+
+	EventDispatcher* EventDispatcher::GetInstance() {
+		if (instance_ == nullptr) {
+			instance_ = new EventDispatcher();
+		}
+
+		return instance_;
+	}
+
+	void EventDispatcher::Shutdown() {
+		if (instance_ != nullptr) {
+			delete instance_;
+			instance_ = nullptr;
+		}
+	}
+
+	void EventDispatcher::Post(const char* name, Persistent<Function>* handler, vector<double> args) {
+		this->queue_.push_back({ name, handler, args });
+
+		// Runs after the input events of this iteration, but before GTK redraws
+		if (this->flush_source_id_ == 0) {
+			this->flush_source_id_ = g_idle_add_full(G_PRIORITY_HIGH_IDLE, FlushCallback, this, NULL);
+		}
+	}
+
+	void EventDispatcher::Dispatch(const char* name, Local<Function> handler, int argc, Local<Value> argv[]) {
+		Isolate* isolate = Isolate::GetCurrent();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+		TryCatch try_catch(isolate);
+
+		PerformanceMonitor::Scope measure(name, handler);
+		handler->Call(context, context->Global(), argc, argv);
+
+		if (try_catch.HasCaught()) {
+			report_exception(isolate, &try_catch);
+		}
+	}
+
+	void EventDispatcher::Flush() {
+		vector<Event> events;
+		events.swap(this->queue_);
+
+		if (events.empty()) {
+			return;
+		}
+
+		Isolate* isolate = Isolate::GetCurrent();
+		HandleScope handle_scope(isolate);
+		Local<Context> context = isolate->GetCurrentContext();
+		TryCatch try_catch(isolate);
+
+		{
+			// Microtasks would otherwise run after every single call
+			Isolate::SuppressMicrotaskExecutionScope suppress_microtasks(isolate);
+
+			// Collect the events of batched handlers first, so each one is called once
+			map<Persistent<Function>*, Local<Array>> batches;
+
+			for (Event& event : events) {
+				Local<Function> handler = Local<Function>::New(isolate, *event.handler);
+
+				if (handler.IsEmpty() || !IsBatched(isolate, handler)) {
+					continue;
+				}
+
+				if (batches.count(event.handler) == 0) {
+					batches[event.handler] = Array::New(isolate);
+				}
+
+				Local<Array> args = Array::New(isolate, event.args.size());
+
+				for (size_t i = 0; i < event.args.size(); i++) {
+					args->Set(context, i, Number::New(isolate, event.args[i]));
+				}
+
+				Local<Array> batch = batches[event.handler];
+				batch->Set(context, batch->Length(), args);
+			}
+
+			for (Event& event : events) {
+				Local<Function> handler = Local<Function>::New(isolate, *event.handler);
+
+				if (handler.IsEmpty()) {
+					continue;
+				}
+
+				PerformanceMonitor::Scope measure(event.name, handler);
+
+				if (batches.count(event.handler) > 0) {
+					// Batched handlers run in the position of their first event
+					Local<Value> args[1] = { batches[event.handler] };
+					batches.erase(event.handler);
+					handler->Call(context, context->Global(), 1, args);
+				} else if (!IsBatched(isolate, handler)) {
+					vector<Local<Value>> args;
+
+					for (double value : event.args) {
+						args.push_back(Number::New(isolate, value));
+					}
+
+					handler->Call(context, context->Global(), args.size(), args.data());
+				}
+
+				if (try_catch.HasCaught()) {
+					report_exception(isolate, &try_catch);
+					try_catch.Reset();
+				}
+			}
+		}
+
+		PerformanceMonitor::Scope measure("microtasks");
+		isolate->PerformMicrotaskCheckpoint();
+
+		if (try_catch.HasCaught()) {
+			report_exception(isolate, &try_catch);
+		}
+	}
+
+	void EventDispatcher::SetBatched(Isolate* isolate, Local<Function> handler) {
+		Local<Context> context = isolate->GetCurrentContext();
+		Local<Private> key = Private::ForApi(isolate, String::NewFromUtf8(isolate, "mosaic::batched").ToLocalChecked());
+
+		handler->SetPrivate(context, key, True(isolate));
+	}
+
+	bool EventDispatcher::IsBatched(Isolate* isolate, Local<Function> handler) {
+		Local<Context> context = isolate->GetCurrentContext();
+		Local<Private> key = Private::ForApi(isolate, String::NewFromUtf8(isolate, "mosaic::batched").ToLocalChecked());
+
+		return handler->HasPrivate(context, key).FromMaybe(false);
+	}
+
+	gboolean EventDispatcher::FlushCallback(gpointer user_data) {
+		EventDispatcher* self = (EventDispatcher*)user_data;
+		self->flush_source_id_ = 0;
+		self->Flush();
+
+		return G_SOURCE_REMOVE;
+	}
+}
@@ -0,0 +1,285 @@
+#include <gtk-3.0/gtk/gtk.h>
+#include <glib.h>
+#include <string.h>
+#include <algorithm>
+#include <runtime/frame_scheduler.h>
+
+using namespace std;
+
+namespace mosaic::runtime {
+	FrameScheduler* FrameScheduler::instance_ = nullptr;
+
+	FrameScheduler::FrameScheduler() {
+		this->source_id_ = 0;
+		this->source_is_timeout_ = false;
+		this->slice_start_ = 0;
+		this->in_slice_ = false;
+	}
+
+	FrameScheduler::~FrameScheduler() {
+		if (this->source_id_ != 0) {
+			g_source_remove(this->source_id_);
+		}
+
+		for (DelayedTask* delayed : this->delayed_) {
+			g_source_remove(delayed->source_id);
+			delete delayed;
+		}
+
+		for (auto& entry : this->clocks_) {
+			g_object_weak_unref(G_OBJECT(entry.first), ClockFinalizedCallback, this);
+		}
+	}
+
+	FrameScheduler* FrameScheduler::GetInstance() {
+		if (instance_ == nullptr) {
+			instance_ = new FrameScheduler();
+		}
+
+		return instance_;
+	}
+
+	void FrameScheduler::Shutdown() {
+		if (instance_ != nullptr) {
+			delete instance_;
+			instance_ = nullptr;
+		}
+	}
+
+	bool FrameScheduler::ParsePriority(const char* name, Priority* priority) {
+		static const char* names[PRIORITY_COUNT] = { "user-blocking", "user-visible", "background" };
+
+		for (int i = 0; i < PRIORITY_COUNT; i++) {
+			if (strcmp(names[i], name) == 0) {
+				*priority = (Priority)i;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void FrameScheduler::Post(Priority priority, function<void()> task, guint delay) {
+		if (delay == 0) {
+			this->queues_[priority].push_back(task);
+			this->Schedule();
+			return;
+		}
+
+		DelayedTask* delayed = new DelayedTask { this, priority, task, 0 };
+		this->delayed_.push_back(delayed);
+
+		delayed->source_id = g_timeout_add(delay, +[](gpointer user_data) -> gboolean {
+			DelayedTask* delayed = (DelayedTask*)user_data;
+			FrameScheduler* self = delayed->scheduler;
+
+			self->delayed_.erase(remove(self->delayed_.begin(), self->delayed_.end(), delayed), self->delayed_.end());
+			self->Post(delayed->priority, delayed->task);
+			delete delayed;
+
+			return G_SOURCE_REMOVE;
+		}, delayed);
+	}
+
+	void FrameScheduler::BeginFrame(GdkFrameClock* clock) {
+		auto found = this->clocks_.find(clock);
+
+		if (found == this->clocks_.end()) {
+			// Closed windows take their clock along, forget it then
+			g_object_weak_ref(G_OBJECT(clock), ClockFinalizedCallback, this);
+			found = this->clocks_.emplace(clock, ClockTiming { 0, default_refresh_interval, 0, 0, 0, false }).first;
+		}
+
+		ClockTiming& timing = found->second;
+		gint64 refresh_interval = 0;
+		gint64 presentation_time = 0;
+
+		timing.frame_time = gdk_frame_clock_get_frame_time(clock);
+		gdk_frame_clock_get_refresh_info(clock, timing.frame_time, &refresh_interval, &presentation_time);
+
+		if (refresh_interval > 0) {
+			timing.refresh_interval = refresh_interval;
+		}
+
+		timing.paint_start = g_get_monotonic_time();
+	}
+
+	void FrameScheduler::EndFrame(GdkFrameClock* clock) {
+		auto found = this->clocks_.find(clock);
+
+		if (found == this->clocks_.end()) {
+			return;
+		}
+
+		ClockTiming& timing = found->second;
+		gint64 now = g_get_monotonic_time();
+		gint64 duration = now - timing.paint_start;
+
+		// Smoothed, one slow frame shouldn't shrink every slice after it
+		timing.paint_duration = timing.paint_duration == 0 ? duration : (timing.paint_duration * 7 + duration) / 8;
+		timing.over_budget = now - timing.frame_time > timing.refresh_interval;
+		timing.last_paint_end = now;
+
+		// Background tasks waiting for a frame within budget can go now
+		if (!timing.over_budget && this->source_is_timeout_) {
+			g_source_remove(this->source_id_);
+			this->source_id_ = 0;
+			this->Schedule();
+		}
+	}
+
+	static gint64 get_clock_next_paint(gint64 frame_time, gint64 refresh_interval, gint64 now) {
+		gint64 next_paint = frame_time + refresh_interval;
+
+		if (next_paint <= now) {
+			next_paint += ((now - next_paint) / refresh_interval + 1) * refresh_interval;
+		}
+
+		return next_paint;
+	}
+
+	gint64 FrameScheduler::GetNextPaint(gint64 now) {
+		gint64 next_paint = 0;
+
+		for (auto& entry : this->clocks_) {
+			const ClockTiming& timing = entry.second;
+
+			if (timing.frame_time != 0) {
+				gint64 clock_next_paint = get_clock_next_paint(timing.frame_time, timing.refresh_interval, now);
+				next_paint = next_paint == 0 ? clock_next_paint : min(next_paint, clock_next_paint);
+			}
+		}
+
+		return next_paint;
+	}
+
+	gint64 FrameScheduler::GetRefreshInterval() {
+		gint64 refresh_interval = 0;
+
+		for (auto& entry : this->clocks_) {
+			refresh_interval = refresh_interval == 0 ? entry.second.refresh_interval : min(refresh_interval, entry.second.refresh_interval);
+		}
+
+		return refresh_interval == 0 ? default_refresh_interval : refresh_interval;
+	}
+
+	gint64 FrameScheduler::GetDeadline() {
+		gint64 now = g_get_monotonic_time();
+		gint64 deadline = 0;
+
+		for (auto& entry : this->clocks_) {
+			const ClockTiming& timing = entry.second;
+
+			if (timing.frame_time == 0) {
+				continue;
+			}
+
+			// Leave the usual paint time free, but never more than half a frame
+			gint64 next_paint = get_clock_next_paint(timing.frame_time, timing.refresh_interval, now);
+			gint64 clock_deadline = next_paint - min(timing.paint_duration, timing.refresh_interval / 2);
+			deadline = deadline == 0 ? clock_deadline : min(deadline, clock_deadline);
+		}
+
+		if (deadline == 0) {
+			return this->slice_start_ + default_refresh_interval;
+		}
+
+		return deadline;
+	}
+
+	bool FrameScheduler::CanRunBackground(gint64 now) {
+		for (auto& entry : this->clocks_) {
+			const ClockTiming& timing = entry.second;
+
+			// Frames that stopped coming can't be over budget
+			if (timing.over_budget && now - timing.last_paint_end <= 2 * timing.refresh_interval) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void FrameScheduler::Schedule() {
+		bool has_foreground = !this->queues_[PRIORITY_USER_BLOCKING].empty() || !this->queues_[PRIORITY_USER_VISIBLE].empty();
+		bool has_background = !this->queues_[PRIORITY_BACKGROUND].empty();
+
+		if (this->source_id_ != 0 || (!has_foreground && !has_background)) {
+			return;
+		}
+
+		gint64 now = g_get_monotonic_time();
+		gint64 ready = now;
+
+		if (this->queues_[PRIORITY_USER_BLOCKING].empty()) {
+			// Past the deadline, the next slice starts once the coming frame was painted
+			gint64 next_paint = this->GetNextPaint(now);
+
+			if (next_paint != 0 && now >= this->GetDeadline()) {
+				ready = next_paint;
+			}
+
+			if (!has_foreground && !this->CanRunBackground(now)) {
+				ready = max(ready, now + this->GetRefreshInterval());
+			}
+		}
+
+		// Low priority sources, so input and GTK's redraws always go first
+		if (ready <= now) {
+			this->source_id_ = g_idle_add_full(G_PRIORITY_DEFAULT_IDLE, RunSliceCallback, this, NULL);
+			this->source_is_timeout_ = false;
+		} else {
+			guint delay = (guint)((ready - now + 999) / 1000);
+			this->source_id_ = g_timeout_add_full(G_PRIORITY_DEFAULT_IDLE, delay, RunSliceCallback, this, NULL);
+			this->source_is_timeout_ = true;
+		}
+	}
+
+	void FrameScheduler::RunSlice() {
+		this->slice_start_ = g_get_monotonic_time();
+		this->in_slice_ = true;
+		gint64 deadline = this->GetDeadline();
+
+		while (true) {
+			gint64 now = g_get_monotonic_time();
+			Priority priority = PRIORITY_COUNT;
+
+			if (!this->queues_[PRIORITY_USER_BLOCKING].empty()) {
+				priority = PRIORITY_USER_BLOCKING;
+			} else if (now < deadline) {
+				if (!this->queues_[PRIORITY_USER_VISIBLE].empty()) {
+					priority = PRIORITY_USER_VISIBLE;
+				} else if (!this->queues_[PRIORITY_BACKGROUND].empty() && this->CanRunBackground(now)) {
+					priority = PRIORITY_BACKGROUND;
+				}
+			}
+
+			if (priority == PRIORITY_COUNT) {
+				break;
+			}
+
+			// Tasks may post others, take this one out first
+			function<void()> task = move(this->queues_[priority].front());
+			this->queues_[priority].pop_front();
+			task();
+		}
+
+		this->in_slice_ = false;
+		this->Schedule();
+	}
+
+	gboolean FrameScheduler::RunSliceCallback(gpointer user_data) {
+		FrameScheduler* self = (FrameScheduler*)user_data;
+
+		self->source_id_ = 0;
+		self->source_is_timeout_ = false;
+		self->RunSlice();
+
+		return G_SOURCE_REMOVE;
+	}
+
+	void FrameScheduler::ClockFinalizedCallback(gpointer user_data, GObject* clock) {
+		FrameScheduler* self = (FrameScheduler*)user_data;
+		self->clocks_.erase((GdkFrameClock*)clock);
+	}
+}
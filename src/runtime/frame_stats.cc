@@ -0,0 +1,239 @@
+#include <v8.h>
+#include <gtk-3.0/gtk/gtk.h>
+#include <glib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+#include <runtime/frame_stats.h>
+
+using namespace v8;
+using namespace std;
+
+namespace mosaic::runtime {
+	vector<FrameStats*> FrameStats::instances_;
+	vector<FrameStats*> FrameStats::active_;
+	guint FrameStats::log_source_id_ = 0;
+	int FrameStats::script_depth_ = 0;
+
+	// About two seconds of frames at 60 Hz
+	static const size_t window_size = 120;
+
+	// Assumed when the frame clock doesn't know the display's refresh rate
+	static const gint64 default_refresh_interval = 16667;
+
+	static const char* metric_names[FrameStats::METRIC_COUNT] = { "script", "raster", "latency" };
+
+	FrameStats::FrameStats(const string& name) {
+		this->name_ = name;
+		this->samples_.reserve(window_size);
+		this->next_sample_ = 0;
+		this->frames_ = 0;
+		this->dropped_ = 0;
+		this->logged_frames_ = 0;
+		this->logged_dropped_ = 0;
+		this->frame_start_ = 0;
+		this->frame_script_ = 0;
+		this->invalidated_at_ = 0;
+
+		instances_.push_back(this);
+
+		const char* interval = getenv("MOSAIC_FRAME_STATS");
+
+		if (log_source_id_ == 0 && interval != NULL && interval[0] != '\0') {
+			double seconds = atof(interval) > 0 ? atof(interval) : 5;
+			log_source_id_ = g_timeout_add((guint)(seconds * 1000), LogCallback, NULL);
+		}
+	}
+
+	FrameStats::~FrameStats() {
+		instances_.erase(remove(instances_.begin(), instances_.end(), this), instances_.end());
+		active_.erase(remove(active_.begin(), active_.end(), this), active_.end());
+	}
+
+	void FrameStats::MarkInvalidated() {
+		if (this->invalidated_at_ == 0) {
+			this->invalidated_at_ = g_get_monotonic_time();
+		}
+	}
+
+	void FrameStats::BeginFrame() {
+		this->frame_start_ = g_get_monotonic_time();
+		this->frame_script_ = 0;
+		active_.push_back(this);
+	}
+
+	void FrameStats::CancelFrame() {
+		active_.erase(remove(active_.begin(), active_.end(), this), active_.end());
+	}
+
+	void FrameStats::AddScriptTime(gint64 microseconds) {
+		for (FrameStats* stats : active_) {
+			stats->frame_script_ += microseconds;
+		}
+	}
+
+	gint64 FrameStats::BeginScript() {
+		script_depth_++;
+		return g_get_monotonic_time();
+	}
+
+	void FrameStats::EndScript(gint64 start) {
+		script_depth_--;
+
+		// The outer callback's time already includes this one
+		if (script_depth_ == 0) {
+			AddScriptTime(g_get_monotonic_time() - start);
+		}
+	}
+
+	void FrameStats::ResolvePresentations(GdkFrameClock* clock) {
+		auto pending = this->pending_.begin();
+
+		while (pending != this->pending_.end()) {
+			// GDK only keeps the timings of the last few frames, older ones keep their paint latency
+			GdkFrameTimings* timings = pending->clock == clock ? gdk_frame_clock_get_timings(clock, pending->frame_counter) : NULL;
+
+			if (timings != NULL && !gdk_frame_timings_get_complete(timings)) {
+				pending++;
+				continue;
+			}
+
+			// Zero when the backend can't tell
+			gint64 presentation_time = timings != NULL ? gdk_frame_timings_get_presentation_time(timings) : 0;
+
+			if (presentation_time > pending->invalidated_at) {
+				this->samples_[pending->sample].values[METRIC_LATENCY] = (presentation_time - pending->invalidated_at) / 1000.0;
+			}
+
+			pending = this->pending_.erase(pending);
+		}
+	}
+
+	void FrameStats::EndFrame(GdkFrameClock* clock) {
+		gint64 now = g_get_monotonic_time();
+		gint64 total = now - this->frame_start_;
+		active_.erase(remove(active_.begin(), active_.end(), this), active_.end());
+		this->ResolvePresentations(clock);
+
+		// Frames GTK painted on its own, e.g. after a resize, answer no invalidate
+		gint64 invalidated_at = this->invalidated_at_ != 0 ? this->invalidated_at_ : this->frame_start_;
+		gint64 latency = now - invalidated_at;
+		this->invalidated_at_ = 0;
+
+		Sample sample;
+		sample.values[METRIC_SCRIPT] = this->frame_script_ / 1000.0;
+		sample.values[METRIC_RASTER] = max(total - this->frame_script_, (gint64)0) / 1000.0;
+		sample.values[METRIC_LATENCY] = latency / 1000.0;
+
+		size_t index = this->next_sample_;
+
+		if (this->samples_.size() < window_size) {
+			index = this->samples_.size();
+			this->samples_.push_back(sample);
+		} else {
+			this->samples_[this->next_sample_] = sample;
+			this->next_sample_ = (this->next_sample_ + 1) % window_size;
+		}
+
+		this->frames_++;
+
+		// The frame still has to reach the screen, the clock tells when a few frames later
+		if (clock != NULL) {
+			this->pending_.push_back({ clock, gdk_frame_clock_get_frame_counter(clock), invalidated_at, index });
+		}
+
+		// An invalidate has to wait for the next vblank, every vblank past that one is a dropped frame.
+		// Counted at the end of the paint, presenting always takes one more.
+		gint64 refresh_interval = 0;
+
+		if (clock != NULL) {
+			gdk_frame_clock_get_refresh_info(clock, gdk_frame_clock_get_frame_time(clock), &refresh_interval, NULL);
+		}
+
+		if (refresh_interval <= 0) {
+			refresh_interval = default_refresh_interval;
+		}
+
+		this->dropped_ += max(latency / refresh_interval - 1, (gint64)0);
+	}
+
+	double FrameStats::GetPercentile(Metric metric, double percentile) {
+		if (this->samples_.empty()) {
+			return 0;
+		}
+
+		vector<double> values;
+		values.reserve(this->samples_.size());
+
+		for (const Sample& sample : this->samples_) {
+			values.push_back(sample.values[metric]);
+		}
+
+		// Nearest rank, so p100 is the slowest frame and not an interpolation
+		size_t rank = (size_t)ceil(clamp(percentile, 0.0, 100.0) / 100 * values.size());
+		size_t index = rank > 0 ? rank - 1 : 0;
+		nth_element(values.begin(), values.begin() + index, values.end());
+
+		return values[index];
+	}
+
+	Local<Object> FrameStats::ToObject(Local<Context> context) {
+		Isolate* isolate = context->GetIsolate();
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<Object> object = Object::New(isolate);
+		object->Set(context, String::NewFromUtf8(isolate, "frames").ToLocalChecked(), Number::New(isolate, this->frames_)).Check();
+		object->Set(context, String::NewFromUtf8(isolate, "dropped").ToLocalChecked(), Number::New(isolate, this->dropped_)).Check();
+
+		for (int metric = 0; metric < METRIC_COUNT; metric++) {
+			Local<Object> percentiles = Object::New(isolate);
+			percentiles->Set(context, String::NewFromUtf8(isolate, "p50").ToLocalChecked(), Number::New(isolate, this->GetPercentile((Metric)metric, 50))).Check();
+			percentiles->Set(context, String::NewFromUtf8(isolate, "p95").ToLocalChecked(), Number::New(isolate, this->GetPercentile((Metric)metric, 95))).Check();
+			percentiles->Set(context, String::NewFromUtf8(isolate, "p99").ToLocalChecked(), Number::New(isolate, this->GetPercentile((Metric)metric, 99))).Check();
+			percentiles->Set(context, String::NewFromUtf8(isolate, "max").ToLocalChecked(), Number::New(isolate, this->GetPercentile((Metric)metric, 100))).Check();
+
+			object->Set(context, String::NewFromUtf8(isolate, metric_names[metric]).ToLocalChecked(), percentiles).Check();
+		}
+
+		return handle_scope.Escape(object);
+	}
+
+	gboolean FrameStats::LogCallback(gpointer user_data) {
+		for (FrameStats* stats : instances_) {
+			size_t frames = stats->frames_ - stats->logged_frames_;
+			size_t dropped = stats->dropped_ - stats->logged_dropped_;
+
+			// Idle windows and areas would only repeat their last line
+			if (frames == 0) {
+				continue;
+			}
+
+			stats->logged_frames_ = stats->frames_;
+			stats->logged_dropped_ = stats->dropped_;
+
+			fprintf(
+				stderr,
+				"[frames] %s: %zu frames, %zu dropped | script p50 %.2f p95 %.2f ms | raster p50 %.2f p95 %.2f ms | latency p50 %.2f p95 %.2f ms\n",
+				stats->name_.c_str(),
+				frames,
+				dropped,
+				stats->GetPercentile(METRIC_SCRIPT, 50),
+				stats->GetPercentile(METRIC_SCRIPT, 95),
+				stats->GetPercentile(METRIC_RASTER, 50),
+				stats->GetPercentile(METRIC_RASTER, 95),
+				stats->GetPercentile(METRIC_LATENCY, 50),
+				stats->GetPercentile(METRIC_LATENCY, 95)
+			);
+		}
+
+		return G_SOURCE_CONTINUE;
+	}
+
+	void FrameStats::Shutdown() {
+		if (log_source_id_ != 0) {
+			g_source_remove(log_source_id_);
+			log_source_id_ = 0;
+		}
+	}
+}
@@ -0,0 +1,307 @@
+#include <v8.h>
+#include <gtk-3.0/gtk/gtk.h>
+#include <glib.h>
+#include <glib-unix.h>
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <runtime/io_ring.h>
+#include <runtime/performance_monitor.h>
+#include "loader.h"
+
+using namespace v8;
+using namespace std;
+
+namespace mosaic::runtime {
+	IoRing* IoRing::instance_ = nullptr;
+	bool IoRing::probed_ = false;
+
+	static int io_uring_setup(unsigned int entries, io_uring_params* params) {
+		return (int)syscall(__NR_io_uring_setup, entries, params);
+	}
+
+	static int io_uring_enter(int ring_fd, unsigned int to_submit, unsigned int min_complete, unsigned int flags) {
+		return (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, NULL, 0);
+	}
+
+	static int io_uring_register(int ring_fd, unsigned int opcode, void* arg, unsigned int nr_args) {
+		return (int)syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args);
+	}
+
+	IoRing::IoRing() : ring_fd_(-1), event_fd_(-1), event_source_id_(0), sq_ring_(MAP_FAILED), cq_ring_(MAP_FAILED), sqes_((io_uring_sqe*)MAP_FAILED), in_flight_(0), features_(0) {
+	}
+
+	IoRing::~IoRing() {
+		for (Request* request : this->backlog_) {
+			delete request;
+		}
+
+		for (pair<Request*, int>& failed : this->failed_) {
+			delete failed.first;
+		}
+
+		if (this->event_source_id_ != 0) g_source_remove(this->event_source_id_);
+		if (this->sqes_ != MAP_FAILED) munmap(this->sqes_, this->sqes_size_);
+		if (this->cq_ring_ != MAP_FAILED && this->cq_ring_ != this->sq_ring_) munmap(this->cq_ring_, this->cq_ring_size_);
+		if (this->sq_ring_ != MAP_FAILED) munmap(this->sq_ring_, this->sq_ring_size_);
+		if (this->event_fd_ >= 0) close(this->event_fd_);
+		if (this->ring_fd_ >= 0) close(this->ring_fd_);
+	}
+
+	IoRing* IoRing::GetInstance() {
+		if (!probed_) {
+			probed_ = true;
+
+			// Setting MOSAIC_NO_IO_URING forces the thread pool fallback
+			if (g_getenv("MOSAIC_NO_IO_URING") != NULL) {
+				return nullptr;
+			}
+
+			IoRing* ring = new IoRing();
+
+			if (ring->Setup(256, { IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ, IORING_OP_WRITE, IORING_OP_CLOSE })) {
+				instance_ = ring;
+			} else {
+				delete ring;
+			}
+		}
+
+		return instance_;
+	}
+
+	void IoRing::Shutdown() {
+		delete instance_;
+		instance_ = nullptr;
+	}
+
+	bool IoRing::Setup(unsigned int entries, initializer_list<int> required_ops) {
+		io_uring_params params;
+		memset(&params, 0, sizeof(params));
+
+		this->ring_fd_ = io_uring_setup(entries, &params);
+
+		if (this->ring_fd_ < 0) {
+			return false;
+		}
+
+		this->features_ = params.features;
+
+		// Make sure every operation we rely on is implemented by this kernel
+		size_t probe_size = sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op);
+		io_uring_probe* probe = (io_uring_probe*)calloc(1, probe_size);
+		bool supported = io_uring_register(this->ring_fd_, IORING_REGISTER_PROBE, probe, 256) >= 0;
+
+		for (int op : required_ops) {
+			supported = supported && op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+		}
+
+		free(probe);
+
+		if (!supported) {
+			return false;
+		}
+
+		this->sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+		this->cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+		if (params.features & IORING_FEAT_SINGLE_MMAP) {
+			this->sq_ring_size_ = max(this->sq_ring_size_, this->cq_ring_size_);
+			this->cq_ring_size_ = this->sq_ring_size_;
+		}
+
+		this->sq_ring_ = mmap(NULL, this->sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->ring_fd_, IORING_OFF_SQ_RING);
+
+		if (this->sq_ring_ == MAP_FAILED) {
+			return false;
+		}
+
+		if (params.features & IORING_FEAT_SINGLE_MMAP) {
+			this->cq_ring_ = this->sq_ring_;
+		} else {
+			this->cq_ring_ = mmap(NULL, this->cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->ring_fd_, IORING_OFF_CQ_RING);
+
+			if (this->cq_ring_ == MAP_FAILED) {
+				return false;
+			}
+		}
+
+		this->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+		this->sqes_ = (io_uring_sqe*)mmap(NULL, this->sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->ring_fd_, IORING_OFF_SQES);
+
+		if (this->sqes_ == MAP_FAILED) {
+			return false;
+		}
+
+		char* sq = (char*)this->sq_ring_;
+		this->sq_head_ = (unsigned int*)(sq + params.sq_off.head);
+		this->sq_tail_ = (unsigned int*)(sq + params.sq_off.tail);
+		this->sq_mask_ = (unsigned int*)(sq + params.sq_off.ring_mask);
+		this->sq_entries_ = (unsigned int*)(sq + params.sq_off.ring_entries);
+		this->sq_array_ = (unsigned int*)(sq + params.sq_off.array);
+
+		char* cq = (char*)this->cq_ring_;
+		this->cq_head_ = (unsigned int*)(cq + params.cq_off.head);
+		this->cq_tail_ = (unsigned int*)(cq + params.cq_off.tail);
+		this->cq_mask_ = (unsigned int*)(cq + params.cq_off.ring_mask);
+		this->cqes_ = (io_uring_cqe*)(cq + params.cq_off.cqes);
+		this->cq_entries_ = params.cq_entries;
+
+		// Completions are signalled through an eventfd watched by the main loop
+		this->event_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+		if (this->event_fd_ < 0 || io_uring_register(this->ring_fd_, IORING_REGISTER_EVENTFD, &this->event_fd_, 1) < 0) {
+			return false;
+		}
+
+		this->event_source_id_ = g_unix_fd_add_full(G_PRIORITY_DEFAULT, this->event_fd_, G_IO_IN, CompletionSourceCallback, this, NULL);
+		return true;
+	}
+
+	void IoRing::Submit(Prepare prepare, Completion completion) {
+		Request* request = new Request();
+		request->prepare = prepare;
+		request->completion = completion;
+
+		if (!this->backlog_.empty() || !this->Enqueue(request)) {
+			this->backlog_.push_back(request);
+			return;
+		}
+
+		this->Flush();
+	}
+
+	void IoRing::Flush() {
+		unsigned int head = __atomic_load_n(this->sq_head_, __ATOMIC_ACQUIRE);
+		unsigned int tail = *this->sq_tail_;
+		int error = 0;
+
+		while (head != tail) {
+			int result = io_uring_enter(this->ring_fd_, tail - head, 0, 0);
+
+			if (result < 0 && errno == EINTR) {
+				continue;
+			}
+
+			if (result <= 0) {
+				error = result < 0 ? errno : EAGAIN;
+				break;
+			}
+
+			head = __atomic_load_n(this->sq_head_, __ATOMIC_ACQUIRE);
+		}
+
+		if (error == 0) {
+			return;
+		}
+
+		// The kernel only takes entries while entering, so the rest can be taken back
+		for (unsigned int i = head; i != tail; i++) {
+			Request* request = (Request*)this->sqes_[this->sq_array_[i & *this->sq_mask_]].user_data;
+			this->failed_.push_back({ request, -error });
+			this->in_flight_--;
+		}
+
+		__atomic_store_n(this->sq_tail_, head, __ATOMIC_RELEASE);
+
+		// Completions run from the main loop as usual, never from inside Submit()
+		uint64_t value = 1;
+
+		while (write(this->event_fd_, &value, sizeof(value)) < 0 && errno == EINTR) {
+		}
+	}
+
+	bool IoRing::Enqueue(Request* request) {
+		unsigned int head = __atomic_load_n(this->sq_head_, __ATOMIC_ACQUIRE);
+		unsigned int tail = *this->sq_tail_;
+
+		// Keep in-flight requests within the completion queue so none are dropped
+		if (tail - head >= *this->sq_entries_ || this->in_flight_ >= this->cq_entries_) {
+			return false;
+		}
+
+		unsigned int index = tail & *this->sq_mask_;
+		io_uring_sqe* sqe = &this->sqes_[index];
+
+		memset(sqe, 0, sizeof(io_uring_sqe));
+		request->prepare(sqe);
+		sqe->user_data = (uint64_t)request;
+
+		this->sq_array_[index] = index;
+		__atomic_store_n(this->sq_tail_, tail + 1, __ATOMIC_RELEASE);
+		this->in_flight_++;
+
+		return true;
+	}
+
+	void IoRing::Reap() {
+		uint64_t value;
+
+		while (read(this->event_fd_, &value, sizeof(value)) < 0 && errno == EINTR) {
+		}
+
+		Isolate* isolate = Isolate::GetCurrent();
+		HandleScope handle_scope(isolate);
+		TryCatch try_catch(isolate);
+		PerformanceMonitor::Scope measure("io-completion");
+
+		// Requests the kernel refused are settled with the error from entering the ring
+		vector<pair<Request*, int>> failed;
+		failed.swap(this->failed_);
+
+		for (pair<Request*, int>& entry : failed) {
+			entry.first->completion(entry.second);
+			delete entry.first;
+
+			if (try_catch.HasCaught()) {
+				report_exception(isolate, &try_catch);
+				try_catch.Reset();
+			}
+		}
+
+		unsigned int head = *this->cq_head_;
+
+		while (head != __atomic_load_n(this->cq_tail_, __ATOMIC_ACQUIRE)) {
+			io_uring_cqe* cqe = &this->cqes_[head & *this->cq_mask_];
+			Request* request = (Request*)cqe->user_data;
+			int result = cqe->res;
+
+			head++;
+			__atomic_store_n(this->cq_head_, head, __ATOMIC_RELEASE);
+			this->in_flight_--;
+
+			// Completions may submit follow-up operations
+			request->completion(result);
+			delete request;
+
+			if (try_catch.HasCaught()) {
+				report_exception(isolate, &try_catch);
+				try_catch.Reset();
+			}
+		}
+
+		// Slots were freed, move queued requests into the ring
+		while (!this->backlog_.empty() && this->Enqueue(this->backlog_.front())) {
+			this->backlog_.pop_front();
+		}
+
+		this->Flush();
+
+		isolate->PerformMicrotaskCheckpoint();
+
+		if (try_catch.HasCaught()) {
+			report_exception(isolate, &try_catch);
+		}
+	}
+
+	gboolean IoRing::CompletionSourceCallback(gint fd, GIOCondition condition, gpointer user_data) {
+		IoRing* self = (IoRing*)user_data;
+		self->Reap();
+
+		return G_SOURCE_CONTINUE;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,303 @@
+#include <v8.h>
+#include <gtk-3.0/gtk/gtk.h>
+#include <glib.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <runtime/performance_monitor.h>
+#include "loader.h"
+
+using namespace v8;
+using namespace std;
+
+namespace mosaic::runtime {
+	PerformanceMonitor* PerformanceMonitor::instance_ = nullptr;
+
+	// Number of entries kept around for Performance.getEntries()
+	static const size_t max_buffered_entries = 150;
+
+	// How often the lag timer is expected to fire, in milliseconds
+	static const guint lag_sample_interval = 100;
+
+	static string escape_json(const string& value) {
+		string result;
+
+		for (char c : value) {
+			if (c == '"' || c == '\\') {
+				result += '\\';
+				result += c;
+			} else if ((unsigned char)c < 0x20) {
+				result += ' ';
+			} else {
+				result += c;
+			}
+		}
+
+		return result;
+	}
+
+	PerformanceMonitor::Scope::Scope(const char* name, Local<Function> callback) {
+		this->name_ = name;
+		this->callback_ = callback;
+		this->start_ = g_get_monotonic_time();
+
+		PerformanceMonitor::GetInstance()->depth_++;
+	}
+
+	PerformanceMonitor::Scope::~Scope() {
+		PerformanceMonitor* monitor = PerformanceMonitor::GetInstance();
+		monitor->depth_--;
+		monitor->RecordDispatch(this->name_, this->callback_, this->start_, g_get_monotonic_time());
+	}
+
+	PerformanceMonitor::PerformanceMonitor() {
+		this->origin_ = g_get_monotonic_time();
+		this->depth_ = 0;
+		this->long_task_threshold_ = 50;
+		this->next_listener_id_ = 1;
+		this->deliver_source_id_ = 0;
+		this->lag_source_id_ = 0;
+		this->last_lag_tick_ = 0;
+		this->current_lag_ = 0;
+		this->max_lag_ = 0;
+		this->lag_sum_ = 0;
+		this->lag_samples_ = 0;
+		this->trace_file_ = NULL;
+		this->trace_has_events_ = false;
+
+		const char* threshold = getenv("MOSAIC_LONG_TASK_MS");
+
+		if (threshold != NULL && atof(threshold) > 0) {
+			this->long_task_threshold_ = atof(threshold);
+		}
+
+		const char* trace_path = getenv("MOSAIC_TRACE");
+
+		if (trace_path != NULL && trace_path[0] != '\0') {
+			this->trace_file_ = fopen(trace_path, "w");
+
+			if (this->trace_file_ != NULL) {
+				fputs("{\"traceEvents\":[\n", this->trace_file_);
+				this->EnableLagSampling();
+			}
+		}
+	}
+
+	PerformanceMonitor::~PerformanceMonitor() {
+		if (this->lag_source_id_ != 0) {
+			g_source_remove(this->lag_source_id_);
+		}
+
+		if (this->deliver_source_id_ != 0) {
+			g_source_remove(this->deliver_source_id_);
+		}
+
+		if (this->trace_file_ != NULL) {
+			fputs("\n]}\n", this->trace_file_);
+			fclose(this->trace_file_);
+		}
+	}
+
+	PerformanceMonitor* PerformanceMonitor::GetInstance() {
+		if (instance_ == nullptr) {
+			instance_ = new PerformanceMonitor();
+		}
+
+		return instance_;
+	}
+
+	void PerformanceMonitor::Shutdown() {
+		if (instance_ != nullptr) {
+			delete instance_;
+			instance_ = nullptr;
+		}
+	}
+
+	double PerformanceMonitor::Now() {
+		return (g_get_monotonic_time() - this->origin_) / 1000.0;
+	}
+
+	void PerformanceMonitor::EnableLagSampling() {
+		if (this->lag_source_id_ != 0) {
+			return;
+		}
+
+		this->last_lag_tick_ = g_get_monotonic_time();
+		this->lag_source_id_ = g_timeout_add(lag_sample_interval, LagSampleCallback, this);
+	}
+
+	int PerformanceMonitor::AddListener(Listener listener) {
+		int id = this->next_listener_id_++;
+		this->listeners_[id] = listener;
+		return id;
+	}
+
+	void PerformanceMonitor::RemoveListener(int id) {
+		this->listeners_.erase(id);
+
+		// Nobody is left to take the queued entries
+		if (this->listeners_.empty()) {
+			this->undelivered_.clear();
+
+			if (this->deliver_source_id_ != 0) {
+				g_source_remove(this->deliver_source_id_);
+				this->deliver_source_id_ = 0;
+			}
+		}
+	}
+
+	void PerformanceMonitor::RecordDispatch(const char* name, Local<Function> callback, gint64 start, gint64 end) {
+		bool is_long_task = this->depth_ == 0 && (end - start) / 1000.0 >= this->long_task_threshold_;
+
+		if (this->trace_file_ == NULL && !is_long_task) {
+			return;
+		}
+
+		// Resolving the source is only worth it for dispatches someone will look at
+		string source = DescribeSource(callback);
+
+		if (this->trace_file_ != NULL) {
+			this->WriteTraceEvent(name, source, start, end);
+		}
+
+		if (is_long_task) {
+			this->Record({ "longtask", name, source, (start - this->origin_) / 1000.0, (end - start) / 1000.0 });
+		}
+	}
+
+	void PerformanceMonitor::Record(Entry entry) {
+		this->entries_.push_back(entry);
+
+		if (this->entries_.size() > max_buffered_entries) {
+			this->entries_.pop_front();
+		}
+
+		if (this->listeners_.empty()) {
+			return;
+		}
+
+		this->undelivered_.push_back(entry);
+
+		// Deliver later so observers never run inside the dispatch they observe
+		if (this->deliver_source_id_ == 0) {
+			this->deliver_source_id_ = g_idle_add(DeliverCallback, this);
+		}
+	}
+
+	void PerformanceMonitor::Deliver() {
+		this->deliver_source_id_ = 0;
+
+		vector<Entry> batch;
+		batch.swap(this->undelivered_);
+
+		if (batch.empty()) {
+			return;
+		}
+
+		Isolate* isolate = Isolate::GetCurrent();
+		HandleScope handle_scope(isolate);
+		TryCatch try_catch(isolate);
+
+		// Copy, listeners may disconnect while being called
+		map<int, Listener> listeners = this->listeners_;
+
+		for (auto& [id, listener] : listeners) {
+			// Disconnected by an earlier listener of this batch
+			if (this->listeners_.count(id) == 0) {
+				continue;
+			}
+
+			listener(batch);
+
+			if (try_catch.HasCaught()) {
+				report_exception(isolate, &try_catch);
+				try_catch.Reset();
+			}
+		}
+
+		isolate->PerformMicrotaskCheckpoint();
+
+		if (try_catch.HasCaught()) {
+			report_exception(isolate, &try_catch);
+		}
+	}
+
+	void PerformanceMonitor::WriteTraceEvent(const char* name, const string& source, gint64 start, gint64 end) {
+		fprintf(
+			this->trace_file_,
+			"%s{\"name\":\"%s\",\"cat\":\"mosaic\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":%d,\"tid\":1,\"args\":{\"source\":\"%s\"}}",
+			this->trace_has_events_ ? ",\n" : "",
+			escape_json(name).c_str(),
+			(long long)(start - this->origin_),
+			(long long)(end - start),
+			(int)getpid(),
+			escape_json(source).c_str()
+		);
+
+		this->trace_has_events_ = true;
+	}
+
+	string PerformanceMonitor::DescribeSource(Local<Function> callback) {
+		if (callback.IsEmpty()) {
+			return "";
+		}
+
+		Isolate* isolate = Isolate::GetCurrent();
+		Local<Value> resource_name = callback->GetScriptOrigin().ResourceName();
+		int line = callback->GetScriptLineNumber();
+		int column = callback->GetScriptColumnNumber();
+
+		// Scripts compiled without a name still get a usable source
+		string resource = "<anonymous>";
+
+		if (!resource_name.IsEmpty() && resource_name->IsString() && resource_name.As<String>()->Length() > 0) {
+			resource = *String::Utf8Value(isolate, resource_name);
+		}
+
+		if (line == Function::kLineOffsetNotFound) {
+			return resource;
+		}
+
+		// V8 reports zero-based positions
+		return resource + ":" + to_string(line + 1) + ":" + to_string(column + 1);
+	}
+
+	gboolean PerformanceMonitor::LagSampleCallback(gpointer user_data) {
+		PerformanceMonitor* self = (PerformanceMonitor*)user_data;
+		gint64 now = g_get_monotonic_time();
+
+		// Anything past the expected interval was spent waiting for the loop
+		double lag = (now - self->last_lag_tick_) / 1000.0 - lag_sample_interval;
+
+		if (lag < 0) {
+			lag = 0;
+		}
+
+		self->last_lag_tick_ = now;
+		self->current_lag_ = lag;
+		self->lag_sum_ += lag;
+		self->lag_samples_++;
+
+		if (lag > self->max_lag_) {
+			self->max_lag_ = lag;
+		}
+
+		if (lag >= self->long_task_threshold_) {
+			gint64 lag_start = now - (gint64)(lag * 1000);
+
+			if (self->trace_file_ != NULL) {
+				self->WriteTraceEvent("event-loop-lag", "", lag_start, now);
+			}
+
+			self->Record({ "lag", "event-loop", "", (lag_start - self->origin_) / 1000.0, lag });
+		}
+
+		return G_SOURCE_CONTINUE;
+	}
+
+	gboolean PerformanceMonitor::DeliverCallback(gpointer user_data) {
+		PerformanceMonitor* self = (PerformanceMonitor*)user_data;
+		self->Deliver();
+
+		return G_SOURCE_REMOVE;
+	}
+}
@@ -0,0 +1,324 @@
+#include <v8.h>
+#include <gtk-3.0/gtk/gtk.h>
+#include <glib.h>
+#include <glib-unix.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <errno.h>
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <runtime/performance_monitor.h>
+#include <runtime/task_pool.h>
+#include "loader.h"
+
+using namespace v8;
+using namespace std;
+
+namespace mosaic::runtime {
+	TaskPool* TaskPool::instance_ = nullptr;
+
+	// Index of the worker running on the current thread, or -1 on other threads.
+	static thread_local long current_worker_index = -1;
+
+	TaskPool::TaskPool(size_t thread_count) : next_worker_(0), pending_(0), stopping_(false) {
+		this->event_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+		this->event_source_id_ = g_unix_fd_add_full(G_PRIORITY_DEFAULT, this->event_fd_, G_IO_IN, CompletionSourceCallback, this, NULL);
+
+		for (size_t i = 0; i < thread_count; i++) {
+			this->workers_.push_back(new Worker());
+		}
+
+		for (size_t i = 0; i < thread_count; i++) {
+			this->workers_[i]->handle = thread(&TaskPool::RunWorker, this, i);
+		}
+	}
+
+	TaskPool::~TaskPool() {
+		{
+			lock_guard<mutex> lock(this->sleep_mutex_);
+			this->stopping_ = true;
+		}
+
+		this->sleep_condition_.notify_all();
+
+		for (Worker* worker : this->workers_) {
+			worker->handle.join();
+
+			for (Job* job : worker->queue) {
+				delete job;
+			}
+
+			delete worker;
+		}
+
+		for (Job* job : this->completed_) {
+			delete job;
+		}
+
+		g_source_remove(this->event_source_id_);
+		close(this->event_fd_);
+	}
+
+	TaskPool* TaskPool::GetInstance() {
+		if (instance_ == nullptr) {
+			unsigned int cores = thread::hardware_concurrency();
+
+			// Leave one core to the main loop
+			instance_ = new TaskPool(cores > 1 ? cores - 1 : 1);
+		}
+
+		return instance_;
+	}
+
+	void TaskPool::Shutdown() {
+		delete instance_;
+		instance_ = nullptr;
+	}
+
+	Local<Promise> TaskPool::Submit(Local<Context> context, Work work, Completion completion) {
+		Isolate* isolate = context->GetIsolate();
+		EscapableHandleScope handle_scope(isolate);
+
+		Local<Promise::Resolver> resolver = Promise::Resolver::New(context).ToLocalChecked();
+
+		// Globals are not copyable, so share them with the completion closure
+		auto persistent_context = make_shared<Global<Context>>(isolate, context);
+		auto persistent_resolver = make_shared<Global<Promise::Resolver>>(isolate, resolver);
+
+		Job* job = new Job();
+		job->work = work;
+		job->complete = [job, isolate, persistent_context, persistent_resolver, completion]() {
+			Local<Context> context = persistent_context->Get(isolate);
+			Local<Promise::Resolver> resolver = persistent_resolver->Get(isolate);
+			Context::Scope context_scope(context);
+
+			if (!job->error.empty()) {
+				resolver->Reject(context, Exception::Error(
+					String::NewFromUtf8(isolate, job->error.c_str()).ToLocalChecked()
+				)).Check();
+			} else if (completion) {
+				completion(context, resolver);
+			} else {
+				resolver->Resolve(context, Undefined(isolate)).Check();
+			}
+		};
+
+		this->Push(job);
+		return handle_scope.Escape(resolver->GetPromise());
+	}
+
+	void TaskPool::Post(Work work, function<void()> main_thread_callback) {
+		Job* job = new Job();
+		job->work = work;
+		job->complete = main_thread_callback;
+
+		this->Push(job);
+	}
+
+	void TaskPool::ParallelFor(size_t count, function<void(size_t index)> body) {
+		if (count == 0) {
+			return;
+		}
+
+		struct Batch {
+			atomic<size_t> next { 0 };
+			atomic<size_t> done { 0 };
+			mutex done_mutex;
+			condition_variable done_condition;
+		};
+
+		auto batch = make_shared<Batch>();
+
+		// Every participant claims indices until none are left, so slow items don't stall the rest
+		auto run = [batch, count, body]() {
+			size_t index;
+
+			while ((index = batch->next++) < count) {
+				body(index);
+
+				if (++batch->done == count) {
+					lock_guard<mutex> lock(batch->done_mutex);
+					batch->done_condition.notify_all();
+				}
+			}
+		};
+
+		size_t helpers = min(count - 1, this->workers_.size());
+
+		for (size_t i = 0; i < helpers; i++) {
+			this->Post(run);
+		}
+
+		run();
+
+		unique_lock<mutex> lock(batch->done_mutex);
+		batch->done_condition.wait(lock, [&batch, count]() { return batch->done == count; });
+	}
+
+	void TaskPool::Push(Job* job) {
+		// Nested work stays on the submitting worker, everything else is spread round-robin
+		size_t index = current_worker_index >= 0
+			? (size_t)current_worker_index
+			: this->next_worker_++ % this->workers_.size();
+
+		Worker* worker = this->workers_[index];
+
+		{
+			lock_guard<mutex> lock(worker->queue_mutex);
+			worker->queue.push_back(job);
+		}
+
+		{
+			lock_guard<mutex> lock(this->sleep_mutex_);
+			this->pending_++;
+		}
+
+		this->sleep_condition_.notify_one();
+	}
+
+	TaskPool::Job* TaskPool::Pop(size_t worker_index) {
+		Worker* worker = this->workers_[worker_index];
+		lock_guard<mutex> lock(worker->queue_mutex);
+
+		if (worker->queue.empty()) {
+			return nullptr;
+		}
+
+		// Owner takes the newest job, which is the most likely to be cache-hot
+		Job* job = worker->queue.back();
+		worker->queue.pop_back();
+		return job;
+	}
+
+	TaskPool::Job* TaskPool::Steal(size_t thief_index) {
+		size_t count = this->workers_.size();
+
+		for (size_t i = 1; i < count; i++) {
+			Worker* victim = this->workers_[(thief_index + i) % count];
+			lock_guard<mutex> lock(victim->queue_mutex);
+
+			if (!victim->queue.empty()) {
+				// Thieves take the oldest job from the other end
+				Job* job = victim->queue.front();
+				victim->queue.pop_front();
+				return job;
+			}
+		}
+
+		return nullptr;
+	}
+
+	void TaskPool::RunWorker(size_t worker_index) {
+		current_worker_index = worker_index;
+
+		while (true) {
+			Job* job = this->Pop(worker_index);
+
+			if (job == nullptr) {
+				job = this->Steal(worker_index);
+			}
+
+			if (job == nullptr) {
+				unique_lock<mutex> lock(this->sleep_mutex_);
+				this->sleep_condition_.wait(lock, [this]() { return this->pending_ > 0 || this->stopping_; });
+
+				if (this->stopping_) {
+					return;
+				}
+
+				continue;
+			}
+
+			{
+				lock_guard<mutex> lock(this->sleep_mutex_);
+				this->pending_--;
+			}
+
+			try {
+				job->work();
+			} catch (const exception& e) {
+				job->error = e.what();
+			} catch (...) {
+				job->error = "Native task failed.";
+			}
+
+			this->Complete(job);
+		}
+	}
+
+	void TaskPool::Complete(Job* job) {
+		if (!job->complete) {
+			delete job;
+			return;
+		}
+
+		bool was_empty;
+
+		{
+			lock_guard<mutex> lock(this->completed_mutex_);
+			was_empty = this->completed_.empty();
+			this->completed_.push_back(job);
+		}
+
+		// Only wake the main loop once per batch
+		if (was_empty) {
+			this->Wake();
+		}
+	}
+
+	void TaskPool::Wake() {
+		uint64_t value = 1;
+
+		// EAGAIN means the counter is full, so the main loop is already woken
+		while (write(this->event_fd_, &value, sizeof(value)) < 0 && errno == EINTR) {
+		}
+	}
+
+	void TaskPool::DrainCompletions() {
+		uint64_t value;
+
+		// EAGAIN means another drain already reset the counter, the batch below is still checked
+		while (read(this->event_fd_, &value, sizeof(value)) < 0 && errno == EINTR) {
+		}
+
+		vector<Job*> batch;
+
+		{
+			lock_guard<mutex> lock(this->completed_mutex_);
+			batch.swap(this->completed_);
+		}
+
+		if (batch.empty()) {
+			return;
+		}
+
+		Isolate* isolate = Isolate::GetCurrent();
+		HandleScope handle_scope(isolate);
+		TryCatch try_catch(isolate);
+		PerformanceMonitor::Scope measure("task-completion");
+
+		for (Job* job : batch) {
+			job->complete();
+			delete job;
+
+			if (try_catch.HasCaught()) {
+				report_exception(isolate, &try_catch);
+				try_catch.Reset();
+			}
+		}
+
+		isolate->PerformMicrotaskCheckpoint();
+
+		if (try_catch.HasCaught()) {
+			report_exception(isolate, &try_catch);
+		}
+	}
+
+	gboolean TaskPool::CompletionSourceCallback(gint fd, GIOCondition condition, gpointer user_data) {
+		TaskPool* self = (TaskPool*)user_data;
+		self->DrainCompletions();
+
+		return G_SOURCE_CONTINUE;
+	}
+}
\ No newline at end of file